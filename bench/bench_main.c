@@ -0,0 +1,160 @@
+/* ===========================================================
+   #File: bench_main.c #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: owin32_bench: runs the harness's cases, writes and compares result files #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+/*
+    owin32_bench [filter...] [reps=N] [warmup=N] [cpus=LIST] [json=FILE] [tmp=DIR]
+                    runs every case whose name starts with one of the
+                    filters (all of them without any), prints a table and,
+                    with json=, writes the results; exits 1 on a MISMATCH
+    owin32_bench list
+                    the cases, one per line
+    owin32_bench compare BASE.json NEW.json [threshold=PCT]
+                    NEW against BASE, case by case; exits 1 when a case got
+                    slower beyond PCT (default 5) and beyond the noise, or
+                    fails its check in NEW
+
+For a baseline and a later check of the same machine:
+
+    owin32_bench cpus=2 reps=20 json=base.json
+    ...
+    owin32_bench cpus=2 reps=20 json=new.json
+    owin32_bench compare base.json new.json threshold=3
+*/
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "harness.h"
+
+#ifndef _countof
+#define _countof(a) (sizeof(a) / sizeof((a)[0]))
+#endif
+
+#define MAX_FILTERS     32
+
+static BenchGroup const * const g_groups [] = {
+    &g_queue_group, &g_co_group, &g_fileio_group, &g_records_group, &g_str_group, &g_misc_group,
+    &g_except_group,
+};
+
+// =========================================================================================
+
+/* "key=value": the value if arg has that key, NULL otherwise */
+static char const *
+option (char const * arg, char const * key) {
+    size_t len = strlen(key);
+    return (0 == strncmp(arg, key, len) && '=' == arg[len]) ? arg + len + 1 : NULL;
+}
+
+/* No filters selects every case, otherwise those with one of them as a prefix */
+static int
+selected (char const * name, char const * const * filters, int n_filters) {
+    if (0 == n_filters)
+        return 1;
+    for (int i = 0; i < n_filters; ++i)
+        if (0 == strncmp(name, filters[i], strlen(filters[i])))
+            return 1;
+    return 0;
+}
+
+static int
+compare (int argc, char * argv []) {
+    double threshold = 5.0;
+    char const * v;
+    if (argc < 4) {
+        fprintf(stderr, "usage: owin32_bench compare BASE.json NEW.json [threshold=PCT]\n");
+        return(2);
+    }
+    for (int i = 4; i < argc; ++i) {
+        if (NULL != (v = option(argv[i], "threshold"))) {
+            threshold = atof(v);
+        } else {
+            fprintf(stderr, "unknown argument: %s\n", argv[i]);
+            return(2);
+        }
+    }
+    int regressions = Bench_Compare(argv[2], argv[3], threshold, stdout);
+    if (regressions < 0) {
+        fprintf(stderr, "cannot read %s or %s\n", argv[2], argv[3]);
+        return(2);
+    }
+    return(regressions > 0);
+}
+
+int main (int argc, char * argv []) {
+    char const * filters[MAX_FILTERS];
+    char const * json = NULL;
+    char const * v;
+    int n_filters = 0;
+
+    if (argc > 1 && 0 == strcmp(argv[1], "compare"))
+        return compare(argc, argv);
+    if (argc > 1 && 0 == strcmp(argv[1], "list")) {
+        for (size_t g = 0; g < _countof(g_groups); ++g)
+            for (size_t i = 0; i < g_groups[g]->count; ++i)
+                printf("%-28s %s\n", g_groups[g]->cases[i].name, g_groups[g]->cases[i].unit);
+        return(0);
+    }
+
+    for (int i = 1; i < argc; ++i) {
+        if (NULL != (v = option(argv[i], "reps"))) {
+            g_bench.reps = atoi(v);
+        } else if (NULL != (v = option(argv[i], "warmup"))) {
+            g_bench.warmup = atoi(v);
+        } else if (NULL != (v = option(argv[i], "cpus"))) {
+            g_bench.cpus = v;
+        } else if (NULL != (v = option(argv[i], "json"))) {
+            json = v;
+        } else if (NULL != (v = option(argv[i], "tmp"))) {
+            g_bench.tmp_dir = v;
+        } else if (strchr(argv[i], '=') != NULL || n_filters == MAX_FILTERS) {
+            fprintf(stderr, "unknown argument: %s\n", argv[i]);
+            return(2);
+        } else {
+            filters[n_filters++] = argv[i];
+        }
+    }
+    if (g_bench.cpus != NULL && !Bench_Pin(g_bench.cpus)) {
+        fprintf(stderr, "cannot pin to cpus %s\n", g_bench.cpus);
+        return(2);
+    }
+
+    size_t total = 0;
+    for (size_t g = 0; g < _countof(g_groups); ++g)
+        total += g_groups[g]->count;
+    BenchResult * results = (BenchResult *)calloc(total, sizeof(BenchResult));
+    size_t n = 0;
+    int failed = 0;
+    if (NULL == results)
+        return(2);
+
+    printf("%d reps, %d warmup, cpus %s\n", g_bench.reps, g_bench.warmup, g_bench.cpus ? g_bench.cpus : "any");
+    Bench_PrintHeader(stdout);
+    for (size_t g = 0; g < _countof(g_groups); ++g) {
+        for (size_t i = 0; i < g_groups[g]->count; ++i) {
+            BenchCase const * c = &g_groups[g]->cases[i];
+            if (!selected(c->name, filters, n_filters))
+                continue;
+            failed |= !Bench_Run(c, &results[n]);
+            Bench_Print(&results[n++], stdout);
+            fflush(stdout);
+        }
+    }
+    if (0 == n)
+        fprintf(stderr, "no case matches\n");
+    if (json != NULL && !Bench_WriteJson(json, results, n)) {
+        fprintf(stderr, "cannot write %s\n", json);
+        failed = 1;
+    }
+    free(results);
+    return(failed || 0 == n);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+/* ===========================================================
+   #File: bench_util.h #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: What the samples' own bench programs share: workload names, timing, thread runs #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#include <string.h>
+
+#include "../multithreading/common/mt_platform.h"
+
+/*
+The bench programs next to the samples (alloc_bench, pool_bench, ...) print
+their own tables of sizes and thread counts, which owin32_bench's fixed cases
+do not cover. Their command line is a list of workload names, none for all
+of them, plus key=value options of their own; every measurement is the best
+of BENCH_REPS runs. A program defines BENCH_REPS before the include to
+change it.
+*/
+
+#ifndef BENCH_REPS
+#define BENCH_REPS          3       // best of
+#endif
+#define BENCH_MAX_THREADS   64
+
+/* No workload names runs every workload, otherwise only the named ones; key=value is not a name */
+MT_INLINE int
+BenchUtil_Wanted (int argc, char * argv [], char const * name) {
+    int named = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (0 == strcmp(argv[i], name))
+            return 1;
+        named |= (NULL == strchr(argv[i], '='));
+    }
+    return !named;
+}
+
+/* mt_now_ns in seconds: differences of two are wall times */
+MT_INLINE double
+BenchUtil_Now (void) {
+    return (double)mt_now_ns() * 1e-9;
+}
+
+/*
+Runs fn on n threads (at most BENCH_MAX_THREADS), thread i getting
+(char *)args + i * arg_size. Returns the wall time from the first start
+to the last join, or a negative time if a thread cannot be started.
+*/
+MT_INLINE double
+BenchUtil_RunThreads (int n, MtThreadFn fn, void * args, size_t arg_size) {
+    MtThread threads[BENCH_MAX_THREADS];
+    int started = 0, ok = (n <= BENCH_MAX_THREADS);
+    int64_t t = mt_now_ns();
+    for (; ok && started < n; ++started)
+        ok = mt_thread_create(&threads[started], fn, (char *)args + (size_t)started * arg_size);
+    if (!ok)
+        --started;
+    for (int i = 0; i < started; ++i)
+        mt_thread_join(threads[i]);
+    t = mt_now_ns() - t;
+    return ok ? (double)t * 1e-9 : -1.0;
+}
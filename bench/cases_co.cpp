@@ -0,0 +1,107 @@
+/* ===========================================================
+   #File: cases_co.cpp #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Harness cases: common/co_queue's awaitable queue on a thread pool #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+/*
+    queue/co_queue      one producer and one consumer coroutine on a pool of
+                        two, through a CoQueue of 1024
+    queue/co_fanout     one producer, 64 consumer coroutines on the same pool
+*/
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L    /* clock_gettime */
+#endif
+
+#include <stdlib.h>
+
+#include "harness.h"
+#include "../multithreading/common/co_queue.h"
+#include "../multithreading/common/thread_group.h"
+#include "../multithreading/common/thread_pool.h"
+
+#define CO_ITEMS        (1 << 17)
+#define CO_CAPACITY     1024
+#define CO_WORKERS      2
+#define CO_FANOUT       64
+
+// =========================================================================================
+
+struct CoRun {
+    ThreadPool          pool;
+    int64_t volatile    sum;
+};
+
+static CoTask<void>
+co_producer (CoQueue<int64_t> * q, Latch * done) {
+    for (int64_t v = 1; v <= CO_ITEMS; ++v)
+        co_await q->push(v);
+    Latch_CountDown(done);
+}
+static CoTask<void>
+co_consumer (CoQueue<int64_t> * q, CoRun * r, Latch * done) {
+    int64_t sum = 0;
+    while (std::optional<int64_t> v = co_await q->pop())
+        sum += *v;
+    mt_fetch_add(&r->sum, sum);
+    Latch_CountDown(done);
+}
+
+static void *
+setup_co (void) {
+    CoRun * r = (CoRun *)calloc(1, sizeof(CoRun));
+    if (r != NULL && !ThreadPool_Init(&r->pool, CO_WORKERS)) {
+        free(r);
+        r = NULL;
+    }
+    return r;
+}
+static void
+teardown_co (void * state) {
+    ThreadPool_Deinit(&((CoRun *)state)->pool);
+    free(state);
+}
+
+static int64_t
+co_run (CoRun * r, int consumers) {
+    Latch produced, consumed;
+    r->sum = 0;
+    Latch_Init(&produced, 1);
+    Latch_Init(&consumed, consumers);
+    {
+        CoQueue<int64_t> q(&r->pool, CO_CAPACITY);
+        for (int i = 0; i < consumers; ++i)
+            Co_Spawn(&r->pool, co_consumer(&q, r, &consumed));
+        Co_Spawn(&r->pool, co_producer(&q, &produced));
+        Latch_Wait(&produced, MT_INFINITE);
+        q.close();
+        Latch_Wait(&consumed, MT_INFINITE);
+        ThreadPool_Wait(&r->pool);     // the last resumptions may still be returning
+    }
+    Latch_Deinit(&produced);
+    Latch_Deinit(&consumed);
+    return (mt_load_acquire(&r->sum) == (int64_t)CO_ITEMS * (CO_ITEMS + 1) / 2) ? CO_ITEMS : -1;
+}
+static int64_t
+run_co_queue (void * state) {
+    return co_run((CoRun *)state, 1);
+}
+static int64_t
+run_co_fanout (void * state) {
+    return co_run((CoRun *)state, CO_FANOUT);
+}
+
+// =========================================================================================
+
+static BenchCase const g_co_cases [] = {
+    {"queue/co_queue",      "msg",      setup_co,   run_co_queue,   teardown_co},
+    {"queue/co_fanout",     "msg",      setup_co,   run_co_fanout,  teardown_co},
+};
+
+BenchGroup const g_co_group = {g_co_cases, sizeof(g_co_cases) / sizeof(g_co_cases[0])};
@@ -0,0 +1,485 @@
+/* ===========================================================
+   #File: cases_except.cpp #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Harness cases: except_hndlng's error propagation, fault-guarded batches, lazy buffers #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+/*
+The propagation cases are ms_try_except's: 8 frames over a leaf that fails
+on 1% of 64k inputs, each strategy checked against the sum and the error
+count of the code variant.
+
+    except/propagate_code           int return, the result through an out parameter
+    except/propagate_last_error     bool return, the code in thread-local state
+    except/propagate_result         value and code returned together
+    except/propagate_exception      C++ throw at the leaf, try/catch at the top
+    except/propagate_seh            RaiseException, __try/__except (Windows)
+    except/propagate_longjmp        setjmp per call, longjmp at the leaf
+    except/batch_clean              FaultBatch_Run over 1M records, 4096 per chunk
+    except/batch_corrupt            the same with 8 bad pointers planted: exactly
+                                    their chunks must fault
+    except/lazy_append              64-byte records appended to a LazyBuffer,
+                                    16 MB committed by faults 64 KB at a time
+    except/lazy_committed           the same, committed 1 MB ahead: no faults
+
+FaultBatch's signal handler must be installed before LazyBuffer's (see
+fault_batch.h), so the batch cases come first.
+*/
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <setjmp.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include "harness.h"
+#include "../except_hndlng/lazy_buffer/lazy_buffer.h"
+#include "../except_hndlng/ms_try_except/fault_batch.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#define NOINLINE __declspec(noinline)
+#else
+#define NOINLINE __attribute__((noinline))
+#endif
+
+#define DEPTH           8
+#define N_INPUTS        (1 << 16)
+#define FAIL_BELOW      655         // of 65536: 1%
+#define ERR_BAD_RECORD  0x2001
+
+#define SCAN_RECORDS    (1 << 20)
+#define SCAN_VALUES     (1 << 12)
+#define SCAN_BAD_EVERY  (1 << 17)
+#define SCAN_CHUNK      4096
+
+#define LAZY_BYTES      ((size_t)16 << 20)
+#define LAZY_RESERVE    ((size_t)64 << 20)
+#define LAZY_CHUNK      (64 << 10)
+#define LAZY_AHEAD      (1 << 20)
+
+static uint64_t
+next_rand (uint64_t * state) {
+    // -- xorshift64*
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+// =========================================================================================
+
+#pragma region propagate
+static inline bool
+leaf_fails (uint32_t x) {
+    return (x & 0xFFFF) < FAIL_BELOW;
+}
+static inline uint32_t
+leaf_work (uint32_t x) {
+    x *= 0x9E3779B1u;
+    x ^= x >> 15;
+    x *= 0x85EBCA77u;
+    return x ^ (x >> 13);
+}
+
+template <int D> static NOINLINE int
+by_code (uint32_t x, uint32_t * out) {
+    if constexpr (D == 0) {
+        if (leaf_fails(x))
+            return ERR_BAD_RECORD;
+        *out = leaf_work(x);
+        return 0;
+    } else {
+        int err = by_code<D - 1>(x, out);
+        if (err != 0)
+            return err;
+        *out += D;
+        return 0;
+    }
+}
+
+static thread_local uint32_t t_last_error;
+
+template <int D> static NOINLINE bool
+by_last_error (uint32_t x, uint32_t * out) {
+    if constexpr (D == 0) {
+        if (leaf_fails(x)) {
+            t_last_error = ERR_BAD_RECORD;
+            return false;
+        }
+        *out = leaf_work(x);
+        return true;
+    } else {
+        if (!by_last_error<D - 1>(x, out))
+            return false;
+        *out += D;
+        return true;
+    }
+}
+
+struct Result {
+    uint32_t value;
+    int error;
+};
+
+template <int D> static NOINLINE Result
+by_result (uint32_t x) {
+    if constexpr (D == 0) {
+        if (leaf_fails(x))
+            return Result{0, ERR_BAD_RECORD};
+        return Result{leaf_work(x), 0};
+    } else {
+        Result r = by_result<D - 1>(x);
+        if (r.error != 0)
+            return r;
+        return Result{r.value + D, 0};
+    }
+}
+
+struct RecordError {
+    int code;
+};
+
+template <int D> static NOINLINE uint32_t
+by_exception (uint32_t x) {
+    if constexpr (D == 0) {
+        if (leaf_fails(x))
+            throw RecordError{ERR_BAD_RECORD};
+        return leaf_work(x);
+    } else {
+        return by_exception<D - 1>(x) + D;
+    }
+}
+
+#ifdef _WIN32
+#define EXC_BAD_RECORD  0xE0002001u
+
+template <int D> static NOINLINE uint32_t
+by_seh (uint32_t x) {
+    if constexpr (D == 0) {
+        if (leaf_fails(x))
+            RaiseException(EXC_BAD_RECORD, 0, 0, NULL);
+        return leaf_work(x);
+    } else {
+        return by_seh<D - 1>(x) + D;
+    }
+}
+/* __try cannot share a function with objects that unwind */
+static uint32_t
+seh_call (uint32_t x, uint64_t * errors) {
+    __try {
+        return by_seh<DEPTH>(x);
+    } __except (GetExceptionCode() == EXC_BAD_RECORD ? EXCEPTION_EXECUTE_HANDLER : EXCEPTION_CONTINUE_SEARCH) {
+        ++*errors;
+        return 0;
+    }
+}
+#endif
+
+static thread_local jmp_buf * t_jump;
+
+template <int D> static NOINLINE uint32_t
+by_longjmp (uint32_t x) {
+    if constexpr (D == 0) {
+        if (leaf_fails(x))
+            longjmp(*t_jump, ERR_BAD_RECORD);
+        return leaf_work(x);
+    } else {
+        return by_longjmp<D - 1>(x) + D;
+    }
+}
+
+struct PropagateRun {
+    uint32_t    inputs[N_INPUTS];
+    uint64_t    sum;            // the code variant's, for the check
+    uint64_t    errors;
+};
+
+static int64_t
+check_totals (PropagateRun const * r, uint64_t sum, uint64_t errors) {
+    Bench_Consume(sum);
+    return (sum == r->sum && errors == r->errors) ? N_INPUTS : -1;
+}
+
+static void *
+setup_propagate (void) {
+    PropagateRun * r = (PropagateRun *)malloc(sizeof(PropagateRun));
+    if (NULL == r)
+        return NULL;
+    uint64_t rng = 0x9E3779B97F4A7C15ULL;
+    for (uint32_t & x : r->inputs)
+        x = (uint32_t)(next_rand(&rng) >> 32);
+    // -- the code variant is the reference: a run against its own totals only times it
+    r->sum = 0;
+    r->errors = 0;
+    for (uint32_t x : r->inputs) {
+        uint32_t v;
+        if (by_code<DEPTH>(x, &v) != 0)
+            r->errors++;
+        else
+            r->sum += v;
+    }
+    return r;
+}
+static void
+teardown_propagate (void * state) {
+    free(state);
+}
+static int64_t
+run_propagate_code (void * state) {
+    PropagateRun * r = (PropagateRun *)state;
+    uint64_t sum = 0, errors = 0;
+    for (uint32_t x : r->inputs) {
+        uint32_t v;
+        if (by_code<DEPTH>(x, &v) != 0)
+            errors++;
+        else
+            sum += v;
+    }
+    return check_totals(r, sum, errors);
+}
+static int64_t
+run_propagate_last_error (void * state) {
+    PropagateRun * r = (PropagateRun *)state;
+    uint64_t sum = 0, errors = 0;
+    for (uint32_t x : r->inputs) {
+        uint32_t v;
+        if (!by_last_error<DEPTH>(x, &v))
+            errors += (t_last_error == ERR_BAD_RECORD);
+        else
+            sum += v;
+    }
+    return check_totals(r, sum, errors);
+}
+static int64_t
+run_propagate_result (void * state) {
+    PropagateRun * r = (PropagateRun *)state;
+    uint64_t sum = 0, errors = 0;
+    for (uint32_t x : r->inputs) {
+        Result res = by_result<DEPTH>(x);
+        if (res.error != 0)
+            errors++;
+        else
+            sum += res.value;
+    }
+    return check_totals(r, sum, errors);
+}
+static int64_t
+run_propagate_exception (void * state) {
+    PropagateRun * r = (PropagateRun *)state;
+    uint64_t sum = 0, errors = 0;
+    for (uint32_t x : r->inputs) {
+        try {
+            sum += by_exception<DEPTH>(x);
+        } catch (RecordError const & e) {
+            errors += (e.code == ERR_BAD_RECORD);
+        }
+    }
+    return check_totals(r, sum, errors);
+}
+#ifdef _WIN32
+static int64_t
+run_propagate_seh (void * state) {
+    PropagateRun * r = (PropagateRun *)state;
+    uint64_t sum = 0, errors = 0;
+    for (uint32_t x : r->inputs)
+        sum += seh_call(x, &errors);
+    return check_totals(r, sum, errors);
+}
+#endif
+static int64_t
+run_propagate_longjmp (void * state) {
+    PropagateRun * r = (PropagateRun *)state;
+    struct { uint64_t sum, errors; } t = {0, 0};
+    for (uint32_t x : r->inputs) {
+        jmp_buf env;
+        t_jump = &env;
+        // -- t is only written after the call returns, never between setjmp and longjmp
+        int err = setjmp(env);
+        if (err == 0)
+            t.sum += by_longjmp<DEPTH>(x);
+        else
+            t.errors += (err == ERR_BAD_RECORD);
+    }
+    return check_totals(r, t.sum, t.errors);
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region batch
+struct ScanRecord {
+    uint64_t key;
+    uint64_t const * value;
+};
+
+struct ScanRun {
+    std::vector<uint64_t>   values;
+    std::vector<ScanRecord> clean;
+    std::vector<ScanRecord> corrupt;
+    std::vector<uint8_t>    planted;    // per chunk: holds a bad pointer
+    size_t                  n_planted;  // chunks that do
+    std::vector<uint64_t>   ref_sums;   // per chunk, of the clean records
+    std::vector<uint64_t>   sums;
+    std::vector<uint8_t>    status;
+};
+
+struct ScanJob {
+    ScanRecord const * records;
+    uint64_t * chunk_sums;
+};
+
+static int
+scan_chunk (void * ctx, size_t i_chunk, size_t first, size_t count) {
+    ScanJob * job = (ScanJob *)ctx;
+    ScanRecord const * r = job->records + first;
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; ++i)
+        sum += r[i].key ^ *r[i].value;
+    job->chunk_sums[i_chunk] = sum;
+    return 0;
+}
+
+static void *
+setup_scan (void) {
+    ScanRun * r = new ScanRun;
+    size_t n_chunks = FaultBatch_ChunkCount(SCAN_RECORDS, SCAN_CHUNK);
+    uint64_t rng = 0xD1B54A32D192ED03ULL;
+    r->values.resize(SCAN_VALUES);
+    for (uint64_t & v : r->values)
+        v = next_rand(&rng);
+    r->clean.resize(SCAN_RECORDS);
+    for (ScanRecord & rec : r->clean) {
+        uint64_t x = next_rand(&rng);
+        rec.key = x;
+        rec.value = &r->values[(x >> 40) % SCAN_VALUES];
+    }
+    // -- bad pointers: near NULL, and into the kernel half
+    r->corrupt = r->clean;
+    r->planted.assign(n_chunks, 0);
+    r->n_planted = 0;
+    for (size_t i = SCAN_BAD_EVERY / 2; i < SCAN_RECORDS; i += SCAN_BAD_EVERY) {
+        r->corrupt[i].value = (i / SCAN_BAD_EVERY % 2) ? (uint64_t const *)(uintptr_t)0x10 : (uint64_t const *)~(uintptr_t)0xFFF;
+        r->n_planted += !r->planted[i / SCAN_CHUNK];
+        r->planted[i / SCAN_CHUNK] = 1;
+    }
+
+    r->ref_sums.resize(n_chunks);
+    r->sums.resize(n_chunks);
+    r->status.resize(n_chunks);
+    ScanJob ref = {r->clean.data(), r->ref_sums.data()};
+    for (size_t i = 0, first = 0; first < SCAN_RECORDS; ++i, first += SCAN_CHUNK)
+        scan_chunk(&ref, i, first, (SCAN_RECORDS - first < SCAN_CHUNK) ? SCAN_RECORDS - first : SCAN_CHUNK);
+    return r;
+}
+static void
+teardown_scan (void * state) {
+    delete (ScanRun *)state;
+}
+/* With corrupt, exactly the planted chunks faulted; every other chunk gave the clean sum */
+static int64_t
+scan_batch (ScanRun * r, bool corrupt) {
+    ScanJob job = {(corrupt ? r->corrupt : r->clean).data(), r->sums.data()};
+    FaultBatchResult result;
+    FaultBatch_Run(SCAN_RECORDS, SCAN_CHUNK, scan_chunk, &job, r->status.data(), &result);
+
+    bool ok = (result.n_faulted == (corrupt ? r->n_planted : 0));
+    for (size_t c = 0; ok && c < r->status.size(); ++c)
+        ok = (corrupt && r->planted[c])
+            ? FAULT_CHUNK_FAULTED == r->status[c]
+            : (FAULT_CHUNK_OK == r->status[c] && r->sums[c] == r->ref_sums[c]);
+    return ok ? SCAN_RECORDS : -1;
+}
+static int64_t
+run_batch_clean (void * state) {
+    return scan_batch((ScanRun *)state, false);
+}
+static int64_t
+run_batch_corrupt (void * state) {
+    return scan_batch((ScanRun *)state, true);
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region lazy
+/* A 64-byte record, as lazy_buffer_main appends */
+struct LazyRecord {
+    uint64_t seq;
+    uint64_t payload[7];
+};
+
+#define LAZY_RECORDS    (LAZY_BYTES / sizeof(LazyRecord))
+
+static void *
+setup_lazy (void) {
+    LazyBuffer * b = (LazyBuffer *)malloc(sizeof(LazyBuffer));
+    if (b != NULL && !LazyBuffer_Init(b, LAZY_RESERVE, LAZY_CHUNK)) {
+        free(b);
+        return NULL;
+    }
+    return b;
+}
+static void
+teardown_lazy (void * state) {
+    LazyBuffer_Deinit((LazyBuffer *)state);
+    free(state);
+}
+/* Decommits, appends LAZY_RECORDS (committing ahead or not) and reads them back */
+static int64_t
+lazy_append (LazyBuffer * b, bool ahead) {
+    size_t const step = LAZY_AHEAD / sizeof(LazyRecord);
+    LazyRecord * r = (LazyRecord *)b->base;
+    LazyBuffer_Reset(b);
+    int64_t faults = LazyBuffer_Faults(b);
+    bool ok = true;
+    for (size_t i = 0; i < LAZY_RECORDS; ++i) {
+        if (ahead && i % step == 0)
+            ok = ok && LazyBuffer_Commit(b, i * sizeof(LazyRecord), LAZY_AHEAD);
+        r[i].seq = i;
+        for (int k = 0; k < 7; ++k)
+            r[i].payload[k] = i * (uint64_t)(k + 1);
+    }
+    uint64_t sum = 0;
+    for (size_t i = 0; i < LAZY_RECORDS; ++i)
+        sum += r[i].seq;
+    faults = LazyBuffer_Faults(b) - faults;
+    ok = ok && (sum == (uint64_t)LAZY_RECORDS * (LAZY_RECORDS - 1) / 2)
+        && faults == (ahead ? 0 : (int64_t)(LAZY_BYTES / LAZY_CHUNK));
+    return ok ? (int64_t)LAZY_RECORDS : -1;
+}
+static int64_t
+run_lazy_append (void * state) {
+    return lazy_append((LazyBuffer *)state, false);
+}
+static int64_t
+run_lazy_committed (void * state) {
+    return lazy_append((LazyBuffer *)state, true);
+}
+#pragma endregion
+
+// =========================================================================================
+
+static BenchCase const g_except_cases [] = {
+    {"except/propagate_code",       "call",     setup_propagate,    run_propagate_code,         teardown_propagate},
+    {"except/propagate_last_error", "call",     setup_propagate,    run_propagate_last_error,   teardown_propagate},
+    {"except/propagate_result",     "call",     setup_propagate,    run_propagate_result,       teardown_propagate},
+    {"except/propagate_exception",  "call",     setup_propagate,    run_propagate_exception,    teardown_propagate},
+#ifdef _WIN32
+    {"except/propagate_seh",        "call",     setup_propagate,    run_propagate_seh,          teardown_propagate},
+#endif
+    {"except/propagate_longjmp",    "call",     setup_propagate,    run_propagate_longjmp,      teardown_propagate},
+    {"except/batch_clean",          "record",   setup_scan,         run_batch_clean,            teardown_scan},
+    {"except/batch_corrupt",        "record",   setup_scan,         run_batch_corrupt,          teardown_scan},
+    {"except/lazy_append",          "record",   setup_lazy,         run_lazy_append,            teardown_lazy},
+    {"except/lazy_committed",       "record",   setup_lazy,         run_lazy_committed,         teardown_lazy},
+};
+
+BenchGroup const g_except_group = {g_except_cases, sizeof(g_except_cases) / sizeof(g_except_cases[0])};
@@ -0,0 +1,251 @@
+/* ===========================================================
+   #File: cases_fileio.c #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Harness cases: win32_fileio's copy, stdio vs native calls, and cat #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+/*
+A 16 MB text file of 200000 80-character lines is made once per case; every
+repetition reads all of it, so the unit is the byte.
+
+    fileio/copy_stdio_100       win32_fileio's C copy: fread/fwrite, 100 bytes at a time
+    fileio/copy_native_100      its Win32 copy: ReadFile/WriteFile (read/write off
+                                Windows), 100 bytes at a time
+    fileio/copy_stdio_64k       the same two with a 64 KB buffer
+    fileio/copy_native_64k
+    fileio/cat_lines            fgets/fputs to the null device, a line at a time
+    fileio/cat_block            fread/fwrite to the null device, 64 KB at a time
+    fileio/cat_report           misc/report's cat_file loop: ReadFile/WriteFile to
+                                the null device, 512 bytes at a time (Windows)
+*/
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "harness.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#define NULL_DEVICE     "NUL"
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#define NULL_DEVICE     "/dev/null"
+#endif
+
+#define LINES           200000
+#define LINE_LEN        80
+#define FILE_BYTES      ((int64_t)LINES * LINE_LEN)
+#define BLOCK           (64 << 10)
+#define SMALL           100         // win32_fileio's buffer
+#define REPORT_BUF      0x200       // report's default buffer
+
+typedef struct FileRun {
+    char    in[512];
+    char    out[512];
+    char    buf[BLOCK];
+} FileRun;
+
+// =========================================================================================
+
+static void *
+setup_file (void) {
+    FileRun * r = (FileRun *)malloc(sizeof(FileRun));
+    if (NULL == r)
+        return NULL;
+    Bench_TempPath(r->in, sizeof(r->in), "fileio_in.txt");
+    Bench_TempPath(r->out, sizeof(r->out), "fileio_out.txt");
+    FILE * f = fopen(r->in, "wb");
+    if (NULL == f) {
+        free(r);
+        return NULL;
+    }
+    // -- lines of printable text, each ending in '\n'
+    char line[LINE_LEN];
+    int ok = 1;
+    for (int n = 0; ok && n < LINES; ++n) {
+        for (int i = 0; i < LINE_LEN - 1; ++i)
+            line[i] = (char)('a' + (n + i) % 26);
+        line[LINE_LEN - 1] = '\n';
+        ok = (LINE_LEN == fwrite(line, 1, LINE_LEN, f));
+    }
+    if (0 != fclose(f) || !ok) {
+        remove(r->in);
+        free(r);
+        return NULL;
+    }
+    return r;
+}
+static void
+teardown_file (void * state) {
+    FileRun * r = (FileRun *)state;
+    remove(r->out);
+    remove(r->in);
+    free(r);
+}
+
+// =========================================================================================
+
+#pragma region copy
+static int64_t
+copy_stdio (FileRun * r, size_t size) {
+    FILE * in = fopen(r->in, "rb");
+    FILE * out = fopen(r->out, "wb");
+    int64_t total = 0;
+    size_t nread;
+    int ok = (in != NULL && out != NULL);
+    while (ok && (nread = fread(r->buf, 1, size, in)) > 0) {
+        ok = (fwrite(r->buf, 1, nread, out) == nread);
+        total += (int64_t)nread;
+    }
+    if (out != NULL)
+        ok &= (0 == fclose(out));
+    if (in != NULL)
+        fclose(in);
+    return (ok && FILE_BYTES == total) ? total : -1;
+}
+
+static int64_t
+copy_native (FileRun * r, size_t size) {
+    int64_t total = 0;
+    int ok;
+#ifdef _WIN32
+    DWORD nread = 0, nwritten = 0;
+    HANDLE in = CreateFileA(r->in, GENERIC_READ, FILE_SHARE_READ, NULL,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    HANDLE out = CreateFileA(r->out, GENERIC_WRITE, 0, NULL,
+        CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    ok = (INVALID_HANDLE_VALUE != in && INVALID_HANDLE_VALUE != out);
+    while (ok && ReadFile(in, r->buf, (DWORD)size, &nread, NULL) && nread > 0) {
+        ok = WriteFile(out, r->buf, nread, &nwritten, NULL) && nread == nwritten;
+        total += nread;
+    }
+    if (INVALID_HANDLE_VALUE != out)
+        CloseHandle(out);
+    if (INVALID_HANDLE_VALUE != in)
+        CloseHandle(in);
+#else
+    ssize_t nread;
+    int in = open(r->in, O_RDONLY);
+    int out = open(r->out, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    ok = (in >= 0 && out >= 0);
+    while (ok && (nread = read(in, r->buf, size)) > 0) {
+        ok = (write(out, r->buf, (size_t)nread) == nread);
+        total += nread;
+    }
+    if (out >= 0)
+        ok &= (0 == close(out));
+    if (in >= 0)
+        close(in);
+#endif
+    return (ok && FILE_BYTES == total) ? total : -1;
+}
+
+static int64_t
+run_copy_stdio_100 (void * state) {
+    return copy_stdio((FileRun *)state, SMALL);
+}
+static int64_t
+run_copy_native_100 (void * state) {
+    return copy_native((FileRun *)state, SMALL);
+}
+static int64_t
+run_copy_stdio_64k (void * state) {
+    return copy_stdio((FileRun *)state, BLOCK);
+}
+static int64_t
+run_copy_native_64k (void * state) {
+    return copy_native((FileRun *)state, BLOCK);
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region cat
+static int64_t
+run_cat_lines (void * state) {
+    FileRun * r = (FileRun *)state;
+    FILE * in = fopen(r->in, "rb");
+    FILE * out = fopen(NULL_DEVICE, "wb");
+    int64_t total = 0, lines = 0;
+    int ok = (in != NULL && out != NULL);
+    while (ok && fgets(r->buf, LINE_LEN + 1, in)) {
+        ok = (fputs(r->buf, out) >= 0);
+        total += (int64_t)strlen(r->buf);
+        lines++;
+    }
+    if (out != NULL)
+        fclose(out);
+    if (in != NULL)
+        fclose(in);
+    return (ok && FILE_BYTES == total && LINES == lines) ? total : -1;
+}
+static int64_t
+run_cat_block (void * state) {
+    FileRun * r = (FileRun *)state;
+    FILE * in = fopen(r->in, "rb");
+    FILE * out = fopen(NULL_DEVICE, "wb");
+    int64_t total = 0;
+    size_t nread;
+    int ok = (in != NULL && out != NULL);
+    while (ok && (nread = fread(r->buf, 1, BLOCK, in)) > 0) {
+        ok = (fwrite(r->buf, 1, nread, out) == nread);
+        total += (int64_t)nread;
+    }
+    if (out != NULL)
+        fclose(out);
+    if (in != NULL)
+        fclose(in);
+    return (ok && FILE_BYTES == total) ? total : -1;
+}
+#ifdef _WIN32
+/* report_main.c's cat_file, which stops at the first failed read or write */
+static int64_t
+run_cat_report (void * state) {
+    FileRun * r = (FileRun *)state;
+    HANDLE in = CreateFileA(r->in, GENERIC_READ, FILE_SHARE_READ, NULL,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    HANDLE out = CreateFileA(NULL_DEVICE, GENERIC_WRITE, 0, NULL,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    DWORD n_in = 0, n_out = 0;
+    int64_t total = 0;
+    int ok = (INVALID_HANDLE_VALUE != in && INVALID_HANDLE_VALUE != out);
+    while (ok
+        && ReadFile(in, r->buf, REPORT_BUF, &n_in, NULL)
+        && (n_in != 0)
+        && WriteFile(out, r->buf, n_in, &n_out, NULL)
+    )
+        total += n_out;
+    if (INVALID_HANDLE_VALUE != out)
+        CloseHandle(out);
+    if (INVALID_HANDLE_VALUE != in)
+        CloseHandle(in);
+    return (ok && FILE_BYTES == total) ? total : -1;
+}
+#endif
+#pragma endregion
+
+// =========================================================================================
+
+static BenchCase const g_fileio_cases [] = {
+    {"fileio/copy_stdio_100",   "byte",     setup_file,     run_copy_stdio_100,     teardown_file},
+    {"fileio/copy_native_100",  "byte",     setup_file,     run_copy_native_100,    teardown_file},
+    {"fileio/copy_stdio_64k",   "byte",     setup_file,     run_copy_stdio_64k,     teardown_file},
+    {"fileio/copy_native_64k",  "byte",     setup_file,     run_copy_native_64k,    teardown_file},
+    {"fileio/cat_lines",        "byte",     setup_file,     run_cat_lines,          teardown_file},
+    {"fileio/cat_block",        "byte",     setup_file,     run_cat_block,          teardown_file},
+#ifdef _WIN32
+    {"fileio/cat_report",       "byte",     setup_file,     run_cat_report,         teardown_file},
+#endif
+};
+
+BenchGroup const g_fileio_group = {g_fileio_cases, sizeof(g_fileio_cases) / sizeof(g_fileio_cases[0])};
@@ -0,0 +1,174 @@
+/* ===========================================================
+   #File: cases_misc.c #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Harness cases: misc's allocators against malloc, and the asynchronous log #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+/*
+    alloc/malloc            64k blocks of 64 bytes from malloc, then all freed
+    alloc/pool              the same from a MemPool
+    alloc/arena             the same from a MemArena, freed with one Reset
+    alloc/aligned           Mem_AllocAligned of cache-line blocks, then all freed
+    log/write               Log_Write of 64k records to a text sink on the null
+                            device, then Log_Flush; dropped records count too
+*/
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "harness.h"
+#include "../misc/alloc/mem_alloc.h"
+#include "../misc/log/log.h"
+
+#ifdef _WIN32
+#define NULL_DEVICE     "NUL"
+#else
+#define NULL_DEVICE     "/dev/null"
+#endif
+
+#define BLOCKS          (1 << 16)
+#define BLOCK_SIZE      64
+#define LOG_RECORDS     (1 << 16)
+#define LOG_RING        (4 << 20)
+
+typedef struct AllocRun {
+    MemPool     pool;
+    MemArena    arena;
+    void *      blocks[BLOCKS];
+} AllocRun;
+
+// =========================================================================================
+
+#pragma region alloc
+static void *
+setup_alloc (void) {
+    AllocRun * r = (AllocRun *)calloc(1, sizeof(AllocRun));
+    if (NULL == r)
+        return NULL;
+    if (!MemPool_Init(&r->pool, BLOCK_SIZE, 0, BLOCKS)) {
+        free(r);
+        return NULL;
+    }
+    if (!MemArena_Init(&r->arena, (size_t)BLOCKS * BLOCK_SIZE * 2)) {
+        MemPool_Deinit(&r->pool);
+        free(r);
+        return NULL;
+    }
+    return r;
+}
+static void
+teardown_alloc (void * state) {
+    AllocRun * r = (AllocRun *)state;
+    MemArena_Deinit(&r->arena);
+    MemPool_FlushThread(&r->pool);
+    MemPool_Deinit(&r->pool);
+    free(r);
+}
+
+/* Touches every block, as a caller would, and checks none of them overlap its neighbour */
+static int
+fill (AllocRun * r) {
+    for (int i = 0; i < BLOCKS; ++i) {
+        if (NULL == r->blocks[i])
+            return 0;
+        memset(r->blocks[i], i & 0xFF, BLOCK_SIZE);
+    }
+    for (int i = 0; i < BLOCKS; ++i)
+        if (((unsigned char *)r->blocks[i])[BLOCK_SIZE - 1] != (i & 0xFF))
+            return 0;
+    return 1;
+}
+
+static int64_t
+run_malloc (void * state) {
+    AllocRun * r = (AllocRun *)state;
+    for (int i = 0; i < BLOCKS; ++i)
+        r->blocks[i] = malloc(BLOCK_SIZE);
+    int ok = fill(r);
+    for (int i = 0; i < BLOCKS; ++i)
+        free(r->blocks[i]);
+    return ok ? BLOCKS : -1;
+}
+static int64_t
+run_pool (void * state) {
+    AllocRun * r = (AllocRun *)state;
+    for (int i = 0; i < BLOCKS; ++i)
+        r->blocks[i] = MemPool_Alloc(&r->pool);
+    int ok = fill(r);
+    for (int i = 0; i < BLOCKS; ++i)
+        if (r->blocks[i] != NULL)
+            MemPool_Free(&r->pool, r->blocks[i]);
+    return ok ? BLOCKS : -1;
+}
+static int64_t
+run_arena (void * state) {
+    AllocRun * r = (AllocRun *)state;
+    size_t mark = MemArena_Mark(&r->arena);
+    for (int i = 0; i < BLOCKS; ++i)
+        r->blocks[i] = MemArena_Alloc(&r->arena, BLOCK_SIZE, 0);
+    int ok = fill(r);
+    MemArena_Reset(&r->arena, mark);
+    return ok ? BLOCKS : -1;
+}
+static int64_t
+run_aligned (void * state) {
+    AllocRun * r = (AllocRun *)state;
+    int ok = 1;
+    for (int i = 0; i < BLOCKS; ++i) {
+        r->blocks[i] = Mem_AllocAligned(BLOCK_SIZE, MEM_CACHE_LINE, 0);
+        ok &= (0 == ((uintptr_t)r->blocks[i] & (MEM_CACHE_LINE - 1)));
+    }
+    ok &= fill(r);
+    for (int i = 0; i < BLOCKS; ++i)
+        Mem_FreeAligned(r->blocks[i]);
+    return ok ? BLOCKS : -1;
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region log
+static void *
+setup_log (void) {
+    FILE * sink = fopen(NULL_DEVICE, "w");
+    if (NULL == sink)
+        return NULL;
+    if (!Log_Init(LOG_RING)) {
+        fclose(sink);
+        return NULL;
+    }
+    Log_AddTextSink(sink);      // Log_Shutdown closes it
+    Log_SetLevel(LOG_DEBUG);
+    return sink;
+}
+static void
+teardown_log (void * state) {
+    (void)state;
+    Log_Shutdown();
+}
+static int64_t
+run_log (void * state) {
+    (void)state;
+    for (int i = 0; i < LOG_RECORDS; ++i)
+        Log_Write(LOG_INFO, "bench", 0, "record %d of %d: %s", i, LOG_RECORDS, "pirate ahoy");
+    Log_Flush();
+    return LOG_RECORDS;
+}
+#pragma endregion
+
+// =========================================================================================
+
+static BenchCase const g_misc_cases [] = {
+    {"alloc/malloc",        "block",    setup_alloc,    run_malloc,     teardown_alloc},
+    {"alloc/pool",          "block",    setup_alloc,    run_pool,       teardown_alloc},
+    {"alloc/arena",         "block",    setup_alloc,    run_arena,      teardown_alloc},
+    {"alloc/aligned",       "block",    setup_alloc,    run_aligned,    teardown_alloc},
+    {"log/write",           "record",   setup_log,      run_log,        teardown_log},
+};
+
+BenchGroup const g_misc_group = {g_misc_cases, sizeof(g_misc_cases) / sizeof(g_misc_cases[0])};
@@ -0,0 +1,491 @@
+/* ===========================================================
+   #File: cases_queues.c #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Harness cases: multithreading's queues and the handshake round trip #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+/*
+    queue/channel_spsc      one sender thread, one receiver: CHANNEL_SPSC, batches of 32
+    queue/channel_mpmc      the same through the MPMC ring
+    queue/urgency           push 1024 of mixed priority, pop them all; one thread
+    queue/sharded           one producer, one consumer on the local shard
+    queue/thread_pool       tasks submitted from outside, then ThreadPool_Wait
+    queue/timer_wheel       arm + cancel with 1024 timers pending
+    queue/queue_stats       QueueStats enqueue + dequeue + lock, one thread
+    handshake/channel_pool  app02: request over an SPSC channel, a pool task
+                            reverses it, the result comes back on a blocking one
+    handshake/condvar       the original event pattern: one slot, a server thread,
+                            a lock and condition variable per direction
+*/
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L    /* clock_gettime */
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "harness.h"
+#include "../multithreading/common/channel.h"
+#include "../multithreading/common/mt_platform.h"
+#include "../multithreading/common/queue_stats.h"
+#include "../multithreading/common/sharded_queue.h"
+#include "../multithreading/common/thread_pool.h"
+#include "../multithreading/common/timer_wheel.h"
+#include "../multithreading/common/topology.h"
+#include "../multithreading/common/urgency_queue.h"
+
+#define CHANNEL_MESSAGES    (1 << 18)
+#define CHANNEL_CAPACITY    1024
+#define URGENCY_CAPACITY    1024
+#define URGENCY_ROUNDS      64
+#define SHARDED_MESSAGES    (1 << 18)
+#define POOL_TASKS          (1 << 16)
+#define WHEEL_PENDING       1024
+#define WHEEL_OPS           (1 << 18)
+#define STATS_OPS           (1 << 18)
+#define HANDSHAKES          (1 << 13)
+
+// =========================================================================================
+
+#pragma region channels
+typedef struct ChannelRun {
+    Channel     ch;
+    int64_t     n;
+} ChannelRun;
+
+static void
+channel_sender (void * arg) {
+    ChannelRun * r = (ChannelRun *)arg;
+    for (int64_t i = 1; i <= r->n; i++)
+        Channel_Send(&r->ch, &i);
+    Channel_Close(&r->ch);
+}
+static int64_t
+channel_run (int flags, int batch) {
+    ChannelRun r;
+    MtThread sender;
+    int64_t expected = 1, msg;
+    int ok = 1;
+    r.n = CHANNEL_MESSAGES;
+    if (!Channel_Init(&r.ch, sizeof(int64_t), CHANNEL_CAPACITY, flags, batch))
+        return -1;
+    if (!mt_thread_create(&sender, channel_sender, &r)) {
+        Channel_Deinit(&r.ch);
+        return -1;
+    }
+    while (Channel_Recv(&r.ch, &msg))
+        ok &= (msg == expected++);
+    mt_thread_join(sender);
+    Channel_Deinit(&r.ch);
+    return (ok && expected == r.n + 1) ? r.n : -1;
+}
+static int64_t
+run_channel_spsc (void * state) {
+    (void)state;
+    return channel_run(CHANNEL_SPSC, 32);
+}
+static int64_t
+run_channel_mpmc (void * state) {
+    (void)state;
+    return channel_run(0, 1);
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region urgency
+static void *
+setup_urgency (void) {
+    UrgencyQueue * q = (UrgencyQueue *)malloc(sizeof(UrgencyQueue));
+    if (q != NULL && !UrgencyQueue_Init(q, sizeof(int64_t), URGENCY_CAPACITY, 1, 1000)) {
+        free(q);
+        q = NULL;
+    }
+    return q;
+}
+static void
+teardown_urgency (void * state) {
+    UrgencyQueue_Deinit((UrgencyQueue *)state);
+    free(state);
+}
+static int64_t
+run_urgency (void * state) {
+    UrgencyQueue * q = (UrgencyQueue *)state;
+    int64_t now = 0, ops = 0, key, prev, v;
+    for (int round = 0; round < URGENCY_ROUNDS; ++round) {
+        for (int64_t i = 0; i < URGENCY_CAPACITY; ++i, ++now)
+            if (!UrgencyQueue_Push(q, 0, (int)(i % 4), now + (i * 7919) % 5000, now, &i))
+                return -1;
+        // -- keys must come out in order
+        for (prev = INT64_MIN; UrgencyQueue_Pop(q, 0, &v, &key); prev = key, ++ops)
+            if (key < prev)
+                return -1;
+    }
+    return (ops == (int64_t)URGENCY_ROUNDS * URGENCY_CAPACITY) ? ops : -1;
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region sharded
+typedef struct ShardedRun {
+    Topology        topo;
+    ShardedQueue    q;
+} ShardedRun;
+
+typedef struct Message {
+    int64_t     value;
+    char        payload[MT_CACHE_LINE - sizeof(int64_t)];
+} Message;
+
+static void *
+setup_sharded (void) {
+    ShardedRun * r = (ShardedRun *)calloc(1, sizeof(ShardedRun));
+    if (NULL == r)
+        return NULL;
+    if (!Topology_Detect(&r->topo, 0)) {
+        free(r);
+        return NULL;
+    }
+    // -- both threads use domain 0's shard: the local path, what pinned pairs see
+    if (!ShardedQueue_Init(&r->q, &r->topo, sizeof(Message), CHANNEL_CAPACITY)) {
+        Topology_Deinit(&r->topo);
+        free(r);
+        return NULL;
+    }
+    return r;
+}
+static void
+teardown_sharded (void * state) {
+    ShardedRun * r = (ShardedRun *)state;
+    ShardedQueue_Deinit(&r->q);
+    Topology_Deinit(&r->topo);
+    free(r);
+}
+static void
+sharded_producer (void * arg) {
+    ShardedQueue * q = (ShardedQueue *)arg;
+    Message m;
+    memset(&m, 0, sizeof(m));
+    for (m.value = 1; m.value <= SHARDED_MESSAGES; ++m.value)
+        while (!ShardedQueue_Push(q, 0, &m))
+            mt_yield();
+}
+static int64_t
+run_sharded (void * state) {
+    ShardedRun * r = (ShardedRun *)state;
+    MtThread producer;
+    Message m;
+    int64_t sum = 0;
+    if (!mt_thread_create(&producer, sharded_producer, &r->q))
+        return -1;
+    for (int64_t n = 0; n < SHARDED_MESSAGES; ) {
+        if (ShardedQueue_PopLocal(&r->q, 0, &m)) {
+            sum += m.value;
+            n++;
+        } else {
+            mt_yield();
+        }
+    }
+    mt_thread_join(producer);
+    return (sum == (int64_t)SHARDED_MESSAGES * (SHARDED_MESSAGES + 1) / 2) ? SHARDED_MESSAGES : -1;
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region thread pool
+typedef struct PoolRun {
+    ThreadPool          pool;
+    int64_t volatile    done;
+} PoolRun;
+
+static void *
+setup_pool (void) {
+    PoolRun * r = (PoolRun *)calloc(1, sizeof(PoolRun));
+    if (r != NULL && !ThreadPool_Init(&r->pool, 0)) {
+        free(r);
+        r = NULL;
+    }
+    return r;
+}
+static void
+teardown_pool (void * state) {
+    ThreadPool_Deinit(&((PoolRun *)state)->pool);
+    free(state);
+}
+static void
+pool_task (void * arg) {
+    mt_fetch_add(&((PoolRun *)arg)->done, 1);
+}
+static int64_t
+run_pool (void * state) {
+    PoolRun * r = (PoolRun *)state;
+    r->done = 0;
+    for (int i = 0; i < POOL_TASKS; ++i)
+        while (!ThreadPool_Submit(&r->pool, pool_task, r))
+            mt_yield();     // out of room: let the workers drain some
+    ThreadPool_Wait(&r->pool);
+    return (POOL_TASKS == mt_load_acquire(&r->done)) ? POOL_TASKS : -1;
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region timer wheel
+typedef struct WheelRun {
+    TimerWheel  wheel;
+    Timer       pending[WHEEL_PENDING];
+    Timer       timer;
+} WheelRun;
+
+static void
+noop (void * arg) {
+    (void)arg;
+}
+static void *
+setup_wheel (void) {
+    WheelRun * r = (WheelRun *)calloc(1, sizeof(WheelRun));
+    if (r != NULL && !TimerWheel_Init(&r->wheel, 1)) {
+        free(r);
+        return NULL;
+    }
+    // -- far out, never due while the case runs
+    for (int i = 0; i < WHEEL_PENDING; ++i) {
+        Timer_Init(&r->pending[i], noop, NULL);
+        TimerWheel_Arm(&r->wheel, &r->pending[i], 3600 * 1000 + i * 37);
+    }
+    Timer_Init(&r->timer, noop, NULL);
+    return r;
+}
+static void
+teardown_wheel (void * state) {
+    WheelRun * r = (WheelRun *)state;
+    for (int i = 0; i < WHEEL_PENDING; ++i)
+        TimerWheel_Cancel(&r->wheel, &r->pending[i]);
+    TimerWheel_Deinit(&r->wheel);
+    free(r);
+}
+static int64_t
+run_wheel (void * state) {
+    WheelRun * r = (WheelRun *)state;
+    int ok = 1;
+    for (int i = 0; i < WHEEL_OPS; ++i) {
+        TimerWheel_Arm(&r->wheel, &r->timer, 1000 + (i & 1023) * 50);
+        ok &= TimerWheel_Cancel(&r->wheel, &r->timer);
+    }
+    return ok ? WHEEL_OPS : -1;
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region queue stats
+static void *
+setup_stats (void) {
+    QueueStats * s = (QueueStats *)malloc(sizeof(QueueStats));
+    if (s != NULL)
+        QueueStats_Init(s, "bench");
+    return s;
+}
+static void
+teardown_stats (void * state) {
+    free(state);
+}
+static int64_t
+run_stats (void * state) {
+    QueueStats * s = (QueueStats *)state;
+    int64_t stamp = QueueStats_Now();
+    for (int i = 0; i < STATS_OPS; ++i) {
+        QueueStats_LockAcquired(s, 0);
+        QueueStats_Enqueue(s, i & 63);
+        QueueStats_Dequeue(s, stamp);
+    }
+    return STATS_OPS;
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region handshake
+typedef struct HandshakeMessage {
+    char    str[64];
+} HandshakeMessage;
+
+typedef struct Handshake {
+    ThreadPool      pool;
+    Channel         requests;
+    Channel         results;
+    // -- condvar: the slot, a flag per direction, the server thread
+    MtLock          lock;
+    MtCond          submitted_cv;
+    MtCond          returned_cv;
+    int             submitted;
+    int             returned;
+    int             stop;
+    HandshakeMessage    slot;
+    MtThread        server;
+} Handshake;
+
+static void
+reverse (char * s) {
+    for (size_t i = 0, j = strlen(s); i + 1 < j; ++i, --j) {
+        char c = s[i];
+        s[i] = s[j - 1];
+        s[j - 1] = c;
+    }
+}
+/* The request as the client builds it, and the check of the result */
+static void
+make_request (HandshakeMessage * m, int i) {
+    snprintf(m->str, sizeof(m->str), "request %d to the server", i);
+}
+static int
+check_result (HandshakeMessage * m, int i) {
+    HandshakeMessage want;
+    make_request(&want, i);
+    reverse(want.str);
+    return 0 == strcmp(m->str, want.str);
+}
+
+static void *
+setup_channel_pool (void) {
+    Handshake * h = (Handshake *)calloc(1, sizeof(Handshake));
+    if (NULL == h)
+        return NULL;
+    // -- app02's setup: one message in flight each way, the client blocks on the result
+    if (!Channel_Init(&h->requests, sizeof(HandshakeMessage), 2, CHANNEL_SPSC, 1)) {
+        free(h);
+        return NULL;
+    }
+    if (!Channel_Init(&h->results, sizeof(HandshakeMessage), 2, CHANNEL_SPSC | CHANNEL_BLOCKING, 1)) {
+        Channel_Deinit(&h->requests);
+        free(h);
+        return NULL;
+    }
+    if (!ThreadPool_Init(&h->pool, 0)) {
+        Channel_Deinit(&h->results);
+        Channel_Deinit(&h->requests);
+        free(h);
+        return NULL;
+    }
+    return h;
+}
+static void
+teardown_channel_pool (void * state) {
+    Handshake * h = (Handshake *)state;
+    ThreadPool_Deinit(&h->pool);
+    Channel_Deinit(&h->results);
+    Channel_Deinit(&h->requests);
+    free(h);
+}
+static void
+server_task (void * arg) {
+    Handshake * h = (Handshake *)arg;
+    HandshakeMessage m;
+    if (!Channel_TryRecv(&h->requests, &m))
+        return;
+    reverse(m.str);
+    Channel_Send(&h->results, &m);
+}
+static int64_t
+run_channel_pool (void * state) {
+    Handshake * h = (Handshake *)state;
+    HandshakeMessage m;
+    int ok = 1;
+    for (int i = 0; i < HANDSHAKES; ++i) {
+        make_request(&m, i);
+        if (!Channel_TrySend(&h->requests, &m) || !ThreadPool_Submit(&h->pool, server_task, h))
+            return -1;
+        Channel_Recv(&h->results, &m);
+        ok &= check_result(&m, i);
+    }
+    return ok ? HANDSHAKES : -1;
+}
+
+static void
+condvar_server (void * arg) {
+    Handshake * h = (Handshake *)arg;
+    mt_lock(&h->lock);
+    for (;;) {
+        while (!h->submitted && !h->stop)
+            mt_cond_wait(&h->submitted_cv, &h->lock);
+        if (h->stop)
+            break;
+        h->submitted = 0;
+        reverse(h->slot.str);
+        h->returned = 1;
+        mt_cond_signal(&h->returned_cv);
+    }
+    mt_unlock(&h->lock);
+}
+static void *
+setup_condvar (void) {
+    Handshake * h = (Handshake *)calloc(1, sizeof(Handshake));
+    if (NULL == h)
+        return NULL;
+    mt_lock_init(&h->lock);
+    mt_cond_init(&h->submitted_cv);
+    mt_cond_init(&h->returned_cv);
+    if (!mt_thread_create(&h->server, condvar_server, h)) {
+        mt_cond_deinit(&h->returned_cv);
+        mt_cond_deinit(&h->submitted_cv);
+        mt_lock_deinit(&h->lock);
+        free(h);
+        return NULL;
+    }
+    return h;
+}
+static void
+teardown_condvar (void * state) {
+    Handshake * h = (Handshake *)state;
+    mt_lock(&h->lock);
+    h->stop = 1;
+    mt_cond_signal(&h->submitted_cv);
+    mt_unlock(&h->lock);
+    mt_thread_join(h->server);
+    mt_cond_deinit(&h->returned_cv);
+    mt_cond_deinit(&h->submitted_cv);
+    mt_lock_deinit(&h->lock);
+    free(h);
+}
+static int64_t
+run_condvar (void * state) {
+    Handshake * h = (Handshake *)state;
+    int ok = 1;
+    for (int i = 0; i < HANDSHAKES; ++i) {
+        mt_lock(&h->lock);
+        make_request(&h->slot, i);
+        h->submitted = 1;
+        mt_cond_signal(&h->submitted_cv);
+        while (!h->returned)
+            mt_cond_wait(&h->returned_cv, &h->lock);
+        h->returned = 0;
+        ok &= check_result(&h->slot, i);
+        mt_unlock(&h->lock);
+    }
+    return ok ? HANDSHAKES : -1;
+}
+#pragma endregion
+
+// =========================================================================================
+
+static BenchCase const g_queue_cases [] = {
+    {"queue/channel_spsc",      "msg",      NULL,               run_channel_spsc,   NULL},
+    {"queue/channel_mpmc",      "msg",      NULL,               run_channel_mpmc,   NULL},
+    {"queue/urgency",           "msg",      setup_urgency,      run_urgency,        teardown_urgency},
+    {"queue/sharded",           "msg",      setup_sharded,      run_sharded,        teardown_sharded},
+    {"queue/thread_pool",       "task",     setup_pool,         run_pool,           teardown_pool},
+    {"queue/timer_wheel",       "timer",    setup_wheel,        run_wheel,          teardown_wheel},
+    {"queue/queue_stats",       "msg",      setup_stats,        run_stats,          teardown_stats},
+    {"handshake/channel_pool",  "trip",     setup_channel_pool, run_channel_pool,   teardown_channel_pool},
+    {"handshake/condvar",       "trip",     setup_condvar,      run_condvar,        teardown_condvar},
+};
+
+BenchGroup const g_queue_group = {g_queue_cases, sizeof(g_queue_cases) / sizeof(g_queue_cases[0])};
@@ -0,0 +1,303 @@
+/* ===========================================================
+   #File: cases_records.cpp #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Harness cases: Pirate record I/O, raw, packed, indexed, imported, journaled #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+/*
+Every case's setup writes the same 100k pirates as a raw record file, its
+block-packed copy, its name index and a text file to import.
+
+    records/write_raw       fwrite of the array, a record at a time
+    records/read_raw        fread back, a record at a time
+    records/pack            PirateBlock_Pack of the raw file
+    records/scan            PirateBlock_Scan of the packed file, a thread per core
+    records/get_random      PirateBlock_Get of 1024 random records
+    records/index_find      PirateIndex_Find of every name, in random order
+    records/import          PirateImport_Run of the text file, a thread per core
+    records/journal_append  PirateJournal_AppendAsync of 2048 records, 16 at a
+                            time, up to 256 per sync, then the wait for the
+                            last ticket
+*/
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+
+#include "harness.h"
+#include "../fileio/records/crt_compat.h"
+#include "../fileio/records/pirate.h"
+#include "../fileio/records/pirate_block.h"
+#include "../fileio/records/pirate_import.h"
+#include "../fileio/records/pirate_index.h"
+#include "../fileio/records/pirate_journal.h"
+
+#define RECORDS         100000
+#define RANDOM_GETS     1024
+#define JOURNAL_RECORDS 2048
+#define JOURNAL_CHUNK   16
+#define JOURNAL_BATCH   256         // records per sync at most
+
+struct RecordsRun {
+    Pirate *    pirates;
+    uint32_t *  order;          // a permutation of the record #s
+    char        raw[512];
+    char        packed[512];
+    char        index[512];
+    char        text[512];
+    char        imported[512];
+    char        journal[512];
+    char        wal[520];
+};
+
+static void
+make_pirate (Pirate * p, uint32_t i) {
+    static char const * const ranks[] = {"Captain", "Quartermaster", "Bosun", "Gunner", "Cook"};
+    memset(p, 0, sizeof(*p));
+    // -- some names fit in the index key, the longer ones do not
+    snprintf(p->name, sizeof(p->name), (i % 3) ? "%s %u" : "%s %u of the Seven Seas",
+        ranks[i % 5], (unsigned)(i * 2654435761u % 1000003u));
+    p->bounty = 1000 + (i * 7919u) % 500000;
+    p->crew_count = 1 + i % 200;
+}
+
+static uint64_t
+crew_total (Pirate const * pirates, size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; ++i)
+        sum += pirates[i].crew_count;
+    return sum;
+}
+
+static void
+remove_files (RecordsRun * r) {
+    remove(r->raw);
+    remove(r->packed);
+    remove(r->index);
+    remove(r->text);
+    remove(r->imported);
+    remove(r->journal);
+    remove(r->wal);
+}
+
+static bool
+write_raw (RecordsRun * r) {
+    FILE * f = fopen(r->raw, "wb");
+    if (NULL == f)
+        return false;
+    bool ok = true;
+    for (size_t i = 0; ok && i < RECORDS; ++i)
+        ok = (1 == fwrite(&r->pirates[i], sizeof(Pirate), 1, f));
+    return (0 == fclose(f)) && ok;
+}
+
+static bool
+write_text (RecordsRun * r) {
+    FILE * f = fopen(r->text, "wb");
+    if (NULL == f)
+        return false;
+    bool ok = true;
+    for (size_t i = 0; ok && i < RECORDS; ++i)
+        ok = (fprintf(f, "%s,%u,%u\n", r->pirates[i].name, r->pirates[i].bounty, r->pirates[i].crew_count) > 0);
+    return (0 == fclose(f)) && ok;
+}
+
+static void
+teardown_records (void * state) {
+    RecordsRun * r = (RecordsRun *)state;
+    remove_files(r);
+    free(r->order);
+    free(r->pirates);
+    free(r);
+}
+
+static void *
+setup_records (void) {
+    RecordsRun * r = (RecordsRun *)calloc(1, sizeof(RecordsRun));
+    if (NULL == r)
+        return NULL;
+    r->pirates = (Pirate *)malloc(sizeof(Pirate) * RECORDS);
+    r->order = (uint32_t *)malloc(sizeof(uint32_t) * RECORDS);
+    Bench_TempPath(r->raw, sizeof(r->raw), "records.dat");
+    Bench_TempPath(r->packed, sizeof(r->packed), "records.blk");
+    Bench_TempPath(r->index, sizeof(r->index), "records.idx");
+    Bench_TempPath(r->text, sizeof(r->text), "records.txt");
+    Bench_TempPath(r->imported, sizeof(r->imported), "records_imported.dat");
+    Bench_TempPath(r->journal, sizeof(r->journal), "records_journal.dat");
+    snprintf(r->wal, sizeof(r->wal), "%s.wal", r->journal);
+    if (NULL == r->pirates || NULL == r->order) {
+        teardown_records(r);
+        return NULL;
+    }
+
+    uint32_t seed = 12345;
+    for (uint32_t i = 0; i < RECORDS; ++i) {
+        make_pirate(&r->pirates[i], i);
+        r->order[i] = i;
+    }
+    for (uint32_t i = RECORDS - 1; i > 0; --i) {
+        seed = seed * 1664525u + 1013904223u;
+        uint32_t k = seed % (i + 1), t = r->order[i];
+        r->order[i] = r->order[k];
+        r->order[k] = t;
+    }
+    if (!write_raw(r) || !write_text(r) || !PirateBlock_Pack(r->raw, r->packed, 0)
+        || !PirateIndex_Build(r->raw, r->index)) {
+        teardown_records(r);
+        return NULL;
+    }
+    return r;
+}
+
+// =========================================================================================
+
+#pragma region raw
+static int64_t
+run_write_raw (void * state) {
+    return write_raw((RecordsRun *)state) ? RECORDS : -1;
+}
+static int64_t
+run_read_raw (void * state) {
+    RecordsRun * r = (RecordsRun *)state;
+    FILE * f = fopen(r->raw, "rb");
+    if (NULL == f)
+        return -1;
+    Pirate p;
+    uint64_t n = 0, sum = 0;
+    while (1 == fread(&p, sizeof(p), 1, f)) {
+        sum += p.crew_count;
+        n++;
+    }
+    fclose(f);
+    return (RECORDS == n && crew_total(r->pirates, RECORDS) == sum) ? RECORDS : -1;
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region packed
+struct ScanSum {
+    std::atomic<uint64_t>   records;
+    std::atomic<uint64_t>   crew;
+};
+
+static bool
+scan_block (void * ctx, uint64_t first_record, Pirate const * pirates, size_t count) {
+    ScanSum * s = (ScanSum *)ctx;
+    (void)first_record;
+    s->records += count;
+    s->crew += crew_total(pirates, count);
+    return true;
+}
+
+static int64_t
+run_pack (void * state) {
+    RecordsRun * r = (RecordsRun *)state;
+    return PirateBlock_Pack(r->raw, r->packed, 0) ? RECORDS : -1;
+}
+static int64_t
+run_scan (void * state) {
+    RecordsRun * r = (RecordsRun *)state;
+    PirateBlockReader reader;
+    ScanSum s;
+    s.records = 0;
+    s.crew = 0;
+    if (!PirateBlock_Open(&reader, r->packed))
+        return -1;
+    bool ok = PirateBlock_Scan(&reader, 0, scan_block, &s);
+    PirateBlock_Close(&reader);
+    return (ok && RECORDS == s.records && crew_total(r->pirates, RECORDS) == s.crew) ? RECORDS : -1;
+}
+static int64_t
+run_get_random (void * state) {
+    RecordsRun * r = (RecordsRun *)state;
+    PirateBlockReader reader;
+    Pirate p;
+    bool ok;
+    if (!PirateBlock_Open(&reader, r->packed))
+        return -1;
+    ok = true;
+    for (int i = 0; ok && i < RANDOM_GETS; ++i) {
+        uint32_t no = r->order[i];
+        ok = PirateBlock_Get(&reader, no, &p) && 0 == strcmp(p.name, r->pirates[no].name);
+    }
+    PirateBlock_Close(&reader);
+    return ok ? RANDOM_GETS : -1;
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region index
+static int64_t
+run_index_find (void * state) {
+    RecordsRun * r = (RecordsRun *)state;
+    PirateIndex idx;
+    if (!PirateIndex_Open(&idx, r->raw, r->index))
+        return -1;
+    bool ok = true;
+    for (uint32_t i = 0; ok && i < RECORDS; ++i) {
+        // -- duplicate names find their lowest record #, which has the same name
+        char const * name = r->pirates[r->order[i]].name;
+        int64_t no = PirateIndex_Find(&idx, name);
+        ok = (no >= 0 && no <= (int64_t)r->order[i] && 0 == strcmp(r->pirates[no].name, name));
+    }
+    PirateIndex_Close(&idx);
+    return ok ? RECORDS : -1;
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region import and journal
+static int64_t
+run_import (void * state) {
+    RecordsRun * r = (RecordsRun *)state;
+    PirateImportStats stats;
+    if (!PirateImport_Run(r->text, r->imported, 0, &stats))
+        return -1;
+    return (RECORDS == stats.records && 0 == stats.bad_lines) ? RECORDS : -1;
+}
+static int64_t
+run_journal_append (void * state) {
+    RecordsRun * r = (RecordsRun *)state;
+    PirateJournal * j = new PirateJournal;
+    PirateTicket ticket = 0;
+    uint64_t first = 0;
+    bool ok;
+    // -- a new record file every time, so each run syncs the same amount
+    remove(r->journal);
+    remove(r->wal);
+    ok = PirateJournal_Open(j, r->journal, JOURNAL_BATCH);
+    for (size_t i = 0; ok && i < JOURNAL_RECORDS; i += JOURNAL_CHUNK) {
+        ticket = PirateJournal_AppendAsync(j, &r->pirates[i], JOURNAL_CHUNK, &first);
+        ok = (first == i);
+    }
+    if (ok)
+        ok = PirateJournal_Wait(j, ticket);
+    ok = PirateJournal_Close(j) && ok;
+    delete j;
+    return ok ? JOURNAL_RECORDS : -1;
+}
+#pragma endregion
+
+// =========================================================================================
+
+static BenchCase const g_records_cases [] = {
+    {"records/write_raw",       "record",   setup_records,  run_write_raw,      teardown_records},
+    {"records/read_raw",        "record",   setup_records,  run_read_raw,       teardown_records},
+    {"records/pack",            "record",   setup_records,  run_pack,           teardown_records},
+    {"records/scan",            "record",   setup_records,  run_scan,           teardown_records},
+    {"records/get_random",      "record",   setup_records,  run_get_random,     teardown_records},
+    {"records/index_find",      "lookup",   setup_records,  run_index_find,     teardown_records},
+    {"records/import",          "record",   setup_records,  run_import,         teardown_records},
+    {"records/journal_append",  "record",   setup_records,  run_journal_append, teardown_records},
+};
+
+BenchGroup const g_records_group = {g_records_cases, sizeof(g_records_cases) / sizeof(g_records_cases[0])};
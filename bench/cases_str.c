@@ -0,0 +1,260 @@
+/* ===========================================================
+   #File: cases_str.c #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Harness cases: the cstr sample's transcoder, case folding, builder and intern table #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+/*
+    str/utf8_to_16          4 MB of mixed-script UTF-8 to UTF-16, per input byte
+    str/utf16_to_8          and back, per output byte, checked against the original
+    str/casefold_equal      CaseFold_EqualA of 64k words against their upper case
+    str/casefold_hash       CaseFold_HashA of the same pairs, which must agree
+    str/strbuf_append       a 64k-piece string built in a StrArena
+    str/intern_add          64k strings, half of them repeats, into a new StrIntern
+    str/intern_find         lookups of all of them, hits and misses, in a full one
+*/
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "harness.h"
+#include "../fileio/cstr/casefold.h"
+#include "../fileio/cstr/intern.h"
+#include "../fileio/cstr/strbuf.h"
+#include "../fileio/cstr/utf.h"
+
+#ifndef _countof
+#define _countof(a) (sizeof(a) / sizeof((a)[0]))
+#endif
+
+#define CORPUS_BYTES    (4 << 20)
+#define WORDS           (1 << 16)
+#define WORD_CCH        24
+
+static char const * const g_lines [] = {
+    "The quick brown fox jumps over the lazy dog. 0123456789\n",
+    "Gr\xC3\xB6\xC3\x9F" "e, fa\xC3\xA7" "ade, na\xC3\xAFve, \xC3\x86r\xC3\xB8, Se\xC3\xB1or, d\xC3\xA9j\xC3\xA0 vu\n",
+    "\xD0\xA1\xD1\x8A\xD0\xB5\xD1\x88\xD1\x8C \xD0\xB6\xD0\xB5 \xD0\xB5\xD1\x89\xD1\x91 \xD1\x8D\xD1\x82\xD0\xB8\xD1\x85\n",
+    "\xE5\xA4\xA9\xE5\x9C\xB0\xE7\x8E\x84\xE9\xBB\x84\xE5\xAE\x87\xE5\xAE\x99\xE6\xB4\xAA\xE8\x8D\x92\n",
+    "\xF0\x9F\x8F\xB4\xE2\x80\x8D\xE2\x98\xA0\xEF\xB8\x8F \xF0\x9F\x92\xB0\xE2\x9A\x93\xF0\x9F\xA6\x9C\n",
+};
+
+// =========================================================================================
+
+#pragma region utf
+typedef struct UtfRun {
+    char *      utf8;
+    size_t      cb;
+    utf16_t *   utf16;
+    size_t      cch;
+    char *      back;           // utf16_to_8's output
+} UtfRun;
+
+static void
+teardown_utf (void * state) {
+    UtfRun * r = (UtfRun *)state;
+    free(r->back);
+    free(r->utf16);
+    free(r->utf8);
+    free(r);
+}
+static void *
+setup_utf (void) {
+    UtfRun * r = (UtfRun *)calloc(1, sizeof(UtfRun));
+    if (NULL == r)
+        return NULL;
+    r->utf8 = (char *)malloc(CORPUS_BYTES + 256);
+    r->back = (char *)malloc(CORPUS_BYTES + 256);
+    if (NULL == r->utf8 || NULL == r->back) {
+        teardown_utf(r);
+        return NULL;
+    }
+    // -- whole lines only, so the corpus stays valid UTF-8
+    for (size_t k = 0; r->cb < CORPUS_BYTES; ++k) {
+        char const * l = g_lines[k % _countof(g_lines)];
+        size_t len = strlen(l);
+        memcpy(r->utf8 + r->cb, l, len);
+        r->cb += len;
+    }
+    if (FAILED(Utf8_CchToUtf16(&r->cch, r->utf8, r->cb))
+        || NULL == (r->utf16 = (utf16_t *)malloc(sizeof(utf16_t) * (r->cch + 1)))
+        || FAILED(Utf8_ToUtf16Cch(r->utf16, r->cch + 1, r->utf8, r->cb, NULL))) {
+        teardown_utf(r);
+        return NULL;
+    }
+    return r;
+}
+static int64_t
+run_utf8_to_16 (void * state) {
+    UtfRun * r = (UtfRun *)state;
+    size_t written = 0;
+    if (FAILED(Utf8_ToUtf16Cch(r->utf16, r->cch + 1, r->utf8, r->cb, &written)))
+        return -1;
+    return (written == r->cch) ? (int64_t)r->cb : -1;
+}
+static int64_t
+run_utf16_to_8 (void * state) {
+    UtfRun * r = (UtfRun *)state;
+    size_t written = 0;
+    if (FAILED(Utf16_ToUtf8Cb(r->back, r->cb + 1, r->utf16, r->cch, &written)))
+        return -1;
+    return (written == r->cb && 0 == memcmp(r->back, r->utf8, r->cb)) ? (int64_t)r->cb : -1;
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region words
+/* WORDS words, each also in upper case, and TCHAR copies for the builder and the table */
+typedef struct WordRun {
+    char        lower[WORDS][WORD_CCH];
+    char        upper[WORDS][WORD_CCH];
+    size_t      cb[WORDS];
+    TCHAR       t[WORDS][WORD_CCH];
+    StrIntern   table;
+    int         table_init;
+} WordRun;
+
+static void *
+setup_words (void) {
+    WordRun * r = (WordRun *)calloc(1, sizeof(WordRun));
+    if (NULL == r)
+        return NULL;
+    uint32_t seed = 2021;
+    for (int i = 0; i < WORDS; ++i) {
+        // -- 6 to 20 letters; the second half of the list repeats the first
+        int src = (i < WORDS / 2) ? i : i - WORDS / 2;
+        if (src != i) {
+            memcpy(r->lower[i], r->lower[src], WORD_CCH);
+        } else {
+            seed = seed * 1664525u + 1013904223u;
+            int len = 6 + (int)((seed >> 16) % 15);
+            for (int k = 0; k < len; ++k) {
+                seed = seed * 1664525u + 1013904223u;
+                r->lower[i][k] = (char)('a' + (seed >> 16) % 26);
+            }
+        }
+        r->cb[i] = strlen(r->lower[i]);
+        for (size_t k = 0; k <= r->cb[i]; ++k) {
+            char c = r->lower[i][k];
+            r->upper[i][k] = (c >= 'a' && c <= 'z') ? (char)(c - 'a' + 'A') : c;
+            r->t[i][k] = (TCHAR)c;
+        }
+    }
+    return r;
+}
+static void
+teardown_words (void * state) {
+    WordRun * r = (WordRun *)state;
+    if (r->table_init)
+        StrIntern_Deinit(&r->table);
+    free(r);
+}
+
+static int64_t
+run_casefold_equal (void * state) {
+    WordRun * r = (WordRun *)state;
+    int equal = 0;
+    for (int i = 0; i < WORDS; ++i)
+        equal += CaseFold_EqualA(r->lower[i], r->cb[i], r->upper[i], r->cb[i]);
+    return (WORDS == equal) ? WORDS : -1;
+}
+static int64_t
+run_casefold_hash (void * state) {
+    WordRun * r = (WordRun *)state;
+    int ok = 1;
+    uint64_t sum = 0;
+    for (int i = 0; i < WORDS; ++i) {
+        uint64_t h = CaseFold_HashA(r->lower[i], r->cb[i]);
+        ok &= (h == CaseFold_HashA(r->upper[i], r->cb[i]));
+        sum += h;
+    }
+    Bench_Consume(sum);
+    return ok ? WORDS : -1;
+}
+
+static int64_t
+run_strbuf_append (void * state) {
+    WordRun * r = (WordRun *)state;
+    StrArena arena;
+    StrBuf sb;
+    size_t cch = 0;
+    int ok = 1;
+    StrArena_Init(&arena, 0);
+    StrBuf_Init(&sb, &arena);
+    for (int i = 0; ok && i < WORDS; ++i) {
+        ok = SUCCEEDED(StrBuf_Append(&sb, r->t[i], r->cb[i]));
+        cch += r->cb[i];
+    }
+    ok &= (sb.cch == cch);
+    StrBuf_Free(&sb);
+    StrArena_Deinit(&arena);
+    return ok ? WORDS : -1;
+}
+
+static int64_t
+run_intern_add (void * state) {
+    WordRun * r = (WordRun *)state;
+    StrIntern t;
+    int ok = SUCCEEDED(StrIntern_Init(&t, 0));
+    if (!ok)
+        return -1;
+    for (int i = 0; ok && i < WORDS; ++i)
+        ok = (StrIntern_Add(&t, r->t[i], r->cb[i]) != NULL);
+    // -- the repeats must not have added anything (the first half may hold a few duplicates itself)
+    ok &= (StrIntern_Count(&t) <= WORDS / 2);
+    StrIntern_Deinit(&t);
+    return ok ? WORDS : -1;
+}
+static void *
+setup_table (void) {
+    WordRun * r = (WordRun *)setup_words();
+    if (NULL == r)
+        return NULL;
+    // -- even words only: an odd one is a miss unless it happens to equal an even one
+    r->table_init = SUCCEEDED(StrIntern_Init(&r->table, 0));
+    for (int i = 0; r->table_init && i < WORDS / 2; i += 2) {
+        if (NULL == StrIntern_Add(&r->table, r->t[i], r->cb[i])) {
+            teardown_words(r);
+            return NULL;
+        }
+    }
+    if (!r->table_init) {
+        free(r);
+        return NULL;
+    }
+    return r;
+}
+static int64_t
+run_intern_find (void * state) {
+    WordRun * r = (WordRun *)state;
+    int ok = 1;
+    uint64_t hits = 0;
+    for (int i = 0; i < WORDS; ++i) {
+        StrAtom const * a = StrIntern_Find(&r->table, r->t[i], r->cb[i]);
+        ok &= (0 != (i % (WORDS / 2)) % 2 || a != NULL);
+        hits += (a != NULL);
+    }
+    Bench_Consume(hits);
+    return ok ? WORDS : -1;
+}
+#pragma endregion
+
+// =========================================================================================
+
+static BenchCase const g_str_cases [] = {
+    {"str/utf8_to_16",      "byte",     setup_utf,      run_utf8_to_16,     teardown_utf},
+    {"str/utf16_to_8",      "byte",     setup_utf,      run_utf16_to_8,     teardown_utf},
+    {"str/casefold_equal",  "compare",  setup_words,    run_casefold_equal, teardown_words},
+    {"str/casefold_hash",   "hash",     setup_words,    run_casefold_hash,  teardown_words},
+    {"str/strbuf_append",   "append",   setup_words,    run_strbuf_append,  teardown_words},
+    {"str/intern_add",      "string",   setup_words,    run_intern_add,     teardown_words},
+    {"str/intern_find",     "lookup",   setup_table,    run_intern_find,    teardown_words},
+};
+
+BenchGroup const g_str_group = {g_str_cases, sizeof(g_str_cases) / sizeof(g_str_cases[0])};
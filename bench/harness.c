@@ -0,0 +1,284 @@
+/* ===========================================================
+   #File: harness.c #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Portable benchmark harness: cases, repetitions, statistics, JSON, compare #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE                 /* sched_setaffinity */
+#endif
+
+#include "harness.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../multithreading/common/mt_platform.h"
+
+#ifndef _WIN32
+#include <sched.h>
+#endif
+
+#define COMPARE_MAX_RESULTS     1024
+
+BenchOptions g_bench = {10, 1, NULL, "."};
+
+static uint64_t volatile g_sink;
+
+// =========================================================================================
+
+#pragma region running
+static int
+compare_double (void const * a, void const * b) {
+    double x = *(double const *)a, y = *(double const *)b;
+    return (x > y) - (x < y);
+}
+/* Nearest rank, over sorted samples */
+static double
+percentile (double const * sorted, int n, double p) {
+    int rank = (int)ceil(p * n);
+    return sorted[(rank < 1) ? 0 : rank - 1];
+}
+
+int
+Bench_Run (BenchCase const * c, BenchResult * r) {
+    memset(r, 0, sizeof(*r));
+    snprintf(r->name, sizeof(r->name), "%s", c->name);
+    snprintf(r->unit, sizeof(r->unit), "%s", c->unit);
+    void * state = NULL;
+    if (c->setup != NULL && NULL == (state = c->setup()))
+        return 0;
+
+    int reps = (g_bench.reps < 1) ? 1 : (g_bench.reps > BENCH_MAX_REPS) ? BENCH_MAX_REPS : g_bench.reps;
+    double * samples = (double *)malloc(sizeof(double) * (size_t)reps);
+    int ok = (samples != NULL);
+    for (int i = 0; ok && i < g_bench.warmup; ++i)
+        ok = (c->run(state) > 0);
+    for (int i = 0; ok && i < reps; ++i) {
+        int64_t t = mt_now_ns();
+        int64_t ops = c->run(state);
+        t = mt_now_ns() - t;
+        ok = (ops > 0);
+        samples[i] = ok ? (double)t / (double)ops : 0;
+        r->ops = ops;
+    }
+    if (c->teardown != NULL)
+        c->teardown(state);
+
+    if (ok) {
+        double sum = 0, sq = 0;
+        for (int i = 0; i < reps; ++i)
+            sum += samples[i];
+        r->mean_ns = sum / reps;
+        for (int i = 0; i < reps; ++i)
+            sq += (samples[i] - r->mean_ns) * (samples[i] - r->mean_ns);
+        r->stddev_ns = (reps > 1) ? sqrt(sq / (reps - 1)) : 0;
+
+        qsort(samples, (size_t)reps, sizeof(double), compare_double);
+        r->min_ns = samples[0];
+        r->median_ns = (reps % 2) ? samples[reps / 2] : (samples[reps / 2 - 1] + samples[reps / 2]) / 2;
+        r->p99_ns = percentile(samples, reps, 0.99);
+        r->reps = reps;
+    }
+    r->ok = ok;
+    free(samples);
+    return ok;
+}
+
+int
+Bench_Pin (char const * cpus) {
+#ifdef _WIN32
+    DWORD_PTR mask = 0;
+#else
+    cpu_set_t set;
+    CPU_ZERO(&set);
+#endif
+    int n = 0;
+    // -- "0-3,8": ranges and single processors
+    for (char const * s = cpus; *s; ) {
+        char * end;
+        long lo = strtol(s, &end, 10), hi = lo;
+        if (end == s)
+            return 0;
+        if ('-' == *end)
+            hi = strtol(end + 1, &end, 10);
+        for (long c = lo; c <= hi; ++c) {
+#ifdef _WIN32
+            if (c >= 0 && c < (long)(8 * sizeof(mask)))
+                mask |= (DWORD_PTR)1 << c;
+#else
+            if (c >= 0 && c < CPU_SETSIZE)
+                CPU_SET((int)c, &set);
+#endif
+            n++;
+        }
+        s = (',' == *end) ? end + 1 : end;
+    }
+    if (0 == n)
+        return 0;
+#ifdef _WIN32
+    // -- the process's: the threads the cases start are pinned too
+    return SetProcessAffinityMask(GetCurrentProcess(), mask) != 0;
+#else
+    // -- the calling thread's, which every thread started later inherits
+    return 0 == sched_setaffinity(0, sizeof(set), &set);
+#endif
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region output
+void
+Bench_PrintHeader (FILE * out) {
+    fprintf(out, "%-28s %-7s %10s %12s %12s %10s %12s\n",
+        "case", "unit", "ops", "median ns", "p99 ns", "stddev%", "M ops/s");
+}
+void
+Bench_Print (BenchResult const * r, FILE * out) {
+    if (!r->ok) {
+        fprintf(out, "%-28s %-7s %10s  (MISMATCH)\n", r->name, r->unit, "-");
+        return;
+    }
+    fprintf(out, "%-28s %-7s %10lld %12.2f %12.2f %10.1f %12.2f\n",
+        r->name, r->unit, (long long)r->ops, r->median_ns, r->p99_ns,
+        r->median_ns > 0 ? 100.0 * r->stddev_ns / r->median_ns : 0.0,
+        r->median_ns > 0 ? 1e3 / r->median_ns : 0.0);
+}
+
+int
+Bench_WriteJson (char const * path, BenchResult const * results, size_t count) {
+    FILE * f = fopen(path, "w");
+    if (NULL == f)
+        return 0;
+#ifdef _WIN32
+    char const * os = "windows";
+#elif defined(__linux__)
+    char const * os = "linux";
+#else
+    char const * os = "posix";
+#endif
+    // -- names and units are the cases' own literals: nothing to escape
+    fprintf(f, "{\"harness\": \"owin32_bench\", \"version\": 1, \"os\": \"%s\", \"time\": %lld,\n",
+        os, (long long)time(NULL));
+    fprintf(f, " \"cpus\": \"%s\", \"logical_processors\": %d, \"reps\": %d, \"warmup\": %d,\n",
+        g_bench.cpus ? g_bench.cpus : "", mt_cpu_count(), g_bench.reps, g_bench.warmup);
+    fprintf(f, " \"results\": [\n");
+    for (size_t i = 0; i < count; ++i) {
+        BenchResult const * r = &results[i];
+        fprintf(f, "  {\"name\": \"%s\", \"unit\": \"%s\", \"ok\": %s, \"ops\": %lld, \"reps\": %d, "
+            "\"min_ns\": %.4f, \"median_ns\": %.4f, \"p99_ns\": %.4f, \"mean_ns\": %.4f, \"stddev_ns\": %.4f}%s\n",
+            r->name, r->unit, r->ok ? "true" : "false", (long long)r->ops, r->reps,
+            r->min_ns, r->median_ns, r->p99_ns, r->mean_ns, r->stddev_ns, (i + 1 < count) ? "," : "");
+    }
+    fprintf(f, " ]}\n");
+    return 0 == fclose(f);
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region compare
+/* A number after "key": on the line; false if the key is not there */
+static int
+json_number (char const * line, char const * key, double * v) {
+    char const * p = strstr(line, key);
+    return p != NULL && 1 == sscanf(p + strlen(key), " : %lf", v);
+}
+/* The files Bench_WriteJson writes: one result per line, read back with strstr */
+static int
+read_results (char const * path, BenchResult * results, int max) {
+    FILE * f = fopen(path, "r");
+    char line[1024];
+    int n = 0;
+    if (NULL == f)
+        return -1;
+    while (n < max && fgets(line, sizeof(line), f)) {
+        char const * p = strstr(line, "\"name\": \"");
+        if (NULL == p)
+            continue;
+        BenchResult * r = &results[n];
+        memset(r, 0, sizeof(*r));
+        p += strlen("\"name\": \"");
+        size_t len = strcspn(p, "\"");
+        if (len >= sizeof(r->name))
+            continue;
+        memcpy(r->name, p, len);
+        r->ok = (NULL != strstr(line, "\"ok\": true"));
+        if (json_number(line, "\"median_ns\"", &r->median_ns) && json_number(line, "\"stddev_ns\"", &r->stddev_ns))
+            n++;
+    }
+    fclose(f);
+    return n;
+}
+
+int
+Bench_Compare (char const * base_path, char const * new_path, double threshold_pct, FILE * out) {
+    BenchResult * base = (BenchResult *)malloc(sizeof(BenchResult) * COMPARE_MAX_RESULTS);
+    BenchResult * cur = (BenchResult *)malloc(sizeof(BenchResult) * COMPARE_MAX_RESULTS);
+    int n_base = (base && cur) ? read_results(base_path, base, COMPARE_MAX_RESULTS) : -1;
+    int n_cur = (n_base >= 0) ? read_results(new_path, cur, COMPARE_MAX_RESULTS) : -1;
+    int regressions = 0;
+    if (n_base < 0 || n_cur < 0) {
+        free(base);
+        free(cur);
+        return -1;
+    }
+
+    fprintf(out, "%-28s %12s %12s %9s\n", "case", "base ns", "new ns", "change%");
+    for (int i = 0; i < n_cur; ++i) {
+        BenchResult const * c = &cur[i], * b = NULL;
+        for (int k = 0; k < n_base && NULL == b; ++k)
+            if (0 == strcmp(base[k].name, c->name))
+                b = &base[k];
+        if (NULL == b || !b->ok || !c->ok) {
+            fprintf(out, "%-28s %12s %12s %9s  %s\n", c->name, "-", "-", "-",
+                (NULL == b) ? "new" : (!c->ok) ? "MISMATCH" : "no baseline");
+            regressions += (b != NULL && !c->ok);
+            continue;
+        }
+        double change = (b->median_ns > 0) ? 100.0 * (c->median_ns - b->median_ns) / b->median_ns : 0;
+        // -- beyond the threshold and beyond what the two runs' own spread explains
+        double noise = b->stddev_ns + c->stddev_ns;
+        char const * verdict = "";
+        if (change > threshold_pct && c->median_ns - b->median_ns > noise) {
+            verdict = "REGRESSION";
+            regressions++;
+        } else if (change < -threshold_pct && b->median_ns - c->median_ns > noise) {
+            verdict = "improved";
+        }
+        fprintf(out, "%-28s %12.2f %12.2f %+9.1f%s%s\n", c->name, b->median_ns, c->median_ns, change,
+            *verdict ? "  " : "", verdict);
+    }
+    for (int k = 0; k < n_base; ++k) {
+        int found = 0;
+        for (int i = 0; i < n_cur && !found; ++i)
+            found = (0 == strcmp(base[k].name, cur[i].name));
+        if (!found)
+            fprintf(out, "%-28s %12.2f %12s %9s  gone\n", base[k].name, base[k].median_ns, "-", "-");
+    }
+    fprintf(out, "%d regression(s) beyond %.1f%%\n", regressions, threshold_pct);
+    free(base);
+    free(cur);
+    return regressions;
+}
+#pragma endregion
+
+// =========================================================================================
+
+char *
+Bench_TempPath (char * buf, size_t size, char const * name) {
+    snprintf(buf, size, "%s/owin32_bench_%s", g_bench.tmp_dir, name);
+    return buf;
+}
+void
+Bench_Consume (uint64_t v) {
+    g_sink += v;
+}
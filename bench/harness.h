@@ -0,0 +1,127 @@
+#pragma once
+
+/* ===========================================================
+   #File: harness.h #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Portable benchmark harness: cases, repetitions, statistics, JSON, compare #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+One executable for the modules of every solution, built with CMake on
+Windows and Linux alike:
+
+ - A case is a setup (untimed), a run that does some fixed work and says
+   how many operations that was, and a teardown. The harness runs it
+   `warmup` times untimed, then `reps` times timed, and keeps ns per
+   operation of every repetition: min, median, p99, mean, stddev.
+ - Cases come in groups (queue, handshake, fileio, records, str, alloc, log,
+   except), one table each in its cases_*.c / .cpp file; their names are
+   "group/case", and filters on the command line select by prefix.
+ - A run that returns a negative count failed its own check; the case is
+   reported as MISMATCH and the run exits non-zero.
+ - Results go to a JSON file, one result per line, and compare mode
+   reads two such files and flags the cases whose median got slower by
+   more than a threshold and more than the noise (stddev) of both runs.
+
+Files the cases need are made in the working directory (or tmp=) with
+an "owin32_bench_" prefix and removed afterwards.
+*/
+
+#define BENCH_NAME_LEN      64
+#define BENCH_MAX_REPS      1000
+
+typedef struct BenchCase {
+    char const *    name;           // "group/case"
+    char const *    unit;           // what one operation is: "msg", "byte", "record", ...
+    void *          (*setup) (void);            // may be NULL; NULL return on failure is reported
+    int64_t         (*run) (void * state);      // one repetition: operations done, < 0 if its check failed
+    void            (*teardown) (void * state); // may be NULL
+} BenchCase;
+
+typedef struct BenchGroup {
+    BenchCase const *   cases;
+    size_t              count;
+} BenchGroup;
+
+typedef struct BenchResult {
+    char        name[BENCH_NAME_LEN];
+    char        unit[16];
+    int64_t     ops;                // per repetition (the last one)
+    int         reps;
+    double      min_ns;             // all per operation
+    double      median_ns;
+    double      p99_ns;
+    double      mean_ns;
+    double      stddev_ns;
+    int         ok;
+} BenchResult;
+
+typedef struct BenchOptions {
+    int             reps;           // timed repetitions
+    int             warmup;         // untimed ones before them
+    char const *    cpus;           // "2", "0-3", "0,2,4"; NULL: no pinning
+    char const *    tmp_dir;        // where cases put their files
+} BenchOptions;
+
+/* Options shared with the cases */
+extern BenchOptions g_bench;
+
+// =========================================================================================
+
+/* Runs c per g_bench into r; false when setup failed or a run's check did */
+int
+Bench_Run (BenchCase const * c, BenchResult * r);
+
+/* Restricts the process (and the threads it starts) to the cpus list; false on failure */
+int
+Bench_Pin (char const * cpus);
+
+void
+Bench_PrintHeader (FILE * out);
+
+void
+Bench_Print (BenchResult const * r, FILE * out);
+
+/* { ...run info..., "results": [ one line per result ] } */
+int
+Bench_WriteJson (char const * path, BenchResult const * results, size_t count);
+
+/* Regressions of new_path against base_path beyond threshold_pct; -1 if a file cannot be read */
+int
+Bench_Compare (char const * base_path, char const * new_path, double threshold_pct, FILE * out);
+
+// =========================================================================================
+
+/* The cases, a table per cases_*.c / .cpp file */
+extern BenchGroup const g_queue_group;      // queues and the handshake round trip
+extern BenchGroup const g_co_group;         // the C++20 awaitable queue
+extern BenchGroup const g_fileio_group;     // file copy and cat
+extern BenchGroup const g_records_group;    // pirate record I/O
+extern BenchGroup const g_str_group;        // cstr string routines
+extern BenchGroup const g_misc_group;       // misc: allocators against malloc, logging
+extern BenchGroup const g_except_group;     // error propagation, fault-guarded batches, lazy buffers
+
+// =========================================================================================
+
+/* A path in g_bench.tmp_dir: owin32_bench_<name>; the buffer is the caller's */
+char *
+Bench_TempPath (char * buf, size_t size, char const * name);
+
+/* Keeps the compiler from dropping a computed value */
+void
+Bench_Consume (uint64_t v);
+
+#ifdef __cplusplus
+}
+#endif
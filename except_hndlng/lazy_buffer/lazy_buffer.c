@@ -0,0 +1,241 @@
+/* ===========================================================
+   #File: lazy_buffer.c #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Reserve-then-commit-on-fault buffers #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#if !defined(_WIN32) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE     /* MAP_ANONYMOUS, MAP_NORESERVE, madvise */
+#endif
+
+#include "lazy_buffer.h"
+
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/*
+The handler's table: a slot goes from NULL to a buffer at Init and back at
+Deinit. The handler only reads it (acquire loads, no lock), since it may
+run at any instruction of any thread; Init and Deinit serialize on a lock.
+*/
+static LazyBuffer * volatile g_buffers[LAZY_MAX_BUFFERS];
+static int g_handler_installed;
+
+// =========================================================================================
+
+#pragma region platform
+#ifdef _WIN32
+static SRWLOCK g_table_lock = SRWLOCK_INIT;
+
+static void         table_lock (void)       { AcquireSRWLockExclusive(&g_table_lock); }
+static void         table_unlock (void)     { ReleaseSRWLockExclusive(&g_table_lock); }
+static LazyBuffer * load_slot (int i)       { return (LazyBuffer *)ReadPointerAcquire((PVOID const volatile *)&g_buffers[i]); }
+static void         store_slot (int i, LazyBuffer * b) { WritePointerRelease((PVOID volatile *)&g_buffers[i], b); }
+static void         count_fault (LazyBuffer * b) { InterlockedIncrement64((LONG64 volatile *)&b->faults); }
+
+static size_t
+page_size (void) {
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return si.dwPageSize;
+}
+static char *
+reserve_range (size_t len) {
+    return (char *)VirtualAlloc(NULL, len, MEM_RESERVE, PAGE_NOACCESS);
+}
+static void
+release_range (char * p, size_t len) {
+    (void)len;
+    VirtualFree(p, 0, MEM_RELEASE);
+}
+static int
+commit_range (char * p, size_t len) {
+    return NULL != VirtualAlloc(p, len, MEM_COMMIT, PAGE_READWRITE);
+}
+static void
+decommit_range (char * p, size_t len) {
+    VirtualFree(p, len, MEM_DECOMMIT);
+}
+#else
+static pthread_mutex_t g_table_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void         table_lock (void)       { pthread_mutex_lock(&g_table_lock); }
+static void         table_unlock (void)     { pthread_mutex_unlock(&g_table_lock); }
+static LazyBuffer * load_slot (int i)       { return __atomic_load_n(&g_buffers[i], __ATOMIC_ACQUIRE); }
+static void         store_slot (int i, LazyBuffer * b) { __atomic_store_n(&g_buffers[i], b, __ATOMIC_RELEASE); }
+static void         count_fault (LazyBuffer * b) { __atomic_add_fetch(&b->faults, 1, __ATOMIC_RELAXED); }
+
+static size_t
+page_size (void) {
+    return (size_t)sysconf(_SC_PAGESIZE);
+}
+static char *
+reserve_range (size_t len) {
+    void * p = mmap(NULL, len, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    return (MAP_FAILED == p) ? NULL : (char *)p;
+}
+static void
+release_range (char * p, size_t len) {
+    munmap(p, len);
+}
+/* mprotect is a plain system call: safe enough in the SIGSEGV handler */
+static int
+commit_range (char * p, size_t len) {
+    return 0 == mprotect(p, len, PROT_READ | PROT_WRITE);
+}
+static void
+decommit_range (char * p, size_t len) {
+    mprotect(p, len, PROT_NONE);
+    madvise(p, len, MADV_DONTNEED);     // drop the pages; the next touch faults again
+}
+#endif
+#pragma endregion
+
+// =========================================================================================
+
+/* Commits the chunk around addr if it belongs to a buffer; false for foreign faults */
+static int
+handle_fault (char const * addr) {
+    for (int i = 0; i < LAZY_MAX_BUFFERS; i++) {
+        LazyBuffer * b = load_slot(i);
+        if (NULL == b || addr < b->base || addr >= b->base + b->reserved)
+            continue;
+        size_t off = (size_t)(addr - b->base);
+        off -= off % b->chunk;
+        size_t len = (b->reserved - off < b->chunk) ? b->reserved - off : b->chunk;
+        if (!commit_range(b->base + off, len))
+            return 0;           // out of memory: let the fault take its normal course
+        count_fault(b);
+        return 1;
+    }
+    return 0;
+}
+
+#pragma region handler
+#ifdef _WIN32
+static LONG CALLBACK
+on_exception (PEXCEPTION_POINTERS info) {
+    EXCEPTION_RECORD const * r = info->ExceptionRecord;
+    /* -- ExceptionInformation: [0] read/write/execute, [1] the address */
+    if (r->ExceptionCode != EXCEPTION_ACCESS_VIOLATION || r->NumberParameters < 2 || r->ExceptionInformation[0] == 8)
+        return EXCEPTION_CONTINUE_SEARCH;
+    return handle_fault((char const *)r->ExceptionInformation[1]) ? EXCEPTION_CONTINUE_EXECUTION : EXCEPTION_CONTINUE_SEARCH;
+}
+static int
+install_handler (void) {
+    /* -- first in line: a fault of ours is never an error for the frame-based handlers */
+    return NULL != AddVectoredExceptionHandler(1, on_exception);
+}
+#else
+static struct sigaction g_prev_segv;
+
+static void
+on_segv (int sig, siginfo_t * si, void * ctx) {
+    int saved_errno = errno;
+    int ours = handle_fault((char const *)si->si_addr);
+    errno = saved_errno;
+    if (ours)
+        return;             // the faulting instruction runs again, now on committed memory
+
+    if ((g_prev_segv.sa_flags & SA_SIGINFO) && g_prev_segv.sa_sigaction != NULL) {
+        g_prev_segv.sa_sigaction(sig, si, ctx);
+    } else if (g_prev_segv.sa_handler != SIG_DFL && g_prev_segv.sa_handler != SIG_IGN) {
+        g_prev_segv.sa_handler(sig);
+    } else {
+        /* -- back to the default action; returning re-faults and ends the process */
+        struct sigaction dfl;
+        memset(&dfl, 0, sizeof(dfl));
+        dfl.sa_handler = SIG_DFL;
+        sigaction(SIGSEGV, &dfl, NULL);
+    }
+}
+static int
+install_handler (void) {
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = on_segv;
+    sa.sa_flags = SA_SIGINFO | SA_ONSTACK | SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    return 0 == sigaction(SIGSEGV, &sa, &g_prev_segv);
+}
+#endif
+#pragma endregion
+
+// =========================================================================================
+
+int
+LazyBuffer_Init (LazyBuffer * b, size_t reserve_bytes, size_t chunk) {
+    size_t page = page_size();
+    memset(b, 0, sizeof(*b));
+    b->slot = -1;
+
+    if (0 == chunk)
+        chunk = LAZY_DEFAULT_CHUNK;
+    b->chunk = (chunk + page - 1) / page * page;
+    b->reserved = (reserve_bytes + page - 1) / page * page;
+    if (0 == b->reserved || NULL == (b->base = reserve_range(b->reserved)))
+        return 0;
+
+    table_lock();
+    if (!g_handler_installed)
+        g_handler_installed = install_handler();
+    for (int i = 0; g_handler_installed && i < LAZY_MAX_BUFFERS; i++) {
+        if (NULL == g_buffers[i]) {
+            b->slot = i;
+            store_slot(i, b);
+            break;
+        }
+    }
+    table_unlock();
+
+    if (b->slot < 0) {
+        release_range(b->base, b->reserved);
+        b->base = NULL;
+        return 0;
+    }
+    return 1;
+}
+void
+LazyBuffer_Deinit (LazyBuffer * b) {
+    if (NULL == b->base)
+        return;
+    /* -- out of the table first, so no fault can commit into the released range */
+    table_lock();
+    store_slot(b->slot, NULL);
+    table_unlock();
+    release_range(b->base, b->reserved);
+    b->base = NULL;
+    b->slot = -1;
+}
+void
+LazyBuffer_Reset (LazyBuffer * b) {
+    if (b->base != NULL)
+        decommit_range(b->base, b->reserved);
+}
+int
+LazyBuffer_Commit (LazyBuffer * b, size_t offset, size_t len) {
+    size_t page = page_size();
+    if (offset > b->reserved || len > b->reserved - offset)
+        return 0;
+    if (0 == len)
+        return 1;
+    size_t first = offset / page * page;
+    size_t end = (offset + len + page - 1) / page * page;
+    return commit_range(b->base + first, end - first);
+}
+int64_t
+LazyBuffer_Faults (LazyBuffer const * b) {
+    return b->faults;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+/* ===========================================================
+   #File: lazy_buffer.h #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Reserve-then-commit-on-fault buffers #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+A LazyBuffer reserves a large address range up front and commits none of
+it. The first touch of a page faults; a process-wide handler recognizes the
+address, commits the chunk around it and resumes the faulting instruction.
+Arrays can grow to GBs in place: no realloc copies, no up-front commit, and
+pointers into the buffer stay valid as it grows.
+
+ - Windows: VirtualAlloc(MEM_RESERVE), then MEM_COMMIT from a vectored
+   exception handler on EXCEPTION_ACCESS_VIOLATION. The reserved pages are
+   the guard: unlike PAGE_GUARD they trip on any access, not only the next
+   page in order, so random access works too.
+ - Linux: mmap(PROT_NONE, MAP_NORESERVE), then mprotect(PROT_READ | PROT_WRITE)
+   from a SIGSEGV handler. Faults outside every buffer go to the handler that
+   was installed before ours, or kill the process as usual.
+ - Any thread may fault any page at any time; two threads faulting the same
+   chunk both commit it, which is harmless.
+ - Up to LAZY_MAX_BUFFERS buffers exist at once. Deinit and Reset require
+   that no other thread touches the buffer meanwhile.
+*/
+
+#define LAZY_MAX_BUFFERS        64
+#define LAZY_DEFAULT_CHUNK      (64 * 1024)
+
+typedef struct LazyBuffer {
+    char *              base;
+    size_t              reserved;       // bytes of address space
+    size_t              chunk;          // bytes committed per fault, a multiple of the page size
+    volatile int64_t    faults;         // faults served, for statistics
+    int                 slot;           // in the handler's table
+} LazyBuffer;
+
+/* chunk 0 picks LAZY_DEFAULT_CHUNK; false when the range cannot be reserved or the table is full */
+int
+LazyBuffer_Init (LazyBuffer * b, size_t reserve_bytes, size_t chunk);
+
+/* Releases the whole range */
+void
+LazyBuffer_Deinit (LazyBuffer * b);
+
+/* Decommits everything: the memory goes back to the system, the range stays reserved */
+void
+LazyBuffer_Reset (LazyBuffer * b);
+
+/* Commits [offset, offset + len) without faulting, e.g. ahead of a bulk write */
+int
+LazyBuffer_Commit (LazyBuffer * b, size_t offset, size_t len);
+
+int64_t
+LazyBuffer_Faults (LazyBuffer const * b);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,241 @@
+/* ===========================================================
+   #File: lazy_buffer_main.c #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: LazyBuffer growth benchmark and concurrent fault test #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L    /* clock_gettime */
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lazy_buffer.h"
+#include "../../bench/bench_util.h"
+
+#ifndef _countof
+#define _countof(a) (sizeof(a) / sizeof((a)[0]))
+#endif
+
+// =========================================================================================
+
+#if SIZE_MAX > 0xFFFFFFFFu
+#define RESERVE_BYTES   ((size_t)4 << 30)
+#else
+#define RESERVE_BYTES   ((size_t)1 << 30)   // what a 32-bit process can usually find in one piece
+#endif
+
+/* A 64-byte record, about the size of the queue and record store entries */
+typedef struct Record {
+    uint64_t seq;
+    uint64_t payload[7];
+} Record;
+
+// =========================================================================================
+
+#pragma region grow
+/* Each strategy appends n records and returns the sum of their seq fields, read back */
+static uint64_t
+sum_records (Record const * r, size_t n) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < n; ++i)
+        sum += r[i].seq;
+    return sum;
+}
+static void
+fill_record (Record * r, size_t i) {
+    r->seq = i;
+    for (int k = 0; k < 7; ++k)
+        r->payload[k] = i * (uint64_t)(k + 1);
+}
+
+/* realloc to twice the capacity whenever full: the usual growable array */
+static uint64_t
+grow_realloc (size_t n, int64_t * faults) {
+    size_t cap = 64;
+    Record * r = (Record *)malloc(cap * sizeof(Record));
+    *faults = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (i == cap) {
+            Record * bigger = (Record *)realloc(r, 2 * cap * sizeof(Record));
+            if (NULL == bigger) {
+                free(r);
+                return 0;
+            }
+            r = bigger;
+            cap *= 2;
+        }
+        fill_record(&r[i], i);
+    }
+    uint64_t sum = sum_records(r, n);
+    free(r);
+    return sum;
+}
+/* A LazyBuffer committed by faults, chunk bytes at a time */
+static uint64_t
+grow_lazy (size_t n, size_t chunk, int64_t * faults) {
+    LazyBuffer b;
+    if (!LazyBuffer_Init(&b, RESERVE_BYTES, chunk))
+        return 0;
+    Record * r = (Record *)b.base;
+    for (size_t i = 0; i < n; ++i)
+        fill_record(&r[i], i);
+    uint64_t sum = sum_records(r, n);
+    *faults = LazyBuffer_Faults(&b);
+    LazyBuffer_Deinit(&b);
+    return sum;
+}
+/* The same buffer, committed explicitly 1 MB ahead: no faults, the baseline for their cost */
+static uint64_t
+grow_committed (size_t n, int64_t * faults) {
+    LazyBuffer b;
+    size_t const step = (1 << 20) / sizeof(Record);
+    if (!LazyBuffer_Init(&b, RESERVE_BYTES, 0))
+        return 0;
+    Record * r = (Record *)b.base;
+    for (size_t i = 0; i < n; ++i) {
+        if (i % step == 0)
+            LazyBuffer_Commit(&b, i * sizeof(Record), step * sizeof(Record));
+        fill_record(&r[i], i);
+    }
+    uint64_t sum = sum_records(r, n);
+    *faults = LazyBuffer_Faults(&b);
+    LazyBuffer_Deinit(&b);
+    return sum;
+}
+
+static void
+bench_grow (void) {
+    static size_t const sizes_mb [] = {16, 256, 1024};
+
+    printf("Append 64-byte records (ms, best of %d)\n", BENCH_REPS);
+    printf("%-8s %12s %12s %12s %12s %14s\n", "MB", "realloc", "lazy 64K", "lazy 2M", "committed", "faults (64K)");
+    for (size_t s = 0; s < _countof(sizes_mb); ++s) {
+        if (sizes_mb[s] << 20 >= RESERVE_BYTES)
+            break;
+        size_t n = (sizes_mb[s] << 20) / sizeof(Record);
+        uint64_t expect = (uint64_t)n * (n - 1) / 2;
+        double best[4] = {1e30, 1e30, 1e30, 1e30};
+        int64_t faults[4] = {0, 0, 0, 0};
+        int ok = 1;
+
+        for (int rep = 0; rep < BENCH_REPS; ++rep) {
+            for (int k = 0; k < 4; ++k) {
+                double t = BenchUtil_Now();
+                uint64_t sum =
+                    (k == 0) ? grow_realloc(n, &faults[k]) :
+                    (k == 1) ? grow_lazy(n, 64 << 10, &faults[k]) :
+                    (k == 2) ? grow_lazy(n, 2 << 20, &faults[k]) :
+                               grow_committed(n, &faults[k]);
+                t = BenchUtil_Now() - t;
+                ok &= (sum == expect);
+                if (t < best[k])
+                    best[k] = t;
+            }
+        }
+        printf(
+            "%-8zu %12.1f %12.1f %12.1f %12.1f %14lld%s\n", sizes_mb[s],
+            best[0] * 1e3, best[1] * 1e3, best[2] * 1e3, best[3] * 1e3,
+            (long long)faults[1], ok ? "" : "  (MISMATCH)"
+        );
+    }
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region faults
+typedef struct FaultJob {
+    LazyBuffer *        b;
+    size_t              n_words;
+    int                 thread;
+    int                 n_threads;
+    volatile int *      go;
+} FaultJob;
+
+/* Word i belongs to thread i % n_threads: every thread writes into every page, all at once */
+static void
+fault_job (void * arg) {
+    FaultJob * j = (FaultJob *)arg;
+    uint64_t * w = (uint64_t *)j->b->base;
+    while (!*j->go)
+        ;
+    for (size_t i = (size_t)j->thread; i < j->n_words; i += (size_t)j->n_threads)
+        w[i] = ((uint64_t)j->thread << 56) | i;
+}
+
+static int
+check_faults (void) {
+    enum { MAX_THREADS = 16, ROUNDS = 4 };
+    static int const threads [] = {2, 4, 8, 16};
+    size_t const bytes = (size_t)64 << 20;
+    LazyBuffer b;
+    int ok = 1;
+
+    /* -- one page per fault: as many faults, and as many collisions, as possible */
+    if (!LazyBuffer_Init(&b, bytes, 1)) {
+        printf("cannot reserve %zu bytes\n", bytes);
+        return 0;
+    }
+    printf("Concurrent faults on %zu MB, one page per fault\n", bytes >> 20);
+    printf("%-8s %8s %12s %12s\n", "threads", "rounds", "faults", "result");
+    for (size_t t = 0; t < _countof(threads); ++t) {
+        int n = threads[t];
+        int64_t faults = 0;
+        int round_ok = 1;
+        for (int round = 0; round < ROUNDS; ++round) {
+            FaultJob jobs[MAX_THREADS];
+            volatile int go = 0;
+            MtThread h[MAX_THREADS];
+            int started = 0;
+            int64_t before = LazyBuffer_Faults(&b);
+            LazyBuffer_Reset(&b);
+            for (int i = 0; i < n; ++i) {
+                jobs[i].b = &b;
+                jobs[i].n_words = bytes / sizeof(uint64_t);
+                jobs[i].thread = i;
+                jobs[i].n_threads = n;
+                jobs[i].go = &go;
+                started += mt_thread_create(&h[started], fault_job, &jobs[i]);
+            }
+            go = 1;
+            for (int i = 0; i < started; ++i)
+                mt_thread_join(h[i]);
+            round_ok &= (started == n);
+            faults += LazyBuffer_Faults(&b) - before;
+
+            /* -- every word holds what its owner wrote: no write was lost to a racing commit */
+            uint64_t const * w = (uint64_t const *)b.base;
+            for (size_t i = 0; i < bytes / sizeof(uint64_t); ++i) {
+                if (w[i] != (((uint64_t)(i % (size_t)n) << 56) | i)) {
+                    round_ok = 0;
+                    break;
+                }
+            }
+        }
+        printf("%-8d %8d %12lld %12s\n", n, ROUNDS, (long long)faults, round_ok ? "ok" : "CORRUPT");
+        ok &= round_ok;
+    }
+    LazyBuffer_Deinit(&b);
+    return ok;
+}
+#pragma endregion
+
+// =========================================================================================
+
+int main (int argc, char * argv []) {
+    int ok = 1;
+    if (BenchUtil_Wanted(argc, argv, "faults"))
+        ok = check_faults();
+    if (BenchUtil_Wanted(argc, argv, "grow"))
+        bench_grow();
+    return(ok ? 0 : 1);
+}
@@ -0,0 +1,180 @@
+/* ===========================================================
+   #File: fault_batch.c #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Batch execution that survives hardware faults, chunk by chunk #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L    /* sigaction, sigsetjmp */
+#endif
+
+#include "fault_batch.h"
+
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <setjmp.h>
+#include <signal.h>
+#endif
+
+// =========================================================================================
+
+#pragma region guard
+#ifdef _WIN32
+/* The hardware faults a corrupted input can cause; everything else keeps searching */
+static int
+fault_filter (EXCEPTION_POINTERS const * info, uint32_t * code, void ** addr) {
+    EXCEPTION_RECORD const * r = info->ExceptionRecord;
+    switch (r->ExceptionCode) {
+    case EXCEPTION_ACCESS_VIOLATION:
+    case EXCEPTION_IN_PAGE_ERROR:       // a mapped file that could not be read
+        if (r->NumberParameters >= 2)
+            *addr = (void *)r->ExceptionInformation[1];
+        /* fall through */
+    case EXCEPTION_DATATYPE_MISALIGNMENT:
+    case EXCEPTION_ARRAY_BOUNDS_EXCEEDED:
+    case EXCEPTION_INT_DIVIDE_BY_ZERO:
+    case EXCEPTION_INT_OVERFLOW:
+    case EXCEPTION_ILLEGAL_INSTRUCTION:
+    case EXCEPTION_PRIV_INSTRUCTION:
+        *code = (uint32_t)r->ExceptionCode;
+        return EXCEPTION_EXECUTE_HANDLER;
+    default:
+        return EXCEPTION_CONTINUE_SEARCH;
+    }
+}
+static FaultChunkStatus
+run_guarded (FaultChunkFn fn, void * ctx, size_t i_chunk, size_t first, size_t count, uint32_t * code, void ** addr) {
+    __try {
+        return fn(ctx, i_chunk, first, count) ? FAULT_CHUNK_FAILED : FAULT_CHUNK_OK;
+    } __except (fault_filter(GetExceptionInformation(), code, addr)) {
+        return FAULT_CHUNK_FAULTED;
+    }
+}
+#else
+static int const g_signals [] = {SIGSEGV, SIGBUS, SIGFPE, SIGILL};
+#define N_SIGNALS ((int)(sizeof(g_signals) / sizeof(g_signals[0])))
+
+static struct sigaction g_prev[N_SIGNALS];
+static pthread_once_t g_install_once = PTHREAD_ONCE_INIT;
+
+/* The jump target of the chunk this thread is running, NULL outside a chunk */
+static _Thread_local sigjmp_buf * volatile t_jump;
+static _Thread_local uint32_t t_code;
+static _Thread_local void * t_addr;
+
+static void
+on_fault (int sig, siginfo_t * si, void * ctx) {
+    sigjmp_buf * j = t_jump;
+    if (j != NULL) {
+        t_jump = NULL;
+        t_code = (uint32_t)sig;
+        t_addr = (sig == SIGSEGV || sig == SIGBUS) ? si->si_addr : NULL;
+        siglongjmp(*j, 1);
+    }
+
+    /* -- not in a chunk: whoever had the signal before us */
+    for (int i = 0; i < N_SIGNALS; i++) {
+        if (g_signals[i] != sig)
+            continue;
+        struct sigaction const * prev = &g_prev[i];
+        if ((prev->sa_flags & SA_SIGINFO) && prev->sa_sigaction != NULL) {
+            prev->sa_sigaction(sig, si, ctx);
+        } else if (prev->sa_handler != SIG_DFL && prev->sa_handler != SIG_IGN) {
+            prev->sa_handler(sig);
+        } else {
+            /* -- back to the default action; returning re-faults and ends the process */
+            struct sigaction dfl;
+            memset(&dfl, 0, sizeof(dfl));
+            dfl.sa_handler = SIG_DFL;
+            sigaction(sig, &dfl, NULL);
+        }
+        return;
+    }
+}
+static void
+install_handlers (void) {
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = on_fault;
+    /* -- SA_NODEFER: the signal is not blocked in the handler, so jumping out needs no mask restore */
+    sa.sa_flags = SA_SIGINFO | SA_NODEFER;
+    sigemptyset(&sa.sa_mask);
+    for (int i = 0; i < N_SIGNALS; i++)
+        sigaction(g_signals[i], &sa, &g_prev[i]);
+}
+static FaultChunkStatus
+run_guarded (FaultChunkFn fn, void * ctx, size_t i_chunk, size_t first, size_t count, uint32_t * code, void ** addr) {
+    sigjmp_buf env;
+    sigjmp_buf * outer = t_jump;    // a chunk may run a batch of its own
+    int r;
+
+    /* -- savemask 0: no sigprocmask system call per chunk */
+    if (sigsetjmp(env, 0) != 0) {
+        t_jump = outer;
+        *code = t_code;
+        *addr = t_addr;
+        return FAULT_CHUNK_FAULTED;
+    }
+    t_jump = &env;
+    r = fn(ctx, i_chunk, first, count);
+    t_jump = outer;
+    return r ? FAULT_CHUNK_FAILED : FAULT_CHUNK_OK;
+}
+#endif
+#pragma endregion
+
+// =========================================================================================
+
+size_t
+FaultBatch_ChunkCount (size_t n_items, size_t chunk_items) {
+    if (0 == chunk_items)
+        return 0;
+    return n_items / chunk_items + (n_items % chunk_items != 0);
+}
+
+size_t
+FaultBatch_Run (
+    size_t n_items, size_t chunk_items,
+    FaultChunkFn fn, void * ctx,
+    uint8_t * status, FaultBatchResult * result
+) {
+    memset(result, 0, sizeof(*result));
+    result->n_chunks = FaultBatch_ChunkCount(n_items, chunk_items);
+#ifndef _WIN32
+    pthread_once(&g_install_once, install_handlers);
+#endif
+
+    for (size_t i = 0; i < result->n_chunks; i++) {
+        size_t first = i * chunk_items;
+        size_t count = (n_items - first < chunk_items) ? n_items - first : chunk_items;
+        uint32_t code = 0;
+        void * addr = NULL;
+
+        FaultChunkStatus s = run_guarded(fn, ctx, i, first, count, &code, &addr);
+        if (status != NULL)
+            status[i] = (uint8_t)s;
+        switch (s) {
+        case FAULT_CHUNK_OK:
+            result->n_ok++;
+            break;
+        case FAULT_CHUNK_FAILED:
+            result->n_failed++;
+            break;
+        case FAULT_CHUNK_FAULTED:
+            if (0 == result->n_faulted++) {
+                result->first_fault_chunk = i;
+                result->first_fault_code = code;
+                result->first_fault_addr = addr;
+            }
+            break;
+        }
+    }
+    return result->n_ok;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+/* ===========================================================
+   #File: fault_batch.h #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Batch execution that survives hardware faults, chunk by chunk #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+FaultBatch_Run splits n_items into chunks and calls fn once per chunk
+inside a fault guard. A chunk that faults (a bad pointer in a corrupted
+record, a read error on a mapped file, a division by zero) is marked
+FAULTED and the scan moves on to the next chunk; the guard costs once
+per chunk, never per record.
+
+ - Windows: __try/__except around the call; the filter takes access
+   violations, in-page errors, misalignment, bounds and integer faults.
+   Stack overflows and C++ exceptions are not taken.
+ - Linux: a SIGSEGV/SIGBUS/SIGFPE/SIGILL handler siglongjmps back to a
+   sigsetjmp taken before the call. The signals are installed with
+   SA_NODEFER, so the jump does not restore the mask with a system call.
+   Faults outside a guarded chunk go to the handler installed before ours.
+   A handler that resolves faults itself (LazyBuffer) must be installed
+   after the first FaultBatch_Run, or its faults inside a chunk count as ours.
+ - A faulted chunk is abandoned midway: whatever it wrote stays as it was,
+   and nothing it allocated is freed, C++ destructors included. fn should
+   write its results somewhere the caller discards for faulted chunks.
+ - Any number of threads may run batches at once.
+*/
+
+typedef enum FaultChunkStatus {
+    FAULT_CHUNK_OK,
+    FAULT_CHUNK_FAILED,         // fn returned nonzero
+    FAULT_CHUNK_FAULTED         // fn faulted
+} FaultChunkStatus;
+
+/* Process items [first, first + count); nonzero reports a failure without a fault */
+typedef int (*FaultChunkFn) (void * ctx, size_t i_chunk, size_t first, size_t count);
+
+typedef struct FaultBatchResult {
+    size_t      n_chunks;
+    size_t      n_ok;
+    size_t      n_failed;
+    size_t      n_faulted;
+    size_t      first_fault_chunk;  // valid when n_faulted > 0
+    uint32_t    first_fault_code;   // exception code, or signal number
+    void *      first_fault_addr;   // the address accessed, when the fault has one
+} FaultBatchResult;
+
+/* The # of chunks for n_items; the size of the status array Run fills */
+size_t
+FaultBatch_ChunkCount (size_t n_items, size_t chunk_items);
+
+/* status may be NULL, else it gets one FaultChunkStatus per chunk; returns result->n_ok */
+size_t
+FaultBatch_Run (
+    size_t n_items, size_t chunk_items,
+    FaultChunkFn fn, void * ctx,
+    uint8_t * status, FaultBatchResult * result
+);
+
+#ifdef __cplusplus
+}
+#endif
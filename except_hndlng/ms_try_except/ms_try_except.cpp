@@ -0,0 +1,549 @@
+/* ===========================================================
+   #File: ms_try_except.cpp #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Cost of error propagation strategies on a hot path #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+/*
+Every strategy runs the same call chain: DEPTH frames over a leaf that
+"parses a record" and fails at a set rate. The no-error column is what an
+I/O loop pays on every record; the others show what each failure costs.
+
+    code        int return, the result through an out parameter
+    last_error  bool return, the code in thread-local state (GetLastError/SetLastError on Windows)
+    result      value and code returned together (Result<T>, an expected-like type)
+    exception   C++ throw at the leaf, one try/catch at the top
+    seh         RaiseException at the leaf, __try/__except at the top (Windows)
+    longjmp     setjmp per call at the top, longjmp at the leaf (the portable non-local exit)
+
+Before timing, every strategy is checked against the code variant over the
+same inputs: the sums of the values and the # of errors must agree.
+
+The batch part scans a large array of records through FaultBatch_Run, with
+and without bad pointers planted in it, against the same scan unguarded.
+
+    ms_try_except [propagate] [batch] [check]
+
+No arguments runs everything; "check" only runs the cross-checks.
+*/
+
+#include <setjmp.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include "fault_batch.h"
+
+#define BENCH_REPS      5           // best of
+#include "../../bench/bench_util.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#define NOINLINE __declspec(noinline)
+#else
+#define NOINLINE __attribute__((noinline))
+#endif
+
+#ifndef _countof
+#define _countof(a) (sizeof(a) / sizeof((a)[0]))
+#endif
+
+// =========================================================================================
+
+#define BENCH_MIN_SEC   0.05        // each rep runs whole passes for at least this long
+#define N_INPUTS        (1 << 16)   // one pass
+#define ERR_BAD_RECORD  0x2001      // the one failure of the leaf
+
+static uint32_t g_inputs[N_INPUTS];
+static uint32_t g_fail_below;       // the leaf fails when the low 16 bits of its input are below this
+
+static uint64_t
+next_rand (uint64_t * state) {
+    // -- xorshift64*
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+/* The leaf's work: a few dependent multiplies, about the cost of decoding a small field */
+static inline bool
+leaf_fails (uint32_t x) {
+    return (x & 0xFFFF) < g_fail_below;
+}
+static inline uint32_t
+leaf_work (uint32_t x) {
+    x *= 0x9E3779B1u;
+    x ^= x >> 15;
+    x *= 0x85EBCA77u;
+    return x ^ (x >> 13);
+}
+
+// =========================================================================================
+
+#pragma region strategies
+/* -- code: the error is the return value */
+template <int D> static NOINLINE int
+by_code (uint32_t x, uint32_t * out) {
+    if constexpr (D == 0) {
+        if (leaf_fails(x))
+            return ERR_BAD_RECORD;
+        *out = leaf_work(x);
+        return 0;
+    } else {
+        int err = by_code<D - 1>(x, out);
+        if (err != 0)
+            return err;
+        *out += D;
+        return 0;
+    }
+}
+
+/* -- last_error: success flag, the code on the side */
+#ifdef _WIN32
+static void     set_last_error (uint32_t e) { SetLastError((DWORD)e); }
+static uint32_t get_last_error (void)       { return (uint32_t)GetLastError(); }
+#else
+static thread_local uint32_t t_last_error;
+static void     set_last_error (uint32_t e) { t_last_error = e; }
+static uint32_t get_last_error (void)       { return t_last_error; }
+#endif
+
+template <int D> static NOINLINE bool
+by_last_error (uint32_t x, uint32_t * out) {
+    if constexpr (D == 0) {
+        if (leaf_fails(x)) {
+            set_last_error(ERR_BAD_RECORD);
+            return false;
+        }
+        *out = leaf_work(x);
+        return true;
+    } else {
+        if (!by_last_error<D - 1>(x, out))
+            return false;
+        *out += D;
+        return true;
+    }
+}
+
+/* -- result: value and error travel together, small enough for a register pair */
+template <typename T>
+struct Result {
+    T value;
+    int error;
+
+    static Result ok (T v)      { return Result{v, 0}; }
+    static Result fail (int e)  { return Result{T(), e}; }
+    bool has_value () const     { return error == 0; }
+};
+
+template <int D> static NOINLINE Result<uint32_t>
+by_result (uint32_t x) {
+    if constexpr (D == 0) {
+        if (leaf_fails(x))
+            return Result<uint32_t>::fail(ERR_BAD_RECORD);
+        return Result<uint32_t>::ok(leaf_work(x));
+    } else {
+        Result<uint32_t> r = by_result<D - 1>(x);
+        if (!r.has_value())
+            return r;
+        return Result<uint32_t>::ok(r.value + D);
+    }
+}
+
+/* -- exception: nothing between the throw and the catch looks at errors */
+struct RecordError {
+    int code;
+};
+
+template <int D> static NOINLINE uint32_t
+by_exception (uint32_t x) {
+    if constexpr (D == 0) {
+        if (leaf_fails(x))
+            throw RecordError{ERR_BAD_RECORD};
+        return leaf_work(x);
+    } else {
+        return by_exception<D - 1>(x) + D;
+    }
+}
+
+/* -- seh: RaiseException, filtered on the code at the top */
+#ifdef _WIN32
+#define EXC_BAD_RECORD  0xE0002001u     // customer bit set, error severity
+
+template <int D> static NOINLINE uint32_t
+by_seh (uint32_t x) {
+    if constexpr (D == 0) {
+        if (leaf_fails(x))
+            RaiseException(EXC_BAD_RECORD, 0, 0, NULL);
+        return leaf_work(x);
+    } else {
+        return by_seh<D - 1>(x) + D;
+    }
+}
+#endif
+
+/* -- longjmp: the jump target of the calling thread */
+static thread_local jmp_buf * t_jump;
+
+template <int D> static NOINLINE uint32_t
+by_longjmp (uint32_t x) {
+    if constexpr (D == 0) {
+        if (leaf_fails(x))
+            longjmp(*t_jump, ERR_BAD_RECORD);
+        return leaf_work(x);
+    } else {
+        return by_longjmp<D - 1>(x) + D;
+    }
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region passes
+/* One pass over the inputs; sum of the values and # of errors, for the cross-check */
+struct PassTotals {
+    uint64_t sum;
+    uint64_t errors;
+};
+
+template <int D> static PassTotals
+pass_code (void) {
+    PassTotals t = {0, 0};
+    for (uint32_t x : g_inputs) {
+        uint32_t v;
+        if (by_code<D>(x, &v) != 0)
+            t.errors++;
+        else
+            t.sum += v;
+    }
+    return t;
+}
+template <int D> static PassTotals
+pass_last_error (void) {
+    PassTotals t = {0, 0};
+    for (uint32_t x : g_inputs) {
+        uint32_t v;
+        if (!by_last_error<D>(x, &v))
+            t.errors += (get_last_error() == ERR_BAD_RECORD);
+        else
+            t.sum += v;
+    }
+    return t;
+}
+template <int D> static PassTotals
+pass_result (void) {
+    PassTotals t = {0, 0};
+    for (uint32_t x : g_inputs) {
+        Result<uint32_t> r = by_result<D>(x);
+        if (!r.has_value())
+            t.errors++;
+        else
+            t.sum += r.value;
+    }
+    return t;
+}
+template <int D> static PassTotals
+pass_exception (void) {
+    PassTotals t = {0, 0};
+    for (uint32_t x : g_inputs) {
+        try {
+            t.sum += by_exception<D>(x);
+        } catch (RecordError const & e) {
+            t.errors += (e.code == ERR_BAD_RECORD);
+        }
+    }
+    return t;
+}
+#ifdef _WIN32
+/* __try cannot share a function with objects that unwind, so one call per frame */
+template <int D> static uint32_t
+seh_call (uint32_t x, uint64_t * errors) {
+    __try {
+        return by_seh<D>(x);
+    } __except (GetExceptionCode() == EXC_BAD_RECORD ? EXCEPTION_EXECUTE_HANDLER : EXCEPTION_CONTINUE_SEARCH) {
+        ++*errors;
+        return 0;
+    }
+}
+template <int D> static PassTotals
+pass_seh (void) {
+    PassTotals t = {0, 0};
+    for (uint32_t x : g_inputs)
+        t.sum += seh_call<D>(x, &t.errors);
+    return t;
+}
+#endif
+template <int D> static PassTotals
+pass_longjmp (void) {
+    PassTotals t = {0, 0};
+    for (uint32_t x : g_inputs) {
+        jmp_buf env;
+        t_jump = &env;
+        // -- t is only written after the call returns, never between setjmp and longjmp
+        int err = setjmp(env);
+        if (err == 0)
+            t.sum += by_longjmp<D>(x);
+        else
+            t.errors += (err == ERR_BAD_RECORD);
+    }
+    return t;
+}
+#pragma endregion
+
+// =========================================================================================
+
+typedef PassTotals (*PassFn) (void);
+
+struct Strategy {
+    char const * name;
+    PassFn pass[2];     // DEPTHS
+};
+
+static int const g_depths [] = {1, 8};
+#define DEPTHS _countof(g_depths)
+
+static Strategy const g_strategies [] = {
+    {"code",       {pass_code<1>,       pass_code<8>}},
+    {"last_error", {pass_last_error<1>, pass_last_error<8>}},
+    {"result",     {pass_result<1>,     pass_result<8>}},
+    {"exception",  {pass_exception<1>,  pass_exception<8>}},
+#ifdef _WIN32
+    {"seh",        {pass_seh<1>,        pass_seh<8>}},
+#endif
+    {"longjmp",    {pass_longjmp<1>,    pass_longjmp<8>}},
+};
+
+/* Failure rates, in 1/65536 of the inputs */
+static struct {
+    char const * name;
+    uint32_t fail_below;
+} const g_rates [] = {
+    {"0%",    0},
+    {"0.1%",  66},
+    {"1%",    655},
+    {"10%",   6554},
+    {"100%",  65536},
+};
+
+/* ns per call, best of BENCH_REPS */
+static double
+time_pass (PassFn pass) {
+    double best = 1e30;
+    for (int rep = 0; rep < BENCH_REPS; ++rep) {
+        uint64_t n = 0;
+        double start = BenchUtil_Now();
+        double sec;
+        do {
+            volatile uint64_t sink = pass().sum;
+            (void)sink;
+            n += N_INPUTS;
+        } while ((sec = (BenchUtil_Now() - start)) < BENCH_MIN_SEC);
+        if (sec * 1e9 / (double)n < best)
+            best = sec * 1e9 / (double)n;
+    }
+    return best;
+}
+
+static bool
+check_strategies (void) {
+    bool ok = true;
+    for (auto const & rate : g_rates) {
+        g_fail_below = rate.fail_below;
+        for (size_t d = 0; d < DEPTHS; ++d) {
+            PassTotals ref = g_strategies[0].pass[d]();
+            for (auto const & s : g_strategies) {
+                PassTotals t = s.pass[d]();
+                if (t.sum != ref.sum || t.errors != ref.errors) {
+                    printf(
+                        "MISMATCH %s depth %d rate %s: sum %llu errors %llu, code gives %llu / %llu\n",
+                        s.name, g_depths[d], rate.name,
+                        (unsigned long long)t.sum, (unsigned long long)t.errors,
+                        (unsigned long long)ref.sum, (unsigned long long)ref.errors
+                    );
+                    ok = false;
+                }
+            }
+        }
+    }
+    return ok;
+}
+
+#pragma region batch
+/* A record of a scanned file: the value sits behind a pointer, which a corrupted file can spoil */
+struct ScanRecord {
+    uint64_t key;
+    uint64_t const * value;
+};
+
+#define SCAN_RECORDS    (1 << 23)       // 8M records, 128 MB on 64-bit
+#define SCAN_VALUES     (1 << 16)
+#define SCAN_BAD_EVERY  (1 << 20)       // one planted bad pointer per 1M records
+
+struct ScanJob {
+    ScanRecord const * records;
+    uint64_t * chunk_sums;
+};
+
+static int
+scan_chunk (void * ctx, size_t i_chunk, size_t first, size_t count) {
+    ScanJob * job = (ScanJob *)ctx;
+    ScanRecord const * r = job->records + first;
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; ++i)
+        sum += r[i].key ^ *r[i].value;
+    job->chunk_sums[i_chunk] = sum;
+    return 0;
+}
+/* The same chunks, called straight: the baseline */
+static void
+scan_unguarded (ScanJob * job, size_t n, size_t chunk) {
+    for (size_t i = 0, first = 0; first < n; ++i, first += chunk)
+        scan_chunk(job, i, first, (n - first < chunk) ? n - first : chunk);
+}
+
+struct ScanData {
+    std::vector<ScanRecord> clean;
+    std::vector<ScanRecord> corrupt;
+    std::vector<uint64_t> values;
+};
+
+static void
+make_scan_data (ScanData * d) {
+    uint64_t rng = 0xD1B54A32D192ED03ULL;
+    d->values.resize(SCAN_VALUES);
+    for (uint64_t & v : d->values)
+        v = next_rand(&rng);
+    d->clean.resize(SCAN_RECORDS);
+    for (ScanRecord & r : d->clean) {
+        uint64_t x = next_rand(&rng);
+        r.key = x;
+        r.value = &d->values[(x >> 40) % SCAN_VALUES];
+    }
+    /* -- bad pointers: near NULL, and into the kernel half */
+    d->corrupt = d->clean;
+    for (size_t i = SCAN_BAD_EVERY / 2; i < SCAN_RECORDS; i += SCAN_BAD_EVERY)
+        d->corrupt[i].value = (i / SCAN_BAD_EVERY % 2) ? (uint64_t const *)(uintptr_t)0x10 : (uint64_t const *)~(uintptr_t)0xFFF;
+}
+/* What a guarded scan of d->corrupt must give: which chunks fault, and the sums of the others */
+static bool
+check_batch (ScanData const * d, size_t chunk) {
+    size_t n_chunks = FaultBatch_ChunkCount(SCAN_RECORDS, chunk);
+    std::vector<uint64_t> sums(n_chunks), ref_sums(n_chunks);
+    std::vector<uint8_t> status(n_chunks);
+    ScanJob job = {d->corrupt.data(), sums.data()};
+    ScanJob ref = {d->clean.data(), ref_sums.data()};
+    FaultBatchResult result;
+    bool ok = true;
+
+    scan_unguarded(&ref, SCAN_RECORDS, chunk);
+    FaultBatch_Run(SCAN_RECORDS, chunk, scan_chunk, &job, status.data(), &result);
+
+    size_t n_bad = 0;
+    for (size_t c = 0; c < n_chunks; ++c) {
+        bool bad = false;
+        for (size_t i = c * chunk; i < (c + 1) * chunk && i < SCAN_RECORDS; ++i)
+            bad |= (d->corrupt[i].value != d->clean[i].value);
+        n_bad += bad;
+        if (bad ? status[c] != FAULT_CHUNK_FAULTED : (status[c] != FAULT_CHUNK_OK || sums[c] != ref_sums[c]))
+            ok = false;
+    }
+    if (!ok || result.n_faulted != n_bad || result.n_ok != n_chunks - n_bad) {
+        printf("MISMATCH batch of %zu: %zu chunks faulted, %zu expected\n", chunk, result.n_faulted, n_bad);
+        return false;
+    }
+    return true;
+}
+
+static size_t const g_chunks [] = {256, 4096, 65536, 1 << 20};
+
+static void
+bench_batch (ScanData const * d) {
+    std::vector<uint64_t> sums(SCAN_RECORDS / g_chunks[0] + 1);
+    ScanJob clean = {d->clean.data(), sums.data()};
+    ScanJob corrupt = {d->corrupt.data(), sums.data()};
+    FaultBatchResult result;
+
+    printf(
+        "\nScan of %d records, ns per record (best of %d); corrupt: one bad pointer per %d records\n",
+        SCAN_RECORDS, BENCH_REPS, SCAN_BAD_EVERY
+    );
+    printf("%-10s %12s %12s %10s %12s %10s\n", "chunk", "unguarded", "guarded", "overhead", "corrupt", "faulted");
+    for (size_t chunk : g_chunks) {
+        double best[3] = {1e30, 1e30, 1e30};
+        for (int rep = 0; rep < BENCH_REPS; ++rep) {
+            for (int k = 0; k < 3; ++k) {
+                double start = BenchUtil_Now();
+                if (k == 0)
+                    scan_unguarded(&clean, SCAN_RECORDS, chunk);
+                else
+                    FaultBatch_Run(SCAN_RECORDS, chunk, scan_chunk, k == 1 ? &clean : &corrupt, NULL, &result);
+                double sec = (BenchUtil_Now() - start);
+                if (sec < best[k])
+                    best[k] = sec;
+            }
+        }
+        printf(
+            "%-10zu %12.3f %12.3f %9.1f%% %12.3f %10zu\n", chunk,
+            best[0] * 1e9 / SCAN_RECORDS, best[1] * 1e9 / SCAN_RECORDS,
+            (best[1] / best[0] - 1.0) * 100.0,
+            best[2] * 1e9 / SCAN_RECORDS, result.n_faulted
+        );
+    }
+}
+#pragma endregion
+
+// =========================================================================================
+
+static void
+bench_propagate (void) {
+    for (size_t d = 0; d < DEPTHS; ++d) {
+        printf("\nns per call, %d frame(s) above the leaf, by failure rate (best of %d)\n", g_depths[d], BENCH_REPS);
+        printf("%-12s", "strategy");
+        for (auto const & rate : g_rates)
+            printf(" %10s", rate.name);
+        printf("\n");
+        for (auto const & s : g_strategies) {
+            printf("%-12s", s.name);
+            for (auto const & rate : g_rates) {
+                g_fail_below = rate.fail_below;
+                printf(" %10.2f", time_pass(s.pass[d]));
+                fflush(stdout);
+            }
+            printf("\n");
+        }
+    }
+}
+
+int main (int argc, char * argv []) {
+    uint64_t rng = 0x9E3779B97F4A7C15ULL;
+    for (uint32_t & x : g_inputs)
+        x = (uint32_t)(next_rand(&rng) >> 32);
+    ScanData scan;
+    make_scan_data(&scan);
+
+    bool ok = check_strategies();
+    for (size_t chunk : g_chunks)
+        ok = check_batch(&scan, chunk) && ok;
+    if (!ok)
+        return(1);
+    /* -- "check" alone only verifies */
+    if (argc == 2 && 0 == strcmp(argv[1], "check")) {
+        printf("all strategies agree, faulted chunks are exactly the corrupt ones\n");
+        return(0);
+    }
+
+    if (BenchUtil_Wanted(argc, argv, "propagate"))
+        bench_propagate();
+    if (BenchUtil_Wanted(argc, argv, "batch"))
+        bench_batch(&scan);
+    return(0);
+}
@@ -0,0 +1,270 @@
+/* ===========================================================
+   #File: casefold.c #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Case-insensitive compare, equality and hash without a locale #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#include "casefold.h"
+#include "casefold_table.h"
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FOLD_SSE2 1
+#include <emmintrin.h>
+#else
+#define FOLD_SSE2 0
+#endif
+
+#define HASH_MUL 0x9E3779B97F4A7C15ULL
+
+// =========================================================================================
+
+static size_t
+wcslen16 (utf16_t const * s) {
+    utf16_t const * p = s;
+    while (*p)
+        ++p;
+    return (size_t)(p - s);
+}
+static unsigned
+fold_a (unsigned char c) {
+    return ((unsigned)(c - 'A') < 26u) ? c + 0x20u : c;
+}
+static unsigned
+fold_w (utf16_t c) {
+    return (utf16_t)(c + g_fold_delta[g_fold_page[c >> 8]][c & 0xFF]);
+}
+
+/* The scalar path: whole strings without SSE2, otherwise the chunks SIMD could not settle */
+static int
+compare_units_a (unsigned char const * a, unsigned char const * b, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        unsigned fa = fold_a(a[i]), fb = fold_a(b[i]);
+        if (fa != fb)
+            return (fa < fb) ? -1 : 1;
+    }
+    return 0;
+}
+static int
+compare_units_w (utf16_t const * a, utf16_t const * b, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        unsigned fa = fold_w(a[i]), fb = fold_w(b[i]);
+        if (fa != fb)
+            return (fa < fb) ? -1 : 1;
+    }
+    return 0;
+}
+
+#if FOLD_SSE2
+/*
+A-Z -> a-z in every lane, the rest untouched. The compares are signed, so
+bytes >= 0x80 (units >= 0x8000) are negative and never in range.
+*/
+static __m128i
+fold_ascii8 (__m128i v) {
+    __m128i upper = _mm_and_si128(
+        _mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)),
+        _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1))
+    );
+    return _mm_add_epi8(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+static __m128i
+fold_ascii16 (__m128i v) {
+    __m128i upper = _mm_and_si128(
+        _mm_cmpgt_epi16(v, _mm_set1_epi16('A' - 1)),
+        _mm_cmplt_epi16(v, _mm_set1_epi16('Z' + 1))
+    );
+    return _mm_add_epi16(v, _mm_and_si128(upper, _mm_set1_epi16(0x20)));
+}
+static int
+all_equal (__m128i a, __m128i b) {
+    return 0xFFFF == _mm_movemask_epi8(_mm_cmpeq_epi8(a, b));
+}
+#endif
+
+#if FOLD_SSE2
+static int
+chunk_a (unsigned char const * a, unsigned char const * b) {
+    __m128i va = _mm_loadu_si128((__m128i const *)a);
+    __m128i vb = _mm_loadu_si128((__m128i const *)b);
+    if (all_equal(va, vb) || all_equal(fold_ascii8(va), fold_ascii8(vb)))
+        return 0;
+    return compare_units_a(a, b, 16);
+}
+static int
+chunk_w (utf16_t const * a, utf16_t const * b) {
+    __m128i va = _mm_loadu_si128((__m128i const *)a);
+    __m128i vb = _mm_loadu_si128((__m128i const *)b);
+    if (all_equal(va, vb) || all_equal(fold_ascii16(va), fold_ascii16(vb)))
+        return 0;
+    // -- a real difference, or letters past ASCII: the table decides
+    return compare_units_w(a, b, 8);
+}
+#endif
+
+/*
+With SSE2, a tail shorter than a chunk is handled by one more chunk that
+ends at n: its first units were already found equal, so a difference can
+only be in the new ones and the order comes out right.
+*/
+static int
+compare_a (unsigned char const * a, unsigned char const * b, size_t n) {
+#if FOLD_SSE2
+    if (n >= 16) {
+        int c = 0;
+        size_t i = 0;
+        for (; 0 == c && i + 16 <= n; i += 16)
+            c = chunk_a(a + i, b + i);
+        if (0 == c && i < n)
+            c = chunk_a(a + n - 16, b + n - 16);
+        return c;
+    }
+#endif
+    return compare_units_a(a, b, n);
+}
+static int
+compare_w (utf16_t const * a, utf16_t const * b, size_t n) {
+#if FOLD_SSE2
+    if (n >= 8) {
+        int c = 0;
+        size_t i = 0;
+        for (; 0 == c && i + 8 <= n; i += 8)
+            c = chunk_w(a + i, b + i);
+        if (0 == c && i < n)
+            c = chunk_w(a + n - 8, b + n - 8);
+        return c;
+    }
+#endif
+    return compare_units_w(a, b, n);
+}
+
+/*
+The hash runs over the folded text, 16 bytes at a time, so the SIMD and the
+scalar paths produce the same value. The last partial chunk is zero padded,
+the length goes into the finalizer.
+*/
+static uint64_t
+mix (uint64_t h, unsigned char const * chunk) {
+    uint64_t w0, w1;
+    memcpy(&w0, chunk, 8);
+    memcpy(&w1, chunk + 8, 8);
+    h = (h ^ w0) * HASH_MUL;
+    h ^= h >> 32;
+    h = (h ^ w1) * HASH_MUL;
+    h ^= h >> 29;
+    return h;
+}
+static uint64_t
+finish (uint64_t h, size_t len) {
+    // -- murmur3 fmix64
+    h ^= (uint64_t)len;
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// =========================================================================================
+
+int
+CaseFold_CompareA (char const * a, size_t cb_a, char const * b, size_t cb_b) {
+    if (UTF_NUL_TERMINATED == cb_a)
+        cb_a = strlen(a);
+    if (UTF_NUL_TERMINATED == cb_b)
+        cb_b = strlen(b);
+    int c = compare_a((unsigned char const *)a, (unsigned char const *)b, (cb_a < cb_b) ? cb_a : cb_b);
+    if (c)
+        return c;
+    return (cb_a < cb_b) ? -1 : (cb_a > cb_b) ? 1 : 0;
+}
+int
+CaseFold_EqualA (char const * a, size_t cb_a, char const * b, size_t cb_b) {
+    if (UTF_NUL_TERMINATED == cb_a)
+        cb_a = strlen(a);
+    if (UTF_NUL_TERMINATED == cb_b)
+        cb_b = strlen(b);
+    return cb_a == cb_b && 0 == compare_a((unsigned char const *)a, (unsigned char const *)b, cb_a);
+}
+uint64_t
+CaseFold_HashA (char const * s, size_t cb) {
+    unsigned char const * p = (unsigned char const *)s;
+    unsigned char chunk[16];
+    uint64_t h = 0;
+    size_t i = 0;
+    if (UTF_NUL_TERMINATED == cb)
+        cb = strlen(s);
+
+#if FOLD_SSE2
+    for (; i + 16 <= cb; i += 16) {
+        _mm_storeu_si128((__m128i *)chunk, fold_ascii8(_mm_loadu_si128((__m128i const *)(p + i))));
+        h = mix(h, chunk);
+    }
+#endif
+    while (i < cb) {
+        size_t k = 0;
+        for (; k < 16 && i < cb; ++k, ++i)
+            chunk[k] = (unsigned char)fold_a(p[i]);
+        memset(chunk + k, 0, 16 - k);
+        h = mix(h, chunk);
+    }
+    return finish(h, cb);
+}
+int
+CaseFold_CompareW (utf16_t const * a, size_t cch_a, utf16_t const * b, size_t cch_b) {
+    if (UTF_NUL_TERMINATED == cch_a)
+        cch_a = wcslen16(a);
+    if (UTF_NUL_TERMINATED == cch_b)
+        cch_b = wcslen16(b);
+    int c = compare_w(a, b, (cch_a < cch_b) ? cch_a : cch_b);
+    if (c)
+        return c;
+    return (cch_a < cch_b) ? -1 : (cch_a > cch_b) ? 1 : 0;
+}
+int
+CaseFold_EqualW (utf16_t const * a, size_t cch_a, utf16_t const * b, size_t cch_b) {
+    if (UTF_NUL_TERMINATED == cch_a)
+        cch_a = wcslen16(a);
+    if (UTF_NUL_TERMINATED == cch_b)
+        cch_b = wcslen16(b);
+    return cch_a == cch_b && 0 == compare_w(a, b, cch_a);
+}
+uint64_t
+CaseFold_HashW (utf16_t const * s, size_t cch) {
+    utf16_t chunk[8];
+    uint64_t h = 0;
+    size_t i = 0;
+    if (UTF_NUL_TERMINATED == cch)
+        cch = wcslen16(s);
+
+#if FOLD_SSE2
+    for (; i + 8 <= cch; i += 8) {
+        __m128i v = _mm_loadu_si128((__m128i const *)(s + i));
+        __m128i high = _mm_and_si128(v, _mm_set1_epi16((short)0xFF80));
+        if (all_equal(high, _mm_setzero_si128())) {
+            _mm_storeu_si128((__m128i *)chunk, fold_ascii16(v));
+        } else {
+            for (size_t k = 0; k < 8; ++k)
+                chunk[k] = (utf16_t)fold_w(s[i + k]);
+        }
+        h = mix(h, (unsigned char const *)chunk);
+    }
+#endif
+    while (i < cch) {
+        size_t k = 0;
+        for (; k < 8 && i < cch; ++k, ++i)
+            chunk[k] = (utf16_t)fold_w(s[i]);
+        memset(chunk + k, 0, (8 - k) * sizeof(utf16_t));
+        h = mix(h, (unsigned char const *)chunk);
+    }
+    return finish(h, cch);
+}
+utf16_t
+CaseFold_Unit (utf16_t c) {
+    return (utf16_t)fold_w(c);
+}
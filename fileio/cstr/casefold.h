@@ -0,0 +1,55 @@
+#pragma once
+
+/* ===========================================================
+   #File: casefold.h #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Case-insensitive compare, equality and hash without a locale #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "utf.h"
+
+/*
+CompareStringEx(LOCALE_NAME_INVARIANT, LINGUISTIC_IGNORECASE, ...) sorts
+linguistically, which is far more than a key lookup needs. These routines
+compare code units after simple case folding, like CompareStringOrdinal with
+bIgnoreCase, except that folding goes to lower case:
+ - ...W folds every BMP unit through the Unicode simple case folding table
+   (casefold_table.h); surrogates, hence supplementary characters, compare as is.
+   U+0130 (I with dot above) has no simple folding and stays itself, so it
+   does not match 'i' or 'I'.
+ - ...A folds A-Z only; bytes >= 0x80 compare as is, which suits UTF-8 keys.
+ - Compare returns <0, 0 or >0 like strcmp; a string sorts before the
+   strings it is a prefix of.
+ - Strings that are Equal always have the same Hash.
+ - Lengths may be UTF_NUL_TERMINATED.
+With SSE2, 16 bytes are compared at a time: chunks equal as is or after
+folding A-Z are skipped, only the others are settled with the table.
+*/
+
+int
+CaseFold_CompareA (char const * a, size_t cb_a, char const * b, size_t cb_b);
+
+int
+CaseFold_EqualA (char const * a, size_t cb_a, char const * b, size_t cb_b);
+
+uint64_t
+CaseFold_HashA (char const * s, size_t cb);
+
+int
+CaseFold_CompareW (utf16_t const * a, size_t cch_a, utf16_t const * b, size_t cch_b);
+
+int
+CaseFold_EqualW (utf16_t const * a, size_t cch_a, utf16_t const * b, size_t cch_b);
+
+uint64_t
+CaseFold_HashW (utf16_t const * s, size_t cch);
+
+/* Simple case folding of one UTF-16 unit */
+utf16_t
+CaseFold_Unit (utf16_t c);
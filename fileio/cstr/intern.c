@@ -0,0 +1,225 @@
+/* ===========================================================
+   #File: intern.c #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Thread-safe string interning: equal strings share one atom #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#include "intern.h"
+#include "strbuf.h"     // StrArena
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+#define DEFAULT_SHARD_BITS  6
+#define MAX_SHARD_BITS      12
+#define INITIAL_SLOTS       64      // per shard, a power of 2
+#define HASH_MUL            0x9E3779B97F4A7C15ULL
+
+typedef struct Slot {
+    uint64_t    hash;
+    StrAtom *   atom;               // NULL: free
+} Slot;
+
+struct StrInternShard {
+#ifdef _WIN32
+    SRWLOCK             lock;
+#else
+    pthread_rwlock_t    lock;
+#endif
+    Slot *              slots;
+    size_t              mask;       // # of slots - 1
+    size_t              count;
+    StrArena            arena;      // atoms of this shard
+    char                pad[64];    // keep the locks of neighbor shards off one cache line
+};
+
+// =========================================================================================
+
+#pragma region lock
+#ifdef _WIN32
+static void lock_init (StrInternShard * s)      { InitializeSRWLock(&s->lock); }
+static void lock_deinit (StrInternShard * s)    { (void)s; }
+static void lock_shared (StrInternShard * s)    { AcquireSRWLockShared(&s->lock); }
+static void unlock_shared (StrInternShard * s)  { ReleaseSRWLockShared(&s->lock); }
+static void lock_excl (StrInternShard * s)      { AcquireSRWLockExclusive(&s->lock); }
+static void unlock_excl (StrInternShard * s)    { ReleaseSRWLockExclusive(&s->lock); }
+#else
+static void lock_init (StrInternShard * s)      { pthread_rwlock_init(&s->lock, NULL); }
+static void lock_deinit (StrInternShard * s)    { pthread_rwlock_destroy(&s->lock); }
+static void lock_shared (StrInternShard * s)    { pthread_rwlock_rdlock(&s->lock); }
+static void unlock_shared (StrInternShard * s)  { pthread_rwlock_unlock(&s->lock); }
+static void lock_excl (StrInternShard * s)      { pthread_rwlock_wrlock(&s->lock); }
+static void unlock_excl (StrInternShard * s)    { pthread_rwlock_unlock(&s->lock); }
+#endif
+#pragma endregion
+
+static StrInternShard *
+shard_of (StrIntern * t, uint64_t hash) {
+    // -- the top bits pick the shard, the low bits the slot
+    return &t->shards[(t->shard_bits > 0) ? (size_t)(hash >> (64 - t->shard_bits)) : 0];
+}
+static StrAtom *
+probe (StrInternShard const * s, uint64_t hash, TCHAR const * str, size_t cch) {
+    for (size_t i = (size_t)hash & s->mask;; i = (i + 1) & s->mask) {
+        Slot const * slot = &s->slots[i];
+        if (NULL == slot->atom)
+            return NULL;
+        if (slot->hash == hash && slot->atom->cch == cch &&
+            0 == memcmp(slot->atom->str, str, cch * sizeof(TCHAR)))
+            return slot->atom;
+    }
+}
+static void
+put (Slot * slots, size_t mask, uint64_t hash, StrAtom * atom) {
+    size_t i = (size_t)hash & mask;
+    while (slots[i].atom)
+        i = (i + 1) & mask;
+    slots[i].hash = hash;
+    slots[i].atom = atom;
+}
+/* Double the slots; the caller holds the lock exclusively */
+static int
+grow (StrInternShard * s) {
+    size_t n = (s->mask + 1) * 2;
+    Slot * slots = (Slot *)calloc(n, sizeof(Slot));
+    if (NULL == slots)
+        return 0;
+    for (size_t i = 0; i <= s->mask; ++i)
+        if (s->slots[i].atom)
+            put(slots, n - 1, s->slots[i].hash, s->slots[i].atom);
+    free(s->slots);
+    s->slots = slots;
+    s->mask = n - 1;
+    return 1;
+}
+
+// =========================================================================================
+
+uint64_t
+StrIntern_Hash (TCHAR const * s, size_t cch) {
+    unsigned char const * p = (unsigned char const *)s;
+    size_t n = cch * sizeof(TCHAR);
+    uint64_t h = (uint64_t)n * HASH_MUL;
+    uint64_t w;
+
+    for (; n >= 8; n -= 8, p += 8) {
+        memcpy(&w, p, 8);
+        h = (h ^ w) * HASH_MUL;
+        h ^= h >> 32;
+    }
+    if (n) {
+        w = 0;
+        memcpy(&w, p, n);
+        h = (h ^ w) * HASH_MUL;
+    }
+
+    // -- murmur3 fmix64: every input bit reaches the top (shard) bits
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return h;
+}
+HRESULT
+StrIntern_Init (StrIntern * t, unsigned shard_bits) {
+    if (0 == shard_bits)
+        shard_bits = DEFAULT_SHARD_BITS;
+    if (shard_bits > MAX_SHARD_BITS)
+        return STRSAFE_E_INVALID_PARAMETER;
+
+    size_t n = (size_t)1 << shard_bits;
+    t->shard_bits = shard_bits;
+    t->shards = (StrInternShard *)calloc(n, sizeof(StrInternShard));
+    if (NULL == t->shards)
+        return E_OUTOFMEMORY;
+
+    for (size_t i = 0; i < n; ++i) {
+        StrInternShard * s = &t->shards[i];
+        s->slots = (Slot *)calloc(INITIAL_SLOTS, sizeof(Slot));
+        if (NULL == s->slots) {
+            StrIntern_Deinit(t);            // stops at the first shard without slots
+            return E_OUTOFMEMORY;
+        }
+        s->mask = INITIAL_SLOTS - 1;
+        lock_init(s);
+        StrArena_Init(&s->arena, 0);
+    }
+    return S_OK;
+}
+void
+StrIntern_Deinit (StrIntern * t) {
+    size_t n = (size_t)1 << t->shard_bits;
+    if (NULL == t->shards)
+        return;
+    for (size_t i = 0; i < n && t->shards[i].slots; ++i) {
+        StrInternShard * s = &t->shards[i];
+        StrArena_Deinit(&s->arena);
+        lock_deinit(s);
+        free(s->slots);
+    }
+    free(t->shards);
+    t->shards = NULL;
+}
+StrAtom const *
+StrIntern_Add (StrIntern * t, TCHAR const * s, size_t cch) {
+    uint64_t hash = StrIntern_Hash(s, cch);
+    StrInternShard * shard = shard_of(t, hash);
+    StrAtom * atom;
+
+    // -- the common case: already there, shared lock only
+    lock_shared(shard);
+    atom = probe(shard, hash, s, cch);
+    unlock_shared(shard);
+    if (atom)
+        return atom;
+
+    lock_excl(shard);
+    // -- another thread may have added it in between
+    atom = probe(shard, hash, s, cch);
+    if (NULL == atom) {
+        // -- keep the load under 1/2 so probe runs stay short
+        if ((shard->count + 1) * 2 > shard->mask + 1 && !grow(shard)) {
+            unlock_excl(shard);
+            return NULL;
+        }
+        atom = (StrAtom *)StrArena_Alloc(&shard->arena, offsetof(StrAtom, str) + (cch + 1) * sizeof(TCHAR));
+        if (atom) {
+            atom->hash = hash;
+            atom->cch = cch;
+            memcpy(atom->str, s, cch * sizeof(TCHAR));
+            atom->str[cch] = 0;
+            put(shard->slots, shard->mask, hash, atom);
+            ++shard->count;
+        }
+    }
+    unlock_excl(shard);
+    return atom;
+}
+StrAtom const *
+StrIntern_Find (StrIntern * t, TCHAR const * s, size_t cch) {
+    uint64_t hash = StrIntern_Hash(s, cch);
+    StrInternShard * shard = shard_of(t, hash);
+    lock_shared(shard);
+    StrAtom const * atom = probe(shard, hash, s, cch);
+    unlock_shared(shard);
+    return atom;
+}
+size_t
+StrIntern_Count (StrIntern * t) {
+    size_t n = (size_t)1 << t->shard_bits;
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i) {
+        lock_shared(&t->shards[i]);
+        count += t->shards[i].count;
+        unlock_shared(&t->shards[i]);
+    }
+    return count;
+}
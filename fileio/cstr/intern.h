@@ -0,0 +1,65 @@
+#pragma once
+
+/* ===========================================================
+   #File: intern.h #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Thread-safe string interning: equal strings share one atom #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "strsafe_compat.h"
+
+/*
+Interning a string returns its atom: the one copy of that text the table
+keeps. Two atoms of the same table are equal exactly when the pointers are,
+so once interned, strings compare in O(1) and the hash is never recomputed.
+
+ - Atoms live as long as the table; they never move and are never freed
+   one by one.
+ - The table is split into shards, each an open-addressing hash table with
+   its own reader/writer lock (SRWLOCK, or pthread_rwlock_t) and its own
+   StrArena for the text. Lookups of present strings only take the lock
+   shared, so threads interning the same vocabulary do not serialize.
+ - Comparison is case-sensitive and ordinal, embedded NULs included.
+*/
+
+typedef struct StrAtom {
+    uint64_t        hash;
+    size_t          cch;            // without the NUL
+    TCHAR           str[1];         // NUL-terminated, cch + 1 characters
+} StrAtom;
+
+typedef struct StrInternShard StrInternShard;
+typedef struct StrIntern {
+    StrInternShard *    shards;
+    unsigned            shard_bits; // 1 << shard_bits shards
+} StrIntern;
+
+/* shard_bits 0 picks the default (64 shards) */
+HRESULT
+StrIntern_Init (StrIntern * t, unsigned shard_bits);
+
+/* Frees every atom; no thread may still be using the table */
+void
+StrIntern_Deinit (StrIntern * t);
+
+/* The atom of s, added on first use; NULL when out of memory */
+StrAtom const *
+StrIntern_Add (StrIntern * t, TCHAR const * s, size_t cch);
+
+/* The atom of s if it was interned, NULL otherwise; never allocates */
+StrAtom const *
+StrIntern_Find (StrIntern * t, TCHAR const * s, size_t cch);
+
+/* # of distinct strings */
+size_t
+StrIntern_Count (StrIntern * t);
+
+/* The hash the table uses, for callers keeping their own side tables */
+uint64_t
+StrIntern_Hash (TCHAR const * s, size_t cch);
@@ -30,6 +30,11 @@
 
 #include <strsafe.h> // StringCchCat, StringCbCat, StringCchCopy, StringCbCopy
 
+#include "casefold.h" // CaseFold_CompareW
+#include "intern.h"   // StrIntern, StrAtom
+#include "strbuf.h" // StrBuf, StrRef
+#include "utf.h"    // Utf16_ToUtf8Cb, Utf8_ToUtf16Cch
+
 int main (void) {
 #pragma region ANSI vs UTF-16
     // =======================================================================================================
@@ -134,6 +139,29 @@ int main (void) {
     _tprintf(_T("str_cpy_cat = %s\n"), str_cpy_cat);
 #pragma endregion Secure vs Unsecure string manipulation
     printf("=============================\n");
+#pragma region Counted strings
+    printf("Counted strings\n");
+    printf("=============================\n");
+    //
+    // StringCchCat has to find the end of str_cpy_cat on every call,
+    // a StrBuf carries its length and only ever touches the new text
+    //
+    StrBuf sb;
+    StrBuf_Init(&sb, NULL);
+    StrBuf_AppendSz(&sb, str_dst);
+    StrBuf_AppendRef(&sb, STRREF(" additional text"));
+    _tprintf(_T("sb = %s (%llu characters)\n"), sb.str, sb.cch);
+
+    // NOTE: over a fixed buffer it truncates just like StringCchCat
+    TCHAR str_fixed[8];
+    StrBuf sb_fixed;
+    StrBuf_InitFixed(&sb_fixed, str_fixed, _countof(str_fixed));
+    HRESULT hr_fixed = StrBuf_AppendRef(&sb_fixed, StrBuf_Ref(&sb));
+    _tprintf(_T("sb_fixed = %s (%s)\n"), sb_fixed.str,
+        (STRSAFE_E_INSUFFICIENT_BUFFER == hr_fixed) ? _T("truncated") : _T("complete"));
+    StrBuf_Free(&sb);
+#pragma endregion Counted strings
+    printf("=============================\n");
 #pragma region String Compare
     printf("String Compare\n");
     printf("=============================\n");
@@ -158,6 +186,25 @@ int main (void) {
     else if (0 > res)
         printf("1st string less (CompareStringEx)\n");
 //
+// ordinal ignore-case, no locale: enough for keys, and much cheaper
+//
+    res = CaseFold_CompareW(str_cpy_cat, UTF_NUL_TERMINATED, str_dst, UTF_NUL_TERMINATED);
+    if (0 == res)
+        printf("strings equal (CaseFold_CompareW)\n");
+    else if (0 < res)
+        printf("1st string greater (CaseFold_CompareW)\n");
+    else if (0 > res)
+        printf("1st string less (CaseFold_CompareW)\n");
+//
+// interned: hashed and copied once, after that equality is a pointer compare
+//
+    StrIntern atoms;
+    StrIntern_Init(&atoms, 0);
+    StrAtom const * atom_1 = StrIntern_Add(&atoms, str_cpy_cat, _tcslen(str_cpy_cat));
+    StrAtom const * atom_2 = StrIntern_Add(&atoms, str_dst, _tcslen(str_dst));
+    printf("strings %s (StrIntern)\n", (atom_1 == atom_2) ? "equal" : "not equal");
+    StrIntern_Deinit(&atoms);
+//
 // C approach
 //
     res = _tcscmp(str_cpy_cat, str_dst);
@@ -173,6 +220,25 @@ int main (void) {
         printf("1st string less (_tcscmp)\n");
 #pragma endregion String Compare
     printf("=============================\n");
+#pragma region UTF-8 vs UTF-16
+    printf("UTF-8 vs UTF-16\n");
+    printf("=============================\n");
+    //
+    // Length query first, then convert into a bounded buffer (like StringCch*)
+    //
+    size_t cb_utf8 = 0;
+    char str_utf8[100];
+    Utf16_CbToUtf8(&cb_utf8, str_cpy_cat, UTF_NUL_TERMINATED);
+    Utf16_ToUtf8Cb(str_utf8, sizeof(str_utf8), str_cpy_cat, UTF_NUL_TERMINATED, NULL);
+    printf("UTF-8 copy = %s (%llu bytes)\n", str_utf8, cb_utf8);
+
+    // NOTE: a buffer too small is still NUL-terminated, on a whole character
+    WCHAR str_small[6];
+    HRESULT hr = Utf8_ToUtf16Cch(str_small, _countof(str_small), str_utf8, UTF_NUL_TERMINATED, NULL);
+    wprintf(L"truncated UTF-16 copy = %s (%s)\n", str_small,
+        (STRSAFE_E_INSUFFICIENT_BUFFER == hr) ? L"insufficient buffer" : L"complete");
+#pragma endregion UTF-8 vs UTF-16
+    printf("=============================\n");
     return(0);
 }
 
@@ -0,0 +1,247 @@
+/* ===========================================================
+   #File: strbuf.c #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Counted strings and a string builder that never rescans #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#include "strbuf.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+
+#define ARENA_ALIGN 16
+
+struct StrArenaBlock {
+    StrArenaBlock * next;       // older block
+    size_t          size;       // usable bytes after the header
+    size_t          used;
+    size_t          last;       // offset of the most recent allocation
+};
+
+// =========================================================================================
+
+#pragma region arena
+static size_t
+align_up (size_t n) {
+    return (n + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+static char *
+block_data (StrArenaBlock * b) {
+    return (char *)b + align_up(sizeof(StrArenaBlock));
+}
+static void *
+arena_alloc (StrArena * a, size_t bytes) {
+    StrArenaBlock * b = a->head;
+    bytes = align_up(bytes);
+    if (NULL == b || b->size - b->used < bytes) {
+        size_t size = (bytes > a->block_bytes) ? bytes : a->block_bytes;
+        b = (StrArenaBlock *)malloc(align_up(sizeof(StrArenaBlock)) + size);
+        if (NULL == b)
+            return NULL;
+        b->next = a->head;
+        b->size = size;
+        b->used = 0;
+        a->head = b;
+    }
+    b->last = b->used;
+    b->used += bytes;
+    return block_data(b) + b->last;
+}
+/* Grow the most recent allocation without moving it, if the block has room */
+static int
+arena_extend (StrArena * a, void * p, size_t bytes) {
+    StrArenaBlock * b = a->head;
+    if (NULL == b || block_data(b) + b->last != (char *)p)
+        return 0;
+    bytes = align_up(bytes);
+    if (b->size - b->last < bytes)
+        return 0;
+    b->used = b->last + bytes;
+    return 1;
+}
+
+void
+StrArena_Init (StrArena * a, size_t block_bytes) {
+    a->head = NULL;
+    a->block_bytes = block_bytes ? block_bytes : 64 * 1024;
+}
+void
+StrArena_Deinit (StrArena * a) {
+    while (a->head) {
+        StrArenaBlock * next = a->head->next;
+        free(a->head);
+        a->head = next;
+    }
+}
+void *
+StrArena_Alloc (StrArena * a, size_t bytes) {
+    return arena_alloc(a, bytes);
+}
+#pragma endregion
+
+// =========================================================================================
+
+static int
+is_inline (StrBuf const * sb) {
+    return sb->str == sb->inline_buf;
+}
+/* Make room for need characters plus the NUL; growable buffers only */
+static HRESULT
+grow (StrBuf * sb, size_t need) {
+    size_t cap = sb->cap;
+    if (need >= STRSAFE_MAX_CCH)
+        return STRSAFE_E_INSUFFICIENT_BUFFER;
+
+    // -- geometric growth keeps n appends O(n) overall
+    while (cap < need + 1)
+        cap = (cap < STRSAFE_MAX_CCH / 2) ? cap * 2 : STRSAFE_MAX_CCH;
+
+    TCHAR * p;
+    if (sb->arena) {
+        if (!is_inline(sb) && arena_extend(sb->arena, sb->str, cap * sizeof(TCHAR))) {
+            sb->cap = cap;
+            return S_OK;
+        }
+        p = (TCHAR *)arena_alloc(sb->arena, cap * sizeof(TCHAR));
+        if (p)
+            memcpy(p, sb->str, (sb->cch + 1) * sizeof(TCHAR));
+    } else if (is_inline(sb)) {
+        p = (TCHAR *)malloc(cap * sizeof(TCHAR));
+        if (p)
+            memcpy(p, sb->str, (sb->cch + 1) * sizeof(TCHAR));
+    } else {
+        p = (TCHAR *)realloc(sb->str, cap * sizeof(TCHAR));
+    }
+    if (NULL == p)
+        return E_OUTOFMEMORY;
+    sb->str = p;
+    sb->cap = cap;
+    return S_OK;
+}
+
+// =========================================================================================
+
+void
+StrBuf_Init (StrBuf * sb, StrArena * arena) {
+    sb->str = sb->inline_buf;
+    sb->str[0] = 0;
+    sb->cch = 0;
+    sb->cap = STRBUF_INLINE_CCH;
+    sb->arena = arena;
+    sb->fixed = 0;
+}
+void
+StrBuf_InitFixed (StrBuf * sb, TCHAR * buf, size_t cch_buf) {
+    sb->str = buf;
+    sb->cch = 0;
+    sb->cap = cch_buf;
+    sb->arena = NULL;
+    sb->fixed = 1;
+    if (cch_buf)
+        buf[0] = 0;
+}
+void
+StrBuf_Free (StrBuf * sb) {
+    if (!sb->fixed && !sb->arena && !is_inline(sb))
+        free(sb->str);
+    StrBuf_Init(sb, sb->arena);
+}
+void
+StrBuf_Clear (StrBuf * sb) {
+    sb->cch = 0;
+    if (sb->cap)
+        sb->str[0] = 0;
+}
+HRESULT
+StrBuf_Reserve (StrBuf * sb, size_t cch) {
+    if (cch + 1 <= sb->cap)
+        return S_OK;
+    if (sb->fixed)
+        return STRSAFE_E_INSUFFICIENT_BUFFER;
+    return grow(sb, cch);
+}
+HRESULT
+StrBuf_Append (StrBuf * sb, TCHAR const * s, size_t cch) {
+    HRESULT hr = S_OK;
+    if (0 == sb->cap)
+        return STRSAFE_E_INVALID_PARAMETER;
+
+    // -- s may be part of sb itself (sb.str + k): growing would move it, keep its offset
+    uintptr_t at = (uintptr_t)s - (uintptr_t)sb->str;
+    int aliased = (uintptr_t)s >= (uintptr_t)sb->str && at < sb->cap * sizeof(TCHAR);
+
+    if (sb->cch + cch + 1 > sb->cap) {
+        if (sb->fixed || FAILED(hr = grow(sb, sb->cch + cch))) {
+            // -- StringCchCat behavior: copy what fits, keep the NUL
+            cch = sb->cap - 1 - sb->cch;
+            hr = STRSAFE_E_INSUFFICIENT_BUFFER;
+        } else if (aliased) {
+            s = (TCHAR const *)((char const *)sb->str + at);
+        }
+    }
+    // -- an aliased s overlaps the destination after a Clear (StrBuf_Copy)
+    memmove(sb->str + sb->cch, s, cch * sizeof(TCHAR));
+    sb->cch += cch;
+    sb->str[sb->cch] = 0;
+    return hr;
+}
+HRESULT
+StrBuf_AppendSz (StrBuf * sb, TCHAR const * s) {
+    return StrBuf_Append(sb, s, _tcslen(s));
+}
+HRESULT
+StrBuf_AppendRef (StrBuf * sb, StrRef s) {
+    return StrBuf_Append(sb, s.str, s.cch);
+}
+HRESULT
+StrBuf_AppendChar (StrBuf * sb, TCHAR c) {
+    // -- the common case without the memcpy
+    if (sb->cch + 2 <= sb->cap) {
+        sb->str[sb->cch++] = c;
+        sb->str[sb->cch] = 0;
+        return S_OK;
+    }
+    return StrBuf_Append(sb, &c, 1);
+}
+HRESULT
+StrBuf_Copy (StrBuf * sb, TCHAR const * s, size_t cch) {
+    StrBuf_Clear(sb);
+    return StrBuf_Append(sb, s, cch);
+}
+StrRef
+StrBuf_Ref (StrBuf const * sb) {
+    return StrRef_Make(sb->str, sb->cch);
+}
+StrRef
+StrRef_Make (TCHAR const * s, size_t cch) {
+    StrRef r;
+    r.str = s;
+    r.cch = cch;
+    return r;
+}
+StrRef
+StrRef_FromSz (TCHAR const * s) {
+    return StrRef_Make(s, _tcslen(s));
+}
+int
+StrRef_Compare (StrRef a, StrRef b) {
+    size_t n = (a.cch < b.cch) ? a.cch : b.cch;
+#ifdef _UNICODE
+    // -- wmemcmp compares code units, memcmp would compare little-endian bytes
+    int c = (n > 0) ? wmemcmp(a.str, b.str, n) : 0;
+#else
+    int c = (n > 0) ? memcmp(a.str, b.str, n) : 0;
+#endif
+    if (c != 0)
+        return c;
+    return (a.cch < b.cch) ? -1 : (a.cch > b.cch) ? 1 : 0;
+}
+int
+StrRef_Equal (StrRef a, StrRef b) {
+    return a.cch == b.cch && 0 == memcmp(a.str, b.str, a.cch * sizeof(TCHAR));
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+/* ===========================================================
+   #File: strbuf.h #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Counted strings and a string builder that never rescans #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#include <stddef.h>
+
+#include "strsafe_compat.h"
+
+/*
+StringCchCat has to find the end of its destination on every call, so
+building a string out of n pieces costs O(n^2). A StrBuf keeps the length
+and the capacity next to the pointer and appends in O(piece).
+
+ - The string is always NUL-terminated, so str can go to any Win32 call.
+ - The first STRBUF_INLINE_CCH characters live inside the StrBuf itself;
+   a StrBuf must therefore not be copied by value.
+ - Growth comes from the heap, or from a StrArena when one is given: arena
+   strings are never freed one by one, the whole arena goes at once, and
+   the most recent arena string grows in place.
+ - StrBuf_InitFixed wraps a caller buffer that never grows: appends that do
+   not fit are truncated and return STRSAFE_E_INSUFFICIENT_BUFFER, exactly
+   like StringCchCat/StringCchCopy. Growable buffers stop at STRSAFE_MAX_CCH.
+*/
+
+#define STRBUF_INLINE_CCH 64
+
+/* A counted, read-only view: pointer + length, not necessarily NUL-terminated */
+typedef struct StrRef {
+    TCHAR const *   str;
+    size_t          cch;
+} StrRef;
+
+/* StrRef of a string literal, without calling _tcslen */
+#define STRREF(lit) StrRef_Make(_T(lit), (sizeof(_T(lit)) / sizeof(TCHAR)) - 1)
+
+typedef struct StrArenaBlock StrArenaBlock;
+typedef struct StrArena {
+    StrArenaBlock * head;           // newest block, the others hang off it
+    size_t          block_bytes;    // default block size
+} StrArena;
+
+typedef struct StrBuf {
+    TCHAR *         str;            // NUL-terminated contents
+    size_t          cch;            // length, without the NUL
+    size_t          cap;            // room in str, including the NUL
+    StrArena *      arena;          // NULL: heap
+    int             fixed;          // caller buffer, never grows
+    TCHAR           inline_buf[STRBUF_INLINE_CCH];
+} StrBuf;
+
+void
+StrArena_Init (StrArena * a, size_t block_bytes);
+
+/* Frees every string ever grown from the arena */
+void
+StrArena_Deinit (StrArena * a);
+
+/* Raw bytes from the arena, 16-byte aligned; NULL when out of memory */
+void *
+StrArena_Alloc (StrArena * a, size_t bytes);
+
+/* arena may be NULL */
+void
+StrBuf_Init (StrBuf * sb, StrArena * arena);
+
+void
+StrBuf_InitFixed (StrBuf * sb, TCHAR * buf, size_t cch_buf);
+
+void
+StrBuf_Free (StrBuf * sb);
+
+void
+StrBuf_Clear (StrBuf * sb);
+
+/* Make room for cch characters (plus the NUL) */
+HRESULT
+StrBuf_Reserve (StrBuf * sb, size_t cch);
+
+/* s may point into sb's own buffer, e.g. to append a part of it */
+HRESULT
+StrBuf_Append (StrBuf * sb, TCHAR const * s, size_t cch);
+
+/* Scans s once for its length, never the destination */
+HRESULT
+StrBuf_AppendSz (StrBuf * sb, TCHAR const * s);
+
+HRESULT
+StrBuf_AppendRef (StrBuf * sb, StrRef s);
+
+HRESULT
+StrBuf_AppendChar (StrBuf * sb, TCHAR c);
+
+/* Replace the contents */
+HRESULT
+StrBuf_Copy (StrBuf * sb, TCHAR const * s, size_t cch);
+
+StrRef
+StrBuf_Ref (StrBuf const * sb);
+
+StrRef
+StrRef_Make (TCHAR const * s, size_t cch);
+
+StrRef
+StrRef_FromSz (TCHAR const * s);
+
+/* <0, 0, >0 like _tcscmp, but from the lengths: embedded NULs compare too */
+int
+StrRef_Compare (StrRef a, StrRef b);
+
+int
+StrRef_Equal (StrRef a, StrRef b);
@@ -0,0 +1,21 @@
+#pragma once
+
+/*
+The string helpers report errors with the strsafe.h HRESULTs.
+Outside Windows provide those names (TCHAR and the like come from
+win32_compat.h) so they still build.
+*/
+#include "../../misc/compat/win32_compat.h"
+
+#ifdef _WIN32
+#include <strsafe.h>
+#else
+typedef long HRESULT;
+#define S_OK                            ((HRESULT)0L)
+#define E_OUTOFMEMORY                   ((HRESULT)0x8007000EL)
+#define SUCCEEDED(hr)                   (((HRESULT)(hr)) >= 0)
+#define FAILED(hr)                      (((HRESULT)(hr)) < 0)
+#define STRSAFE_MAX_CCH                 2147483647
+#define STRSAFE_E_INSUFFICIENT_BUFFER   ((HRESULT)0x8007007AL)
+#define STRSAFE_E_INVALID_PARAMETER     ((HRESULT)0x80070057L)
+#endif
@@ -0,0 +1,269 @@
+/* ===========================================================
+   #File: utf.c #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: UTF-8 <-> UTF-16 transcoding with StringCch-like bounded buffers #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#include "utf.h"
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define UTF_SSE2 1
+#include <emmintrin.h>
+#else
+#define UTF_SSE2 0
+#endif
+
+// =========================================================================================
+
+static size_t
+wcslen16 (utf16_t const * s) {
+    utf16_t const * p = s;
+    while (*p)
+        ++p;
+    return (size_t)(p - s);
+}
+static int
+is_cont (uint8_t b) {
+    return (b & 0xC0) == 0x80;
+}
+
+/*
+Shared by the length query (write == 0) and the conversion (write == 1).
+Both are static inline with a constant write flag, so each gets its own
+copy without the dead branches.
+cap is the room in dst without the NUL; *pn receives the # of units produced.
+*/
+static inline HRESULT
+utf8_to_16 (utf16_t * dst, size_t cap, uint8_t const * s, size_t len, size_t * pn, int write) {
+    uint8_t const * end = s + len;
+    size_t n = 0;
+    HRESULT hr = S_OK;
+
+    while (s < end) {
+#if UTF_SSE2
+        // -- ASCII fast path: 16 bytes in, 16 units out
+        while ((size_t)(end - s) >= 16 && (!write || cap - n >= 16)) {
+            __m128i v = _mm_loadu_si128((__m128i const *)s);
+            if (_mm_movemask_epi8(v))
+                break;
+            if (write) {
+                __m128i zero = _mm_setzero_si128();
+                _mm_storeu_si128((__m128i *)(dst + n), _mm_unpacklo_epi8(v, zero));
+                _mm_storeu_si128((__m128i *)(dst + n + 8), _mm_unpackhi_epi8(v, zero));
+            }
+            s += 16;
+            n += 16;
+        }
+        if (s == end)
+            break;
+#endif
+        uint32_t c = s[0];
+        size_t adv;
+        if (c < 0x80) {
+            adv = 1;
+        } else if (c < 0xC2) {          // continuation byte or overlong 2-byte lead
+            hr = UTF_E_INVALID_DATA;
+            break;
+        } else if (c < 0xE0) {
+            if (end - s < 2 || !is_cont(s[1])) {
+                hr = UTF_E_INVALID_DATA;
+                break;
+            }
+            c = ((c & 0x1F) << 6) | (s[1] & 0x3F);
+            adv = 2;
+        } else if (c < 0xF0) {
+            if (end - s < 3 || !is_cont(s[1]) || !is_cont(s[2])) {
+                hr = UTF_E_INVALID_DATA;
+                break;
+            }
+            c = ((c & 0x0F) << 12) | ((uint32_t)(s[1] & 0x3F) << 6) | (s[2] & 0x3F);
+            if (c < 0x800 || (c >= 0xD800 && c <= 0xDFFF)) {
+                hr = UTF_E_INVALID_DATA;
+                break;
+            }
+            adv = 3;
+        } else if (c < 0xF5) {
+            if (end - s < 4 || !is_cont(s[1]) || !is_cont(s[2]) || !is_cont(s[3])) {
+                hr = UTF_E_INVALID_DATA;
+                break;
+            }
+            c = ((c & 0x07) << 18) | ((uint32_t)(s[1] & 0x3F) << 12) |
+                ((uint32_t)(s[2] & 0x3F) << 6) | (s[3] & 0x3F);
+            if (c < 0x10000 || c > 0x10FFFF) {
+                hr = UTF_E_INVALID_DATA;
+                break;
+            }
+            adv = 4;
+        } else {
+            hr = UTF_E_INVALID_DATA;
+            break;
+        }
+
+        size_t units = (c >= 0x10000) ? 2 : 1;
+        if (write) {
+            if (cap - n < units) {
+                hr = STRSAFE_E_INSUFFICIENT_BUFFER;
+                break;
+            }
+            if (1 == units) {
+                dst[n] = (utf16_t)c;
+            } else {
+                c -= 0x10000;
+                dst[n] = (utf16_t)(0xD800 | (c >> 10));
+                dst[n + 1] = (utf16_t)(0xDC00 | (c & 0x3FF));
+            }
+        }
+        n += units;
+        s += adv;
+    }
+    *pn = n;
+    return hr;
+}
+static inline HRESULT
+utf16_to_8 (uint8_t * dst, size_t cap, utf16_t const * s, size_t len, size_t * pn, int write) {
+    utf16_t const * end = s + len;
+    size_t n = 0;
+    HRESULT hr = S_OK;
+
+    while (s < end) {
+#if UTF_SSE2
+        // -- ASCII fast path: 16 units in, 16 bytes out
+        while ((size_t)(end - s) >= 16 && (!write || cap - n >= 16)) {
+            __m128i a = _mm_loadu_si128((__m128i const *)s);
+            __m128i b = _mm_loadu_si128((__m128i const *)(s + 8));
+            __m128i high = _mm_and_si128(_mm_or_si128(a, b), _mm_set1_epi16((short)0xFF80));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_setzero_si128())) != 0xFFFF)
+                break;
+            if (write)
+                _mm_storeu_si128((__m128i *)(dst + n), _mm_packus_epi16(a, b));
+            s += 16;
+            n += 16;
+        }
+        if (s == end)
+            break;
+#endif
+        uint32_t c = s[0];
+        size_t adv = 1, bytes;
+        if (c < 0x80) {
+            bytes = 1;
+        } else if (c < 0x800) {
+            bytes = 2;
+        } else if (c < 0xD800 || c > 0xDFFF) {
+            bytes = 3;
+        } else if (c <= 0xDBFF && end - s >= 2 && s[1] >= 0xDC00 && s[1] <= 0xDFFF) {
+            c = 0x10000 + (((c & 0x3FF) << 10) | (s[1] & 0x3FF));
+            bytes = 4;
+            adv = 2;
+        } else {                        // unpaired surrogate
+            hr = UTF_E_INVALID_DATA;
+            break;
+        }
+
+        if (write) {
+            if (cap - n < bytes) {
+                hr = STRSAFE_E_INSUFFICIENT_BUFFER;
+                break;
+            }
+            uint8_t * d = dst + n;
+            switch (bytes) {
+            case 1:
+                d[0] = (uint8_t)c;
+                break;
+            case 2:
+                d[0] = (uint8_t)(0xC0 | (c >> 6));
+                d[1] = (uint8_t)(0x80 | (c & 0x3F));
+                break;
+            case 3:
+                d[0] = (uint8_t)(0xE0 | (c >> 12));
+                d[1] = (uint8_t)(0x80 | ((c >> 6) & 0x3F));
+                d[2] = (uint8_t)(0x80 | (c & 0x3F));
+                break;
+            default:
+                d[0] = (uint8_t)(0xF0 | (c >> 18));
+                d[1] = (uint8_t)(0x80 | ((c >> 12) & 0x3F));
+                d[2] = (uint8_t)(0x80 | ((c >> 6) & 0x3F));
+                d[3] = (uint8_t)(0x80 | (c & 0x3F));
+                break;
+            }
+        }
+        n += bytes;
+        s += adv;
+    }
+    *pn = n;
+    return hr;
+}
+
+// =========================================================================================
+
+HRESULT
+Utf8_CchToUtf16 (size_t * pcch, char const * src, size_t cb_src) {
+    size_t n = 0;
+    HRESULT hr;
+    if (NULL == pcch || NULL == src)
+        return STRSAFE_E_INVALID_PARAMETER;
+    if (UTF_NUL_TERMINATED == cb_src)
+        cb_src = strlen(src);
+    hr = utf8_to_16(NULL, 0, (uint8_t const *)src, cb_src, &n, 0);
+    *pcch = SUCCEEDED(hr) ? n : 0;
+    return hr;
+}
+HRESULT
+Utf8_ToUtf16Cch (
+    utf16_t * dst, size_t cch_dst,
+    char const * src, size_t cb_src,
+    size_t * pcch_written
+) {
+    size_t n = 0;
+    HRESULT hr;
+    if (pcch_written)
+        *pcch_written = 0;
+    if (NULL == dst || 0 == cch_dst || NULL == src)
+        return STRSAFE_E_INVALID_PARAMETER;
+    if (UTF_NUL_TERMINATED == cb_src)
+        cb_src = strlen(src);
+
+    // -- one unit is kept for the NUL
+    hr = utf8_to_16(dst, cch_dst - 1, (uint8_t const *)src, cb_src, &n, 1);
+    dst[n] = 0;
+    if (pcch_written)
+        *pcch_written = n;
+    return hr;
+}
+HRESULT
+Utf16_CbToUtf8 (size_t * pcb, utf16_t const * src, size_t cch_src) {
+    size_t n = 0;
+    HRESULT hr;
+    if (NULL == pcb || NULL == src)
+        return STRSAFE_E_INVALID_PARAMETER;
+    if (UTF_NUL_TERMINATED == cch_src)
+        cch_src = wcslen16(src);
+    hr = utf16_to_8(NULL, 0, src, cch_src, &n, 0);
+    *pcb = SUCCEEDED(hr) ? n : 0;
+    return hr;
+}
+HRESULT
+Utf16_ToUtf8Cb (
+    char * dst, size_t cb_dst,
+    utf16_t const * src, size_t cch_src,
+    size_t * pcb_written
+) {
+    size_t n = 0;
+    HRESULT hr;
+    if (pcb_written)
+        *pcb_written = 0;
+    if (NULL == dst || 0 == cb_dst || NULL == src)
+        return STRSAFE_E_INVALID_PARAMETER;
+    if (UTF_NUL_TERMINATED == cch_src)
+        cch_src = wcslen16(src);
+
+    hr = utf16_to_8((uint8_t *)dst, cb_dst - 1, src, cch_src, &n, 1);
+    dst[n] = 0;
+    if (pcb_written)
+        *pcb_written = n;
+    return hr;
+}
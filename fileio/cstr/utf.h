@@ -0,0 +1,62 @@
+#pragma once
+
+/* ===========================================================
+   #File: utf.h #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: UTF-8 <-> UTF-16 transcoding with StringCch-like bounded buffers #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "strsafe_compat.h"
+
+#ifdef _WIN32
+typedef WCHAR utf16_t;
+#else
+typedef uint16_t utf16_t;
+#endif
+
+/* HRESULT_FROM_WIN32(ERROR_NO_UNICODE_TRANSLATION): malformed input */
+#define UTF_E_INVALID_DATA  ((HRESULT)0x80070459L)
+
+/* Pass as the source length when the source is NUL-terminated */
+#define UTF_NUL_TERMINATED  ((size_t)-1)
+
+/*
+Conventions follow the StringCch* family:
+ - Lengths never include the terminating NUL, destinations always get one
+   (unless their size is 0, which is STRSAFE_E_INVALID_PARAMETER).
+ - When the destination is too small, as many whole characters as fit are
+   converted (a surrogate pair is never split), the result is NUL-terminated
+   and STRSAFE_E_INSUFFICIENT_BUFFER is returned.
+ - Overlong forms, surrogates encoded in UTF-8, code points past U+10FFFF,
+   truncated sequences and unpaired UTF-16 surrogates give UTF_E_INVALID_DATA.
+ - pcch_written / pcb_written (may be NULL) receive the # of units written.
+ASCII runs are converted 16 at a time with SSE2 where available.
+*/
+
+/* # of UTF-16 units needed for src (without the NUL) */
+HRESULT
+Utf8_CchToUtf16 (size_t * pcch, char const * src, size_t cb_src);
+
+HRESULT
+Utf8_ToUtf16Cch (
+    utf16_t * dst, size_t cch_dst,
+    char const * src, size_t cb_src,
+    size_t * pcch_written
+);
+
+/* # of UTF-8 bytes needed for src (without the NUL) */
+HRESULT
+Utf16_CbToUtf8 (size_t * pcb, utf16_t const * src, size_t cch_src);
+
+HRESULT
+Utf16_ToUtf8Cb (
+    char * dst, size_t cb_dst,
+    utf16_t const * src, size_t cch_src,
+    size_t * pcb_written
+);
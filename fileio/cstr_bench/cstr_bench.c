@@ -0,0 +1,720 @@
+/* ===========================================================
+   #File: cstr_bench.c #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Benchmarks for the string routines of the cstr sample #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../cstr/casefold.h"
+#include "../cstr/intern.h"
+#include "../cstr/strbuf.h"
+#include "../cstr/utf.h"
+
+#define BENCH_REPS 5    // best of
+#include "../../bench/bench_util.h"
+
+#ifndef _WIN32
+#include <iconv.h>
+#endif
+
+#ifndef _countof
+#define _countof(a) (sizeof(a) / sizeof((a)[0]))
+#endif
+
+// =========================================================================================
+
+#pragma region utf
+/* One line of text per script, repeated into a corpus of a few MB */
+static struct {
+    char const * name;
+    char const * line;
+} g_corpora [] = {
+    {"ascii",    "The quick brown fox jumps over the lazy dog. 0123456789\n"},
+    {"latin",    "Gr\xC3\xB6\xC3\x9F" "e, fa\xC3\xA7" "ade, na\xC3\xAFve, \xC3\x86r\xC3\xB8, Se\xC3\xB1or, d\xC3\xA9j\xC3\xA0 vu, \xC5\x81\xC3\xB3" "d\xC5\xBA\n"},
+    {"cyrillic", "\xD0\xA1\xD1\x8A\xD0\xB5\xD1\x88\xD1\x8C \xD0\xB6\xD0\xB5 \xD0\xB5\xD1\x89\xD1\x91 \xD1\x8D\xD1\x82\xD0\xB8\xD1\x85 \xD0\xBC\xD1\x8F\xD0\xB3\xD0\xBA\xD0\xB8\xD1\x85 \xD1\x84\xD1\x80\xD0\xB0\xD0\xBD\xD1\x86\xD1\x83\xD0\xB7\xD1\x81\xD0\xBA\xD0\xB8\xD1\x85 \xD0\xB1\xD1\x83\xD0\xBB\xD0\xBE\xD0\xBA\n"},
+    {"cjk",      "\xE5\xA4\xA9\xE5\x9C\xB0\xE7\x8E\x84\xE9\xBB\x84\xE5\xAE\x87\xE5\xAE\x99\xE6\xB4\xAA\xE8\x8D\x92\xE6\x97\xA5\xE6\x9C\x88\xE7\x9B\x88\xE6\x98\x83\xE8\xBE\xB0\xE5\xAE\xBF\xE5\x88\x97\xE5\xBC\xA0\n"},
+    {"emoji",    "\xF0\x9F\x8F\xB4\xE2\x80\x8D\xE2\x98\xA0\xEF\xB8\x8F \xF0\x9F\x92\xB0\xE2\x9A\x93\xF0\x9F\xA6\x9C \xE2\x98\xA0\xEF\xB8\x8F\xF0\x9F\x97\xBA\xEF\xB8\x8F\n"},
+    {"mixed",    NULL},         // all of the above, line by line
+};
+
+static char *
+make_corpus (char const * line, size_t target, size_t * len) {
+    char * buf = (char *)malloc(target + 256);
+    size_t n = 0;
+    size_t k = 0;
+    while (n < target) {
+        char const * l = line ? line : g_corpora[k++ % (_countof(g_corpora) - 1)].line;
+        size_t ll = strlen(l);
+        memcpy(buf + n, l, ll);
+        n += ll;
+    }
+    buf[n] = 0;
+    *len = n;
+    return buf;
+}
+
+/* Platform converters: MultiByteToWideChar / WideCharToMultiByte or iconv */
+#ifdef _WIN32
+static size_t
+os_8to16 (utf16_t * dst, size_t cch, char const * src, size_t len) {
+    return (size_t)MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, src, (int)len, dst, (int)cch);
+}
+static size_t
+os_16to8 (char * dst, size_t cb, utf16_t const * src, size_t len) {
+    return (size_t)WideCharToMultiByte(CP_UTF8, WC_ERR_INVALID_CHARS, src, (int)len, dst, (int)cb, NULL, NULL);
+}
+#define OS_NAME "MultiByteToWideChar"
+#else
+static size_t
+os_iconv (char const * from, char const * to, void * dst, size_t cb_dst, void const * src, size_t cb_src) {
+    iconv_t cd = iconv_open(to, from);
+    char * in = (char *)src;
+    char * out = (char *)dst;
+    size_t in_left = cb_src, out_left = cb_dst;
+    if ((iconv_t)-1 == cd)
+        return 0;
+    size_t r = iconv(cd, &in, &in_left, &out, &out_left);
+    iconv_close(cd);
+    return ((size_t)-1 == r) ? 0 : cb_dst - out_left;
+}
+static size_t
+os_8to16 (utf16_t * dst, size_t cch, char const * src, size_t len) {
+    return os_iconv("UTF-8", "UTF-16LE", dst, cch * sizeof(utf16_t), src, len) / sizeof(utf16_t);
+}
+static size_t
+os_16to8 (char * dst, size_t cb, utf16_t const * src, size_t len) {
+    return os_iconv("UTF-16LE", "UTF-8", dst, cb, src, len * sizeof(utf16_t));
+}
+#define OS_NAME "iconv"
+#endif
+
+/* Each bench_ function returns 0 if a result disagrees with its reference */
+static int
+bench_utf (void) {
+    int all_ok = 1;
+    printf("UTF-8 <-> UTF-16 (MB/s of UTF-8, best of %d)\n", BENCH_REPS);
+    printf("%-10s %12s %12s %12s %12s\n", "corpus", "8->16", "8->16 (os)", "16->8", "16->8 (os)");
+
+    for (size_t c = 0; c < _countof(g_corpora); ++c) {
+        size_t len8, cch16, n_os, n;
+        char * text = make_corpus(g_corpora[c].line, 8u << 20, &len8);
+        Utf8_CchToUtf16(&cch16, text, len8);
+        utf16_t * wide = (utf16_t *)malloc((cch16 + 1) * sizeof(utf16_t));
+        utf16_t * wide_os = (utf16_t *)malloc((cch16 + 1) * sizeof(utf16_t));
+        char * back = (char *)malloc(len8 + 1);
+        double best[4] = {1e9, 1e9, 1e9, 1e9};
+        int ok = 1;
+
+        for (int r = 0; r < BENCH_REPS; ++r) {
+            double t = BenchUtil_Now();
+            Utf8_ToUtf16Cch(wide, cch16 + 1, text, len8, &n);
+            t = BenchUtil_Now() - t;
+            if (t < best[0]) best[0] = t;
+
+            t = BenchUtil_Now();
+            n_os = os_8to16(wide_os, cch16 + 1, text, len8);
+            t = BenchUtil_Now() - t;
+            if (t < best[1]) best[1] = t;
+            ok = ok && n == cch16 && n_os == cch16 && 0 == memcmp(wide, wide_os, n * sizeof(utf16_t));
+
+            t = BenchUtil_Now();
+            Utf16_ToUtf8Cb(back, len8 + 1, wide, cch16, &n);
+            t = BenchUtil_Now() - t;
+            if (t < best[2]) best[2] = t;
+            ok = ok && n == len8 && 0 == memcmp(back, text, len8);
+
+            t = BenchUtil_Now();
+            n_os = os_16to8(back, len8 + 1, wide, cch16);
+            t = BenchUtil_Now() - t;
+            if (t < best[3]) best[3] = t;
+            ok = ok && n_os == len8;
+        }
+
+        double mb = (double)len8 / 1e6;
+        printf(
+            "%-10s %12.0f %12.0f %12.0f %12.0f%s\n", g_corpora[c].name,
+            mb / best[0], mb / best[1], mb / best[2], mb / best[3],
+            ok ? "" : "  (MISMATCH)"
+        );
+        all_ok &= ok;
+        free(back);
+        free(wide_os);
+        free(wide);
+        free(text);
+    }
+    return all_ok;
+}
+#pragma endregion
+
+#pragma region strbuf
+#ifndef _WIN32
+/* What StringCchCat does: find the end of dst, then a bounded copy */
+static HRESULT
+StringCchCat (TCHAR * dst, size_t cch_dst, TCHAR const * src) {
+    size_t len = strlen(dst);
+    while (len + 1 < cch_dst && *src)
+        dst[len++] = *src++;
+    dst[len] = 0;
+    return *src ? STRSAFE_E_INSUFFICIENT_BUFFER : S_OK;
+}
+#endif
+
+static int
+bench_strbuf (void) {
+    TCHAR const * piece = _T(" additional text");
+    size_t piece_len = _tcslen(piece);
+    int pieces [] = {1000, 10000, 40000};
+    int all_ok = 1;
+
+    printf("Repeated concatenation (ms, best of %d)\n", BENCH_REPS);
+    printf("%-10s %14s %14s %14s %14s\n", "pieces", "StringCchCat", "StrBuf fixed", "StrBuf heap", "StrBuf arena");
+
+    for (size_t k = 0; k < _countof(pieces); ++k) {
+        int n = pieces[k];
+        size_t cch = (size_t)n * piece_len + 1;
+        TCHAR * buf = (TCHAR *)malloc(cch * sizeof(TCHAR));
+        double best[4] = {1e9, 1e9, 1e9, 1e9};
+        int ok = 1;
+
+        for (int r = 0; r < BENCH_REPS; ++r) {
+            StrBuf sb;
+            StrArena arena;
+            double t;
+
+            // -- every call walks the whole destination first: O(n^2)
+            t = BenchUtil_Now();
+            buf[0] = 0;
+            for (int i = 0; i < n; ++i)
+                StringCchCat(buf, cch, piece);
+            t = BenchUtil_Now() - t;
+            if (t < best[0]) best[0] = t;
+
+            t = BenchUtil_Now();
+            StrBuf_InitFixed(&sb, buf, cch);
+            for (int i = 0; i < n; ++i)
+                StrBuf_Append(&sb, piece, piece_len);
+            t = BenchUtil_Now() - t;
+            if (t < best[1]) best[1] = t;
+            ok = ok && sb.cch == cch - 1;
+
+            t = BenchUtil_Now();
+            StrBuf_Init(&sb, NULL);
+            for (int i = 0; i < n; ++i)
+                StrBuf_Append(&sb, piece, piece_len);
+            t = BenchUtil_Now() - t;
+            if (t < best[2]) best[2] = t;
+            ok = ok && sb.cch == cch - 1 && 0 == memcmp(sb.str, buf, cch * sizeof(TCHAR));
+            StrBuf_Free(&sb);
+
+            t = BenchUtil_Now();
+            StrArena_Init(&arena, 0);
+            StrBuf_Init(&sb, &arena);
+            for (int i = 0; i < n; ++i)
+                StrBuf_Append(&sb, piece, piece_len);
+            t = BenchUtil_Now() - t;
+            if (t < best[3]) best[3] = t;
+            ok = ok && sb.cch == cch - 1;
+            StrArena_Deinit(&arena);
+        }
+
+        printf(
+            "%-10d %14.3f %14.3f %14.3f %14.3f%s\n", n,
+            1e3 * best[0], 1e3 * best[1], 1e3 * best[2], 1e3 * best[3],
+            ok ? "" : "  (MISMATCH)"
+        );
+        all_ok &= ok;
+        free(buf);
+    }
+    return all_ok;
+}
+#pragma endregion
+
+#pragma region casefold
+static uint64_t g_rng = 0x2545F4914F6CDD1DULL;
+static unsigned
+next_rand (void) {
+    // -- xorshift64*
+    g_rng ^= g_rng >> 12;
+    g_rng ^= g_rng << 25;
+    g_rng ^= g_rng >> 27;
+    return (unsigned)((g_rng * 0x2545F4914F6CDD1DULL) >> 32);
+}
+static int
+sign (int v) {
+    return (v > 0) - (v < 0);
+}
+
+/*
+The C and S entries of Unicode's CaseFolding.txt for every unit the tests
+use, written out by hand so the check does not lean on casefold_table.h.
+U+0130 has only F and T entries: it folds to itself.
+*/
+static utf16_t const g_ref_fold [][2] = {
+    {0x00B5, 0x03BC}, {0x00C0, 0x00E0}, {0x00DE, 0x00FE}, {0x0178, 0x00FF},
+    {0x017F, 0x0073}, {0x01C4, 0x01C6}, {0x01C5, 0x01C6}, {0x03A3, 0x03C3},
+    {0x03A9, 0x03C9}, {0x03C2, 0x03C3}, {0x0401, 0x0451}, {0x0416, 0x0436},
+    {0x0490, 0x0491}, {0x1E9E, 0x00DF}, {0x212A, 0x006B}, {0xAB70, 0x13A0},
+    {0xFF21, 0xFF41},
+};
+static utf16_t
+ref_fold (utf16_t c) {
+    if (c >= 'A' && c <= 'Z')
+        return (utf16_t)(c + 0x20);
+    for (size_t i = 0; i < _countof(g_ref_fold); ++i)
+        if (g_ref_fold[i][0] == c)
+            return g_ref_fold[i][1];
+    return c;
+}
+
+/* The table one unit at a time: the scalar baseline the SIMD paths are timed against */
+static int
+scalar_compare_w (utf16_t const * a, size_t na, utf16_t const * b, size_t nb) {
+    for (size_t i = 0; i < na && i < nb; ++i) {
+        utf16_t fa = CaseFold_Unit(a[i]), fb = CaseFold_Unit(b[i]);
+        if (fa != fb)
+            return (fa < fb) ? -1 : 1;
+    }
+    return (na < nb) ? -1 : (na > nb) ? 1 : 0;
+}
+/* The obvious loops over the hand-written folding: what the SIMD paths must agree with */
+static int
+ref_compare_w (utf16_t const * a, size_t na, utf16_t const * b, size_t nb) {
+    for (size_t i = 0; i < na && i < nb; ++i) {
+        utf16_t fa = ref_fold(a[i]), fb = ref_fold(b[i]);
+        if (fa != fb)
+            return (fa < fb) ? -1 : 1;
+    }
+    return (na < nb) ? -1 : (na > nb) ? 1 : 0;
+}
+static int
+ref_compare_a (char const * a, size_t na, char const * b, size_t nb) {
+    for (size_t i = 0; i < na && i < nb; ++i) {
+        unsigned fa = (unsigned char)a[i], fb = (unsigned char)b[i];
+        if (fa - 'A' < 26u) fa += 0x20;
+        if (fb - 'A' < 26u) fb += 0x20;
+        if (fa != fb)
+            return (fa < fb) ? -1 : 1;
+    }
+    return (na < nb) ? -1 : (na > nb) ? 1 : 0;
+}
+#ifdef _WIN32
+#define strncasecmp _strnicmp
+#else
+#include <strings.h>
+#endif
+
+/* Case pairs the random strings are built from; the 2nd of each pair folds to the 1st.
+   Every unit here must be covered by ref_fold */
+static utf16_t const g_case_pairs [][2] = {
+    {'a', 'A'}, {'z', 'Z'}, {'k', 'K'}, {'k', 0x212A}, {'s', 0x017F}, {'_', '_'}, {'[', '['},
+    {0x00E0, 0x00C0}, {0x00FF, 0x0178}, {0x00FE, 0x00DE},
+    {0x03C3, 0x03A3}, {0x03C3, 0x03C2}, {0x03C9, 0x03A9}, {0x03BC, 0x00B5},
+    {0x0436, 0x0416}, {0x0451, 0x0401}, {0x0491, 0x0490},
+    {0x01C6, 0x01C4}, {0x01C6, 0x01C5}, {0x13A0, 0xAB70},
+    {0xFF41, 0xFF21}, {0x4E2D, 0x4E2D}, {0xD801, 0xD801}, {0xDC28, 0xDC00},
+    {0x00DF, 0x1E9E}, {0x0130, 0x0130},
+};
+
+struct KnownCase {
+    utf16_t const * a;
+    utf16_t const * b;
+    int             expected;
+};
+
+static int
+check_casefold (void) {
+    static utf16_t const kelvin [] = {0x212A, 'e', 'L', 'v', 'I', 'n', 0};
+    static utf16_t const sigma_u [] = {0x03A3, 0x0391, 0x03A3, 0};
+    static utf16_t const sigma_l [] = {0x03C3, 0x03B1, 0x03C2, 0};
+    static utf16_t const strasse_1 [] = {'s', 't', 'r', 'a', 0x00DF, 'e', 0};
+    static utf16_t const strasse_2 [] = {'S', 'T', 'R', 'A', 'S', 'S', 'E', 0};
+    static utf16_t const dotted_i [] = {0x0130, 0};
+    static utf16_t const small_i [] = {'i', 0};
+    static utf16_t const sharp_s [] = {0x00DF, 0};
+    static utf16_t const capital_sharp_s [] = {0x1E9E, 0};
+    static utf16_t const long_s [] = {0x017F, 'T', 0};
+    static utf16_t const st [] = {'s', 't', 0};
+    static utf16_t const lower [] = {'a', '_', 0};
+    static utf16_t const upper [] = {'A', '[', 0};
+    static utf16_t const empty [] = {0};
+    static utf16_t const kelvin_l [] = {'k', 'e', 'l', 'v', 'i', 'n', 0};
+    struct KnownCase const known [] = {
+        {kelvin, kelvin_l, 0},
+        {sigma_u, sigma_l, 0},
+        {strasse_1, strasse_2, 1},      // simple folding keeps the sharp s
+        {dotted_i, upper, 1},
+        {dotted_i, small_i, 1},         // no C or S folding: U+0130 stays itself
+        {capital_sharp_s, sharp_s, 0},
+        {long_s, st, 0},
+        {lower, upper, 1},              // '_' > '[', CompareStringOrdinal would say the opposite
+        {empty, upper, -1},
+    };
+    int failures = 0;
+
+    for (size_t k = 0; k < _countof(known); ++k) {
+        int c = CaseFold_CompareW(known[k].a, UTF_NUL_TERMINATED, known[k].b, UTF_NUL_TERMINATED);
+        if (sign(c) != known[k].expected) {
+            printf("  known case %u: got %d, expected %d\n", (unsigned)k, sign(c), known[k].expected);
+            ++failures;
+        }
+    }
+
+    // -- random strings against a case-flipped (and sometimes altered) copy
+    for (int iter = 0; iter < 200000; ++iter) {
+        utf16_t a[96], b[96];
+        char sa[96], sb[96];
+        size_t na = next_rand() % 90;
+        for (size_t i = 0; i < na; ++i) {
+            utf16_t const * pair = g_case_pairs[(iter & 1) ? next_rand() % 3 : next_rand() % _countof(g_case_pairs)];
+            unsigned r = next_rand();
+            a[i] = pair[r & 1];
+            b[i] = pair[(r >> 1) & 1];
+            sa[i] = (char)((r & 4) ? ('A' + r % 26) : (0x80 | r >> 24));
+            sb[i] = (char)((r & 8) ? sa[i] ^ 0x20 * (sa[i] >= 'A' && sa[i] <= 'Z') : sa[i]);
+        }
+        size_t nb = na;
+        if (0 == next_rand() % 4 && na > 0)
+            b[next_rand() % na] = g_case_pairs[next_rand() % _countof(g_case_pairs)][0];
+        if (0 == next_rand() % 8 && na > 0)
+            sb[next_rand() % na] = (char)next_rand();
+        if (0 == next_rand() % 8)
+            nb = next_rand() % (na + 1);
+
+        int ref = ref_compare_w(a, na, b, nb);
+        int c = CaseFold_CompareW(a, na, b, nb);
+        int eq = CaseFold_EqualW(a, na, b, nb);
+        int hash_ok = !eq || CaseFold_HashW(a, na) == CaseFold_HashW(b, nb);
+        int rev = CaseFold_CompareW(b, nb, a, na);
+
+        int ref_a = ref_compare_a(sa, na, sb, nb);
+        int c_a = CaseFold_CompareA(sa, na, sb, nb);
+        int eq_a = CaseFold_EqualA(sa, na, sb, nb);
+        int hash_ok_a = !eq_a || CaseFold_HashA(sa, na) == CaseFold_HashA(sb, nb);
+        int crt_eq_a = na == nb && 0 == strncasecmp(sa, sb, na);
+
+        if (sign(c) != ref || eq != (0 == ref) || !hash_ok || sign(rev) != -ref ||
+            sign(c_a) != ref_a || eq_a != (0 == ref_a) || !hash_ok_a || (crt_eq_a && !eq_a)) {
+            if (failures < 10)
+                printf("  random case %d (length %u) disagrees with the reference\n", iter, (unsigned)na);
+            ++failures;
+        }
+
+#ifdef _WIN32
+        // -- CompareStringOrdinal upper-cases, so only equality is comparable,
+        //    and only for the pairs both tables agree on
+        if (0 == (iter & 1)) {
+            int os_eq = CSTR_EQUAL == CompareStringOrdinal(a, (int)na, b, (int)nb, TRUE);
+            if (os_eq != eq) {
+                if (failures < 10)
+                    printf("  random case %d disagrees with CompareStringOrdinal\n", iter);
+                ++failures;
+            }
+        }
+#endif
+    }
+    return failures;
+}
+
+/* n keys of 8..56 units and, for each, a copy with the case flipped */
+static size_t
+make_keys (utf16_t const * alphabet, size_t n_alpha, size_t n, utf16_t ** keys, utf16_t ** flipped, size_t ** offsets) {
+    size_t total = 0;
+    *offsets = (size_t *)malloc((n + 1) * sizeof(size_t));
+    for (size_t i = 0; i < n; ++i) {
+        (*offsets)[i] = total;
+        total += 8 + next_rand() % 49;
+    }
+    (*offsets)[n] = total;
+    *keys = (utf16_t *)malloc((total + 1) * sizeof(utf16_t));
+    *flipped = (utf16_t *)malloc((total + 1) * sizeof(utf16_t));
+    for (size_t i = 0; i < total; ++i) {
+        unsigned r = next_rand();
+        utf16_t c = alphabet[r % n_alpha];
+        (*keys)[i] = c;
+        (*flipped)[i] = (r & 0x10000) ? c : alphabet[(r % n_alpha) ^ 1];   // alphabet comes in case pairs
+    }
+    return total;
+}
+
+static int
+bench_casefold (void) {
+    static utf16_t const ascii [] = {
+        'a','A','b','B','c','C','d','D','e','E','f','F','g','G','h','H','i','I','j','J','k','K','l','L','m','M',
+        'n','N','o','O','p','P','q','Q','r','R','s','S','t','T','u','U','v','V','w','W','x','X','y','Y','z','Z',
+        '0','0','_','_','.','.',
+    };
+    static utf16_t const cyrillic [] = {
+        0x0430,0x0410, 0x0431,0x0411, 0x0432,0x0412, 0x0433,0x0413, 0x0434,0x0414, 0x0435,0x0415,
+        0x0436,0x0416, 0x0437,0x0417, 0x0438,0x0418, 0x043A,0x041A, 0x043B,0x041B, 0x043C,0x041C,
+        0x043D,0x041D, 0x043E,0x041E, 0x043F,0x041F, 0x0440,0x0420, 0x0441,0x0421, 0x0442,0x0422,
+        '_','_', '0','0',
+    };
+    static struct {
+        char const *    name;
+        utf16_t const * alphabet;
+        size_t          n;
+    } const sets [] = {
+        {"ascii", ascii, _countof(ascii)},
+        {"cyrillic", cyrillic, _countof(cyrillic)},
+    };
+    size_t const n_keys = 10000;       // stays in cache: this measures the compare, not memory
+
+    int failures = check_casefold();
+    int all_ok = (0 == failures);
+    printf("Case-insensitive compare: %d mismatch(es) against the reference\n", failures);
+    printf("(ns per key, best of %d)\n", BENCH_REPS);
+#ifdef _WIN32
+    printf("%-10s %16s %12s %12s %12s %12s\n", "keys", "CompareStringEx", "strnicmp", "CompareW", "EqualW", "HashW");
+#else
+    printf("%-10s %16s %12s %12s %12s %12s\n", "keys", "scalar", "strncasecmp", "CompareW", "EqualW", "HashW");
+#endif
+
+    for (size_t s = 0; s < _countof(sets); ++s) {
+        utf16_t * keys;
+        utf16_t * flipped;
+        size_t * off;
+        size_t total = make_keys(sets[s].alphabet, sets[s].n, n_keys, &keys, &flipped, &off);
+        char * keys_a = (char *)malloc(total + 1);
+        char * flipped_a = (char *)malloc(total + 1);
+        double best[5] = {1e9, 1e9, 1e9, 1e9, 1e9};
+        volatile uint64_t sink = 0;
+        int ok = 1;
+
+        // -- the byte variant only makes sense for the ASCII keys
+        for (size_t i = 0; i < total; ++i) {
+            keys_a[i] = (char)keys[i];
+            flipped_a[i] = (char)flipped[i];
+        }
+
+        for (int r = 0; r < BENCH_REPS; ++r) {
+            double t;
+            int n_equal[5] = {0, 0, 0, 0, 0};
+
+            t = BenchUtil_Now();
+            for (size_t i = 0; i < n_keys; ++i) {
+                size_t n = off[i + 1] - off[i];
+#ifdef _WIN32
+                n_equal[0] += CSTR_EQUAL == CompareStringEx(
+                    LOCALE_NAME_INVARIANT, LINGUISTIC_IGNORECASE,
+                    keys + off[i], (int)n, flipped + off[i], (int)n, NULL, NULL, 0
+                );
+#else
+                n_equal[0] += 0 == scalar_compare_w(keys + off[i], n, flipped + off[i], n);
+#endif
+            }
+            t = BenchUtil_Now() - t;
+            if (t < best[0]) best[0] = t;
+
+            if (sets[s].alphabet == ascii) {
+                t = BenchUtil_Now();
+                for (size_t i = 0; i < n_keys; ++i) {
+                    size_t n = off[i + 1] - off[i];
+                    n_equal[1] += 0 == strncasecmp(keys_a + off[i], flipped_a + off[i], n);
+                }
+                t = BenchUtil_Now() - t;
+                if (t < best[1]) best[1] = t;
+                ok = ok && n_equal[1] == (int)n_keys;
+            }
+
+            t = BenchUtil_Now();
+            for (size_t i = 0; i < n_keys; ++i) {
+                size_t n = off[i + 1] - off[i];
+                n_equal[2] += 0 == CaseFold_CompareW(keys + off[i], n, flipped + off[i], n);
+            }
+            t = BenchUtil_Now() - t;
+            if (t < best[2]) best[2] = t;
+
+            t = BenchUtil_Now();
+            for (size_t i = 0; i < n_keys; ++i) {
+                size_t n = off[i + 1] - off[i];
+                n_equal[3] += CaseFold_EqualW(keys + off[i], n, flipped + off[i], n);
+            }
+            t = BenchUtil_Now() - t;
+            if (t < best[3]) best[3] = t;
+
+            t = BenchUtil_Now();
+            for (size_t i = 0; i < n_keys; ++i) {
+                size_t n = off[i + 1] - off[i];
+                sink += CaseFold_HashW(keys + off[i], n);
+            }
+            t = BenchUtil_Now() - t;
+            if (t < best[4]) best[4] = t;
+
+            ok = ok && n_equal[0] == (int)n_keys && n_equal[2] == (int)n_keys && n_equal[3] == (int)n_keys;
+        }
+
+        double ns = 1e9 / (double)n_keys;
+        char crt[16] = "-";
+        if (best[1] < 1e9)
+            snprintf(crt, sizeof(crt), "%.1f", ns * best[1]);
+        printf(
+            "%-10s %16.1f %12s %12.1f %12.1f %12.1f%s\n", sets[s].name,
+            ns * best[0], crt, ns * best[2], ns * best[3], ns * best[4],
+            ok ? "" : "  (MISMATCH)"
+        );
+        all_ok &= ok;
+        free(flipped_a);
+        free(keys_a);
+        free(off);
+        free(flipped);
+        free(keys);
+    }
+    return all_ok;
+}
+#pragma endregion
+
+#pragma region intern
+typedef struct InternJob {
+    StrIntern *         table;
+    TCHAR const *       text;       // all keys, back to back
+    size_t const *      off;        // key i is text[off[i], off[i + 1])
+    size_t              n_keys;
+    size_t              first;      // this thread's slice, or its starting point
+    size_t              count;
+    StrAtom const **    atoms;      // per key, NULL for the lookup job
+    int                 ok;
+} InternJob;
+
+static void
+intern_add_job (void * arg) {
+    InternJob * j = (InternJob *)arg;
+    for (size_t k = 0; k < j->count; ++k) {
+        size_t i = (j->first + k) % j->n_keys;
+        StrAtom const * a = StrIntern_Add(j->table, j->text + j->off[i], j->off[i + 1] - j->off[i]);
+        j->atoms[i] = a;
+        j->ok = j->ok && a;
+    }
+}
+static void
+intern_find_job (void * arg) {
+    InternJob * j = (InternJob *)arg;
+    for (size_t k = 0; k < j->count; ++k) {
+        size_t i = (j->first + k) % j->n_keys;
+        j->ok = j->ok && NULL != StrIntern_Find(j->table, j->text + j->off[i], j->off[i + 1] - j->off[i]);
+    }
+}
+
+static int
+bench_intern (void) {
+    size_t const n_keys = 200000;
+    int const threads [] = {1, 2, 4, 8};
+    static char const * const words [] = {"pirate", "bounty", "crew", "ship", "anchor", "parrot", "rum", "map"};
+    InternJob jobs[8];
+    int all_ok = 1;
+
+    // -- keys like "parrot-rum-48213": a shared vocabulary, mostly distinct
+    size_t * off = (size_t *)malloc((n_keys + 1) * sizeof(size_t));
+    TCHAR * text = (TCHAR *)malloc(n_keys * 48 * sizeof(TCHAR));
+    StrAtom const ** atoms_1 = (StrAtom const **)malloc(n_keys * sizeof(StrAtom *));
+    StrAtom const ** atoms_2 = (StrAtom const **)malloc(n_keys * sizeof(StrAtom *));
+    size_t total = 0;
+    for (size_t i = 0; i < n_keys; ++i) {
+        char key[48];
+        int len = snprintf(
+            key, sizeof(key), "%s-%s-%u",
+            words[next_rand() % _countof(words)], words[next_rand() % _countof(words)], (unsigned)i
+        );
+        off[i] = total;
+        for (int k = 0; k < len; ++k)
+            text[total++] = (TCHAR)key[k];
+    }
+    off[n_keys] = total;
+
+    printf("String interning, %u keys (M ops/s, best of %d)\n", (unsigned)n_keys, BENCH_REPS);
+    printf("%-10s %12s %12s %12s\n", "threads", "insert", "lookup", "racing add");
+
+    for (size_t k = 0; k < _countof(threads); ++k) {
+        int n = threads[k];
+        double best[3] = {1e9, 1e9, 1e9};
+        int ok = 1;
+
+        for (int r = 0; r < BENCH_REPS; ++r) {
+            StrIntern table;
+            double t;
+            StrIntern_Init(&table, 0);
+
+            // -- disjoint slices: every call inserts
+            for (int i = 0; i < n; ++i) {
+                InternJob j = {&table, text, off, n_keys, n_keys * i / n, n_keys * (i + 1) / n - n_keys * i / n, atoms_1, 1};
+                jobs[i] = j;
+            }
+            t = BenchUtil_RunThreads(n, intern_add_job, jobs, sizeof(InternJob));
+            ok = ok && t >= 0;
+            if (t < best[0]) best[0] = t;
+            for (int i = 0; i < n; ++i)
+                ok = ok && jobs[i].ok;
+            ok = ok && StrIntern_Count(&table) == n_keys;
+
+            // -- every thread looks every key up, each from a different start
+            for (int i = 0; i < n; ++i) {
+                InternJob j = {&table, text, off, n_keys, n_keys * i / n, n_keys, NULL, 1};
+                jobs[i] = j;
+            }
+            t = BenchUtil_RunThreads(n, intern_find_job, jobs, sizeof(InternJob)) / n;
+            ok = ok && t >= 0;
+            if (t < best[1]) best[1] = t;
+            for (int i = 0; i < n; ++i)
+                ok = ok && jobs[i].ok;
+            StrIntern_Deinit(&table);
+
+            // -- every thread adds every key: first come inserts, all must get the same atom
+            StrIntern_Init(&table, 0);
+            for (int i = 0; i < n; ++i) {
+                InternJob j = {&table, text, off, n_keys, n_keys * i / n, n_keys, (i & 1) ? atoms_2 : atoms_1, 1};
+                jobs[i] = j;
+            }
+            t = BenchUtil_RunThreads(n, intern_add_job, jobs, sizeof(InternJob)) / n;
+            ok = ok && t >= 0;
+            if (t < best[2]) best[2] = t;
+            for (int i = 0; i < n; ++i)
+                ok = ok && jobs[i].ok;
+            ok = ok && StrIntern_Count(&table) == n_keys;
+            for (size_t i = 0; ok && i < n_keys; ++i) {
+                StrAtom const * a = atoms_1[i];
+                ok = (n < 2 || a == atoms_2[i]) &&
+                    a->cch == off[i + 1] - off[i] &&
+                    0 == memcmp(a->str, text + off[i], a->cch * sizeof(TCHAR)) &&
+                    a == StrIntern_Find(&table, text + off[i], a->cch);
+            }
+            StrIntern_Deinit(&table);
+        }
+
+        double mops = (double)n_keys / 1e6;
+        printf(
+            "%-10d %12.2f %12.2f %12.2f%s\n", n,
+            mops / best[0], mops / best[1], mops / best[2],
+            ok ? "" : "  (MISMATCH)"
+        );
+        all_ok &= ok;
+    }
+    free(atoms_2);
+    free(atoms_1);
+    free(text);
+    free(off);
+    return all_ok;
+}
+#pragma endregion
+
+// =========================================================================================
+
+/* Exits 1 on a MISMATCH, so a build can run it as a check */
+int main (int argc, char * argv []) {
+    int ok = 1;
+    if (BenchUtil_Wanted(argc, argv, "utf"))
+        ok &= bench_utf();
+    if (BenchUtil_Wanted(argc, argv, "strbuf"))
+        ok &= bench_strbuf();
+    if (BenchUtil_Wanted(argc, argv, "casefold"))
+        ok &= bench_casefold();
+    if (BenchUtil_Wanted(argc, argv, "intern"))
+        ok &= bench_intern();
+    return(!ok);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+/*
+The samples use the MSVC CRT names (fopen_s, _fseeki64, ...).
+Map them onto their POSIX counterparts when built elsewhere.
+*/
+#ifndef _WIN32
+#include <errno.h>
+#include <stdio.h>
+
+typedef int errno_t;
+
+static inline errno_t
+fopen_s (FILE ** stream, char const * path, char const * mode) {
+    *stream = fopen(path, mode);
+    return (*stream) ? 0 : errno;
+}
+
+#define _fseeki64 fseeko
+#define _ftelli64 ftello
+
+#ifndef _countof
+#define _countof(a) (sizeof(a) / sizeof((a)[0]))
+#endif
+#endif
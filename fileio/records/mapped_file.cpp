@@ -0,0 +1,95 @@
+#include "mapped_file.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+bool
+MappedFile_Open (MappedFile * mf, char const * path) {
+    mf->base = nullptr;
+    mf->size = 0;
+    mf->mapping = NULL;
+    mf->file = CreateFileA(
+        path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL
+    );
+    if (INVALID_HANDLE_VALUE == mf->file)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(mf->file, &size)) {
+        CloseHandle(mf->file);
+        return false;
+    }
+    mf->size = (uint64_t)size.QuadPart;
+
+    // -- CreateFileMapping refuses zero-length files, nothing to map anyway
+    if (0 == mf->size)
+        return true;
+
+    mf->mapping = CreateFileMapping(mf->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (NULL == mf->mapping) {
+        CloseHandle(mf->file);
+        return false;
+    }
+    mf->base = MapViewOfFile(mf->mapping, FILE_MAP_READ, 0, 0, 0);
+    if (nullptr == mf->base) {
+        CloseHandle(mf->mapping);
+        CloseHandle(mf->file);
+        return false;
+    }
+    return true;
+}
+void
+MappedFile_Close (MappedFile * mf) {
+    if (mf->base)
+        UnmapViewOfFile(mf->base);
+    if (mf->mapping)
+        CloseHandle(mf->mapping);
+    if (INVALID_HANDLE_VALUE != mf->file)
+        CloseHandle(mf->file);
+    mf->base = nullptr;
+    mf->size = 0;
+    mf->mapping = NULL;
+    mf->file = INVALID_HANDLE_VALUE;
+}
+#else   // POSIX
+bool
+MappedFile_Open (MappedFile * mf, char const * path) {
+    struct stat st;
+    mf->base = nullptr;
+    mf->size = 0;
+    mf->fd = open(path, O_RDONLY);
+    if (mf->fd < 0)
+        return false;
+    if (fstat(mf->fd, &st) != 0) {
+        close(mf->fd);
+        return false;
+    }
+    mf->size = (uint64_t)st.st_size;
+    if (0 == mf->size)
+        return true;
+
+    void * p = mmap(nullptr, mf->size, PROT_READ, MAP_SHARED, mf->fd, 0);
+    if (MAP_FAILED == p) {
+        close(mf->fd);
+        return false;
+    }
+    mf->base = p;
+    return true;
+}
+void
+MappedFile_Close (MappedFile * mf) {
+    if (mf->base)
+        munmap((void *)mf->base, mf->size);
+    if (mf->fd >= 0)
+        close(mf->fd);
+    mf->base = nullptr;
+    mf->size = 0;
+    mf->fd = -1;
+}
+#endif
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+/*
+Read-only view of a whole file.
+An empty file is a valid mapping with base == nullptr and size == 0.
+*/
+struct MappedFile {
+    void const *    base;       // first byte of the view
+    uint64_t        size;       // size of the file in bytes
+#ifdef _WIN32
+    HANDLE          file;
+    HANDLE          mapping;
+#else
+    int             fd;
+#endif
+};
+
+bool
+MappedFile_Open (MappedFile * mf, char const * path);
+
+void
+MappedFile_Close (MappedFile * mf);
@@ -0,0 +1,28 @@
+#pragma once
+
+/* ===========================================================
+   #File: pirate.h #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Pirate record layout shared by stdio sample and records tool #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#include <stdint.h>
+
+#define PIRATE_NAME_LEN 50
+
+/*
+A record file is nothing more than an array of Pirate structs
+written with fwrite (see stdio_main.cpp), so record #n lives at
+byte offset n * sizeof(Pirate).
+The fields have fixed widths, so the record is 60 bytes on every platform
+and files move between them; it is the layout the unsigned long bounty of
+the first version had on Windows.
+*/
+struct Pirate {
+    char        name[PIRATE_NAME_LEN];
+    uint32_t    bounty;
+    uint32_t    crew_count;
+};
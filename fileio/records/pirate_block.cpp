@@ -0,0 +1,327 @@
+#include "pirate_block.h"
+#include "crt_compat.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#define BLOCK_MAGIC "PIRBLK01"
+
+// =========================================================================================
+
+#pragma region varint codec
+static uint8_t *
+put_varint (uint8_t * p, uint64_t v) {
+    while (v >= 0x80) {
+        *p++ = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+/* Returns nullptr on a truncated or overlong varint */
+static uint8_t const *
+get_varint (uint8_t const * p, uint8_t const * end, uint64_t * v) {
+    uint64_t x = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        uint8_t b = *p++;
+        x |= (uint64_t)(b & 0x7F) << shift;
+        if (0 == (b & 0x80)) {
+            *v = x;
+            return p;
+        }
+    }
+    return nullptr;
+}
+static uint64_t
+zigzag (int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+static int64_t
+unzigzag (uint64_t v) {
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+#pragma endregion
+
+/*
+Encode count records into out, which must hold at least
+count * (sizeof(Pirate) + 32) bytes. Returns the encoded size.
+Deltas are taken mod 2^64, so no bounty or crew count can overflow them.
+*/
+static size_t
+encode_block (Pirate const * pirates, size_t count, uint8_t * out) {
+    uint8_t * p = out;
+    char const * prev_name = "";
+    size_t prev_len = 0;
+    uint64_t prev_bounty = 0;
+    uint64_t prev_crew = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        Pirate const * r = &pirates[i];
+        size_t len = strnlen(r->name, PIRATE_NAME_LEN);
+        size_t shared = 0;
+        while (shared < len && shared < prev_len && r->name[shared] == prev_name[shared])
+            ++shared;
+
+        p = put_varint(p, shared);
+        p = put_varint(p, len - shared);
+        memcpy(p, r->name + shared, len - shared);
+        p += len - shared;
+        p = put_varint(p, zigzag((int64_t)((uint64_t)r->bounty - prev_bounty)));
+        p = put_varint(p, zigzag((int64_t)((uint64_t)r->crew_count - prev_crew)));
+
+        prev_name = r->name;
+        prev_len = len;
+        prev_bounty = r->bounty;
+        prev_crew = r->crew_count;
+    }
+    return (size_t)(p - out);
+}
+
+/* Where decoding stands within a block: what the next record is a delta of */
+struct DecodeState {
+    size_t      prev_len;
+    uint64_t    bounty;
+    uint64_t    crew;
+};
+
+/*
+Decode the next record into r, whose name must already hold the previous
+record's name (or be r itself, overwritten in place).
+Returns nullptr on a corrupt record.
+*/
+static uint8_t const *
+decode_record (
+    uint8_t const * p, uint8_t const * end, DecodeState * st,
+    char const * prev_name, Pirate * r
+) {
+    uint64_t shared, suffix, v;
+
+    if (!(p = get_varint(p, end, &shared)) || !(p = get_varint(p, end, &suffix)))
+        return nullptr;
+    if (shared > st->prev_len || shared + suffix > PIRATE_NAME_LEN || suffix > (uint64_t)(end - p))
+        return nullptr;
+
+    // -- the shared part comes from the previous record of this block
+    if (shared && prev_name != r->name)
+        memcpy(r->name, prev_name, (size_t)shared);
+    memcpy(r->name + shared, p, (size_t)suffix);
+    memset(r->name + shared + suffix, 0, PIRATE_NAME_LEN - (size_t)(shared + suffix));
+    p += suffix;
+    st->prev_len = (size_t)(shared + suffix);
+
+    if (!(p = get_varint(p, end, &v)))
+        return nullptr;
+    st->bounty += (uint64_t)unzigzag(v);
+    if (!(p = get_varint(p, end, &v)))
+        return nullptr;
+    st->crew += (uint64_t)unzigzag(v);
+
+    // -- a value the fields cannot hold was never packed from them
+    r->bounty = (uint32_t)st->bounty;
+    r->crew_count = (uint32_t)st->crew;
+    if (r->bounty != st->bounty || r->crew_count != st->crew)
+        return nullptr;
+    return p;
+}
+static bool
+decode_block (uint8_t const * p, size_t size, size_t count, Pirate * out) {
+    uint8_t const * end = p + size;
+    DecodeState st = {};
+
+    for (size_t i = 0; i < count; ++i)
+        if (!(p = decode_record(p, end, &st, i ? out[i - 1].name : "", &out[i])))
+            return false;
+    return p == end;
+}
+
+// =========================================================================================
+
+bool
+PirateBlock_Pack (char const * data_path, char const * packed_path, uint32_t block_records) {
+    FILE * in = nullptr;
+    FILE * out = nullptr;
+    PirateBlockHeader hdr = {};
+    std::vector<PirateBlockEntry> index;
+    bool ok = true;
+
+    if (0 == block_records)
+        block_records = PIRATE_BLOCK_RECORDS;
+    std::vector<Pirate> records(block_records);
+    std::vector<uint8_t> encoded((size_t)block_records * (sizeof(Pirate) + 32));
+
+    if (fopen_s(&in, data_path, "rb") != 0 || nullptr == in)
+        return false;
+    if (fopen_s(&out, packed_path, "wb") != 0 || nullptr == out) {
+        fclose(in);
+        return false;
+    }
+
+    memcpy(hdr.magic, BLOCK_MAGIC, sizeof(hdr.magic));
+    hdr.block_records = block_records;
+    hdr.record_size = sizeof(Pirate);
+
+    // -- the header is rewritten once the counts are known
+    ok = (1 == fwrite(&hdr, sizeof(hdr), 1, out));
+    uint64_t offset = sizeof(hdr);
+
+    size_t n_read = 0;
+    while (ok && (n_read = fread(records.data(), sizeof(Pirate), block_records, in)) > 0) {
+        PirateBlockEntry e;
+        e.offset = offset;
+        e.size = (uint32_t)encode_block(records.data(), n_read, encoded.data());
+        e.count = (uint32_t)n_read;
+        ok = (e.size == fwrite(encoded.data(), 1, e.size, out));
+        index.push_back(e);
+        offset += e.size;
+        hdr.record_count += n_read;
+    }
+    if (ferror(in))
+        ok = false;
+
+    // -- keep the mapped block index 8-byte aligned
+    static uint8_t const zeros[8] = {};
+    size_t pad = (size_t)((8 - offset % 8) % 8);
+    if (ok && pad)
+        ok = (pad == fwrite(zeros, 1, pad, out));
+    offset += pad;
+
+    hdr.block_count = index.size();
+    hdr.index_offset = offset;
+    if (ok && !index.empty())
+        ok = (index.size() == fwrite(index.data(), sizeof(PirateBlockEntry), index.size(), out));
+    if (ok)
+        ok = (0 == _fseeki64(out, 0, SEEK_SET)) && (1 == fwrite(&hdr, sizeof(hdr), 1, out));
+
+    fclose(in);
+    if (fclose(out))
+        ok = false;
+    return ok;
+}
+bool
+PirateBlock_Unpack (char const * packed_path, char const * data_path) {
+    PirateBlockReader r;
+    FILE * out = nullptr;
+    bool ok = true;
+
+    if (!PirateBlock_Open(&r, packed_path))
+        return false;
+    if (fopen_s(&out, data_path, "wb") != 0 || nullptr == out) {
+        PirateBlock_Close(&r);
+        return false;
+    }
+    std::vector<Pirate> records(r.hdr->block_records);
+    for (uint64_t b = 0; ok && b < r.hdr->block_count; ++b) {
+        size_t n = PirateBlock_ReadBlock(&r, b, records.data());
+        ok = (n > 0) && (n == fwrite(records.data(), sizeof(Pirate), n, out));
+    }
+    if (fclose(out))
+        ok = false;
+    PirateBlock_Close(&r);
+    return ok;
+}
+bool
+PirateBlock_Open (PirateBlockReader * r, char const * packed_path) {
+    r->hdr = nullptr;
+    r->blocks = nullptr;
+    if (!MappedFile_Open(&r->file, packed_path))
+        return false;
+
+    uint8_t const * base = (uint8_t const *)r->file.base;
+    PirateBlockHeader const * hdr = (PirateBlockHeader const *)base;
+    bool ok =
+        r->file.size >= sizeof(PirateBlockHeader) &&
+        0 == memcmp(hdr->magic, BLOCK_MAGIC, sizeof(hdr->magic)) &&
+        sizeof(Pirate) == hdr->record_size &&
+        hdr->block_records > 0 &&
+        hdr->index_offset <= r->file.size &&
+        hdr->block_count <= (r->file.size - hdr->index_offset) / sizeof(PirateBlockEntry);
+    if (!ok) {
+        MappedFile_Close(&r->file);
+        return false;
+    }
+    r->hdr = hdr;
+    r->blocks = (PirateBlockEntry const *)(base + hdr->index_offset);
+    return true;
+}
+void
+PirateBlock_Close (PirateBlockReader * r) {
+    MappedFile_Close(&r->file);
+    r->hdr = nullptr;
+    r->blocks = nullptr;
+}
+size_t
+PirateBlock_ReadBlock (PirateBlockReader const * r, uint64_t block_no, Pirate * out) {
+    if (block_no >= r->hdr->block_count)
+        return 0;
+    PirateBlockEntry const * e = &r->blocks[block_no];
+    if (e->count > r->hdr->block_records ||
+        e->offset > r->hdr->index_offset ||
+        e->size > r->hdr->index_offset - e->offset)
+        return 0;
+
+    uint8_t const * p = (uint8_t const *)r->file.base + e->offset;
+    return decode_block(p, e->size, e->count, out) ? e->count : 0;
+}
+bool
+PirateBlock_Get (PirateBlockReader const * r, uint64_t record_no, Pirate * out) {
+    if (record_no >= r->hdr->record_count)
+        return false;
+    uint64_t b = record_no / r->hdr->block_records;
+    if (b >= r->hdr->block_count)
+        return false;
+    PirateBlockEntry const * e = &r->blocks[b];
+    size_t target = (size_t)(record_no % r->hdr->block_records);
+    if (target >= e->count ||
+        e->offset > r->hdr->index_offset ||
+        e->size > r->hdr->index_offset - e->offset)
+        return false;
+
+    // -- every record is a delta of the one before it: decode up to the target, all in out
+    uint8_t const * p = (uint8_t const *)r->file.base + e->offset;
+    uint8_t const * end = p + e->size;
+    DecodeState st = {};
+    for (size_t i = 0; i <= target; ++i)
+        if (!(p = decode_record(p, end, &st, out->name, out)))
+            return false;
+    return true;
+}
+bool
+PirateBlock_Scan (
+    PirateBlockReader const * r, unsigned thread_count,
+    PirateBlockScanFn fn, void * ctx
+) {
+    std::atomic<uint64_t> next_block{0};
+    std::atomic<bool> ok{true};
+
+    if (0 == thread_count)
+        thread_count = std::thread::hardware_concurrency();
+    if (0 == thread_count)
+        thread_count = 1;
+    if (thread_count > r->hdr->block_count)
+        thread_count = (unsigned)((r->hdr->block_count > 0) ? r->hdr->block_count : 1);
+
+    // -- blocks are independent: workers just grab the next one off a shared counter
+    auto worker = [&] () {
+        std::vector<Pirate> records(r->hdr->block_records);
+        while (ok.load(std::memory_order_relaxed)) {
+            uint64_t b = next_block.fetch_add(1, std::memory_order_relaxed);
+            if (b >= r->hdr->block_count)
+                break;
+            size_t n = PirateBlock_ReadBlock(r, b, records.data());
+            if (0 == n || !fn(ctx, b * r->hdr->block_records, records.data(), n))
+                ok.store(false, std::memory_order_relaxed);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < thread_count; ++i)
+        threads.emplace_back(worker);
+    worker();   // the calling thread is one of the workers
+    for (auto & t : threads)
+        t.join();
+    return ok.load();
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pirate.h"
+#include "mapped_file.h"
+
+/*
+Block-compressed record file.
+
+    | header | block 0 | block 1 | ... | block index |
+
+Records are cut into blocks of block_records Pirates, every block is
+encoded on its own so any one of them can be decoded without the others:
+for each record
+    varint  # of name bytes shared with the previous name in the block
+    varint  # of remaining name bytes, followed by those bytes
+    varint  zigzag(bounty - previous bounty)
+    varint  zigzag(crew_count - previous crew_count)
+the differences taken mod 2^64, so any value round-trips.
+The block index at the end gives the offset and size of every block,
+so record #n lives in block n / block_records.
+*/
+
+#define PIRATE_BLOCK_RECORDS 4096
+
+struct PirateBlockHeader {
+    char        magic[8];           // "PIRBLK01"
+    uint32_t    block_records;      // # of records per block (the last one may be short)
+    uint32_t    record_size;        // sizeof(Pirate) at pack time
+    uint64_t    record_count;       // # of records in the file
+    uint64_t    block_count;        // # of blocks
+    uint64_t    index_offset;       // file offset of the block index
+};
+
+struct PirateBlockEntry {
+    uint64_t    offset;             // file offset of the encoded block
+    uint32_t    size;               // encoded size in bytes
+    uint32_t    count;              // # of records in the block
+};
+
+struct PirateBlockReader {
+    MappedFile                  file;
+    PirateBlockHeader const *   hdr;
+    PirateBlockEntry const *    blocks;
+};
+
+/*
+Called by PirateBlock_Scan for every decoded block, possibly from several threads
+at once and in no particular order. Return false to stop the scan.
+*/
+typedef bool (*PirateBlockScanFn) (
+    void * ctx, uint64_t first_record, Pirate const * pirates, size_t count
+);
+
+/*
+Pack a raw record file (array of Pirate) into a block-compressed file.
+block_records == 0 uses PIRATE_BLOCK_RECORDS.
+*/
+bool
+PirateBlock_Pack (char const * data_path, char const * packed_path, uint32_t block_records);
+
+/* Unpack a block-compressed file back into a raw record file */
+bool
+PirateBlock_Unpack (char const * packed_path, char const * data_path);
+
+bool
+PirateBlock_Open (PirateBlockReader * r, char const * packed_path);
+
+void
+PirateBlock_Close (PirateBlockReader * r);
+
+/*
+Decode block #block_no into out, which must hold block_records Pirates.
+Returns the # of records decoded, 0 if the block is out of range or corrupt.
+*/
+size_t
+PirateBlock_ReadBlock (PirateBlockReader const * r, uint64_t block_no, Pirate * out);
+
+/* Random access to one record, decodes its block up to that record only */
+bool
+PirateBlock_Get (PirateBlockReader const * r, uint64_t record_no, Pirate * out);
+
+/*
+Decode every block with thread_count threads (0 means one per core).
+Returns false if a block is corrupt or the callback stopped the scan.
+*/
+bool
+PirateBlock_Scan (
+    PirateBlockReader const * r, unsigned thread_count,
+    PirateBlockScanFn fn, void * ctx
+);
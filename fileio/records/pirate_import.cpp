@@ -0,0 +1,246 @@
+#include "pirate_import.h"
+#include "crt_compat.h"
+#include "mapped_file.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define CHUNK_BYTES (8u << 20)      // input bytes per parsing task
+
+// =========================================================================================
+
+struct ImportChunk {
+    char const *        begin;
+    char const *        end;
+    std::vector<Pirate> records;
+    uint64_t            lines;          // # of lines in the chunk
+    uint64_t            bad_lines;
+    uint64_t            first_bad;      // 1-based line # within the chunk, 0 if none
+    bool                done;
+};
+
+/*
+Parse an unsigned decimal at p, stops at the first non-digit.
+No locale, no errno: returns nullptr if there are no digits or the value exceeds max.
+*/
+static char const *
+parse_uint (char const * p, char const * end, uint64_t max, uint64_t * out) {
+    char const * start = p;
+    uint64_t v = 0;
+    while (p < end && (unsigned)(*p - '0') < 10) {
+        unsigned d = (unsigned)(*p - '0');
+        if (v > (max - d) / 10)
+            return nullptr;
+        v = v * 10 + d;
+        ++p;
+    }
+    if (p == start)
+        return nullptr;
+    *out = v;
+    return p;
+}
+static bool
+is_sep (char c) {
+    return ',' == c || '\t' == c;
+}
+/* Parse one line [p, end) without its line break */
+static bool
+parse_line (char const * p, char const * end, Pirate * out) {
+    size_t len = 0;
+    // -- all of it: padding and the name's tail go to the file as they are
+    memset(out, 0, sizeof(*out));
+
+    if (p < end && '"' == *p) {
+        // -- quoted name, "" is an escaped quote
+        for (++p;; ++p) {
+            if (p == end)
+                return false;
+            if ('"' == *p) {
+                if (p + 1 < end && '"' == p[1])
+                    ++p;
+                else
+                    break;
+            }
+            if (len < PIRATE_NAME_LEN - 1)
+                out->name[len++] = *p;
+        }
+        ++p;    // closing quote
+    } else {
+        char const * q = p;
+        while (q < end && !is_sep(*q))
+            ++q;
+        len = (size_t)(q - p);
+        if (len > PIRATE_NAME_LEN - 1)
+            len = PIRATE_NAME_LEN - 1;
+        memcpy(out->name, p, len);
+        p = q;
+    }
+
+    uint64_t bounty, crew;
+    if (p == end || !is_sep(*p++))
+        return false;
+    if (!(p = parse_uint(p, end, UINT32_MAX, &bounty)))
+        return false;
+    if (p == end || !is_sep(*p++))
+        return false;
+    if (!(p = parse_uint(p, end, UINT32_MAX, &crew)))
+        return false;
+    if (p != end)
+        return false;
+
+    out->bounty = (uint32_t)bounty;
+    out->crew_count = (uint32_t)crew;
+    return true;
+}
+static void
+parse_chunk (ImportChunk * c) {
+    char const * p = c->begin;
+    c->records.reserve((size_t)(c->end - c->begin) / 24);
+    while (p < c->end) {
+        char const * eol = (char const *)memchr(p, '\n', (size_t)(c->end - p));
+        char const * next = eol ? eol + 1 : c->end;
+        if (!eol)
+            eol = c->end;
+        if (eol > p && '\r' == eol[-1])
+            --eol;
+
+        ++c->lines;
+        if (eol > p) {
+            Pirate r = {};
+            if (parse_line(p, eol, &r)) {
+                c->records.push_back(r);
+            } else {
+                if (0 == c->bad_lines)
+                    c->first_bad = c->lines;
+                ++c->bad_lines;
+            }
+        }
+        p = next;
+    }
+}
+/* Cut [begin, end) into chunks of about CHUNK_BYTES that end right after a '\n' */
+static void
+split_chunks (char const * begin, char const * end, std::vector<ImportChunk> * chunks) {
+    char const * p = begin;
+    while (p < end) {
+        char const * q = ((size_t)(end - p) > CHUNK_BYTES) ? p + CHUNK_BYTES : end;
+        if (q < end) {
+            char const * eol = (char const *)memchr(q, '\n', (size_t)(end - q));
+            q = eol ? eol + 1 : end;
+        }
+        ImportChunk c;
+        c.begin = p;
+        c.end = q;
+        c.lines = 0;
+        c.bad_lines = 0;
+        c.first_bad = 0;
+        c.done = false;
+        chunks->push_back(std::move(c));
+        p = q;
+    }
+}
+
+// =========================================================================================
+
+bool
+PirateImport_Run (
+    char const * text_path, char const * data_path,
+    unsigned thread_count, PirateImportStats * stats
+) {
+    MappedFile in;
+    FILE * out = nullptr;
+    std::vector<ImportChunk> chunks;
+    bool ok = true;
+
+    memset(stats, 0, sizeof(*stats));
+    if (!MappedFile_Open(&in, text_path))
+        return false;
+    if (fopen_s(&out, data_path, "wb") != 0 || nullptr == out) {
+        MappedFile_Close(&in);
+        return false;
+    }
+    stats->bytes = in.size;
+
+    char const * text = (char const *)in.base;
+    split_chunks(text, text + in.size, &chunks);
+
+    if (0 == thread_count)
+        thread_count = std::thread::hardware_concurrency();
+    if (0 == thread_count)
+        thread_count = 1;
+
+    // -- parsers take chunks in order but may not get more than `window` ahead of the writer
+    std::mutex mtx;
+    std::condition_variable cv_parsed;     // a chunk is done
+    std::condition_variable cv_written;    // the writer moved on
+    size_t next_chunk = 0;
+    size_t written = 0;
+    size_t window = 2 * (size_t)thread_count;
+    bool stop = false;
+
+    auto parser = [&] () {
+        for (;;) {
+            size_t i;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv_written.wait(lock, [&] {
+                    return stop || next_chunk >= chunks.size() || next_chunk < written + window;
+                });
+                if (stop || next_chunk >= chunks.size())
+                    return;
+                i = next_chunk++;
+            }
+            parse_chunk(&chunks[i]);
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                chunks[i].done = true;
+            }
+            cv_parsed.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < thread_count; ++t)
+        threads.emplace_back(parser);
+
+    uint64_t line_base = 0;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        ImportChunk * c = &chunks[i];
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv_parsed.wait(lock, [&] { return c->done; });
+        }
+        if (ok && !c->records.empty())
+            ok = (c->records.size() == fwrite(c->records.data(), sizeof(Pirate), c->records.size(), out));
+        stats->records += c->records.size();
+        if (c->bad_lines && 0 == stats->bad_lines)
+            stats->first_bad_line = line_base + c->first_bad;
+        stats->bad_lines += c->bad_lines;
+        line_base += c->lines;
+
+        // -- release the chunk's records and let the parsers move on
+        std::vector<Pirate>().swap(c->records);
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            written = i + 1;
+            if (!ok)
+                stop = true;
+        }
+        cv_written.notify_all();
+        if (!ok)
+            break;
+    }
+
+    for (auto & t : threads)
+        t.join();
+    if (fclose(out))
+        ok = false;
+    MappedFile_Close(&in);
+    return ok;
+}
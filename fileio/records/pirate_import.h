@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "pirate.h"
+
+/*
+Text to record file importer.
+
+One pirate per line, fields separated by ',' (or a tab):
+    name,bounty,crew_count
+The name may be double-quoted (a doubled "" stands for a quote) and is cut
+to PIRATE_NAME_LEN - 1 characters. Empty lines are skipped; lines that do
+not parse are counted and skipped. Records come out in input order.
+
+The input is mapped and cut into newline-aligned chunks that are parsed
+by thread_count threads (0 means one per core); the calling thread writes
+finished chunks in order, parsers never run more than a few chunks ahead.
+*/
+
+struct PirateImportStats {
+    uint64_t    bytes;              // size of the input
+    uint64_t    records;            // # of records written
+    uint64_t    bad_lines;          // # of lines skipped as malformed
+    uint64_t    first_bad_line;     // 1-based line # of the first of them, 0 if none
+};
+
+bool
+PirateImport_Run (
+    char const * text_path, char const * data_path,
+    unsigned thread_count, PirateImportStats * stats
+);
@@ -0,0 +1,614 @@
+#include "pirate_index.h"
+#include "crt_compat.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#define INDEX_MAGIC "PIRIDX01"
+
+// =========================================================================================
+
+static void
+make_key (char * key, char const * name) {
+    // -- zero padding makes keys comparable with a plain memcmp
+    size_t len = strnlen(name, PIRATE_INDEX_KEY_LEN);
+    memcpy(key, name, len);
+    memset(key + len, 0, PIRATE_INDEX_KEY_LEN - len);
+}
+static bool
+entry_less (PirateIndexEntry const & a, PirateIndexEntry const & b) {
+    int c = memcmp(a.key, b.key, PIRATE_INDEX_KEY_LEN);
+    return (c != 0) ? (c < 0) : (a.record_no < b.record_no);
+}
+static bool
+replace_file (char const * from, char const * to) {
+#ifdef _WIN32
+    return FALSE != MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING);
+#else
+    return 0 == rename(from, to);
+#endif
+}
+/*
+Writes an index file of sorted entries as they come, so they need not all be
+in memory: the fences, known only once the entries have gone by, are written
+last into the space left for them after the header.
+The file is written under a temporary name and renamed over index_path,
+so a crash leaves either the old or the new index behind.
+*/
+struct IndexWriter {
+    FILE *              out;
+    PirateIndexHeader   hdr;
+    std::vector<char>   fences;
+    uint64_t            written;
+    bool                ok;
+    char                tmp_path[270];
+};
+
+static bool
+writer_open (IndexWriter * w, char const * index_path, uint64_t count) {
+    memset(&w->hdr, 0, sizeof(w->hdr));
+    memcpy(w->hdr.magic, INDEX_MAGIC, sizeof(w->hdr.magic));
+    w->hdr.key_len = PIRATE_INDEX_KEY_LEN;
+    w->hdr.record_size = sizeof(Pirate);
+    w->hdr.sorted_count = count;
+    w->hdr.fence_count = (count + PIRATE_INDEX_FENCE_STRIDE - 1) / PIRATE_INDEX_FENCE_STRIDE;
+    w->hdr.tail_count = 0;
+    w->fences.clear();
+    w->fences.reserve((size_t)w->hdr.fence_count * PIRATE_INDEX_KEY_LEN);
+    w->written = 0;
+    w->out = nullptr;
+
+    snprintf(w->tmp_path, sizeof(w->tmp_path), "%s.tmp", index_path);
+    if (fopen_s(&w->out, w->tmp_path, "wb") != 0 || nullptr == w->out)
+        return false;
+    long long entries_at =
+        (long long)(sizeof(PirateIndexHeader) + w->hdr.fence_count * PIRATE_INDEX_KEY_LEN);
+    w->ok = (0 == _fseeki64(w->out, entries_at, SEEK_SET));
+    return true;
+}
+static void
+writer_add (IndexWriter * w, PirateIndexEntry const * entries, size_t count) {
+    for (size_t i = 0; i < count; ++i)
+        if (0 == (w->written + i) % PIRATE_INDEX_FENCE_STRIDE)
+            w->fences.insert(w->fences.end(), entries[i].key, entries[i].key + PIRATE_INDEX_KEY_LEN);
+    if (w->ok && count)
+        w->ok = (count == fwrite(entries, sizeof(PirateIndexEntry), count, w->out));
+    w->written += count;
+}
+static bool
+writer_close (IndexWriter * w, char const * index_path) {
+    bool ok = w->ok && w->written == w->hdr.sorted_count;
+    if (ok)
+        ok = (0 == _fseeki64(w->out, 0, SEEK_SET)) &&
+            (1 == fwrite(&w->hdr, sizeof(w->hdr), 1, w->out)) &&
+            (w->fences.empty() || 1 == fwrite(w->fences.data(), w->fences.size(), 1, w->out));
+    if (fclose(w->out))
+        ok = false;
+    if (ok)
+        ok = replace_file(w->tmp_path, index_path);
+    if (!ok)
+        remove(w->tmp_path);
+    return ok;
+}
+/* A complete index file from sorted entries */
+static bool
+write_index (char const * index_path, std::vector<PirateIndexEntry> const & entries) {
+    IndexWriter w;
+    if (!writer_open(&w, index_path, entries.size()))
+        return false;
+    writer_add(&w, entries.data(), entries.size());
+    return writer_close(&w, index_path);
+}
+static bool
+map_index (PirateIndex * idx) {
+    if (!MappedFile_Open(&idx->index_file, idx->index_path))
+        return false;
+    if (!MappedFile_Open(&idx->data_file, idx->data_path)) {
+        MappedFile_Close(&idx->index_file);
+        return false;
+    }
+
+    // -- validate before trusting any of the counts
+    char const * base = (char const *)idx->index_file.base;
+    PirateIndexHeader const * hdr = (PirateIndexHeader const *)base;
+    bool ok =
+        idx->index_file.size >= sizeof(PirateIndexHeader) &&
+        0 == memcmp(hdr->magic, INDEX_MAGIC, sizeof(hdr->magic)) &&
+        PIRATE_INDEX_KEY_LEN == hdr->key_len &&
+        sizeof(Pirate) == hdr->record_size;
+    if (ok) {
+        uint64_t need =
+            sizeof(PirateIndexHeader) +
+            hdr->fence_count * PIRATE_INDEX_KEY_LEN +
+            (hdr->sorted_count + hdr->tail_count) * sizeof(PirateIndexEntry);
+        ok = need <= idx->index_file.size;
+    }
+    if (!ok) {
+        MappedFile_Close(&idx->data_file);
+        MappedFile_Close(&idx->index_file);
+        return false;
+    }
+
+    idx->hdr = hdr;
+    idx->fences = base + sizeof(PirateIndexHeader);
+    idx->sorted = (PirateIndexEntry const *)(idx->fences + hdr->fence_count * PIRATE_INDEX_KEY_LEN);
+    idx->tail = idx->sorted + hdr->sorted_count;
+    return true;
+}
+static void
+unmap_index (PirateIndex * idx) {
+    MappedFile_Close(&idx->data_file);
+    MappedFile_Close(&idx->index_file);
+    idx->hdr = nullptr;
+    idx->fences = nullptr;
+    idx->sorted = nullptr;
+    idx->tail = nullptr;
+}
+/*
+First sorted entry whose key is not less than key.
+The fences narrow the search down to a single stride of entries.
+*/
+static uint64_t
+lower_bound (PirateIndex const * idx, char const * key) {
+    uint64_t lo = 0, hi = idx->hdr->fence_count;
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (memcmp(idx->fences + mid * PIRATE_INDEX_KEY_LEN, key, PIRATE_INDEX_KEY_LEN) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    // -- fence[lo] is the first fence >= key, so the answer is in ((lo - 1) * stride, lo * stride]
+    uint64_t first = (lo > 0) ? (lo - 1) * PIRATE_INDEX_FENCE_STRIDE + 1 : 0;
+    uint64_t last = std::min<uint64_t>(lo * PIRATE_INDEX_FENCE_STRIDE, idx->hdr->sorted_count);
+    while (first < last) {
+        uint64_t mid = first + (last - first) / 2;
+        if (memcmp(idx->sorted[mid].key, key, PIRATE_INDEX_KEY_LEN) < 0)
+            first = mid + 1;
+        else
+            last = mid;
+    }
+    return first;
+}
+static bool
+name_matches (PirateIndex const * idx, uint64_t record_no, char const * name, size_t len, bool prefix) {
+    Pirate const * p = PirateIndex_Record(idx, record_no);
+    if (nullptr == p)
+        return false;
+    if (prefix)
+        return 0 == strncmp(p->name, name, len);
+    return 0 == strncmp(p->name, name, PIRATE_NAME_LEN);
+}
+
+// =========================================================================================
+
+#pragma region external sort
+/*
+PirateIndex_Build sorts entries in runs of INDEX_RUN_ENTRIES, spills each
+run to a temporary file next to the index, and merges the runs
+INDEX_MERGE_WAYS at a time, each pass into fewer and longer runs, the last
+one straight into the index. A file that fits in one run never touches disk
+but for the index itself. PirateIndex_Append merges its tail the same way,
+with the old index's sorted section as the other input.
+*/
+#ifndef INDEX_RUN_ENTRIES
+#define INDEX_RUN_ENTRIES   (1 << 20)   // 32 MB of entries
+#endif
+#define INDEX_MERGE_WAYS    64          // open run files at most
+#define INDEX_MERGE_BUFFER  4096        // entries read or written at a time
+
+static void
+run_path (char * path, size_t size, char const * index_path, unsigned pass, uint64_t run) {
+    snprintf(path, size, "%s.run%u.%llu", index_path, pass, (unsigned long long)run);
+}
+static void
+remove_runs (char const * index_path, unsigned pass, uint64_t first, uint64_t count) {
+    char path[300];
+    for (uint64_t i = first; i < first + count; ++i) {
+        run_path(path, sizeof(path), index_path, pass, i);
+        remove(path);
+    }
+}
+static bool
+spill_run (char const * index_path, uint64_t run, std::vector<PirateIndexEntry> & entries) {
+    char path[300];
+    FILE * out = nullptr;
+    run_path(path, sizeof(path), index_path, 0, run);
+    if (fopen_s(&out, path, "wb") != 0 || nullptr == out)
+        return false;
+    std::sort(entries.begin(), entries.end(), entry_less);
+    bool ok = (entries.size() == fwrite(entries.data(), sizeof(PirateIndexEntry), entries.size(), out));
+    if (fclose(out))
+        ok = false;
+    return ok;
+}
+
+/* Where a merge puts its output: a longer run, or the index itself */
+typedef bool (*MergeSinkFn) (void * ctx, PirateIndexEntry const * entries, size_t count);
+
+static bool
+sink_file (void * ctx, PirateIndexEntry const * entries, size_t count) {
+    return count == fwrite(entries, sizeof(PirateIndexEntry), count, (FILE *)ctx);
+}
+static bool
+sink_index (void * ctx, PirateIndexEntry const * entries, size_t count) {
+    IndexWriter * w = (IndexWriter *)ctx;
+    writer_add(w, entries, count);
+    return w->ok;
+}
+
+/*
+One sorted input of a merge: a run file, a stretch of the index file
+(left entries from where in stands), or, with no file, entries already in buf.
+*/
+struct MergeInput {
+    FILE *                          in;
+    std::vector<PirateIndexEntry>   buf;
+    size_t                          pos;
+    size_t                          len;
+    uint64_t                        left;
+};
+
+/* The next entry of an input into its buffer; false at its end or on a read error */
+static bool
+merge_refill (MergeInput * m) {
+    if (m->pos < m->len)
+        return true;
+    if (nullptr == m->in || 0 == m->left)
+        return false;
+    size_t want = (size_t)std::min<uint64_t>(m->buf.size(), m->left);
+    m->len = fread(m->buf.data(), sizeof(PirateIndexEntry), want, m->in);
+    m->left -= m->len;
+    m->pos = 0;
+    return m->len > 0;
+}
+
+/* Merges the inputs into fn and closes their files; false if a read or fn failed */
+static bool
+merge_inputs (std::vector<MergeInput> & inputs, MergeSinkFn fn, void * ctx) {
+    std::vector<size_t> heap;
+    std::vector<PirateIndexEntry> out;
+    bool ok = true;
+
+    for (size_t i = 0; i < inputs.size(); ++i)
+        if (merge_refill(&inputs[i]))
+            heap.push_back(i);
+
+    // -- a min-heap of the inputs by their current entry
+    auto after = [&inputs] (size_t a, size_t b) {
+        return entry_less(inputs[b].buf[inputs[b].pos], inputs[a].buf[inputs[a].pos]);
+    };
+    std::make_heap(heap.begin(), heap.end(), after);
+    out.reserve(INDEX_MERGE_BUFFER);
+    while (ok && !heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), after);
+        MergeInput * m = &inputs[heap.back()];
+        out.push_back(m->buf[m->pos++]);
+        if (merge_refill(m))
+            std::push_heap(heap.begin(), heap.end(), after);
+        else
+            heap.pop_back();
+        if (out.size() == INDEX_MERGE_BUFFER) {
+            ok = fn(ctx, out.data(), out.size());
+            out.clear();
+        }
+    }
+    if (ok && !out.empty())
+        ok = fn(ctx, out.data(), out.size());
+
+    for (auto & m : inputs) {
+        if (m.in != nullptr) {
+            ok = ok && !ferror(m.in);
+            fclose(m.in);
+            m.in = nullptr;
+        }
+    }
+    return ok;
+}
+
+/* Merges runs [first, first + count) of pass into fn, removing them */
+static bool
+merge_runs (
+    char const * index_path, unsigned pass, uint64_t first, uint64_t count,
+    MergeSinkFn fn, void * ctx
+) {
+    std::vector<MergeInput> inputs((size_t)count);
+    char path[300];
+    bool ok = true;
+
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        MergeInput * m = &inputs[i];
+        m->in = nullptr;
+        m->pos = m->len = 0;
+        m->left = UINT64_MAX;
+        run_path(path, sizeof(path), index_path, pass, first + i);
+        if (ok) {
+            m->buf.resize(INDEX_MERGE_BUFFER);
+            ok = (0 == fopen_s(&m->in, path, "rb") && m->in != nullptr);
+        }
+    }
+    if (ok) {
+        ok = merge_inputs(inputs, fn, ctx);
+    } else {
+        for (auto & m : inputs)
+            if (m.in != nullptr)
+                fclose(m.in);
+    }
+    remove_runs(index_path, pass, first, count);
+    return ok;
+}
+
+/* Merges pass 0's runs down to one pass of at most INDEX_MERGE_WAYS, then into the index */
+static bool
+merge_into_index (char const * index_path, uint64_t runs, uint64_t total) {
+    unsigned pass = 0;
+    bool ok = true;
+
+    while (ok && runs > INDEX_MERGE_WAYS) {
+        uint64_t n_out = 0;
+        for (uint64_t first = 0; first < runs; first += INDEX_MERGE_WAYS, ++n_out) {
+            uint64_t count = std::min<uint64_t>(INDEX_MERGE_WAYS, runs - first);
+            char path[300];
+            FILE * out = nullptr;
+            run_path(path, sizeof(path), index_path, pass + 1, n_out);
+            ok = ok && (0 == fopen_s(&out, path, "wb") && out != nullptr);
+            if (ok)
+                ok = merge_runs(index_path, pass, first, count, sink_file, out);
+            else
+                remove_runs(index_path, pass, first, count);
+            if (out != nullptr && fclose(out))
+                ok = false;
+        }
+        if (!ok)
+            remove_runs(index_path, pass + 1, 0, n_out);
+        runs = n_out;
+        ++pass;
+    }
+    if (!ok)
+        return false;
+
+    IndexWriter w;
+    if (!writer_open(&w, index_path, total)) {
+        remove_runs(index_path, pass, 0, runs);
+        return false;
+    }
+    ok = merge_runs(index_path, pass, 0, runs, sink_index, &w);
+    return writer_close(&w, index_path) && ok;
+}
+/*
+Merges the sorted section of the index at index_path with tail, sorted, into
+a new index with no tail. The sorted section streams from the file, so only
+the tail is in memory.
+*/
+static bool
+merge_tail (char const * index_path, PirateIndexHeader const * hdr, std::vector<PirateIndexEntry> & tail) {
+    std::vector<MergeInput> inputs(2);
+    MergeInput * sorted = &inputs[0];
+    MergeInput * added = &inputs[1];
+    uint64_t total = hdr->sorted_count + tail.size();
+
+    sorted->in = nullptr;
+    sorted->buf.resize(INDEX_MERGE_BUFFER);
+    sorted->pos = sorted->len = 0;
+    sorted->left = hdr->sorted_count;
+    added->in = nullptr;
+    added->buf.swap(tail);
+    added->pos = 0;
+    added->len = added->buf.size();
+    added->left = 0;
+
+    if (fopen_s(&sorted->in, index_path, "rb") != 0 || nullptr == sorted->in)
+        return false;
+    long long sorted_at = (long long)(sizeof(PirateIndexHeader) + hdr->fence_count * PIRATE_INDEX_KEY_LEN);
+    IndexWriter w;
+    if (0 != _fseeki64(sorted->in, sorted_at, SEEK_SET) || !writer_open(&w, index_path, total)) {
+        fclose(sorted->in);
+        return false;
+    }
+    // -- the inputs are closed by then, so the new index can replace the old one
+    bool ok = merge_inputs(inputs, sink_index, &w);
+    return writer_close(&w, index_path) && ok;
+}
+#pragma endregion
+
+// =========================================================================================
+
+bool
+PirateIndex_Build (char const * data_path, char const * index_path) {
+    FILE * in = nullptr;
+    std::vector<PirateIndexEntry> entries;
+    std::vector<Pirate> chunk(4096);
+    uint64_t record_no = 0;
+    uint64_t runs = 0;
+    size_t n_read = 0;
+    bool ok = true;
+
+    if (fopen_s(&in, data_path, "rb") != 0 || nullptr == in)
+        return false;
+
+    // -- single sequential pass: names are only ever read once
+    while (ok && (n_read = fread(chunk.data(), sizeof(Pirate), chunk.size(), in)) > 0) {
+        for (size_t i = 0; ok && i < n_read; ++i) {
+            PirateIndexEntry e;
+            make_key(e.key, chunk[i].name);
+            e.record_no = record_no++;
+            entries.push_back(e);
+            if (INDEX_RUN_ENTRIES == entries.size()) {
+                ok = spill_run(index_path, runs++, entries);
+                entries.clear();
+            }
+        }
+    }
+    ok = ok && !ferror(in);
+    fclose(in);
+
+    // -- it all fit in memory: no runs
+    if (ok && 0 == runs) {
+        std::sort(entries.begin(), entries.end(), entry_less);
+        return write_index(index_path, entries);
+    }
+    if (ok && !entries.empty())
+        ok = spill_run(index_path, runs++, entries);
+    if (!ok) {
+        remove_runs(index_path, 0, 0, runs);
+        return false;
+    }
+    std::vector<PirateIndexEntry>().swap(entries);
+    return merge_into_index(index_path, runs, record_no);
+}
+bool
+PirateIndex_Open (PirateIndex * idx, char const * data_path, char const * index_path) {
+    memset(idx, 0, sizeof(*idx));
+    snprintf(idx->data_path, sizeof(idx->data_path), "%s", data_path);
+    snprintf(idx->index_path, sizeof(idx->index_path), "%s", index_path);
+    return map_index(idx);
+}
+void
+PirateIndex_Close (PirateIndex * idx) {
+    unmap_index(idx);
+}
+uint64_t
+PirateIndex_Count (PirateIndex const * idx) {
+    if (nullptr == idx->hdr)
+        return 0;
+    return idx->hdr->sorted_count + idx->hdr->tail_count;
+}
+Pirate const *
+PirateIndex_Record (PirateIndex const * idx, uint64_t record_no) {
+    if ((record_no + 1) * sizeof(Pirate) > idx->data_file.size)
+        return nullptr;
+    return (Pirate const *)idx->data_file.base + record_no;
+}
+int64_t
+PirateIndex_Find (PirateIndex const * idx, char const * name) {
+    char key[PIRATE_INDEX_KEY_LEN];
+    size_t len = strnlen(name, PIRATE_NAME_LEN);
+    if (nullptr == idx->hdr)
+        return -1;
+    // -- shorter names are stored whole in the key, no need to touch the records
+    bool need_check = len >= PIRATE_INDEX_KEY_LEN;
+
+    make_key(key, name);
+    for (uint64_t i = lower_bound(idx, key); i < idx->hdr->sorted_count; ++i) {
+        PirateIndexEntry const * e = &idx->sorted[i];
+        if (memcmp(e->key, key, PIRATE_INDEX_KEY_LEN) != 0)
+            break;
+        if (!need_check || name_matches(idx, e->record_no, name, len, false))
+            return (int64_t)e->record_no;
+    }
+    // -- appended records always come after the sorted ones
+    for (uint64_t i = 0; i < idx->hdr->tail_count; ++i) {
+        PirateIndexEntry const * e = &idx->tail[i];
+        if (0 == memcmp(e->key, key, PIRATE_INDEX_KEY_LEN) &&
+            (!need_check || name_matches(idx, e->record_no, name, len, false)))
+            return (int64_t)e->record_no;
+    }
+    return -1;
+}
+uint64_t
+PirateIndex_FindPrefix (
+    PirateIndex const * idx, char const * prefix,
+    uint64_t * out, uint64_t max_out
+) {
+    char key[PIRATE_INDEX_KEY_LEN];
+    size_t len = strnlen(prefix, PIRATE_NAME_LEN);
+    size_t key_part = std::min<size_t>(len, PIRATE_INDEX_KEY_LEN);
+    bool need_check = len > PIRATE_INDEX_KEY_LEN;
+    uint64_t n = 0;
+    if (nullptr == idx->hdr)
+        return 0;
+
+    // -- zero padding sorts first, so the padded prefix is the lower bound of its range
+    make_key(key, prefix);
+    for (uint64_t i = lower_bound(idx, key); i < idx->hdr->sorted_count; ++i) {
+        PirateIndexEntry const * e = &idx->sorted[i];
+        if (memcmp(e->key, key, key_part) != 0)
+            break;
+        if (!need_check || name_matches(idx, e->record_no, prefix, len, true)) {
+            if (n < max_out)
+                out[n] = e->record_no;
+            ++n;
+        }
+    }
+    for (uint64_t i = 0; i < idx->hdr->tail_count; ++i) {
+        PirateIndexEntry const * e = &idx->tail[i];
+        if (0 == memcmp(e->key, key, key_part) &&
+            (!need_check || name_matches(idx, e->record_no, prefix, len, true))) {
+            if (n < max_out)
+                out[n] = e->record_no;
+            ++n;
+        }
+    }
+    return n;
+}
+bool
+PirateIndex_Append (PirateIndex * idx, Pirate const * pirates, size_t count) {
+    FILE * data = nullptr;
+    FILE * index = nullptr;
+    if (nullptr == idx->hdr)
+        return false;
+    uint64_t first_no = idx->data_file.size / sizeof(Pirate);
+    PirateIndexHeader hdr = *idx->hdr;
+    std::vector<PirateIndexEntry> tail;
+    bool ok = true;
+
+    // -- appending to the tail could push it over the limit: keep the old tail for the merge
+    bool merge = hdr.tail_count + count > PIRATE_INDEX_TAIL_MAX;
+    if (merge) {
+        tail.assign(idx->tail, idx->tail + hdr.tail_count);
+        for (size_t i = 0; i < count; ++i) {
+            PirateIndexEntry e;
+            make_key(e.key, pirates[i].name);
+            e.record_no = first_no + i;
+            tail.push_back(e);
+        }
+        std::sort(tail.begin(), tail.end(), entry_less);
+    }
+
+    // -- the views must go before the files can be extended or replaced
+    unmap_index(idx);
+
+    // -- records first: an index entry must never point past the end of the data
+    if (fopen_s(&data, idx->data_path, "ab") != 0 || nullptr == data) {
+        map_index(idx);
+        return false;
+    }
+    ok = (count == fwrite(pirates, sizeof(Pirate), count, data));
+    if (fclose(data))
+        ok = false;
+
+    if (ok && merge) {
+        ok = merge_tail(idx->index_path, &hdr, tail);
+    } else if (ok) {
+        if (fopen_s(&index, idx->index_path, "r+b") != 0 || nullptr == index) {
+            map_index(idx);
+            return false;
+        }
+
+        // -- entries go past the current tail, then the header publishes them
+        long long tail_end =
+            (long long)(sizeof(PirateIndexHeader) +
+            hdr.fence_count * PIRATE_INDEX_KEY_LEN +
+            (hdr.sorted_count + hdr.tail_count) * sizeof(PirateIndexEntry));
+        ok = (0 == _fseeki64(index, tail_end, SEEK_SET));
+        for (size_t i = 0; ok && i < count; ++i) {
+            PirateIndexEntry e;
+            make_key(e.key, pirates[i].name);
+            e.record_no = first_no + i;
+            ok = (1 == fwrite(&e, sizeof(e), 1, index));
+        }
+        if (ok) {
+            hdr.tail_count += count;
+            ok = (0 == fflush(index)) &&
+                (0 == _fseeki64(index, 0, SEEK_SET)) &&
+                (1 == fwrite(&hdr, sizeof(hdr), 1, index));
+        }
+        if (fclose(index))
+            ok = false;
+    }
+
+    return map_index(idx) && ok;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pirate.h"
+#include "mapped_file.h"
+
+/*
+Secondary index on Pirate.name.
+
+The index file is meant to be mapped, not loaded:
+    | header | fence keys | sorted entries | tail entries |
+Sorted entries are (key, record #) pairs ordered by key, where key is the
+first PIRATE_INDEX_KEY_LEN bytes of the name (zero padded). Names that do not
+fit in the key are confirmed against the mapped record file.
+Every PIRATE_INDEX_FENCE_STRIDE-th key is repeated in a compact fence array,
+so a lookup binary-searches a few pages of fences and then one small window.
+Appended records go to the unsorted tail; once the tail grows past
+PIRATE_INDEX_TAIL_MAX it is sorted and merged with the sorted section as
+that streams from the old file, so an append holds only the tail in memory.
+*/
+
+#define PIRATE_INDEX_KEY_LEN        24
+#define PIRATE_INDEX_FENCE_STRIDE   256
+#define PIRATE_INDEX_TAIL_MAX       4096
+
+struct PirateIndexHeader {
+    char        magic[8];       // "PIRIDX01"
+    uint32_t    key_len;        // PIRATE_INDEX_KEY_LEN at build time
+    uint32_t    record_size;    // sizeof(Pirate) at build time
+    uint64_t    sorted_count;   // # of entries in the sorted section
+    uint64_t    fence_count;    // # of fence keys
+    uint64_t    tail_count;     // # of unsorted entries after the sorted section
+};
+
+struct PirateIndexEntry {
+    char        key[PIRATE_INDEX_KEY_LEN];
+    uint64_t    record_no;
+};
+
+struct PirateIndex {
+    MappedFile                  index_file;
+    MappedFile                  data_file;
+    PirateIndexHeader const *   hdr;
+    char const *                fences;     // fence_count keys of key_len bytes
+    PirateIndexEntry const *    sorted;
+    PirateIndexEntry const *    tail;
+    char                        index_path[260];
+    char                        data_path[260];
+};
+
+/*
+Build the index of a record file in one streaming pass over it.
+Entries are sorted in bounded runs, spilled next to the index and merged
+when they do not fit in one, so memory does not grow with the file.
+Returns false (errno/GetLastError tell why) if either file cannot be used.
+*/
+bool
+PirateIndex_Build (char const * data_path, char const * index_path);
+
+bool
+PirateIndex_Open (PirateIndex * idx, char const * data_path, char const * index_path);
+
+void
+PirateIndex_Close (PirateIndex * idx);
+
+/* Number of records covered by the index */
+uint64_t
+PirateIndex_Count (PirateIndex const * idx);
+
+/* Record #n of the mapped record file, nullptr if out of range */
+Pirate const *
+PirateIndex_Record (PirateIndex const * idx, uint64_t record_no);
+
+/*
+Exact lookup.
+Returns the lowest record # whose name equals name, -1 if there is none.
+*/
+int64_t
+PirateIndex_Find (PirateIndex const * idx, char const * name);
+
+/*
+Prefix lookup.
+Stores up to max_out matching record #s in out (sorted section first,
+then appended records) and returns the total # of matches.
+*/
+uint64_t
+PirateIndex_FindPrefix (
+    PirateIndex const * idx, char const * prefix,
+    uint64_t * out, uint64_t max_out
+);
+
+/*
+Append records to the record file and keep the index in sync.
+The index stays open and is remapped to see the new records. If it cannot
+be remapped, this returns false and the index is left closed: lookups
+find nothing and appends fail until it is opened again.
+*/
+bool
+PirateIndex_Append (PirateIndex * idx, Pirate const * pirates, size_t count);
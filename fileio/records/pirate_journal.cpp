@@ -0,0 +1,316 @@
+#include "pirate_journal.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define BATCH_MAGIC 0x31424A50u     // "PJB1"
+
+struct BatchHeader {
+    uint32_t    magic;
+    uint32_t    count;              // # of records following the header
+    uint64_t    ticket;
+    uint64_t    first_record;       // record # of the first record in the batch
+    uint64_t    checksum;           // FNV-1a of the fields above and the records
+};
+
+// =========================================================================================
+
+#pragma region raw file helpers
+#ifdef _WIN32
+static intptr_t
+file_open (char const * path) {
+    HANDLE h = CreateFileA(
+        path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL,
+        OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL
+    );
+    return (INVALID_HANDLE_VALUE == h) ? -1 : (intptr_t)h;
+}
+static void
+file_close (intptr_t f) {
+    CloseHandle((HANDLE)f);
+}
+static bool
+file_size (intptr_t f, uint64_t * size) {
+    LARGE_INTEGER li;
+    if (!GetFileSizeEx((HANDLE)f, &li))
+        return false;
+    *size = (uint64_t)li.QuadPart;
+    return true;
+}
+static bool
+file_pwrite (intptr_t f, void const * buf, size_t len, uint64_t offset) {
+    // -- with a synchronous handle, OVERLAPPED only carries the position
+    OVERLAPPED ov = {};
+    DWORD n_written = 0;
+    ov.Offset = (DWORD)offset;
+    ov.OffsetHigh = (DWORD)(offset >> 32);
+    return WriteFile((HANDLE)f, buf, (DWORD)len, &n_written, &ov) && n_written == len;
+}
+static bool
+file_pread (intptr_t f, void * buf, size_t len, uint64_t offset) {
+    OVERLAPPED ov = {};
+    DWORD n_read = 0;
+    ov.Offset = (DWORD)offset;
+    ov.OffsetHigh = (DWORD)(offset >> 32);
+    return ReadFile((HANDLE)f, buf, (DWORD)len, &n_read, &ov) && n_read == len;
+}
+static bool
+file_sync (intptr_t f) {
+    return FALSE != FlushFileBuffers((HANDLE)f);
+}
+static bool
+file_truncate (intptr_t f, uint64_t size) {
+    LARGE_INTEGER li;
+    li.QuadPart = (LONGLONG)size;
+    return SetFilePointerEx((HANDLE)f, li, NULL, FILE_BEGIN) && SetEndOfFile((HANDLE)f);
+}
+#else   // POSIX
+static intptr_t
+file_open (char const * path) {
+    return open(path, O_RDWR | O_CREAT, 0644);
+}
+static void
+file_close (intptr_t f) {
+    close((int)f);
+}
+static bool
+file_size (intptr_t f, uint64_t * size) {
+    struct stat st;
+    if (fstat((int)f, &st) != 0)
+        return false;
+    *size = (uint64_t)st.st_size;
+    return true;
+}
+static bool
+file_pwrite (intptr_t f, void const * buf, size_t len, uint64_t offset) {
+    char const * p = (char const *)buf;
+    while (len > 0) {
+        ssize_t n = pwrite((int)f, p, len, (off_t)offset);
+        if (n <= 0)
+            return false;
+        p += n;
+        len -= (size_t)n;
+        offset += (uint64_t)n;
+    }
+    return true;
+}
+static bool
+file_pread (intptr_t f, void * buf, size_t len, uint64_t offset) {
+    return pread((int)f, buf, len, (off_t)offset) == (ssize_t)len;
+}
+static bool
+file_sync (intptr_t f) {
+    return 0 == fsync((int)f);
+}
+static bool
+file_truncate (intptr_t f, uint64_t size) {
+    return 0 == ftruncate((int)f, (off_t)size);
+}
+#endif
+#pragma endregion
+
+static uint64_t
+fnv1a (uint64_t h, void const * data, size_t len) {
+    uint8_t const * p = (uint8_t const *)data;
+    for (size_t i = 0; i < len; ++i) {
+        h ^= p[i];
+        h *= 0x100000001B3ULL;
+    }
+    return h;
+}
+static uint64_t
+batch_checksum (BatchHeader const * b, Pirate const * pirates) {
+    uint64_t h = 0xCBF29CE484222325ULL;
+    h = fnv1a(h, b, offsetof(BatchHeader, checksum));
+    return fnv1a(h, pirates, (size_t)b->count * sizeof(Pirate));
+}
+/*
+Make the record file match the journal: re-apply every complete batch,
+then sync the record file and empty the journal.
+*/
+static bool
+replay (PirateJournal * j) {
+    uint64_t wal_size, data_size, offset = 0;
+    std::vector<Pirate> records;
+
+    if (!file_size(j->wal_file, &wal_size) || !file_size(j->data_file, &data_size))
+        return false;
+    uint64_t count = data_size / sizeof(Pirate);
+
+    while (offset + sizeof(BatchHeader) <= wal_size) {
+        BatchHeader b;
+        if (!file_pread(j->wal_file, &b, sizeof(b), offset) || BATCH_MAGIC != b.magic)
+            break;
+        uint64_t bytes = (uint64_t)b.count * sizeof(Pirate);
+        if (offset + sizeof(b) + bytes > wal_size)
+            break;      // torn batch: never acknowledged
+        records.resize(b.count);
+        if (!file_pread(j->wal_file, records.data(), (size_t)bytes, offset + sizeof(b)))
+            return false;
+        if (batch_checksum(&b, records.data()) != b.checksum)
+            break;
+        if (!file_pwrite(j->data_file, records.data(), (size_t)bytes, b.first_record * sizeof(Pirate)))
+            return false;
+        if (b.first_record + b.count > count)
+            count = b.first_record + b.count;
+        offset += sizeof(b) + bytes;
+    }
+
+    // -- drop a partial record left by a write that never reached the journal
+    j->record_count = count;
+    return file_truncate(j->data_file, count * sizeof(Pirate)) &&
+        file_sync(j->data_file) &&
+        file_truncate(j->wal_file, 0) &&
+        file_sync(j->wal_file);
+}
+static bool
+checkpoint (PirateJournal * j) {
+    if (!file_sync(j->data_file) || !file_truncate(j->wal_file, 0) || !file_sync(j->wal_file))
+        return false;
+    j->wal_size = 0;
+    return true;
+}
+static void
+flusher_func (PirateJournal * j) {
+    std::vector<Pirate> batch;
+    std::vector<uint8_t> buf;
+
+    for (;;) {
+        BatchHeader b = {};
+        {
+            std::unique_lock<std::mutex> lock(j->mtx);
+            j->cv_queued.wait(lock, [j] { return j->stop || !j->queued.empty(); });
+            if (j->queued.empty())
+                break;      // stopping and nothing left to commit
+
+            // -- take everything queued so far as one batch
+            batch.swap(j->queued);
+            b.ticket = j->queued_ticket++;
+            b.first_record = j->queued_first;
+            j->queued_first += batch.size();
+        }
+        j->cv_durable.notify_all();     // appenders held back by max_batch may queue again
+
+        b.magic = BATCH_MAGIC;
+        b.count = (uint32_t)batch.size();
+        b.checksum = batch_checksum(&b, batch.data());
+
+        // -- one write and one sync for the whole batch
+        size_t bytes = batch.size() * sizeof(Pirate);
+        buf.resize(sizeof(b) + bytes);
+        memcpy(buf.data(), &b, sizeof(b));
+        memcpy(buf.data() + sizeof(b), batch.data(), bytes);
+        bool ok =
+            file_pwrite(j->wal_file, buf.data(), buf.size(), j->wal_size) &&
+            file_sync(j->wal_file);
+
+        // -- durable now; the record file copy may lag until the next checkpoint
+        if (ok) {
+            j->wal_size += buf.size();
+            ok = file_pwrite(j->data_file, batch.data(), bytes, b.first_record * sizeof(Pirate));
+        }
+        if (ok && j->wal_size >= PIRATE_JOURNAL_CHECKPOINT)
+            ok = checkpoint(j);
+        batch.clear();
+
+        {
+            std::lock_guard<std::mutex> lock(j->mtx);
+            if (ok)
+                j->durable_ticket = b.ticket;
+            else
+                j->failed = true;
+            ++j->batches;
+        }
+        j->cv_durable.notify_all();
+        if (!ok)
+            break;
+    }
+}
+
+// =========================================================================================
+
+bool
+PirateJournal_Open (PirateJournal * j, char const * data_path, size_t max_batch) {
+    char wal_path[270];
+    snprintf(wal_path, sizeof(wal_path), "%s.wal", data_path);
+
+    j->data_file = file_open(data_path);
+    if (j->data_file < 0)
+        return false;
+    j->wal_file = file_open(wal_path);
+    if (j->wal_file < 0) {
+        file_close(j->data_file);
+        return false;
+    }
+    if (!replay(j)) {
+        file_close(j->wal_file);
+        file_close(j->data_file);
+        return false;
+    }
+
+    j->wal_size = 0;
+    j->max_batch = (max_batch > 0) ? max_batch : 1;
+    j->queued.clear();
+    j->queued_first = j->record_count;
+    j->queued_ticket = 1;
+    j->durable_ticket = 0;
+    j->batches = 0;
+    j->failed = false;
+    j->stop = false;
+    j->flusher = std::thread(flusher_func, j);
+    return true;
+}
+bool
+PirateJournal_Close (PirateJournal * j) {
+    {
+        std::lock_guard<std::mutex> lock(j->mtx);
+        j->stop = true;
+    }
+    j->cv_queued.notify_one();
+    j->flusher.join();
+
+    bool ok = !j->failed && checkpoint(j);
+    file_close(j->wal_file);
+    file_close(j->data_file);
+    return ok;
+}
+PirateTicket
+PirateJournal_AppendAsync (
+    PirateJournal * j, Pirate const * pirates, size_t count, uint64_t * first_record
+) {
+    PirateTicket ticket;
+    {
+        std::unique_lock<std::mutex> lock(j->mtx);
+        // -- a full batch waits for the flusher to take it
+        j->cv_durable.wait(lock, [j, count] {
+            return j->failed || j->queued.empty() || j->queued.size() + count <= j->max_batch;
+        });
+        if (first_record)
+            *first_record = j->record_count;
+        j->record_count += count;
+        j->queued.insert(j->queued.end(), pirates, pirates + count);
+        ticket = j->queued_ticket;
+    }
+    j->cv_queued.notify_one();
+    return ticket;
+}
+bool
+PirateJournal_Wait (PirateJournal * j, PirateTicket ticket) {
+    std::unique_lock<std::mutex> lock(j->mtx);
+    j->cv_durable.wait(lock, [j, ticket] { return j->failed || j->durable_ticket >= ticket; });
+    return j->durable_ticket >= ticket;
+}
+bool
+PirateJournal_Append (
+    PirateJournal * j, Pirate const * pirates, size_t count, uint64_t * first_record
+) {
+    return PirateJournal_Wait(j, PirateJournal_AppendAsync(j, pirates, count, first_record));
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "pirate.h"
+
+/*
+Durable appends to a record file through a write-ahead journal.
+
+Appenders only queue records. A single flusher thread takes everything
+queued so far as one batch, writes it to <data>.wal with one write,
+syncs the journal (fsync / FlushFileBuffers) and only then marks the
+batch durable and copies it into the record file. Many appenders thus
+share one sync: group commit.
+
+Each journal batch carries a checksum and the record # it starts at.
+Opening the journal replays every complete batch into the record file
+(a torn last batch was never acknowledged and is dropped), so records
+that were reported durable survive a crash. Once the journal grows past
+PIRATE_JOURNAL_CHECKPOINT bytes the record file is synced and the
+journal truncated.
+*/
+
+#define PIRATE_JOURNAL_CHECKPOINT   (64u << 20)
+
+typedef uint64_t PirateTicket;
+
+struct PirateJournal {
+    intptr_t                data_file;      // native handle / descriptor
+    intptr_t                wal_file;
+    uint64_t                wal_size;       // bytes in the journal since the last checkpoint
+    uint64_t                record_count;   // records in the file, durable or queued
+    size_t                  max_batch;      // most records committed by one sync
+
+    std::mutex              mtx;
+    std::condition_variable cv_queued;      // appenders -> flusher
+    std::condition_variable cv_durable;     // flusher -> appenders (batch taken or durable)
+    std::vector<Pirate>     queued;         // records waiting for the next batch
+    uint64_t                queued_first;   // record # of queued[0]
+    PirateTicket            queued_ticket;  // ticket of the batch being queued
+    PirateTicket            durable_ticket; // every batch up to this one is durable
+    uint64_t                batches;        // # of syncs so far
+    bool                    failed;         // an I/O error stopped the flusher
+    bool                    stop;
+    std::thread             flusher;
+};
+
+/*
+Open (or create) data_path for durable appends, replaying <data_path>.wal first.
+max_batch caps the # of records per sync; 1 gives one sync per record.
+*/
+bool
+PirateJournal_Open (PirateJournal * j, char const * data_path, size_t max_batch);
+
+/* Flush what is queued, checkpoint and stop the flusher */
+bool
+PirateJournal_Close (PirateJournal * j);
+
+/*
+Queue records and return at once.
+The returned ticket completes when the records are durable.
+*/
+PirateTicket
+PirateJournal_AppendAsync (
+    PirateJournal * j, Pirate const * pirates, size_t count, uint64_t * first_record
+);
+
+/* Block until the batch of ticket is durable; false if the journal failed */
+bool
+PirateJournal_Wait (PirateJournal * j, PirateTicket ticket);
+
+/* AppendAsync + Wait */
+bool
+PirateJournal_Append (
+    PirateJournal * j, Pirate const * pirates, size_t count, uint64_t * first_record
+);
@@ -0,0 +1,582 @@
+/* ===========================================================
+   #File: records_main.cpp #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Tooling around Pirate record files written by the stdio sample #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "crt_compat.h"
+#include "pirate.h"
+#include "pirate_block.h"
+#include "pirate_import.h"
+#include "pirate_index.h"
+#include "pirate_journal.h"
+
+// =========================================================================================
+
+static char const * g_first_names [] = {
+    "Edward", "Anne", "Mary", "Bartholomew", "Henry", "Jack", "William",
+    "Charles", "Francis", "Grace", "Ching", "Olivier", "Stede", "Samuel"
+};
+static char const * g_last_names [] = {
+    "Teach", "Bonny", "Read", "Roberts", "Morgan", "Rackham", "Kidd",
+    "Vane", "Drake", "O'Malley", "Shih", "Levasseur", "Bonnet", "Bellamy"
+};
+
+static uint64_t
+next_rand (uint64_t * state) {
+    // -- xorshift64*, plenty for synthetic data
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+static void
+make_pirate (Pirate * p, uint64_t n, uint64_t * rng) {
+    uint64_t r = next_rand(rng);
+    memset(p, 0, sizeof(*p));
+    snprintf(
+        p->name, sizeof(p->name), "%s %s %llu",
+        g_first_names[r % _countof(g_first_names)],
+        g_last_names[(r >> 8) % _countof(g_last_names)],
+        (unsigned long long)n
+    );
+    p->bounty = (uint32_t)((r >> 16) % 5000000);
+    p->crew_count = (uint32_t)((r >> 40) % 500);
+}
+static double
+seconds_since (std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+static void
+print_pirate (uint64_t record_no, Pirate const * p) {
+    printf(
+        "#%llu  Name = \"%.*s\",   Bounty = $%u,   Crew size = %u members\n",
+        (unsigned long long)record_no, PIRATE_NAME_LEN, p->name, p->bounty, p->crew_count
+    );
+}
+
+// =========================================================================================
+
+#pragma region gen
+static int
+cmd_gen (char const * data_path, uint64_t count) {
+    FILE * out = nullptr;
+    std::vector<Pirate> chunk(4096);
+    uint64_t rng = 0x9E3779B97F4A7C15ULL;
+
+    if (fopen_s(&out, data_path, "wb") != 0 || nullptr == out) {
+        perror("fopen");
+        return 1;
+    }
+    for (uint64_t n = 0; n < count;) {
+        size_t batch = (size_t)((count - n < chunk.size()) ? count - n : chunk.size());
+        for (size_t i = 0; i < batch; ++i)
+            make_pirate(&chunk[i], n + i, &rng);
+        if (fwrite(chunk.data(), sizeof(Pirate), batch, out) != batch) {
+            perror("fwrite");
+            fclose(out);
+            return 1;
+        }
+        n += batch;
+    }
+    if (fclose(out)) {
+        perror("fclose");
+        return 1;
+    }
+    return 0;
+}
+#pragma endregion
+
+#pragma region index, find, prefix, append
+static int
+cmd_index (char const * data_path, char const * index_path) {
+    auto start = std::chrono::steady_clock::now();
+    if (!PirateIndex_Build(data_path, index_path)) {
+        perror("index");
+        return 1;
+    }
+    printf("index built in %.3f s\n", seconds_since(start));
+    return 0;
+}
+static int
+cmd_find (char const * data_path, char const * index_path, char const * name, bool prefix) {
+    PirateIndex idx;
+    if (!PirateIndex_Open(&idx, data_path, index_path)) {
+        printf("cannot open index %s (rebuild it with \"index\")\n", index_path);
+        return 1;
+    }
+    int res = 0;
+    if (prefix) {
+        uint64_t hits[32];
+        uint64_t n = PirateIndex_FindPrefix(&idx, name, hits, _countof(hits));
+        for (uint64_t i = 0; i < n && i < _countof(hits); ++i)
+            print_pirate(hits[i], PirateIndex_Record(&idx, hits[i]));
+        printf("%llu match(es)\n", (unsigned long long)n);
+    } else {
+        int64_t n = PirateIndex_Find(&idx, name);
+        if (n < 0) {
+            printf("\"%s\" not found\n", name);
+            res = 1;
+        } else {
+            print_pirate((uint64_t)n, PirateIndex_Record(&idx, (uint64_t)n));
+        }
+    }
+    PirateIndex_Close(&idx);
+    return res;
+}
+static int
+cmd_append (
+    char const * data_path, char const * index_path,
+    char const * name, uint32_t bounty, uint32_t crew_count
+) {
+    PirateIndex idx;
+    Pirate p = {};
+    snprintf(p.name, sizeof(p.name), "%s", name);
+    p.bounty = bounty;
+    p.crew_count = crew_count;
+
+    if (!PirateIndex_Open(&idx, data_path, index_path)) {
+        printf("cannot open index %s (rebuild it with \"index\")\n", index_path);
+        return 1;
+    }
+    int res = 0;
+    if (!PirateIndex_Append(&idx, &p, 1)) {
+        perror("append");
+        res = 1;
+    }
+    PirateIndex_Close(&idx);
+    return res;
+}
+#pragma endregion
+
+#pragma region bench-index
+/*
+Random exact lookups of names known to be in the file,
+against a linear scan of the records for a handful of them.
+*/
+static int
+cmd_bench_index (char const * data_path, char const * index_path, uint64_t lookups) {
+    PirateIndex idx;
+    if (0 == lookups) {
+        printf("lookups must be at least 1\n");
+        return 1;
+    }
+    if (!PirateIndex_Open(&idx, data_path, index_path)) {
+        printf("cannot open index %s (rebuild it with \"index\")\n", index_path);
+        return 1;
+    }
+    uint64_t count = PirateIndex_Count(&idx);
+    if (0 == count) {
+        PirateIndex_Close(&idx);
+        return 1;
+    }
+
+    // -- pick the probes up front so only the lookups are timed
+    uint64_t rng = 0xD1B54A32D192ED03ULL;
+    std::vector<uint64_t> probes(lookups);
+    for (auto & p : probes)
+        p = next_rand(&rng) % count;
+
+    uint64_t misses = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t p : probes) {
+        Pirate const * want = PirateIndex_Record(&idx, p);
+        if (PirateIndex_Find(&idx, want->name) < 0)
+            ++misses;
+    }
+    double t_index = seconds_since(start);
+
+    uint64_t scans = (lookups < 16) ? lookups : 16;
+    start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < scans; ++i) {
+        Pirate const * want = PirateIndex_Record(&idx, probes[i]);
+        for (uint64_t r = 0; r < count; ++r)
+            if (0 == strncmp(PirateIndex_Record(&idx, r)->name, want->name, PIRATE_NAME_LEN))
+                break;
+    }
+    double t_scan = seconds_since(start);
+
+    printf("records          : %llu\n", (unsigned long long)count);
+    printf("index lookup     : %.3f us/op (%llu ops, %llu misses)\n",
+        1e6 * t_index / (double)lookups, (unsigned long long)lookups, (unsigned long long)misses);
+    printf("linear scan      : %.3f us/op (%llu ops)\n",
+        1e6 * t_scan / (double)scans, (unsigned long long)scans);
+
+    PirateIndex_Close(&idx);
+    return misses ? 1 : 0;
+}
+#pragma endregion
+
+#pragma region pack, unpack, bench-scan
+static int
+cmd_pack (char const * data_path, char const * packed_path, uint32_t block_records) {
+    auto start = std::chrono::steady_clock::now();
+    if (!PirateBlock_Pack(data_path, packed_path, block_records)) {
+        perror("pack");
+        return 1;
+    }
+    printf("packed in %.3f s\n", seconds_since(start));
+    return 0;
+}
+static int
+cmd_unpack (char const * packed_path, char const * data_path) {
+    if (!PirateBlock_Unpack(packed_path, data_path)) {
+        perror("unpack");
+        return 1;
+    }
+    return 0;
+}
+
+struct ScanTotals {
+    std::atomic<uint64_t> records;
+    std::atomic<uint64_t> bounty;
+};
+static bool
+sum_block (void * ctx, uint64_t first_record, Pirate const * pirates, size_t count) {
+    ScanTotals * t = (ScanTotals *)ctx;
+    uint64_t bounty = 0;
+    (void)first_record;
+    for (size_t i = 0; i < count; ++i)
+        bounty += pirates[i].bounty;
+    t->records += count;
+    t->bounty += bounty;
+    return true;
+}
+/*
+Full scan (sum of bounties) of the raw file against the packed one,
+with 1 thread and with thread_count threads.
+*/
+static int
+cmd_bench_scan (char const * data_path, char const * packed_path, unsigned thread_count) {
+    MappedFile raw;
+    PirateBlockReader r;
+    if (!MappedFile_Open(&raw, data_path)) {
+        perror("open");
+        return 1;
+    }
+    if (!PirateBlock_Open(&r, packed_path)) {
+        perror("open");
+        MappedFile_Close(&raw);
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    ScanTotals raw_totals = {};
+    uint64_t raw_count = raw.size / sizeof(Pirate);
+    sum_block(&raw_totals, 0, (Pirate const *)raw.base, (size_t)raw_count);
+    double t_raw = seconds_since(start);
+
+    ScanTotals one = {};
+    start = std::chrono::steady_clock::now();
+    bool ok = PirateBlock_Scan(&r, 1, sum_block, &one);
+    double t_one = seconds_since(start);
+
+    ScanTotals many = {};
+    start = std::chrono::steady_clock::now();
+    ok = PirateBlock_Scan(&r, thread_count, sum_block, &many) && ok;
+    double t_many = seconds_since(start);
+
+    ok = ok &&
+        one.records == raw_totals.records && one.bounty == raw_totals.bounty &&
+        many.records == raw_totals.records && many.bounty == raw_totals.bounty;
+
+    printf("records          : %llu\n", (unsigned long long)raw_count);
+    printf("raw size         : %llu bytes\n", (unsigned long long)raw.size);
+    printf("packed size      : %llu bytes (%.2fx smaller)\n",
+        (unsigned long long)r.file.size, (double)raw.size / (double)r.file.size);
+    printf("raw scan         : %.3f s\n", t_raw);
+    printf("packed scan x1   : %.3f s\n", t_one);
+    printf("packed scan xN   : %.3f s\n", t_many);
+    printf("checksums        : %s\n", ok ? "match" : "MISMATCH");
+
+    PirateBlock_Close(&r);
+    MappedFile_Close(&raw);
+    return ok ? 0 : 1;
+}
+#pragma endregion
+
+#pragma region gen-text, import, bench-import
+static int
+cmd_gen_text (char const * text_path, uint64_t size_mb) {
+    FILE * out = nullptr;
+    uint64_t rng = 0x9E3779B97F4A7C15ULL;
+    uint64_t limit = size_mb << 20;
+    uint64_t written = 0;
+    std::vector<char> buf(1 << 20);
+
+    if (fopen_s(&out, text_path, "wb") != 0 || nullptr == out) {
+        perror("fopen");
+        return 1;
+    }
+    for (uint64_t n = 0; written < limit;) {
+        size_t used = 0;
+        while (used + 128 < buf.size() && written + used < limit) {
+            Pirate p;
+            make_pirate(&p, n++, &rng);
+            used += (size_t)snprintf(
+                buf.data() + used, buf.size() - used,
+                "%s,%u,%u\n", p.name, p.bounty, p.crew_count
+            );
+        }
+        if (fwrite(buf.data(), 1, used, out) != used) {
+            perror("fwrite");
+            fclose(out);
+            return 1;
+        }
+        written += used;
+    }
+    if (fclose(out)) {
+        perror("fclose");
+        return 1;
+    }
+    return 0;
+}
+static void
+print_import (char const * label, double seconds, PirateImportStats const * st) {
+    printf(
+        "%-16s : %.3f s, %.2f GB/s, %llu records, %llu bad line(s)",
+        label, seconds, (double)st->bytes / seconds / 1e9,
+        (unsigned long long)st->records, (unsigned long long)st->bad_lines
+    );
+    if (st->bad_lines)
+        printf(" (first at line %llu)", (unsigned long long)st->first_bad_line);
+    printf("\n");
+}
+static int
+cmd_import (char const * text_path, char const * data_path, unsigned thread_count) {
+    PirateImportStats st;
+    auto start = std::chrono::steady_clock::now();
+    if (!PirateImport_Run(text_path, data_path, thread_count, &st)) {
+        perror("import");
+        return 1;
+    }
+    print_import("import", seconds_since(start), &st);
+    return 0;
+}
+/* The straightforward way: fgets + strtoul, one thread */
+static bool
+import_with_crt (char const * text_path, char const * data_path, PirateImportStats * st) {
+    FILE * in = nullptr;
+    FILE * out = nullptr;
+    char line[256];
+
+    memset(st, 0, sizeof(*st));
+    if (fopen_s(&in, text_path, "rb") != 0 || nullptr == in)
+        return false;
+    if (fopen_s(&out, data_path, "wb") != 0 || nullptr == out) {
+        fclose(in);
+        return false;
+    }
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), in)) {
+        Pirate p = {};
+        char * comma = strchr(line, ',');
+        char * next = nullptr;
+        st->bytes += strlen(line);
+        if (nullptr != comma)
+            p.bounty = (uint32_t)strtoul(comma + 1, &next, 10);
+        // -- next stops at the NUL of a line with no second comma
+        if (nullptr == comma || ',' != *next) {
+            ++st->bad_lines;
+            continue;
+        }
+        *comma = 0;
+        snprintf(p.name, sizeof(p.name), "%s", line);
+        p.crew_count = (uint32_t)strtoul(next + 1, nullptr, 10);
+        ok = (1 == fwrite(&p, sizeof(p), 1, out));
+        ++st->records;
+    }
+    ok = ok && !ferror(in);
+    fclose(in);
+    if (fclose(out))
+        ok = false;
+    return ok;
+}
+/*
+Generate size_mb of text, then import it with the CRT baseline,
+with the importer on 1 thread and on thread_count threads.
+*/
+static int
+cmd_bench_import (
+    char const * text_path, char const * data_path,
+    uint64_t size_mb, unsigned thread_count
+) {
+    PirateImportStats st;
+    if (cmd_gen_text(text_path, size_mb))
+        return 1;
+
+    auto start = std::chrono::steady_clock::now();
+    if (!import_with_crt(text_path, data_path, &st)) {
+        perror("import");
+        return 1;
+    }
+    print_import("fgets + strtoul", seconds_since(start), &st);
+
+    start = std::chrono::steady_clock::now();
+    if (!PirateImport_Run(text_path, data_path, 1, &st)) {
+        perror("import");
+        return 1;
+    }
+    print_import("import x1", seconds_since(start), &st);
+
+    start = std::chrono::steady_clock::now();
+    if (!PirateImport_Run(text_path, data_path, thread_count, &st)) {
+        perror("import");
+        return 1;
+    }
+    print_import("import xN", seconds_since(start), &st);
+    return 0;
+}
+#pragma endregion
+
+#pragma region bench-commit
+/*
+thread_count appenders each make `appends` single-record durable appends.
+Reports commits/sec and commit latency percentiles for a given max_batch.
+*/
+static bool
+run_commit (
+    char const * data_path, size_t max_batch, unsigned thread_count, uint64_t appends,
+    char const * label
+) {
+    char wal_path[270];
+    snprintf(wal_path, sizeof(wal_path), "%s.wal", data_path);
+    remove(data_path);
+    remove(wal_path);
+
+    PirateJournal j;
+    if (!PirateJournal_Open(&j, data_path, max_batch))
+        return false;
+
+    std::vector<std::vector<double>> latencies(thread_count);
+    std::atomic<bool> ok{true};
+    auto appender = [&] (unsigned t) {
+        uint64_t rng = 0x9E3779B97F4A7C15ULL + t;
+        latencies[t].reserve((size_t)appends);
+        for (uint64_t i = 0; i < appends; ++i) {
+            Pirate p;
+            make_pirate(&p, i, &rng);
+            auto start = std::chrono::steady_clock::now();
+            if (!PirateJournal_Append(&j, &p, 1, nullptr))
+                ok = false;
+            latencies[t].push_back(seconds_since(start));
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < thread_count; ++t)
+        threads.emplace_back(appender, t);
+    for (auto & t : threads)
+        t.join();
+    double elapsed = seconds_since(start);
+    uint64_t batches = j.batches;
+    if (!PirateJournal_Close(&j))
+        ok = false;
+
+    std::vector<double> all;
+    for (auto & l : latencies)
+        all.insert(all.end(), l.begin(), l.end());
+    std::sort(all.begin(), all.end());
+    double p50 = all.empty() ? 0 : all[all.size() / 2];
+    double p99 = all.empty() ? 0 : all[(size_t)((double)(all.size() - 1) * 0.99)];
+
+    printf(
+        "%-16s : %10.0f commits/s, %8llu syncs, p50 %8.1f us, p99 %8.1f us\n",
+        label, (double)all.size() / elapsed, (unsigned long long)batches, 1e6 * p50, 1e6 * p99
+    );
+    return ok;
+}
+static int
+cmd_bench_commit (char const * data_path, unsigned thread_count, uint64_t appends) {
+    if (0 == thread_count)
+        thread_count = 1;
+    bool ok =
+        run_commit(data_path, 1, thread_count, appends, "per-record sync") &&
+        run_commit(data_path, 4096, thread_count, appends, "group commit");
+    if (!ok)
+        perror("bench-commit");
+    return ok ? 0 : 1;
+}
+#pragma endregion
+
+// =========================================================================================
+
+static void
+usage (void) {
+    printf(
+        "usage:\n"
+        "  records gen <data> <count>\n"
+        "  records index <data> <index>\n"
+        "  records find <data> <index> <name>\n"
+        "  records prefix <data> <index> <prefix>\n"
+        "  records append <data> <index> <name> <bounty> <crew>\n"
+        "  records bench-index <data> <index> <lookups>\n"
+        "  records pack <data> <packed> [block_records]\n"
+        "  records unpack <packed> <data>\n"
+        "  records bench-scan <data> <packed> [threads]\n"
+        "  records gen-text <text> <size_mb>\n"
+        "  records import <text> <data> [threads]\n"
+        "  records bench-import <text> <data> <size_mb> [threads]\n"
+        "  records bench-commit <data> <threads> <appends_per_thread>\n"
+    );
+}
+int main (int argc, char * argv []) {
+    if (argc < 2) {
+        usage();
+        return 1;
+    }
+    char const * cmd = argv[1];
+
+    if (0 == strcmp(cmd, "gen") && 4 == argc)
+        return cmd_gen(argv[2], strtoull(argv[3], nullptr, 10));
+    if (0 == strcmp(cmd, "index") && 4 == argc)
+        return cmd_index(argv[2], argv[3]);
+    if (0 == strcmp(cmd, "find") && 5 == argc)
+        return cmd_find(argv[2], argv[3], argv[4], false);
+    if (0 == strcmp(cmd, "prefix") && 5 == argc)
+        return cmd_find(argv[2], argv[3], argv[4], true);
+    if (0 == strcmp(cmd, "append") && 7 == argc)
+        return cmd_append(
+            argv[2], argv[3], argv[4],
+            (uint32_t)strtoul(argv[5], nullptr, 10), (uint32_t)strtoul(argv[6], nullptr, 10)
+        );
+    if (0 == strcmp(cmd, "bench-index") && 5 == argc)
+        return cmd_bench_index(argv[2], argv[3], strtoull(argv[4], nullptr, 10));
+    if (0 == strcmp(cmd, "pack") && (4 == argc || 5 == argc))
+        return cmd_pack(argv[2], argv[3], (5 == argc) ? (uint32_t)strtoul(argv[4], nullptr, 10) : 0);
+    if (0 == strcmp(cmd, "unpack") && 4 == argc)
+        return cmd_unpack(argv[2], argv[3]);
+    if (0 == strcmp(cmd, "bench-scan") && (4 == argc || 5 == argc))
+        return cmd_bench_scan(argv[2], argv[3], (5 == argc) ? (unsigned)strtoul(argv[4], nullptr, 10) : 0);
+    if (0 == strcmp(cmd, "gen-text") && 4 == argc)
+        return cmd_gen_text(argv[2], strtoull(argv[3], nullptr, 10));
+    if (0 == strcmp(cmd, "import") && (4 == argc || 5 == argc))
+        return cmd_import(argv[2], argv[3], (5 == argc) ? (unsigned)strtoul(argv[4], nullptr, 10) : 0);
+    if (0 == strcmp(cmd, "bench-import") && (5 == argc || 6 == argc))
+        return cmd_bench_import(
+            argv[2], argv[3], strtoull(argv[4], nullptr, 10),
+            (6 == argc) ? (unsigned)strtoul(argv[5], nullptr, 10) : 0
+        );
+
+    if (0 == strcmp(cmd, "bench-commit") && 5 == argc)
+        return cmd_bench_commit(argv[2], (unsigned)strtoul(argv[3], nullptr, 10), strtoull(argv[4], nullptr, 10));
+
+    usage();
+    return 1;
+}
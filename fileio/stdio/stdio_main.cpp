@@ -9,11 +9,7 @@
 
 #include <stdio.h>
 
-struct Pirate {
-    char name[50];
-    unsigned long bounty;
-    unsigned int crew_count;
-};
+#include "../records/pirate.h"  /* struct Pirate, shared with the records tool */
 
 int main (void) {
     char str[100];
@@ -136,7 +132,7 @@ int main (void) {
         }
     }
     printf(
-        "Name = \"%s\",   Bounty = $%lu,   Crew size = %u members\n",
+        "Name = \"%s\",   Bounty = $%u,   Crew size = %u members\n",
         kaizokuO.name, kaizokuO.bounty, kaizokuO.crew_count
     );
 
@@ -0,0 +1,400 @@
+/* ===========================================================
+   #File: mem_alloc.c #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Arenas, object pools and aligned blocks off the process heap #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#if !defined(_WIN32) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE     /* MAP_ANONYMOUS, MAP_NORESERVE, posix_memalign */
+#endif
+
+#include "mem_alloc.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sys/mman.h>
+#endif
+
+#define COMMIT_STEP     (64 * 1024)     // arenas and pools commit this much at a time
+#define DEFAULT_ALIGN   16
+#define POOL_BATCH      32              // objects moved between a cache and its pool at once
+#define CACHE_MAX       (2 * POOL_BATCH)
+
+static size_t
+round_up (size_t n, size_t to) {
+    return (n + to - 1) / to * to;
+}
+
+// =========================================================================================
+
+#pragma region platform
+#ifdef _WIN32
+#define THREAD_LOCAL __declspec(thread)
+typedef SRWLOCK Lock;
+
+static void lock_init (Lock * l)    { InitializeSRWLock(l); }
+static void lock_deinit (Lock * l)  { (void)l; }
+static void lock (Lock * l)         { AcquireSRWLockExclusive(l); }
+static void unlock (Lock * l)       { ReleaseSRWLockExclusive(l); }
+
+static char *
+reserve_range (size_t len) {
+    return (char *)VirtualAlloc(NULL, len, MEM_RESERVE, PAGE_NOACCESS);
+}
+static int
+commit_range (char * p, size_t len) {
+    return NULL != VirtualAlloc(p, len, MEM_COMMIT, PAGE_READWRITE);
+}
+static void
+release_range (char * p, size_t len) {
+    (void)len;
+    VirtualFree(p, 0, MEM_RELEASE);
+}
+
+/* The private heap of the aligned blocks, created on first use */
+static HANDLE volatile g_heap;
+
+static HANDLE
+private_heap (void) {
+    HANDLE h = (HANDLE)ReadPointerAcquire((PVOID const volatile *)&g_heap);
+    if (NULL == h) {
+        HANDLE mine = HeapCreate(0, 0, 0);
+        if (NULL == mine)
+            return NULL;
+        h = InterlockedCompareExchangePointer((PVOID volatile *)&g_heap, mine, NULL);
+        if (h != NULL)
+            HeapDestroy(mine);  // another thread won
+        else
+            h = mine;
+    }
+    return h;
+}
+#else
+#define THREAD_LOCAL _Thread_local
+typedef pthread_mutex_t Lock;
+
+static void lock_init (Lock * l)    { pthread_mutex_init(l, NULL); }
+static void lock_deinit (Lock * l)  { pthread_mutex_destroy(l); }
+static void lock (Lock * l)         { pthread_mutex_lock(l); }
+static void unlock (Lock * l)       { pthread_mutex_unlock(l); }
+
+static char *
+reserve_range (size_t len) {
+    void * p = mmap(NULL, len, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    return (MAP_FAILED == p) ? NULL : (char *)p;
+}
+static int
+commit_range (char * p, size_t len) {
+    return 0 == mprotect(p, len, PROT_READ | PROT_WRITE);
+}
+static void
+release_range (char * p, size_t len) {
+    munmap(p, len);
+}
+#endif
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region arena
+int
+MemArena_Init (MemArena * a, size_t reserve_bytes) {
+    memset(a, 0, sizeof(*a));
+    a->reserved = round_up(reserve_bytes, COMMIT_STEP);
+    a->base = (a->reserved != 0) ? reserve_range(a->reserved) : NULL;
+    return a->base != NULL;
+}
+void
+MemArena_Deinit (MemArena * a) {
+    if (a->base != NULL)
+        release_range(a->base, a->reserved);
+    memset(a, 0, sizeof(*a));
+}
+void *
+MemArena_Alloc (MemArena * a, size_t size, size_t align) {
+    if (0 == align)
+        align = DEFAULT_ALIGN;
+    size_t off = (a->used + align - 1) & ~(align - 1);
+    if (off > a->reserved || size > a->reserved - off)
+        return NULL;
+    if (off + size > a->committed) {
+        size_t end = round_up(off + size, COMMIT_STEP);
+        if (end > a->reserved)
+            end = a->reserved;
+        if (!commit_range(a->base + a->committed, end - a->committed))
+            return NULL;
+        a->committed = end;
+    }
+    a->used = off + size;
+    return a->base + off;
+}
+size_t
+MemArena_Mark (MemArena const * a) {
+    return a->used;
+}
+void
+MemArena_Reset (MemArena * a, size_t mark) {
+    if (mark < a->used)
+        a->used = mark;
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region pool
+/* A free object; the first object of a full batch also links the next batch */
+typedef struct FreeObj {
+    struct FreeObj *    next;
+    struct FreeObj *    next_batch;
+} FreeObj;
+
+struct MemPoolShared {
+    Lock        lock;
+    FreeObj *   batches;        // full batches of POOL_BATCH objects
+    FreeObj *   loose;          // what flushed caches gave back, fewer per batch
+    char *      base;
+    size_t      reserved;
+    size_t      committed;
+    size_t      carved;         // bytes handed out from the range so far
+    char        pad[MEM_CACHE_LINE];
+};
+
+typedef struct PoolCache {
+    FreeObj *   head;
+    unsigned    count;
+    uint32_t    gen;            // of the pool the objects belong to
+} PoolCache;
+
+static THREAD_LOCAL PoolCache t_caches[MEM_MAX_POOLS];
+
+/* Pool ids in use, and the generation stamped on the next pool */
+static uint8_t g_pool_ids[MEM_MAX_POOLS];
+static uint32_t g_pool_gen;
+#ifdef _WIN32
+static SRWLOCK g_pools_lock = SRWLOCK_INIT;
+#else
+static pthread_mutex_t g_pools_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/* The calling thread's cache of p; emptied when it still holds a previous pool's objects */
+static PoolCache *
+cache_of (MemPool * p) {
+    PoolCache * c = &t_caches[p->id];
+    if (c->gen != p->gen) {
+        c->head = NULL;
+        c->count = 0;
+        c->gen = p->gen;
+    }
+    return c;
+}
+/* Under the pool lock: up to POOL_BATCH objects from the free lists, or new from the range */
+static FreeObj *
+take_batch (MemPoolShared * s, size_t obj_size, unsigned * count) {
+    FreeObj * batch = s->batches;
+    if (batch != NULL) {
+        s->batches = batch->next_batch;
+        *count = POOL_BATCH;
+        return batch;
+    }
+    if (s->loose != NULL) {
+        unsigned n = 1;
+        FreeObj * last = batch = s->loose;
+        while (n < POOL_BATCH && last->next != NULL) {
+            last = last->next;
+            n++;
+        }
+        s->loose = last->next;
+        last->next = NULL;
+        *count = n;
+        return batch;
+    }
+
+    /* -- carve new objects off the range */
+    size_t n = (s->reserved - s->carved) / obj_size;
+    if (n > POOL_BATCH)
+        n = POOL_BATCH;
+    if (0 == n)
+        return NULL;
+    size_t end = s->carved + n * obj_size;
+    if (end > s->committed) {
+        size_t to = round_up(end, COMMIT_STEP);
+        if (to > s->reserved)
+            to = s->reserved;
+        if (!commit_range(s->base + s->committed, to - s->committed))
+            return NULL;
+        s->committed = to;
+    }
+    batch = (FreeObj *)(s->base + s->carved);
+    for (size_t i = 0; i + 1 < n; i++)
+        ((FreeObj *)(s->base + s->carved + i * obj_size))->next = (FreeObj *)(s->base + s->carved + (i + 1) * obj_size);
+    ((FreeObj *)(s->base + end - obj_size))->next = NULL;
+    s->carved = end;
+    *count = (unsigned)n;
+    return batch;
+}
+
+int
+MemPool_Init (MemPool * p, size_t obj_size, size_t align, size_t max_objects) {
+    memset(p, 0, sizeof(*p));
+    if (0 == align)
+        align = DEFAULT_ALIGN;
+    if (obj_size < sizeof(FreeObj))
+        obj_size = sizeof(FreeObj);
+    // -- the whole range, rounded up to COMMIT_STEP, must fit in a size_t
+    if (obj_size > SIZE_MAX - align ||
+        max_objects > (SIZE_MAX - COMMIT_STEP) / round_up(obj_size, align))
+        return 0;
+    p->obj_size = round_up(obj_size, align);
+
+    MemPoolShared * s = (MemPoolShared *)Mem_AllocAligned(sizeof(MemPoolShared), MEM_CACHE_LINE, MEM_ZERO);
+    if (NULL == s)
+        return 0;
+    s->reserved = round_up(p->obj_size * max_objects, COMMIT_STEP);
+    s->base = (s->reserved != 0) ? reserve_range(s->reserved) : NULL;
+    if (NULL == s->base) {
+        Mem_FreeAligned(s);
+        return 0;
+    }
+    lock_init(&s->lock);
+
+    int found = 0;
+    lock(&g_pools_lock);
+    for (unsigned i = 0; i < MEM_MAX_POOLS; i++) {
+        if (!g_pool_ids[i]) {
+            g_pool_ids[i] = 1;
+            p->id = i;
+            p->gen = ++g_pool_gen;  // never 0: a fresh thread's cache matches no pool
+            found = 1;
+            break;
+        }
+    }
+    unlock(&g_pools_lock);
+    if (!found) {
+        lock_deinit(&s->lock);
+        release_range(s->base, s->reserved);
+        Mem_FreeAligned(s);
+        return 0;
+    }
+    p->shared = s;
+    return 1;
+}
+void
+MemPool_Deinit (MemPool * p) {
+    MemPoolShared * s = p->shared;
+    if (NULL == s)
+        return;
+    lock(&g_pools_lock);
+    g_pool_ids[p->id] = 0;
+    unlock(&g_pools_lock);
+    lock_deinit(&s->lock);
+    release_range(s->base, s->reserved);
+    Mem_FreeAligned(s);
+    p->shared = NULL;
+}
+void *
+MemPool_Alloc (MemPool * p) {
+    PoolCache * c = cache_of(p);
+    FreeObj * obj = c->head;
+    if (NULL == obj) {
+        MemPoolShared * s = p->shared;
+        unsigned n = 0;
+        lock(&s->lock);
+        obj = take_batch(s, p->obj_size, &n);
+        unlock(&s->lock);
+        if (NULL == obj)
+            return NULL;
+        c->count = n;
+    }
+    c->head = obj->next;
+    c->count--;
+    return obj;
+}
+void
+MemPool_Free (MemPool * p, void * ptr) {
+    PoolCache * c = cache_of(p);
+    FreeObj * obj = (FreeObj *)ptr;
+    obj->next = c->head;
+    c->head = obj;
+    if (++c->count < CACHE_MAX)
+        return;
+
+    /* -- full: the newest POOL_BATCH objects go back as one batch, the older ones stay warm */
+    FreeObj * last = obj;
+    for (unsigned i = 1; i < POOL_BATCH; i++)
+        last = last->next;
+    c->head = last->next;
+    c->count -= POOL_BATCH;
+    last->next = NULL;
+
+    MemPoolShared * s = p->shared;
+    lock(&s->lock);
+    obj->next_batch = s->batches;
+    s->batches = obj;
+    unlock(&s->lock);
+}
+void
+MemPool_FlushThread (MemPool * p) {
+    PoolCache * c = cache_of(p);
+    if (NULL == c->head)
+        return;
+    FreeObj * last = c->head;
+    while (last->next != NULL)
+        last = last->next;
+
+    MemPoolShared * s = p->shared;
+    lock(&s->lock);
+    last->next = s->loose;
+    s->loose = c->head;
+    unlock(&s->lock);
+    c->head = NULL;
+    c->count = 0;
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region aligned
+void *
+Mem_AllocAligned (size_t size, size_t align, unsigned flags) {
+    if (align < sizeof(void *))
+        align = sizeof(void *);
+#ifdef _WIN32
+    /* -- over-allocate, keep the heap's pointer just below the aligned block */
+    HANDLE heap = private_heap();
+    if (NULL == heap || size > (size_t)-1 - align - sizeof(void *))
+        return NULL;
+    char * raw = (char *)HeapAlloc(heap, (flags & MEM_ZERO) ? HEAP_ZERO_MEMORY : 0, size + align + sizeof(void *));
+    if (NULL == raw)
+        return NULL;
+    char * p = (char *)(((uintptr_t)raw + sizeof(void *) + align - 1) & ~(uintptr_t)(align - 1));
+    ((void **)p)[-1] = raw;
+    return p;
+#else
+    void * p = NULL;
+    if (posix_memalign(&p, align, size) != 0)
+        return NULL;
+    if (flags & MEM_ZERO)
+        memset(p, 0, size);
+    return p;
+#endif
+}
+void
+Mem_FreeAligned (void * p) {
+    if (NULL == p)
+        return;
+#ifdef _WIN32
+    HeapFree(g_heap, 0, ((void **)p)[-1]);
+#else
+    free(p);
+#endif
+}
+#pragma endregion
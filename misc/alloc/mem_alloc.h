@@ -0,0 +1,114 @@
+#pragma once
+
+/* ===========================================================
+   #File: mem_alloc.h #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Arenas, object pools and aligned blocks off the process heap #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+Three allocators for the hot paths, none of which touch the process heap:
+
+ - MemArena: bump allocation in a reserved address range, committed 64 KB
+   at a time as it grows. Freed all at once (Reset to a mark, or Deinit).
+   One owner: no locking.
+ - MemPool: fixed-size objects, any thread allocates and frees. Each thread
+   keeps a small free cache per pool, so most calls touch no shared state;
+   caches trade objects with the pool in batches under one short lock.
+   Objects come from a reserved range, never returned to the system before
+   MemPool_Deinit.
+ - Mem_AllocAligned: single blocks aligned to a cache line or more, from a
+   private heap (HeapCreate) on Windows, posix_memalign elsewhere. For long
+   lived shared structures whose fields must not share a line with others.
+
+Address space comes from VirtualAlloc (MEM_RESERVE, then MEM_COMMIT) on
+Windows and mmap (PROT_NONE, then mprotect) on Linux. Committed memory
+starts zeroed.
+*/
+
+#define MEM_CACHE_LINE      64
+#define MEM_MAX_POOLS       64      // live pools at once
+#define MEM_ZERO            1u      // Mem_AllocAligned: zero the block
+
+// =========================================================================================
+
+typedef struct MemArena {
+    char *      base;
+    size_t      reserved;
+    size_t      committed;
+    size_t      used;
+} MemArena;
+
+/* Reserves reserve_bytes of address space, commits nothing yet; false on failure */
+int
+MemArena_Init (MemArena * a, size_t reserve_bytes);
+
+void
+MemArena_Deinit (MemArena * a);
+
+/* align is a power of 2, 0 for 16; NULL once the reservation is used up */
+void *
+MemArena_Alloc (MemArena * a, size_t size, size_t align);
+
+/* Everything allocated after the mark is freed by Reset; the memory stays committed */
+size_t
+MemArena_Mark (MemArena const * a);
+
+void
+MemArena_Reset (MemArena * a, size_t mark);
+
+// =========================================================================================
+
+typedef struct MemPoolShared MemPoolShared;
+typedef struct MemPool {
+    MemPoolShared *     shared;
+    size_t              obj_size;   // rounded up to the alignment
+    unsigned            id;         // the thread caches' slot
+    uint32_t            gen;        // tells the caches of a recycled id apart
+} MemPool;
+
+/*
+align 0 means 16; MEM_CACHE_LINE keeps objects off each other's lines.
+False on failure, or when the whole range would not fit in a size_t
+*/
+int
+MemPool_Init (MemPool * p, size_t obj_size, size_t align, size_t max_objects);
+
+/* Frees the whole range; no thread may still use the pool's objects */
+void
+MemPool_Deinit (MemPool * p);
+
+/* NULL once max_objects are out; the object is not zeroed */
+void *
+MemPool_Alloc (MemPool * p);
+
+/* Any thread may free any object of the pool */
+void
+MemPool_Free (MemPool * p, void * obj);
+
+/* Returns the calling thread's cached objects to the pool, e.g. before the thread exits */
+void
+MemPool_FlushThread (MemPool * p);
+
+// =========================================================================================
+
+/* align is a power of 2, at least sizeof(void *); flags: MEM_ZERO */
+void *
+Mem_AllocAligned (size_t size, size_t align, unsigned flags);
+
+void
+Mem_FreeAligned (void * p);
+
+#ifdef __cplusplus
+}
+#endif
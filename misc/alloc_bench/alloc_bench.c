@@ -0,0 +1,221 @@
+/* ===========================================================
+   #File: alloc_bench.c #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Multithreaded alloc/free throughput of the mem_alloc module #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L    /* clock_gettime */
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../alloc/mem_alloc.h"
+#include "../../bench/bench_util.h"
+
+#ifndef _countof
+#define _countof(a) (sizeof(a) / sizeof((a)[0]))
+#endif
+
+// =========================================================================================
+
+#define MAX_THREADS     16
+#define OBJ_SIZE        64          // a queue element and a bit
+#define WINDOW          256         // live objects per thread in the churn pattern
+#define BURST           4096        // objects per burst
+#define OPS_PER_THREAD  (1 << 21)   // alloc + free pairs
+
+// =========================================================================================
+
+#pragma region allocators
+/* The allocators under test, behind one interface; ctx is the pool or the thread's arena */
+typedef struct Allocator {
+    char const *    name;
+    void *          (*alloc) (void * ctx);
+    void            (*free) (void * ctx, void * p);
+} Allocator;
+
+static void * malloc_alloc (void * ctx)             { (void)ctx; return malloc(OBJ_SIZE); }
+static void   malloc_free (void * ctx, void * p)    { (void)ctx; free(p); }
+static void * pool_alloc (void * ctx)               { return MemPool_Alloc((MemPool *)ctx); }
+static void   pool_free (void * ctx, void * p)      { MemPool_Free((MemPool *)ctx, p); }
+#ifdef _WIN32
+static void * heap_alloc (void * ctx)               { (void)ctx; return HeapAlloc(GetProcessHeap(), 0, OBJ_SIZE); }
+static void   heap_free (void * ctx, void * p)      { (void)ctx; HeapFree(GetProcessHeap(), 0, p); }
+#endif
+
+static Allocator const g_allocators [] = {
+    {"malloc",          malloc_alloc,   malloc_free},
+#ifdef _WIN32
+    {"process heap",    heap_alloc,     heap_free},
+#endif
+    {"MemPool",         pool_alloc,     pool_free},
+    {"MemPool aligned", pool_alloc,     pool_free},     // cache-line objects
+};
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region patterns
+typedef struct Job {
+    Allocator const *   a;
+    void *              ctx;
+    int                 thread;
+    int                 ok;
+} Job;
+
+/* Every object carries its owner and serial while live: an object handed out twice shows up */
+static void
+stamp (void * p, int thread, uint64_t serial) {
+    ((uint64_t *)p)[0] = ((uint64_t)thread << 48) | serial;
+    ((uint64_t *)p)[OBJ_SIZE / sizeof(uint64_t) - 1] = serial;
+}
+static int
+stamped (void const * p, int thread, uint64_t serial) {
+    return ((uint64_t const *)p)[0] == (((uint64_t)thread << 48) | serial)
+        && ((uint64_t const *)p)[OBJ_SIZE / sizeof(uint64_t) - 1] == serial;
+}
+
+/* churn: a window of live objects, each step frees a random one and allocates its replacement */
+static void
+churn_job (void * arg) {
+    Job * j = (Job *)arg;
+    void * live[WINDOW];
+    uint64_t serial[WINDOW];
+    uint64_t rng = 0x9E3779B97F4A7C15ULL + (uint64_t)j->thread;
+
+    for (int i = 0; i < WINDOW; ++i) {
+        live[i] = j->a->alloc(j->ctx);
+        stamp(live[i], j->thread, serial[i] = (uint64_t)i);
+    }
+    for (uint64_t op = WINDOW; op < OPS_PER_THREAD; ++op) {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        unsigned k = (unsigned)(rng % WINDOW);
+        j->ok &= stamped(live[k], j->thread, serial[k]);
+        j->a->free(j->ctx, live[k]);
+        live[k] = j->a->alloc(j->ctx);
+        stamp(live[k], j->thread, serial[k] = op);
+    }
+    for (int i = 0; i < WINDOW; ++i) {
+        j->ok &= stamped(live[i], j->thread, serial[i]);
+        j->a->free(j->ctx, live[i]);
+    }
+}
+/* burst: BURST allocations, then all freed, oldest first */
+static void
+burst_job (void * arg) {
+    Job * j = (Job *)arg;
+    void ** live = (void **)malloc(BURST * sizeof(void *));
+    for (uint64_t round = 0; round < OPS_PER_THREAD / BURST; ++round) {
+        for (int i = 0; i < BURST; ++i) {
+            live[i] = j->a->alloc(j->ctx);
+            stamp(live[i], j->thread, round * BURST + (uint64_t)i);
+        }
+        for (int i = 0; i < BURST; ++i) {
+            j->ok &= stamped(live[i], j->thread, round * BURST + (uint64_t)i);
+            j->a->free(j->ctx, live[i]);
+        }
+    }
+    free(live);
+}
+/* burst on a per-thread arena: the allocations are bumps, the frees one Reset per round */
+static void
+arena_job (void * arg) {
+    Job * j = (Job *)arg;
+    MemArena * arena = (MemArena *)j->ctx;
+    void ** live = (void **)malloc(BURST * sizeof(void *));
+    for (uint64_t round = 0; round < OPS_PER_THREAD / BURST; ++round) {
+        size_t mark = MemArena_Mark(arena);
+        for (int i = 0; i < BURST; ++i) {
+            live[i] = MemArena_Alloc(arena, OBJ_SIZE, 0);
+            stamp(live[i], j->thread, round * BURST + (uint64_t)i);
+        }
+        for (int i = 0; i < BURST; ++i)
+            j->ok &= stamped(live[i], j->thread, round * BURST + (uint64_t)i);
+        MemArena_Reset(arena, mark);
+    }
+    free(live);
+}
+#pragma endregion
+
+// =========================================================================================
+
+static int const g_threads [] = {1, 2, 4, 8};
+
+/* M alloc/free pairs per second over all threads, best of BENCH_REPS */
+static double
+measure (MtThreadFn fn, Allocator const * a, int n_threads, int * ok) {
+    double best = 1e30;
+    for (int rep = 0; rep < BENCH_REPS; ++rep) {
+        Job jobs[MAX_THREADS];
+        MemPool pool;
+        MemArena arenas[MAX_THREADS];
+        int is_pool = (a != NULL && a->alloc == pool_alloc);
+        size_t align = (a != NULL && 0 == strcmp(a->name, "MemPool aligned")) ? MEM_CACHE_LINE : 0;
+
+        if (is_pool && !MemPool_Init(&pool, OBJ_SIZE, align, (size_t)n_threads * (BURST + 4 * WINDOW))) {
+            *ok = 0;
+            return 0;
+        }
+        for (int i = 0; i < n_threads; ++i) {
+            jobs[i].a = a;
+            jobs[i].ctx = is_pool ? (void *)&pool : NULL;
+            jobs[i].thread = i;
+            jobs[i].ok = 1;
+            if (NULL == a) {
+                MemArena_Init(&arenas[i], BURST * OBJ_SIZE);
+                jobs[i].ctx = &arenas[i];
+            }
+        }
+        double t = BenchUtil_RunThreads(n_threads, fn, jobs, sizeof(Job));
+        *ok &= (t >= 0);
+        for (int i = 0; i < n_threads; ++i) {
+            *ok &= jobs[i].ok;
+            if (NULL == a)
+                MemArena_Deinit(&arenas[i]);
+        }
+        if (is_pool)
+            MemPool_Deinit(&pool);
+        if (t < best)
+            best = t;
+    }
+    return (double)n_threads * OPS_PER_THREAD / best / 1e6;
+}
+
+static void
+bench_pattern (char const * title, MtThreadFn fn, int with_arena) {
+    printf("\n%s: M alloc+free per second, %d-byte objects (best of %d)\n", title, OBJ_SIZE, BENCH_REPS);
+    printf("%-18s", "threads");
+    for (size_t t = 0; t < _countof(g_threads); ++t)
+        printf(" %10d", g_threads[t]);
+    printf("\n");
+
+    for (size_t k = 0; k < _countof(g_allocators) + (size_t)with_arena; ++k) {
+        Allocator const * a = (k < _countof(g_allocators)) ? &g_allocators[k] : NULL;
+        int ok = 1;
+        printf("%-18s", a ? a->name : "MemArena");
+        for (size_t t = 0; t < _countof(g_threads); ++t) {
+            printf(" %10.1f", measure(a ? fn : arena_job, a, g_threads[t], &ok));
+            fflush(stdout);
+        }
+        printf("%s\n", ok ? "" : "  (CORRUPT)");
+    }
+}
+
+int main (int argc, char * argv []) {
+    if (BenchUtil_Wanted(argc, argv, "churn"))
+        bench_pattern("churn (random frees in a window)", churn_job, 0);
+    if (BenchUtil_Wanted(argc, argv, "burst"))
+        bench_pattern("burst (allocate all, then free all)", burst_job, 1);
+    return(0);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+/* ===========================================================
+   #File: win32_compat.h #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: The Win32 type names the portable modules use, defined once off Windows #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+/*
+Interfaces shared with Linux (Reprt_Err.h, the cstr helpers) are written
+with TCHAR, DWORD and BOOL. On Windows those come from windows.h; anywhere
+else this is the only place that defines them, so headers that need them
+can be included together.
+*/
+#ifdef _WIN32
+#include <windows.h>
+#include <tchar.h>
+#else
+#include <string.h>
+
+typedef char TCHAR;
+typedef char * LPTSTR;
+typedef char const * LPCTSTR;
+typedef unsigned int DWORD;
+typedef int BOOL;
+#define _T(x)       x
+#define _tcslen     strlen
+#define TRUE        1
+#define FALSE       0
+#endif
@@ -0,0 +1,567 @@
+/* ===========================================================
+   #File: log.c #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Structured, asynchronous logging for the tools #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#ifndef _WIN32
+#define _GNU_SOURCE     /* syscall(SYS_gettid) */
+#endif
+
+#include "log.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#define DEFAULT_RING_BYTES  (64 * 1024)
+#define MAX_SINKS           4
+#define POLL_MS             20          /* the writer looks at the rings at least this often */
+#define PAD_MARK            0xFFFFFFFFu /* rest of the ring is unused, continue at 0 */
+
+typedef struct LogRing {
+    struct LogRing *    next;           /* registry, newest first; unlinked by the writer only */
+    uint8_t *           buf;
+    size_t              size;           /* a power of 2 */
+    uint32_t            thread_id;
+    volatile int        exited;         /* the owner is gone: free once drained */
+    char                pad0[64];
+    volatile int64_t    head;           /* bytes ever written, by the owner thread only */
+    char                pad1[64];
+    volatile int64_t    tail;           /* bytes ever consumed, by the writer only */
+    char                pad2[64];
+} LogRing;
+
+// =========================================================================================
+
+#pragma region platform
+#ifdef _WIN32
+#define THREAD_LOCAL __declspec(thread)
+typedef SRWLOCK             log_mutex;
+typedef CONDITION_VARIABLE  log_cond;
+static log_mutex g_mutex = SRWLOCK_INIT;
+static log_cond g_cond_work = CONDITION_VARIABLE_INIT;
+static log_cond g_cond_done = CONDITION_VARIABLE_INIT;
+static HANDLE g_writer;
+static DWORD g_exit_key = FLS_OUT_OF_INDEXES;
+
+static void lock (void)                     { AcquireSRWLockExclusive(&g_mutex); }
+static void unlock (void)                   { ReleaseSRWLockExclusive(&g_mutex); }
+static void cond_wait (log_cond * c, DWORD ms)  { SleepConditionVariableSRW(c, &g_mutex, ms, 0); }
+static void wake_all (log_cond * c)         { WakeAllConditionVariable(c); }
+
+static int64_t load_acquire (volatile int64_t * p)          { return ReadAcquire64(p); }
+static void store_release (volatile int64_t * p, int64_t v) { WriteRelease64(p, v); }
+static uint64_t add_relaxed (volatile uint64_t * p)         { return (uint64_t)InterlockedIncrement64((volatile LONG64 *)p); }
+static int load_int (volatile int * p)                      { return ReadNoFence((volatile LONG *)p); }
+static void store_int_release (volatile int * p, int v)     { WriteRelease((volatile LONG *)p, v); }
+static int load_int_acquire (volatile int * p)              { return ReadAcquire((volatile LONG *)p); }
+static void store_int_seq (volatile int * p, int v)         { InterlockedExchange((volatile LONG *)p, v); }
+static int load_int_seq (volatile int * p)                  { return InterlockedCompareExchange((volatile LONG *)p, 0, 0); }
+static void add_int_seq (volatile int * p, int v)           { InterlockedExchangeAdd((volatile LONG *)p, v); }
+static void yield (void)                                    { SwitchToThread(); }
+
+static uint32_t
+thread_id (void) {
+    return (uint32_t)GetCurrentThreadId();
+}
+static uint64_t
+now_ns (void) {
+    FILETIME ft;
+    ULARGE_INTEGER t;
+    GetSystemTimePreciseAsFileTime(&ft);
+    t.LowPart = ft.dwLowDateTime;
+    t.HighPart = ft.dwHighDateTime;
+    /* -- 100 ns units since 1601 */
+    return (t.QuadPart - 116444736000000000ULL) * 100;
+}
+static void
+utc (time_t s, struct tm * tm) {
+    gmtime_s(tm, &s);
+}
+static DWORD WINAPI writer_main (LPVOID arg);
+static int
+start_writer (void) {
+    g_writer = CreateThread(NULL, 0, writer_main, NULL, 0, NULL);
+    return g_writer != NULL;
+}
+static void
+join_writer (void) {
+    WaitForSingleObject(g_writer, INFINITE);
+    CloseHandle(g_writer);
+}
+static void thread_exited (void * arg);
+static VOID WINAPI
+fls_exit (PVOID value) {
+    if (value != NULL)
+        thread_exited(value);
+}
+/* Thread exit calls thread_exited(value) for every thread that set a value */
+static int
+create_exit_key (void) {
+    if (FLS_OUT_OF_INDEXES == g_exit_key)
+        g_exit_key = FlsAlloc(fls_exit);
+    return FLS_OUT_OF_INDEXES != g_exit_key;
+}
+static void set_exit_value (void * value)   { FlsSetValue(g_exit_key, value); }
+#else   /* POSIX */
+#define THREAD_LOCAL _Thread_local
+typedef pthread_cond_t log_cond;
+static pthread_mutex_t g_mutex = PTHREAD_MUTEX_INITIALIZER;
+static log_cond g_cond_work = PTHREAD_COND_INITIALIZER;
+static log_cond g_cond_done = PTHREAD_COND_INITIALIZER;
+static pthread_t g_writer;
+static pthread_key_t g_exit_key;
+static int g_exit_key_created;
+
+static void lock (void)                     { pthread_mutex_lock(&g_mutex); }
+static void unlock (void)                   { pthread_mutex_unlock(&g_mutex); }
+static void wake_all (log_cond * c)         { pthread_cond_broadcast(c); }
+static void
+cond_wait (log_cond * c, unsigned ms) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_nsec += (long)(ms % 1000) * 1000000;
+    ts.tv_sec += ms / 1000 + ts.tv_nsec / 1000000000;
+    ts.tv_nsec %= 1000000000;
+    pthread_cond_timedwait(c, &g_mutex, &ts);
+}
+
+static int64_t load_acquire (volatile int64_t * p)          { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+static void store_release (volatile int64_t * p, int64_t v) { __atomic_store_n(p, v, __ATOMIC_RELEASE); }
+static uint64_t add_relaxed (volatile uint64_t * p)         { return __atomic_add_fetch(p, 1, __ATOMIC_RELAXED); }
+static int load_int (volatile int * p)                      { return __atomic_load_n(p, __ATOMIC_RELAXED); }
+static void store_int_release (volatile int * p, int v)     { __atomic_store_n(p, v, __ATOMIC_RELEASE); }
+static int load_int_acquire (volatile int * p)              { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+static void store_int_seq (volatile int * p, int v)         { __atomic_store_n(p, v, __ATOMIC_SEQ_CST); }
+static int load_int_seq (volatile int * p)                  { return __atomic_load_n(p, __ATOMIC_SEQ_CST); }
+static void add_int_seq (volatile int * p, int v)           { __atomic_add_fetch(p, v, __ATOMIC_SEQ_CST); }
+static void yield (void)                                    { sched_yield(); }
+
+static uint32_t
+thread_id (void) {
+    return (uint32_t)syscall(SYS_gettid);
+}
+static uint64_t
+now_ns (void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+static void
+utc (time_t s, struct tm * tm) {
+    gmtime_r(&s, tm);
+}
+static void * writer_main (void * arg);
+static int
+start_writer (void) {
+    return 0 == pthread_create(&g_writer, NULL, writer_main, NULL);
+}
+static void
+join_writer (void) {
+    pthread_join(g_writer, NULL);
+}
+static void thread_exited (void * arg);
+/* Thread exit calls thread_exited(value) for every thread that set a value */
+static int
+create_exit_key (void) {
+    if (!g_exit_key_created)
+        g_exit_key_created = (0 == pthread_key_create(&g_exit_key, thread_exited));
+    return g_exit_key_created;
+}
+static void set_exit_value (void * value)   { pthread_setspecific(g_exit_key, value); }
+#endif
+#pragma endregion
+
+// =========================================================================================
+
+/* Shared state; everything but the rings' head/tail/exited, the counters, g_generation and g_level is under g_mutex */
+static LogRing *            g_rings;
+static volatile int64_t     g_generation;       /* bumped when Log_Shutdown frees the rings; read without the lock */
+static volatile int         g_writing;          /* Log_WriteV calls between their check of g_running and the publish */
+static size_t               g_ring_bytes = DEFAULT_RING_BYTES;
+static FILE *               g_text[MAX_SINKS];
+static FILE *               g_binary[MAX_SINKS];
+static int                  g_n_text, g_n_binary;
+static volatile int         g_running;
+static volatile int         g_level = LOG_DEBUG;
+static int                  g_stop;
+static int                  g_atexit;
+static uint64_t             g_flush_requested, g_flush_done;
+static volatile uint64_t    g_dropped;
+static uint64_t             g_dropped_reported;
+
+static THREAD_LOCAL LogRing * t_ring;
+static THREAD_LOCAL int64_t t_generation;       /* of t_ring: a ring of an older one is freed */
+
+static char const * const g_level_names [] = {"DEBUG", "INFO", "WARN", "ERROR", "FATAL"};
+
+static size_t
+align8 (size_t n) {
+    return (n + 7) & ~(size_t)7;
+}
+/* Only while g_running: Log_Shutdown waits for the caller before it frees the rings */
+static LogRing *
+my_ring (void) {
+    if (t_ring)
+        return t_ring;
+
+    LogRing * r = (LogRing *)calloc(1, sizeof(LogRing));
+    if (NULL == r)
+        return NULL;
+    lock();
+    r->size = g_ring_bytes;
+    unlock();
+    r->buf = (uint8_t *)malloc(r->size);
+    if (NULL == r->buf) {
+        free(r);
+        return NULL;
+    }
+    r->thread_id = thread_id();
+
+    lock();
+    r->next = g_rings;
+    g_rings = r;
+    t_generation = load_acquire(&g_generation);
+    unlock();
+    t_ring = r;
+    set_exit_value(r);
+    return r;
+}
+/* The owner is done with its ring; the writer frees it once drained */
+static void
+thread_exited (void * arg) {
+    LogRing * r = (LogRing *)arg;
+    lock();
+    // -- a ring of an older generation went with its Log_Shutdown
+    if (r == t_ring && t_generation == load_acquire(&g_generation))
+        store_int_release(&r->exited, 1);
+    unlock();
+    t_ring = NULL;
+}
+static void
+free_ring (LogRing * r) {
+    free(r->buf);
+    free(r);
+}
+
+#pragma region writer
+static void
+write_text (FILE * f, LogRecord const * rec, char const * tag, char const * msg) {
+    static time_t s_sec = -1;           /* only the writer thread gets here */
+    static char s_stamp[32];
+    time_t sec = (time_t)(rec->time_ns / 1000000000ULL);
+    if (sec != s_sec) {
+        struct tm tm;
+        utc(sec, &tm);
+        strftime(s_stamp, sizeof(s_stamp), "%Y-%m-%dT%H:%M:%S", &tm);
+        s_sec = sec;
+    }
+    fprintf(
+        f, "%s.%06uZ %-5s [%.*s] tid=%u code=%u %.*s\n",
+        s_stamp, (unsigned)(rec->time_ns % 1000000000ULL / 1000),
+        (rec->level <= LOG_FATAL) ? g_level_names[rec->level] : "?",
+        (int)rec->tag_len, tag, (unsigned)rec->thread_id, (unsigned)rec->code,
+        (int)rec->msg_len, msg
+    );
+}
+/* Move everything in the rings to the sinks; returns the # of records */
+static size_t
+drain (LogRing * rings, FILE ** text, int n_text, FILE ** binary, int n_binary) {
+    size_t n = 0;
+    for (LogRing * r = rings; r; r = r->next) {
+        int64_t tail = r->tail;
+        int64_t head = load_acquire(&r->head);
+        while (tail < head) {
+            size_t pos = (size_t)tail & (r->size - 1);
+            LogRecord const * rec = (LogRecord const *)(r->buf + pos);
+            if (PAD_MARK == rec->size) {
+                tail += (int64_t)(r->size - pos);
+                continue;
+            }
+            char const * tag = (char const *)(rec + 1);
+            char const * msg = tag + rec->tag_len;
+            for (int i = 0; i < n_text; ++i)
+                write_text(text[i], rec, tag, msg);
+            for (int i = 0; i < n_binary; ++i)
+                fwrite(rec, rec->size, 1, binary[i]);
+            tail += rec->size;
+            ++n;
+        }
+        /* -- hand the space back to the producer */
+        store_release(&r->tail, tail);
+    }
+    return n;
+}
+static void
+writer_pass (void) {
+    FILE * text[MAX_SINKS];
+    FILE * binary[MAX_SINKS];
+    int n_text, n_binary;
+    LogRing * rings;
+
+    lock();
+    rings = g_rings;
+    n_text = g_n_text;
+    n_binary = g_n_binary;
+    memcpy(text, g_text, sizeof(text));
+    memcpy(binary, g_binary, sizeof(binary));
+    unlock();
+
+    size_t n = drain(rings, text, n_text, binary, n_binary);
+
+    /* -- rings of exited threads, drained: their owners wrote everything before exited */
+    lock();
+    for (LogRing ** link = &g_rings; *link; ) {
+        LogRing * r = *link;
+        if (load_int_acquire(&r->exited) && r->tail == load_acquire(&r->head)) {
+            *link = r->next;
+            free_ring(r);
+        } else {
+            link = &r->next;
+        }
+    }
+    unlock();
+
+    uint64_t dropped = load_acquire((volatile int64_t *)&g_dropped);
+    if (dropped != g_dropped_reported) {
+        for (int i = 0; i < n_text; ++i)
+            fprintf(text[i], "(%llu record(s) dropped on full rings)\n", (unsigned long long)(dropped - g_dropped_reported));
+        g_dropped_reported = dropped;
+        n++;
+    }
+    if (n > 0) {
+        for (int i = 0; i < n_text; ++i)
+            fflush(text[i]);
+        for (int i = 0; i < n_binary; ++i)
+            fflush(binary[i]);
+    }
+}
+#ifdef _WIN32
+static DWORD WINAPI
+writer_main (LPVOID arg)
+#else
+static void *
+writer_main (void * arg)
+#endif
+{
+    (void)arg;
+    lock();
+    for (;;) {
+        uint64_t requested = g_flush_requested;
+        int stop = g_stop;
+        unlock();
+
+        writer_pass();
+
+        lock();
+        g_flush_done = requested;
+        wake_all(&g_cond_done);
+        if (stop)
+            break;
+        if (g_flush_requested == g_flush_done && !g_stop)
+            cond_wait(&g_cond_work, POLL_MS);
+    }
+    unlock();
+    return 0;
+}
+#pragma endregion
+
+// =========================================================================================
+
+int
+Log_Init (size_t ring_bytes) {
+    size_t size = DEFAULT_RING_BYTES;
+    if (ring_bytes) {
+        /* -- a power of 2 with room for the largest record */
+        size = 4096;
+        while (size < ring_bytes)
+            size *= 2;
+    }
+
+    lock();
+    if (g_running) {
+        unlock();
+        return 1;
+    }
+    g_ring_bytes = size;
+    g_stop = 0;
+    if (!create_exit_key() || !start_writer()) {
+        unlock();
+        return 0;
+    }
+    store_int_seq(&g_running, 1);
+    if (!g_atexit)
+        g_atexit = (0 == atexit(Log_Shutdown));
+    unlock();
+    return 1;
+}
+void
+Log_Shutdown (void) {
+    lock();
+    if (!g_running) {
+        unlock();
+        return;
+    }
+    store_int_seq(&g_running, 0);
+    unlock();
+
+    /* -- new records are refused now; the ones being written are let through */
+    while (load_int_seq(&g_writing) > 0)
+        yield();
+
+    lock();
+    g_stop = 1;
+    wake_all(&g_cond_work);
+    unlock();
+
+    /* -- the writer's last pass drains every record published so far */
+    join_writer();
+
+    lock();
+    for (LogRing * r = g_rings, * next; r; r = next) {
+        next = r->next;
+        free_ring(r);
+    }
+    g_rings = NULL;
+    store_release(&g_generation, load_acquire(&g_generation) + 1);
+    for (int i = 0; i < g_n_text; ++i)
+        fclose(g_text[i]);
+    for (int i = 0; i < g_n_binary; ++i)
+        fclose(g_binary[i]);
+    g_n_text = g_n_binary = 0;
+    unlock();
+}
+int
+Log_AddTextSink (FILE * f) {
+    int ok;
+    lock();
+    ok = g_n_text < MAX_SINKS;
+    if (ok)
+        g_text[g_n_text++] = f;
+    unlock();
+    return ok;
+}
+int
+Log_AddBinarySink (FILE * f) {
+    int ok;
+    lock();
+    ok = g_n_binary < MAX_SINKS && 1 == fwrite(LOG_BINARY_MAGIC, 8, 1, f);
+    if (ok)
+        g_binary[g_n_binary++] = f;
+    unlock();
+    return ok;
+}
+void
+Log_SetLevel (LogLevel level) {
+    g_level = (int)level;
+}
+static void
+log_record (LogRing * r, LogLevel level, char const * tag, uint32_t code, char const * fmt, va_list args) {
+    char msg[LOG_TEXT_MAX];
+
+    /* -- format before touching the ring; vsnprintf gives the untruncated length */
+    int n = vsnprintf(msg, sizeof(msg), fmt, args);
+    size_t msg_len = (n < 0) ? 0 : ((size_t)n >= sizeof(msg)) ? sizeof(msg) - 1 : (size_t)n;
+    size_t tag_len = tag ? strlen(tag) : 0;
+    if (tag_len > 255)
+        tag_len = 255;
+    size_t need = align8(sizeof(LogRecord) + tag_len + msg_len);
+
+    int64_t head = r->head;
+    int64_t tail = load_acquire(&r->tail);
+    size_t pos = (size_t)head & (r->size - 1);
+    size_t pad = (pos + need > r->size) ? r->size - pos : 0;   /* records never wrap */
+    size_t used = (size_t)(head - tail);
+    if (used + pad + need > r->size) {
+        add_relaxed(&g_dropped);
+        return;
+    }
+    if (pad) {
+        *(uint32_t *)(r->buf + pos) = PAD_MARK;
+        head += (int64_t)pad;
+        pos = 0;
+    }
+
+    LogRecord * rec = (LogRecord *)(r->buf + pos);
+    rec->size = (uint32_t)need;
+    rec->thread_id = r->thread_id;
+    rec->time_ns = now_ns();
+    rec->code = code;
+    rec->level = (uint16_t)level;
+    rec->tag_len = (uint8_t)tag_len;
+    rec->reserved = 0;
+    rec->msg_len = (uint32_t)msg_len;
+    rec->reserved2 = 0;
+    memcpy(rec + 1, tag, tag_len);
+    memcpy((char *)(rec + 1) + tag_len, msg, msg_len);
+
+    /* -- publish; past half full, wake the writer instead of waiting for its poll */
+    store_release(&r->head, head + (int64_t)need);
+    if (used < r->size / 2 && used + pad + need >= r->size / 2)
+        wake_all(&g_cond_work);
+}
+void
+Log_WriteV (LogLevel level, char const * tag, uint32_t code, char const * fmt, va_list args) {
+    if ((int)level < load_int(&g_level) || !load_int(&g_running))
+        return;
+
+    /* -- announced before g_running is checked again: Log_Shutdown waits for it or refuses it */
+    add_int_seq(&g_writing, 1);
+    if (!load_int_seq(&g_running)) {
+        add_int_seq(&g_writing, -1);
+        return;
+    }
+    if (t_ring && t_generation != load_acquire(&g_generation))
+        t_ring = NULL;          // freed by an earlier Log_Shutdown
+    LogRing * r = my_ring();
+    if (NULL == r) {
+        add_relaxed(&g_dropped);
+        add_int_seq(&g_writing, -1);
+        return;
+    }
+    log_record(r, level, tag, code, fmt, args);
+    add_int_seq(&g_writing, -1);
+}
+void
+Log_Write (LogLevel level, char const * tag, uint32_t code, char const * fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    Log_WriteV(level, tag, code, fmt, args);
+    va_end(args);
+}
+void
+Log_Flush (void) {
+    lock();
+    if (g_running) {
+        uint64_t seq = ++g_flush_requested;
+        wake_all(&g_cond_work);
+        while (g_running && g_flush_done < seq)
+            cond_wait(&g_cond_done, POLL_MS);
+    }
+    unlock();
+}
+void
+Log_ThreadExit (void) {
+    LogRing * r = t_ring;
+    if (r != NULL) {
+        set_exit_value(NULL);
+        thread_exited(r);
+    }
+}
+uint64_t
+Log_Dropped (void) {
+    return (uint64_t)load_acquire((volatile int64_t *)&g_dropped);
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+/* ===========================================================
+   #File: log.h #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Structured, asynchronous logging for the tools #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+Log_Write never formats into a lock, never calls the file system and never
+waits: the record (time, thread id, level, error code, source tag, message)
+is formatted straight into a ring buffer owned by the calling thread.
+A single background writer drains every ring into the sinks.
+
+ - A ring is created on the first Log_Write of a thread. When the thread
+   exits (or calls Log_ThreadExit) the writer drains the ring and frees
+   it, so threads may come and go; each live one costs ring_bytes.
+ - Log_Shutdown refuses new records, waits for the ones being written,
+   drains everything into the sinks and frees every ring.
+ - When a ring is full the record is dropped, not waited for; the writer
+   reports the # of dropped records in the text sinks.
+ - Text sinks get one line per record; binary sinks get LOG_BINARY_MAGIC
+   followed by the raw LogRecord/tag/message triples, for tools to parse.
+ - Log_Flush returns once everything logged before the call is in the
+   sinks and the sinks are flushed. Log_Init registers Log_Shutdown with
+   atexit; paths that leave through ExitProcess/_exit must call it first.
+ - Messages are UTF-8; tags and messages are cut at LOG_TEXT_MAX bytes.
+*/
+
+typedef enum LogLevel {
+    LOG_DEBUG,
+    LOG_INFO,
+    LOG_WARN,
+    LOG_ERROR,
+    LOG_FATAL
+} LogLevel;
+
+#define LOG_BINARY_MAGIC    "PLOGBIN1"
+#define LOG_TEXT_MAX        1024
+
+/* Layout of a record in the rings and in binary sinks; tag and message follow */
+typedef struct LogRecord {
+    uint32_t    size;           // whole record, 8-byte aligned
+    uint32_t    thread_id;
+    uint64_t    time_ns;        // since 1970-01-01 UTC
+    uint32_t    code;           // GetLastError, errno, or 0
+    uint16_t    level;          // LogLevel
+    uint8_t     tag_len;
+    uint8_t     reserved;
+    uint32_t    msg_len;
+    uint32_t    reserved2;
+} LogRecord;
+
+/* ring_bytes 0 picks the default (64 KB per thread); false if the writer could not start */
+int
+Log_Init (size_t ring_bytes);
+
+/* Flush, stop the writer and close the sinks; safe to call more than once */
+void
+Log_Shutdown (void);
+
+/* The sinks take ownership of f and fclose it at shutdown; up to 4 of each */
+int
+Log_AddTextSink (FILE * f);
+
+int
+Log_AddBinarySink (FILE * f);
+
+/* Records below level are discarded at the call site */
+void
+Log_SetLevel (LogLevel level);
+
+void
+Log_Write (LogLevel level, char const * tag, uint32_t code, char const * fmt, ...);
+
+void
+Log_WriteV (LogLevel level, char const * tag, uint32_t code, char const * fmt, va_list args);
+
+void
+Log_Flush (void);
+
+/* The calling thread logs no more: its ring goes once drained; thread exit does the same */
+void
+Log_ThreadExit (void);
+
+/* # of records dropped on full rings so far */
+uint64_t
+Log_Dropped (void);
+
+#ifdef __cplusplus
+}
+#endif
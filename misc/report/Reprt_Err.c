@@ -1,46 +1,257 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L    /* strerror_r, write */
+#endif
+
 #include "Reprt_Err.h"
+#include "../log/log.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <unistd.h>
+#endif
+
+#define MSG_CACHE_SIZE  512     /* distinct error numbers kept, a power of 2 */
+#define MSG_MAX         512     /* characters of one system message */
+#define LINE_MAX_CCH    2048    /* characters of one report */
+
+/* One cached message; never freed, readers may hold it forever */
+typedef struct MSG_ENTRY {
+    DWORD errnum;
+    TCHAR text[1];
+} MSG_ENTRY;
+
 /*
-General-purpose function for reporting system errors.
-Obtain the error number,
-and convert it to the system error message.
-Display this information
-and the user-specified msg to standard error device.
-umsg:       message to be displayed to standard error device.
-excode:     0 - Return.
-            > 0 - ExitProcess with this code.
-print_err:  Display the last system error message ?
+Open addressing, insert-only: a slot goes from NULL to an entry once
+and never changes again, so lookups need nothing but an acquire load.
 */
+static MSG_ENTRY * volatile g_msg_cache[MSG_CACHE_SIZE];
+
+/* Messages past the cache capacity; valid until the thread's next call */
+#ifdef _WIN32
+static __declspec(thread) TCHAR t_overflow[MSG_MAX];
+#else
+static _Thread_local TCHAR t_overflow[MSG_MAX];
+#endif
+
+#pragma region platform
+#ifdef _WIN32
+static MSG_ENTRY *
+cache_load (MSG_ENTRY * volatile * slot) {
+    return (MSG_ENTRY *)ReadPointerAcquire((PVOID const volatile *)slot);
+}
+static MSG_ENTRY *
+cache_publish (MSG_ENTRY * volatile * slot, MSG_ENTRY * e) {
+    /* -- returns what was in the slot: NULL if e went in */
+    return (MSG_ENTRY *)InterlockedCompareExchangePointer((PVOID volatile *)slot, e, NULL);
+}
+static size_t
+format_system (DWORD errnum, TCHAR * buf, size_t cch) {
+    /* -- into our buffer: no FORMAT_MESSAGE_ALLOCATE_BUFFER, no LocalFree */
+    return FormatMessage(
+        FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
+        NULL, errnum,
+        MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT),
+        buf, (DWORD)cch, NULL
+    );
+}
+static DWORD
+last_error (void) {
+    return GetLastError();
+}
+static void
+write_stderr (TCHAR const * text, size_t cch) {
+    HANDLE h = GetStdHandle(STD_ERROR_HANDLE);
+    DWORD mode, n;
+#ifdef UNICODE
+    char bytes[LINE_MAX_CCH * 3];
+    int cb;
+    /* -- a console takes the UTF-16 text as is, one call is one line */
+    if (GetConsoleMode(h, &mode)) {
+        WriteConsole(h, text, (DWORD)cch, &n, NULL);
+        return;
+    }
+    cb = WideCharToMultiByte(CP_ACP, 0, text, (int)cch, bytes, (int)sizeof(bytes), NULL, NULL);
+    WriteFile(h, bytes, (DWORD)cb, &n, NULL);
+#else
+    (void)mode;
+    WriteFile(h, text, (DWORD)cch, &n, NULL);
+#endif
+}
+static void
+exit_process (DWORD excode) {
+    ExitProcess(excode);
+}
+#else   /* POSIX */
+static MSG_ENTRY *
+cache_load (MSG_ENTRY * volatile * slot) {
+    return __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+}
+static MSG_ENTRY *
+cache_publish (MSG_ENTRY * volatile * slot, MSG_ENTRY * e) {
+    MSG_ENTRY * expected = NULL;
+    __atomic_compare_exchange_n(slot, &expected, e, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+    return expected;
+}
+/* strerror_r is int (XSI) or char * (GNU) depending on the feature macros */
+static char const *
+strerror_xsi (int r, char const * buf) {
+    return (0 == r) ? buf : NULL;
+}
+static char const *
+strerror_gnu (char const * r, char const * buf) {
+    (void)buf;
+    return r;
+}
+#define STRERROR_R(e, buf, n) \
+    _Generic(strerror_r((e), (buf), (n)), int: strerror_xsi, default: strerror_gnu)(strerror_r((e), (buf), (n)), (buf))
+
+static size_t
+format_system (DWORD errnum, TCHAR * buf, size_t cch) {
+    char const * s;
+    size_t len;
+    buf[0] = 0;
+    s = STRERROR_R((int)errnum, buf, cch);
+    if (NULL == s || 0 == s[0])
+        return 0;
+    len = strlen(s);
+    if (len > cch - 1)
+        len = cch - 1;
+    memmove(buf, s, len);   /* GNU may return a static string instead of buf */
+    buf[len] = 0;
+    return len;
+}
+static DWORD
+last_error (void) {
+    return (DWORD)errno;
+}
+static void
+write_stderr (TCHAR const * text, size_t cch) {
+    /* -- one write(2) per line: the kernel keeps it whole for pipes and O_APPEND files */
+    while (cch > 0) {
+        ssize_t n = write(STDERR_FILENO, text, cch);
+        if (n <= 0)
+            return;
+        text += n;
+        cch -= (size_t)n;
+    }
+}
+static void
+exit_process (DWORD excode) {
+    exit((int)excode);
+}
+#endif
+#pragma endregion
+
+static size_t
+append (TCHAR * line, size_t cch_line, size_t len, LPCTSTR s) {
+    while (*s && len + 1 < cch_line)
+        line[len++] = *s++;
+    line[len] = 0;
+    return len;
+}
+/* text must hold MSG_MAX characters */
+static size_t
+format_message (DWORD errnum, TCHAR * text) {
+    size_t len = format_system(errnum, text, MSG_MAX);
+
+    /* -- FormatMessage ends its text with CR LF, the report adds its own */
+    while (len > 0 && (text[len - 1] == _T('\n') || text[len - 1] == _T('\r') || text[len - 1] == _T(' ')))
+        len--;
+    if (0 == len) {
+#ifdef _WIN32
+        len = (size_t)_sntprintf_s(text, MSG_MAX, _TRUNCATE, _T("Last Error Number: %lu."), (unsigned long)errnum);
+#else
+        len = (size_t)snprintf(text, MSG_MAX, "Last Error Number: %lu.", (unsigned long)errnum);
+#endif
+    }
+    text[len] = 0;
+    return len;
+}
+static void
+to_utf8 (LPCTSTR s, char * out, int cb_out) {
+#ifdef UNICODE
+    int cb = WideCharToMultiByte(CP_UTF8, 0, s, -1, out, cb_out, NULL, NULL);
+    if (0 == cb)    /* -- did not fit: keep what did */
+        out[cb_out - 1] = 0;
+#else
+    snprintf(out, (size_t)cb_out, "%s", s);
+#endif
+}
+static MSG_ENTRY *
+make_entry (DWORD errnum) {
+    TCHAR text[MSG_MAX];
+    size_t len = format_message(errnum, text);
+    MSG_ENTRY * e = (MSG_ENTRY *)malloc(sizeof(MSG_ENTRY) + len * sizeof(TCHAR));
+    if (e != NULL) {
+        e->errnum = errnum;
+        memcpy(e->text, text, (len + 1) * sizeof(TCHAR));
+    }
+    return e;
+}
+
+LPCTSTR
+SysErrorMessage (DWORD errnum) {
+    static TCHAR const no_memory [] = _T("(out of memory formatting the error message)");
+    size_t i = (size_t)(errnum * 2654435761u) & (MSG_CACHE_SIZE - 1);
+    MSG_ENTRY * mine = NULL;
+
+    for (size_t probes = 0; probes < MSG_CACHE_SIZE; probes++, i = (i + 1) & (MSG_CACHE_SIZE - 1)) {
+        MSG_ENTRY * e = cache_load(&g_msg_cache[i]);
+        if (e == NULL) {
+            /* -- miss: format (outside any lock) and race to publish */
+            if (mine == NULL && (mine = make_entry(errnum)) == NULL)
+                return no_memory;
+            e = cache_publish(&g_msg_cache[i], mine);
+            if (e == NULL)
+                return mine->text;
+        }
+        if (e->errnum == errnum) {
+            free(mine);         /* another thread published the same number first */
+            return e->text;
+        }
+    }
+    /* -- table full: this one is formatted again on every call */
+    free(mine);
+    format_message(errnum, t_overflow);
+    return t_overflow;
+}
+
 void
 ReportError (
     LPCTSTR umsg,        // user-message
     DWORD excode,        // exit-code
     BOOL print_err
 ) {
-    DWORD emsg_len, errnum;
-    LPTSTR sysmsg;
-    errnum = GetLastError();
-    _ftprintf(stderr, _T("%s\n"), umsg);
-    if(print_err) {
-        emsg_len = FormatMessage(
-            FORMAT_MESSAGE_ALLOCATE_BUFFER |
-            FORMAT_MESSAGE_FROM_SYSTEM,
-            NULL, errnum,
-            MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT),
-            (LPTSTR) &sysmsg, 0, NULL
-        );
-        if (emsg_len > 0) {
-            _ftprintf(stderr, _T("%s\n"), sysmsg);
-        } else {
-            _ftprintf(
-                stderr,
-                _T("Last Error Number: %d.\n"), errnum
-            );
-        }
-        if (sysmsg != NULL)
-            LocalFree(sysmsg);
+    TCHAR line[LINE_MAX_CCH];
+    size_t len = 0;
+    DWORD errnum = last_error();
+
+    /* -- the whole report is built first and written with one call;
+          texts stop one short of the end so the line break always fits */
+    len = append(line, LINE_MAX_CCH - 1, len, umsg);
+    len = append(line, LINE_MAX_CCH, len, _T("\n"));
+    if (print_err) {
+        len = append(line, LINE_MAX_CCH - 1, len, SysErrorMessage(errnum));
+        len = append(line, LINE_MAX_CCH, len, _T("\n"));
+    }
+    write_stderr(line, len);
+
+    /* -- the structured copy, if the tool started the log (a no-op otherwise) */
+    char log_umsg[LOG_TEXT_MAX / 2], log_sysmsg[LOG_TEXT_MAX / 2];
+    to_utf8(umsg, log_umsg, sizeof(log_umsg));
+    to_utf8(print_err ? SysErrorMessage(errnum) : _T(""), log_sysmsg, sizeof(log_sysmsg));
+    Log_Write(
+        excode > 0 ? LOG_FATAL : LOG_ERROR, "report", errnum,
+        print_err ? "%s: %s" : "%s", log_umsg, log_sysmsg
+    );
+
+    if (excode > 0) {
+        /* -- ExitProcess skips atexit: flush the log first */
+        Log_Shutdown();
+        exit_process(excode);
     }
-    if (excode > 0)
-        ExitProcess(excode);
     return;
-}
\ No newline at end of file
+}
@@ -1,10 +1,10 @@
 #pragma once
 
-#include <windows.h>
-#include <tchar.h>
+#include "../compat/win32_compat.h"
+
 /*
 General-purpose function for reporting system errors.
-Obtain the error number,
+Obtain the error number (GetLastError, errno on Linux),
 and convert it to the system error message.
 Display this information
 and the user-specified msg to standard error device.
@@ -12,6 +12,8 @@ umsg:       message to be displayed to standard error device.
 excode:     0 - Return.
             > 0 - ExitProcess with this code.
 print_err:  Display the last system error message ?
+The message and the system text go out as one write,
+so lines of concurrent threads never interleave.
 */
 void
 ReportError (
@@ -20,4 +22,12 @@ ReportError (
     BOOL print_err
 );
 
-
+/*
+The system message of errnum, without the trailing line break.
+Formatted once per error number and cached for the life of the process:
+the pointer stays valid and later calls do not lock or allocate.
+Past 512 distinct numbers, new ones are formatted on every call into a
+per-thread buffer that the thread's next call overwrites.
+*/
+LPCTSTR
+SysErrorMessage (DWORD errnum);
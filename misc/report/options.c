@@ -0,0 +1,162 @@
+#include "options.h"
+#include <limits.h>
+
+/* Linear scans: a tool has a handful of options, a table would cost more to build */
+static OPT_SPEC const *
+find_short (OPT_SPEC const * specs, int n_specs, TCHAR name) {
+    for (int i = 0; i < n_specs; i++)
+        if (specs[i].short_name == name)
+            return &specs[i];
+    return NULL;
+}
+static OPT_SPEC const *
+find_long (OPT_SPEC const * specs, int n_specs, LPCTSTR name, size_t len) {
+    for (int i = 0; i < n_specs; i++) {
+        LPCTSTR l = specs[i].long_name;
+        if (l != NULL && _tcsncmp(l, name, len) == 0 && l[len] == 0)
+            return &specs[i];
+    }
+    return NULL;
+}
+/* Decimal digits up to the first non-digit; FALSE if there are none or they overflow max */
+static LPCTSTR
+parse_digits (LPCTSTR p, ULONGLONG max, ULONGLONG * out) {
+    ULONGLONG v = 0;
+    LPCTSTR start = p;
+    while ((unsigned)(*p - _T('0')) < 10) {
+        unsigned d = (unsigned)(*p - _T('0'));
+        if (v > (max - d) / 10)
+            return NULL;
+        v = v * 10 + d;
+        p++;
+    }
+    if (p == start)
+        return NULL;
+    *out = v;
+    return p;
+}
+static BOOL
+parse_value (OPT_SPEC const * spec, LPCTSTR text) {
+    ULONGLONG v;
+    LPCTSTR p = text;
+
+    switch (spec->type) {
+    case OPT_STRING:
+        *(LPCTSTR *)spec->value = text;
+        return TRUE;
+
+    case OPT_INT: {
+        BOOL neg = (*p == _T('-'));
+        if (*p == _T('-') || *p == _T('+'))
+            p++;
+        /* -- LLONG_MIN has one more unit of magnitude than LLONG_MAX */
+        p = parse_digits(p, neg ? (ULONGLONG)LLONG_MAX + 1 : (ULONGLONG)LLONG_MAX, &v);
+        if (p == NULL || *p != 0)
+            return FALSE;
+        *(LONGLONG *)spec->value = neg ? (LONGLONG)(0 - v) : (LONGLONG)v;
+        return TRUE;
+    }
+
+    case OPT_SIZE: {
+        int shift = 0;
+        p = parse_digits(p, ULLONG_MAX, &v);
+        if (p == NULL)
+            return FALSE;
+        switch (*p) {
+        case _T('k'): case _T('K'): shift = 10; p++; break;
+        case _T('m'): case _T('M'): shift = 20; p++; break;
+        case _T('g'): case _T('G'): shift = 30; p++; break;
+        }
+        if (*p != 0 || v > (ULLONG_MAX >> shift))
+            return FALSE;
+        *(ULONGLONG *)spec->value = v << shift;
+        return TRUE;
+    }
+
+    default:
+        return FALSE;
+    }
+}
+static BOOL
+fail (OPT_RESULT * result, OPT_ERROR err, int i_arg) {
+    result->error = err;
+    result->i_error = i_arg;
+    result->i_first = i_arg;
+    return FALSE;
+}
+
+BOOL
+options (
+    int argc, LPTSTR argv [],
+    OPT_SPEC const * specs, int n_specs,
+    OPT_RESULT * result
+) {
+    int i_arg;
+    result->error = OPT_OK;
+    result->i_error = 0;
+
+    for (i_arg = 1; i_arg < argc; i_arg++) {
+        LPCTSTR arg = argv[i_arg];
+        OPT_SPEC const * spec;
+        LPCTSTR value;
+
+        if (arg[0] != _T('-') || arg[1] == 0)
+            break;                  /* first non-option, or "-" */
+
+        if (arg[1] == _T('-')) {
+            if (arg[2] == 0) {      /* "--" ends the options */
+                i_arg++;
+                break;
+            }
+            /* -- long form: --name, --name=value or --name value */
+            LPCTSTR name = arg + 2;
+            LPCTSTR eq = _tcschr(name, _T('='));
+            spec = find_long(specs, n_specs, name, eq ? (size_t)(eq - name) : _tcslen(name));
+            if (spec == NULL)
+                return fail(result, OPT_E_UNKNOWN, i_arg);
+            if (spec->type == OPT_FLAG) {
+                if (eq != NULL)
+                    return fail(result, OPT_E_UNEXPECTED_VALUE, i_arg);
+                *(BOOL *)spec->value = TRUE;
+                continue;
+            }
+            value = eq ? eq + 1 : (i_arg + 1 < argc) ? argv[++i_arg] : NULL;
+            if (value == NULL)
+                return fail(result, OPT_E_MISSING_VALUE, i_arg);
+            if (!parse_value(spec, value))
+                return fail(result, OPT_E_BAD_VALUE, i_arg);
+            continue;
+        }
+
+        /* -- short form: bundled flags, the first valued option takes the rest */
+        for (LPCTSTR p = arg + 1; *p != 0; p++) {
+            spec = find_short(specs, n_specs, *p);
+            if (spec == NULL)
+                return fail(result, OPT_E_UNKNOWN, i_arg);
+            if (spec->type == OPT_FLAG) {
+                *(BOOL *)spec->value = TRUE;
+                continue;
+            }
+            value = (p[1] != 0) ? p + 1 : (i_arg + 1 < argc) ? argv[++i_arg] : NULL;
+            if (value == NULL)
+                return fail(result, OPT_E_MISSING_VALUE, i_arg);
+            if (!parse_value(spec, value))
+                return fail(result, OPT_E_BAD_VALUE, i_arg);
+            break;
+        }
+    }
+
+    result->i_first = i_arg;
+    return TRUE;
+}
+LPCTSTR
+options_error_text (OPT_ERROR err) {
+    switch (err) {
+    case OPT_OK:                    return _T("no error");
+    case OPT_E_UNKNOWN:             return _T("unknown option");
+    case OPT_E_MISSING_VALUE:       return _T("option requires a value");
+    case OPT_E_BAD_VALUE:           return _T("invalid option value");
+    case OPT_E_UNEXPECTED_VALUE:    return _T("option takes no value");
+    default:                        return _T("bad option");
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <windows.h>
+#include <tchar.h>
+/*
+Table-driven command-line parsing.
+The caller describes every option once, in an array of OPT_SPEC,
+and options() walks argv a single time, storing each value
+straight into the variable the spec points to.
+Nothing is allocated: string values point into argv.
+
+Accepted forms:
+    -s -v       -sv         boolean flags, alone or bundled
+    -b 1M       -b1M        short option with a value
+    --threads=8 --threads 8 long option with a value
+    --silent                long flag
+    --                      end of the options
+Options stop at the first argument that does not start with '-';
+a lone "-" is an argument (conventionally stdin).
+Flags are set to TRUE when present; other values are only written
+when their option is given, so initialize them to the defaults.
+*/
+
+typedef enum OPT_TYPE {
+    OPT_FLAG,       // BOOL *,      no value
+    OPT_INT,        // LONGLONG *,  decimal, optional sign
+    OPT_SIZE,       // ULONGLONG *, decimal with an optional K, M or G suffix (powers of 1024)
+    OPT_STRING      // LPCTSTR *,   the text as is
+} OPT_TYPE;
+
+typedef struct OPT_SPEC {
+    TCHAR       short_name;     // 0: long form only
+    LPCTSTR     long_name;      // NULL: short form only
+    OPT_TYPE    type;
+    LPVOID      value;
+} OPT_SPEC;
+
+typedef enum OPT_ERROR {
+    OPT_OK = 0,
+    OPT_E_UNKNOWN,              // no spec for this option
+    OPT_E_MISSING_VALUE,        // valued option at the end of argv
+    OPT_E_BAD_VALUE,            // not a number, or out of range
+    OPT_E_UNEXPECTED_VALUE      // --flag=value
+} OPT_ERROR;
+
+typedef struct OPT_RESULT {
+    int         i_first;        // argv index of the first argument beyond the options
+    OPT_ERROR   error;
+    int         i_error;        // argv index of the offending argument
+} OPT_RESULT;
+
+/*
+Returns FALSE on the first error (described in *result);
+the variables of the options before it have already been set.
+*/
+BOOL
+options (
+    int argc, LPTSTR argv [],
+    OPT_SPEC const * specs, int n_specs,
+    OPT_RESULT * result
+);
+
+/* A one-line description of err, for the usage message */
+LPCTSTR
+options_error_text (OPT_ERROR err);
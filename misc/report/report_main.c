@@ -1,77 +1,18 @@
 #include <windows.h>
+#include <stdio.h>
 #include "Reprt_Err.h"
-
-#ifdef _UNICODE
-#define _memtchr wmemchr
-#else
-#define _memtchr memchr
-#endif
-
-
-#pragma region options Impl
-#include <stdarg.h>
-/*  argv is the command line.
- The options, if any,
- start with a '-' in argv[1], argv[2], ...
- opt_str is a string containing all possible options,
- in one-to-one correspondence with
- the addresses of Boolean variables
- in the variable argument list (...).
- These flags are set if and only if
- the corresponding option character occurs in
- argv [1], argv [2], ...
- The return value is the argv index of
- the first argument beyond the options. */
-
-DWORD options (
-    int argc, LPCTSTR argv [], LPCTSTR opt_str, ...
-) {
-    va_list flag_list;
-    LPBOOL flag;
-    int i_flag = 0, i_arg;
-
-    va_start (flag_list, opt_str);
-
-    while (
-        (flag = va_arg (flag_list, LPBOOL)) != NULL &&
-        i_flag < (int)_tcslen (opt_str)
-        ) {
-        *flag = FALSE;
-        for (
-            i_arg = 1;
-            !(*flag) && i_arg < argc &&
-            argv[i_arg][0] == _T('-');
-            i_arg++
-            ) {
-            *flag = _memtchr(
-                argv[i_arg], opt_str[i_flag],
-                _tcslen (argv[i_arg])
-            ) != NULL;
-        }
-        i_flag++;
-    }
-
-    va_end (flag_list);
-
-    for (
-        i_arg = 1;
-        i_arg < argc && argv[i_arg][0] == _T('-');
-        i_arg++
-        );
-
-    return i_arg;
-}
-#pragma endregion
+#include "options.h"
+#include "../log/log.h"
 
 #define BUF_SIZE 0x200
+#define BUF_SIZE_MAX (64 << 20)
 
 static VOID
-cat_file (HANDLE infile, HANDLE outfile) {
+cat_file (HANDLE infile, HANDLE outfile, LPBYTE buf, DWORD buf_size) {
     DWORD n_in, n_out;
-    BYTE buf[BUF_SIZE];
 
     while (
-        ReadFile(infile, buf, BUF_SIZE, &n_in, NULL) &&
+        ReadFile(infile, buf, buf_size, &n_in, NULL) &&
         (n_in != 0) &&
         WriteFile(outfile, buf, n_in, &n_out, NULL)
         );
@@ -82,18 +23,52 @@ int _tmain (int argc, LPTSTR argv []) {
     HANDLE infile, hstdin;
     hstdin = GetStdHandle(STD_INPUT_HANDLE);
     HANDLE hstdout = GetStdHandle(STD_OUTPUT_HANDLE);
-    BOOL dash_s;
+    BOOL dash_s = FALSE;
+    ULONGLONG buf_size = BUF_SIZE;
+    LPCTSTR log_path = NULL;
     int i_arg, i_first;
 
-    /* dash_s will be set only if "-s" is on cmd. */
+    /* dash_s will be set only if "-s" (--silent) is on cmd. */
+    /* -b (--buffer) sets the copy buffer size, e.g. -b 1M. */
+    /* -l (--log) appends the errors, timestamped, to a log file. */
+    OPT_SPEC const specs [] = {
+        {_T('s'), _T("silent"), OPT_FLAG, &dash_s},
+        {_T('b'), _T("buffer"), OPT_SIZE, &buf_size},
+        {_T('l'), _T("log"), OPT_STRING, &log_path},
+    };
+    OPT_RESULT opt;
+    if (!options(argc, argv, specs, _countof(specs), &opt)) {
+        _ftprintf(
+            stderr, _T("%s: %s\nusage: report [-s] [-b size] [-l logfile] [files...]\n"),
+            argv[opt.i_error], options_error_text(opt.error)
+        );
+        return 2;
+    }
+    if (log_path != NULL) {
+        FILE * log_file = NULL;
+        if (_tfopen_s(&log_file, log_path, _T("a")) != 0 || log_file == NULL)
+            ReportError(_T("Cat Error: Cannot open the log file."), 1, TRUE);
+        /* -- the sink owns the file only once it is added */
+        if (!Log_Init(0) || !Log_AddTextSink(log_file)) {
+            fclose(log_file);
+            ReportError(_T("Cat Error: Cannot open the log file."), 1, TRUE);
+        }
+    }
     /* i_first is the argv [] index of
     the first input file. */
-    i_first = options(
-        argc, argv, _T("s"), &dash_s, NULL
-    );
-    int x = 10;
+    i_first = opt.i_first;
+    if (buf_size < BUF_SIZE)
+        buf_size = BUF_SIZE;
+    if (buf_size > BUF_SIZE_MAX)
+        buf_size = BUF_SIZE_MAX;
+
+    LPBYTE buf = (LPBYTE)HeapAlloc(GetProcessHeap(), 0, (SIZE_T)buf_size);
+    if (buf == NULL)
+        ReportError(_T("Cat Error: Cannot allocate the buffer."), 1, FALSE);
+
     if (i_first == argc) { /* No files in arg list. */
-        cat_file(hstdin, hstdout);
+        cat_file(hstdin, hstdout, buf, (DWORD)buf_size);
+        HeapFree(GetProcessHeap(), 0, buf);
         return 0;
     }
 
@@ -111,7 +86,7 @@ int _tmain (int argc, LPTSTR argv []) {
                     0, TRUE
                 );
         } else {
-            cat_file (infile, hstdout);
+            cat_file (infile, hstdout, buf, (DWORD)buf_size);
             if (GetLastError() != 0 && !dash_s) {
                 ReportError(
                     _T("Cat Error: Cant process file"),
@@ -121,6 +96,7 @@ int _tmain (int argc, LPTSTR argv []) {
             CloseHandle(infile);
         }
     }
+    HeapFree(GetProcessHeap(), 0, buf);
     return 0;
 }
 
@@ -8,12 +8,20 @@
    #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
    =========================================================== */
 
+#define _CRT_SECURE_NO_WARNINGS    /* fopen */
+
 #include <windows.h>
 #include <process.h>    /* _beginthread, _endthread */
 #include <tchar.h>
 #include <windowsx.h>
 
 #include "resource.h"   /* ui controls IDs (from editor) */
+#include "../../misc/alloc/mem_alloc.h"
+#include "../common/queue_stats.h"
+#include "../common/thread_group.h"
+#include "../common/thread_pool.h"
+#include "../common/timer_wheel.h"
+#include "../common/urgency_queue.h"
 
 // =========================================================================================
 
@@ -25,40 +33,186 @@
 
 // =========================================================================================
 
+/*
+ * Layout of the shared state: the writers, the readers and the stop path
+ * all touch it, from different cores.
+ *  - QUEUE_PAD_HOT gives their own cache lines to the stamp counter (bumped
+ *    by every writer) and the read-mostly queue fields, or to the urgency
+ *    queue as a whole, and to the lock, each condition variable and the
+ *    thread group (whose cancel flag every loop reads).
+ *  - QUEUE_PAD_SLOTS gives each slot a line too, filled by writers and
+ *    emptied by readers: the stamp scan's slots, or the urgency queue's
+ *    messages (its arrays start on a line, so a padded message is one).
+ * layout_bench measures both.
+ *
+ * QUEUE_ORDER_URGENCY replaces the stamp scan (FIFO) with a heap per reader:
+ * a reader takes its most urgent element, by deadline and priority, aged so
+ * that nothing waits more than priority * QUEUE_AGING_MS behind newer work.
+ * order_bench compares the two orders under bursts.
+ *
+ * Unlike app03's, this queue is not sharded per NUMA node: elements are
+ * split by request class, one reader each, and a reader must see the most
+ * urgent element of its class wherever it was added. A shard per node
+ * would only order each node's elements, and the two readers would still
+ * cross nodes for every shard.
+ */
+#ifndef QUEUE_PAD_HOT
+#define QUEUE_PAD_HOT       1
+#endif
+#ifndef QUEUE_PAD_SLOTS
+#define QUEUE_PAD_SLOTS     0
+#endif
+
+#ifndef QUEUE_ORDER_URGENCY
+#define QUEUE_ORDER_URGENCY 1
+#endif
+
+#if QUEUE_PAD_HOT
+#define HOT_ALIGNED         MT_ALIGNED(MT_CACHE_LINE)
+#else
+#define HOT_ALIGNED
+#endif
+#if QUEUE_PAD_SLOTS
+#define SLOT_ALIGNED        MT_ALIGNED(MT_CACHE_LINE)
+#else
+#define SLOT_ALIGNED
+#endif
+
+#define QUEUE_CLASSES       2       // even request numbers go to reader 0, odd to reader 1
+#define QUEUE_AGING_MS      4000    // per priority level
+
+/*
+ * Queue telemetry (common/queue_stats): writers that find the queue full,
+ * readers that find nothing to process, lock waits, the depth at each add
+ * and each element's time in the queue. A wheel thread appends a JSON line
+ * to STATS_FILE every STATS_DUMP_MS, and one more on exit
+ */
+#define STATS_FILE          "app01_queue_stats.jsonl"
+#define STATS_DUMP_MS       5000
+#define STATS_TICK_MS       100     // the wheel's tick, for the workers' pauses too
+
+/*
+ * WORKERS_POOL runs the writers and readers as short tasks on a
+ * work-stealing pool (common/thread_pool) instead of a dedicated thread
+ * each, so nothing sleeps on a pool worker:
+ *  - a writer step adds one element, or finds the queue full, then arms its
+ *    timer on the wheel, whose callback submits the next step;
+ *  - every element added submits a task for the reader of its class. A
+ *    reader rests READER_REST_MS after each element, on its timer; a task
+ *    that finds it resting leaves the element queued for the task the
+ *    timer submits.
+ * Without it, WRITERS_COUNT + READERS_COUNT threads loop on the lock and
+ * sleep on the condition variables.
+ */
+#ifndef WORKERS_POOL
+#define WORKERS_POOL        1
+#endif
+
+#define WRITER_PAUSE_MS     1500    // between a writer's requests
+#define WRITER_RETRY_MS     250     // before a pool writer tries a full queue again
+#define READER_REST_MS      2500    // after a reader processes an element
+
+// =========================================================================================
+
+struct Element {
+    int         thread_number;
+    int         request_number;
+    int         priority;       // 0 is the most urgent
+    ULONGLONG   deadline;       // GetTickCount64() by which it should be processed
+    int64_t     enqueued_ns;    // QueueStats_Now() when added
+    /* additional element data */
+
+};
+typedef struct Element Element;
+
+#if QUEUE_ORDER_URGENCY
 struct Queue {
-    struct Element {
-        int thread_number;
-        int request_number;
-        /* additional element data */
+    HOT_ALIGNED UrgencyQueue    uq;     // a heap per reader over shared slots
+};
 
-    };
+/* What the urgency queue copies in and out: an element, padded with QUEUE_PAD_SLOTS */
+struct Slot {
+    SLOT_ALIGNED struct Element e;
+};
+
+typedef struct Queue Queue;
+typedef struct Slot Slot;
+
+/* FALSE on allocation failure; the slots are cache-line aligned, see urgency_queue.c */
+static BOOL
+Queue_Init (Queue * q, int max_e) {
+    return UrgencyQueue_Init(&q->uq, sizeof(Slot), max_e, QUEUE_CLASSES, QUEUE_AGING_MS);
+}
+static void
+Queue_Deinit (Queue * q) {
+    UrgencyQueue_Deinit(&q->uq);
+}
+static BOOL
+Queue_IsFull (Queue * q) {
+    return UrgencyQueue_IsFull(&q->uq);
+}
+static BOOL
+Queue_IsEmpty (Queue * q, int thread_number) {
+    return 0 == UrgencyQueue_Count(&q->uq, thread_number);
+}
+static int
+Queue_Count (Queue * q) {
+    return q->uq.capacity - q->uq.n_free;
+}
+static void
+Queue_AddElement (Queue * q, Element e) {
+    Slot s;
+    s.e = e;
+    // -- does nothing if q is full
+    UrgencyQueue_Push(
+        &q->uq, e.request_number % QUEUE_CLASSES, e.priority,
+        (int64_t)e.deadline, (int64_t)GetTickCount64(), &s
+    );
+}
+static BOOL
+Queue_GetNewElement (Queue * q, int thread_number, Element * e_out) {
+    Slot s;
+    if (!UrgencyQueue_Pop(&q->uq, thread_number, &s, NULL))
+        return FALSE;
+    *e_out = s.e;
+    return TRUE;
+}
+
+// NOTE(omid): popping updates the free slots both readers share:
+// unlike the stamp scan, readers need the lock exclusively
+#define READER_ACQUIRE(l)   AcquireSRWLockExclusive(l)
+#define READER_TRY(l)       TryAcquireSRWLockExclusive(l)
+#define READER_RELEASE(l)   ReleaseSRWLockExclusive(l)
+#define READER_LOCKMODE     0
+#else
+struct Queue {
     struct InnerElement {
-        int             stamp;      // element counter: 0 means read
-        struct Element  e;
+        SLOT_ALIGNED int    stamp;      // element counter: 0 means read
+        struct Element      e;
     };
     int                     max_elements;   // max # of elements
-    int                     curr_stamp;     // keep track of the # of added elements
     struct InnerElement *   elements;       // array of elements
+    HOT_ALIGNED int         curr_stamp;     // keep track of the # of added elements
 };
 
 typedef struct Queue Queue;
-typedef struct Element Element;
 typedef struct InnerElement InnerElement;
 
-static void
+/* FALSE on allocation failure */
+static BOOL
 Queue_Init (Queue * q, int max_e) {
-    q->elements = (InnerElement *)HeapAlloc(
-        GetProcessHeap(), 0, sizeof(InnerElement) * max_e
+    // -- zeroed and on its own cache lines, off the contended process heap
+    q->elements = (InnerElement *)Mem_AllocAligned(
+        sizeof(InnerElement) * max_e, MEM_CACHE_LINE, MEM_ZERO
     );
-    if (q->elements)
-        ZeroMemory(q->elements, sizeof(InnerElement) * max_e);
 
     q->curr_stamp = 0;  // initialize the element counter
     q->max_elements = max_e;
+    return NULL != q->elements;
 }
 static void
 Queue_Deinit (Queue * q) {
-    HeapFree(GetProcessHeap(), 0, q->elements);
+    Mem_FreeAligned(q->elements);
 }
 static int
 Queue_GetFreeSlot (Queue * q) {
@@ -103,6 +257,13 @@ static BOOL
 Queue_IsEmpty (Queue * q, int thread_number) {
     return (-1 == Queue_GetNextSlot(q, thread_number));
 }
+static int
+Queue_Count (Queue * q) {
+    int ret = 0;
+    for (int i = 0; i < q->max_elements; ++i)
+        ret += (q->elements[i].stamp != 0);
+    return ret;
+}
 static void
 Queue_AddElement (Queue * q, Element e) {
     // -- do nothing if q is full
@@ -127,19 +288,47 @@ Queue_GetNewElement (Queue * q, int thread_number, Element * e_out) {
     return ret;
 }
 
+// -- each reader only clears the stamps of its own elements: a shared lock will do
+#define READER_ACQUIRE(l)   AcquireSRWLockShared(l)
+#define READER_TRY(l)       TryAcquireSRWLockShared(l)
+#define READER_RELEASE(l)   ReleaseSRWLockShared(l)
+#define READER_LOCKMODE     CONDITION_VARIABLE_LOCKMODE_SHARED
+#endif
+
 // =========================================================================================
 
-Queue               g_q;                    // shared resource b/w threads
-volatile LONG       g_shutdown;             // signal client/server threads to die
-HWND                g_hwnd;                 // to give status b/w client/server
-SRWLOCK             g_srwlock;              // slim reader-writer lock to protect q
-CONDITION_VARIABLE  g_cv_ready_to_read;     // signaled by writers
-CONDITION_VARIABLE  g_cv_ready_to_write;    // signaled by readers
+HOT_ALIGNED Queue               g_q;                    // shared resource b/w threads
+HWND                            g_hwnd;                 // to give status b/w client/server
+HOT_ALIGNED SRWLOCK             g_srwlock;              // slim reader-writer lock to protect q
+HOT_ALIGNED CONDITION_VARIABLE  g_cv_ready_to_read;     // signaled by writers
+HOT_ALIGNED CONDITION_VARIABLE  g_cv_ready_to_write;    // signaled by readers
+
+// -- reader/writer threads; its cancel token signals them (or their tasks) to die
+HOT_ALIGNED ThreadGroup g_group;
+volatile LONG g_stopped;    // stop_processing: 1 running, 2 done
+
+QueueStats      g_stats;
+TimerWheel      g_wheel;    // drives the dumps, and the pool workers' pauses
+QueueStatsDump  g_dump;
 
-// -- cache handles to all threads [thread kernel objs]
-HANDLE g_threads[MAXIMUM_WAIT_OBJECTS];
+#define WRITERS_COUNT   4
+#define READERS_COUNT   QUEUE_CLASSES   // one per class
 
-int g_threads_count = 0;     // number of reader/writer threads
+/* A writer or reader run as pool tasks (WORKERS_POOL) */
+typedef struct Worker {
+    Timer           timer;              // the next step, on the wheel
+    int             thread_number;
+    int             request_number;     // a writer's current request
+    BOOL            blocked;            // a writer found the queue full and said so
+    volatile LONG   busy;               // a reader is on an element or resting after it
+} Worker;
+
+ThreadPool  g_pool;
+Worker      g_writers[WRITERS_COUNT];
+Worker      g_readers[READERS_COUNT];
+
+// -- writer n sends priority n requests, due this many ms after they are made
+#define WRITER_SLA_MS(n)    (3000 + 2000 * (n))
 
 // =========================================================================================
 //
@@ -162,47 +351,89 @@ add_text (HWND hwnd_list_box, PCTSTR fmt, ...) {
     ListBox_SetCurSel(hwnd_list_box, ListBox_AddString(hwnd_list_box, str));
     va_end(arglist);
 }
+/* READER_ACQUIRE, counted like QueueStats_Lock counts the writers' exclusive acquires */
+static void
+reader_acquire (void) {
+    if (READER_TRY(&g_srwlock)) {
+        QueueStats_LockAcquired(&g_stats, 0);
+    } else {
+        int64_t start = QueueStats_Now();
+        READER_ACQUIRE(&g_srwlock);
+        QueueStats_LockAcquired(&g_stats, max(QueueStats_Now() - start, 1));
+    }
+}
+static BOOL
+shutting_down (void) {
+    return CancelToken_IsCancelled(&g_group.cancel);
+}
+/*
+ * A task arms no timer once it sees the cancel: the tasks that may have
+ * started before it are waited for, then every timer is cancelled, then
+ * whatever the last callbacks submitted
+ */
+static void
+stop_tasks (void) {
+    ThreadPool_Wait(&g_pool);
+    for (int i = 0; i < WRITERS_COUNT; ++i)
+        TimerWheel_Cancel(&g_wheel, &g_writers[i].timer);
+    for (int i = 0; i < READERS_COUNT; ++i)
+        TimerWheel_Cancel(&g_wheel, &g_readers[i].timer);
+    ThreadPool_Wait(&g_pool);
+}
+/* A second caller returns once the first is done, so teardown can follow it */
 static void
 stop_processing() {
-    if (!g_shutdown) {
-        // -- ask all threads to end
-        InterlockedExchange(&g_shutdown, TRUE);
-
-        // -- free all threads waiting on condition variables
-        WakeAllConditionVariable(&g_cv_ready_to_read);
-        WakeAllConditionVariable(&g_cv_ready_to_write);
-
-        // -- wait for all the threads to terminate & then cleanup
-        WaitForMultipleObjects(g_threads_count, g_threads, TRUE, INFINITE);
-
-        // -- cleanup kernel objects
-        while (g_threads_count--)
-            CloseHandle(g_threads[g_threads_count]);
-
-        // -- close each list box
-        add_text(GetDlgItem(g_hwnd, IDC_LIST_SERVERS), TEXT("-----------------"));
-        add_text(GetDlgItem(g_hwnd, IDC_LIST_CLIENTS), TEXT("-----------------"));
+    if (InterlockedCompareExchange(&g_stopped, 1, 0) != 0) {
+        while (g_stopped != 2)
+            Sleep(1);
+        return;
     }
+    // -- ask all threads to end; the ones sleeping between requests wake up at once
+    ThreadGroup_Cancel(&g_group);
+#if WORKERS_POOL
+    stop_tasks();
+#else
+    // -- a thread that checked shutting_down() under the lock is now asleep on its cv:
+    // -- taking the lock once makes sure no one is between the check and the sleep
+    AcquireSRWLockExclusive(&g_srwlock);
+    ReleaseSRWLockExclusive(&g_srwlock);
+
+    // -- free all threads waiting on condition variables
+    WakeAllConditionVariable(&g_cv_ready_to_read);
+    WakeAllConditionVariable(&g_cv_ready_to_write);
+
+    // -- one latch wait for the whole group, no MAXIMUM_WAIT_OBJECTS cap
+    ThreadGroup_Join(&g_group, MT_INFINITE);
+#endif
+
+    // -- close each list box
+    add_text(GetDlgItem(g_hwnd, IDC_LIST_SERVERS), TEXT("-----------------"));
+    add_text(GetDlgItem(g_hwnd, IDC_LIST_CLIENTS), TEXT("-----------------"));
+    InterlockedExchange(&g_stopped, 2);
 }
 unsigned WINAPI
 StoppingThread_Func (void * param_ptr) {
     stop_processing();
     return(0);
 }
-unsigned WINAPI
+void
 WriterThread_Func (void * param_ptr) {
     int thread_number = (intptr_t)param_ptr;
     HWND hwnd_listbox = GetDlgItem(g_hwnd, IDC_LIST_CLIENTS);
 
-    for (int request_number = 1; !g_shutdown; ++request_number) {
-        Element e = {thread_number, request_number};
+    for (int request_number = 1; !shutting_down(); ++request_number) {
+        Element e = {
+            thread_number, request_number,
+            thread_number, GetTickCount64() + WRITER_SLA_MS(thread_number)
+        };
 
         // -- require acess for writing
-        AcquireSRWLockExclusive(&g_srwlock);
+        QueueStats_Lock(&g_stats, &g_srwlock);
 
         // -- if q is full, fall sleep as long as condition variable is not signaled
         // NOTE(omid): during wait for lock, a shutdown might have been instructed
-        if (Queue_IsFull(&g_q) && !g_shutdown) {
+        if (Queue_IsFull(&g_q) && !shutting_down()) {
+            QueueStats_Add(&g_stats, QSTAT_FULL, 1);
             add_text(
                 hwnd_listbox,
                 TEXT("[%d] Queue is full: Cannot add %d"), thread_number, request_number
@@ -210,7 +441,7 @@ WriterThread_Func (void * param_ptr) {
             // -- wait for a reader to empty a slot before acquiring lock again
             SleepConditionVariableSRW(&g_cv_ready_to_write, &g_srwlock, INFINITE, 0);
         }
-        if (g_shutdown) {   // -- shutting down
+        if (shutting_down()) {   // -- shutting down
 
             // NOTE(omid): Other writer threads might still be blocked on the lock
             // -- release the lock. No need to keep the lock any longer
@@ -220,10 +451,12 @@ WriterThread_Func (void * param_ptr) {
 
             add_text(hwnd_listbox, TEXT("[%d] exiting; Bye Bye"), thread_number);
             // -- always return from exiting thread
-            return(0);
+            return;
         } else {
             // -- add new element
+            e.enqueued_ns = QueueStats_Now();
             Queue_AddElement(&g_q, e);
+            QueueStats_Enqueue(&g_stats, Queue_Count(&g_q));
 
             add_text(hwnd_listbox, TEXT("[%d] adding %d"), thread_number, request_number);
 
@@ -233,23 +466,33 @@ WriterThread_Func (void * param_ptr) {
             // -- signal reader threads there is new element to read
             WakeAllConditionVariable(&g_cv_ready_to_read);
 
-            // -- wait before adding another element
-            Sleep(1500);
+            // -- wait before adding another element, unless asked to stop
+            CancelToken_Sleep(&g_group.cancel, WRITER_PAUSE_MS);
         }
     }
     add_text(hwnd_listbox, TEXT("[%d] exiting; Bye Bye"), thread_number);
-    // -- always return from exiting thread
-    return(0);
+}
+/* Reports against the deadline: the order should keep late ones rare */
+static void
+report_element (HWND lbox, int thread_num, Element const * e) {
+    ULONGLONG now = GetTickCount64();
+    add_text(
+        lbox, TEXT("[%d] Processing %d: %d (p%d, %s %llu ms)"), thread_num,
+        e->thread_number, e->request_number, e->priority,
+        (now > e->deadline) ? TEXT("late") : TEXT("slack"),
+        (now > e->deadline) ? now - e->deadline : e->deadline - now
+    );
 }
 static BOOL
 consume_element (int thread_num, int request_num, HWND lbox) {
-    // get shared access to queue to read an element
-    AcquireSRWLockShared(&g_srwlock);
+    // get access to queue to read an element (shared, unless the order needs exclusive)
+    reader_acquire();
 
     // fall asleep until there is s.th. to read
     // check if, while asleep, it was not decided to stop the thread
-    while (Queue_IsEmpty(&g_q, thread_num) && !g_shutdown) {
+    while (Queue_IsEmpty(&g_q, thread_num) && !shutting_down()) {
         // no readable element
+        QueueStats_Add(&g_stats, QSTAT_EMPTY, 1);
         add_text(lbox, TEXT("[%d] Nothing to process"), thread_num);
 
         // since q is empty wait until writers produce anything
@@ -257,15 +500,15 @@ consume_element (int thread_num, int request_num, HWND lbox) {
             &g_cv_ready_to_read,
             &g_srwlock,
             INFINITE,
-            CONDITION_VARIABLE_LOCKMODE_SHARED
+            READER_LOCKMODE
         );
     }
     // on the other hand, when thread is exiting, lock should be released,
     // and other reader(s) should be signaled through condition variables
-    if (g_shutdown) {
+    if (shutting_down()) {
         add_text(lbox, TEXT("[%d] exiting; Bye Bye"), thread_num);
 
-        ReleaseSRWLockShared(&g_srwlock);
+        READER_RELEASE(&g_srwlock);
         WakeConditionVariable(&g_cv_ready_to_read);
 
         return FALSE;
@@ -276,32 +519,120 @@ consume_element (int thread_num, int request_num, HWND lbox) {
     Queue_GetNewElement(&g_q, thread_num, &e);
 
     // -- no need to keep the lock any longer
-    ReleaseSRWLockShared(&g_srwlock);
-
-    add_text(
-        lbox, TEXT("[%d] Processing %d: %d"), thread_num,
-        e.thread_number, e.request_number
-    );
+    READER_RELEASE(&g_srwlock);
+    QueueStats_Dequeue(&g_stats, e.enqueued_ns);
+    report_element(lbox, thread_num, &e);
 
     // -- notify writers a free slot became available to produce new element
     WakeConditionVariable(&g_cv_ready_to_write);
 
     return TRUE;
 }
-unsigned WINAPI
+void
 ReaderThread_Func (void * param_ptr) {
     int thread_number = (intptr_t)param_ptr;
     HWND hwnd_listbox = GetDlgItem(g_hwnd, IDC_LIST_SERVERS);
 
-    for (int request_number = 1; !g_shutdown; ++request_number) {
+    for (int request_number = 1; !shutting_down(); ++request_number) {
         if (FALSE == consume_element(thread_number, request_number, hwnd_listbox))
-            return (0);
-        Sleep(2500);    // wait before reading another element
+            return;
+        CancelToken_Sleep(&g_group.cancel, READER_REST_MS);   // wait before reading another element
     }
-    // g_shutdown has been set during sleep
+    // shutdown has been requested during sleep
     add_text(hwnd_listbox, TEXT("[%d] exiting; Bye Bye"), thread_number);
-    // -- always return from exiting thread
-    return(0);
+}
+
+// =========================================================================================
+
+void ReaderTask_Func (void * param_ptr);
+
+/* One request: added, or the queue full; either way the next step is a timer away */
+void
+WriterTask_Func (void * param_ptr) {
+    Worker * w = (Worker *)param_ptr;
+    HWND hwnd_listbox = GetDlgItem(g_hwnd, IDC_LIST_CLIENTS);
+    if (shutting_down())
+        return;
+
+    Element e = {
+        w->thread_number, w->request_number,
+        w->thread_number, GetTickCount64() + WRITER_SLA_MS(w->thread_number)
+    };
+    QueueStats_Lock(&g_stats, &g_srwlock);
+    BOOL full = Queue_IsFull(&g_q);
+    if (!full) {
+        e.enqueued_ns = QueueStats_Now();
+        Queue_AddElement(&g_q, e);
+        QueueStats_Enqueue(&g_stats, Queue_Count(&g_q));
+    }
+    ReleaseSRWLockExclusive(&g_srwlock);
+
+    if (full) {
+        // -- the same request again, once a reader had time to take one
+        QueueStats_Add(&g_stats, QSTAT_FULL, 1);
+        if (!w->blocked)
+            add_text(hwnd_listbox, TEXT("[%d] Queue is full: Cannot add %d"), w->thread_number, w->request_number);
+        w->blocked = TRUE;
+        TimerWheel_Arm(&g_wheel, &w->timer, WRITER_RETRY_MS);
+        return;
+    }
+    add_text(hwnd_listbox, TEXT("[%d] adding %d"), w->thread_number, w->request_number);
+    w->blocked = FALSE;
+    w->request_number++;
+
+    // -- the element's reader takes it now, or once it has rested from the one before
+    ThreadPool_Submit(&g_pool, ReaderTask_Func, &g_readers[e.request_number % QUEUE_CLASSES]);
+    TimerWheel_Arm(&g_wheel, &w->timer, WRITER_PAUSE_MS);
+}
+/* At most one element per reader at a time: a resting reader's timer comes back for the rest */
+void
+ReaderTask_Func (void * param_ptr) {
+    Worker * r = (Worker *)param_ptr;
+    HWND hwnd_listbox = GetDlgItem(g_hwnd, IDC_LIST_SERVERS);
+    Element e;
+    BOOL got;
+
+    while (!shutting_down() && 0 == InterlockedCompareExchange(&r->busy, TRUE, FALSE)) {
+        reader_acquire();
+        got = Queue_GetNewElement(&g_q, r->thread_number, &e);
+        READER_RELEASE(&g_srwlock);
+        if (got) {
+            QueueStats_Dequeue(&g_stats, e.enqueued_ns);
+            report_element(hwnd_listbox, r->thread_number, &e);
+            TimerWheel_Arm(&g_wheel, &r->timer, READER_REST_MS);
+            return;
+        }
+        InterlockedExchange(&r->busy, FALSE);
+
+        // -- the task of an element added since the look found the reader busy and left: look again
+        reader_acquire();
+        got = !Queue_IsEmpty(&g_q, r->thread_number);
+        READER_RELEASE(&g_srwlock);
+        if (!got) {
+            QueueStats_Add(&g_stats, QSTAT_EMPTY, 1);
+            add_text(hwnd_listbox, TEXT("[%d] Nothing to process"), r->thread_number);
+            return;
+        }
+    }
+}
+/* On the wheel thread: the step itself goes to the pool, or tries again when it is full */
+static void
+WriterTimer_Func (void * param_ptr) {
+    Worker * w = (Worker *)param_ptr;
+    if (shutting_down())
+        return;
+    if (!ThreadPool_Submit(&g_pool, WriterTask_Func, w))
+        TimerWheel_Arm(&g_wheel, &w->timer, WRITER_RETRY_MS);
+}
+static void
+ReaderTimer_Func (void * param_ptr) {
+    Worker * r = (Worker *)param_ptr;
+    if (shutting_down())
+        return;
+    // -- rested: free for the next element, queued meanwhile or not
+    InterlockedExchange(&r->busy, FALSE);
+    if (!ThreadPool_Submit(&g_pool, ReaderTask_Func, r))
+        TimerWheel_Arm(&g_wheel, &r->timer, WRITER_RETRY_MS);
 }
 BOOL
 DialogBox_OnInit (HWND hwnd, HWND hwnd_focus, LPARAM lparam) {
@@ -316,20 +647,32 @@ DialogBox_OnInit (HWND hwnd, HWND hwnd_focus, LPARAM lparam) {
     InitializeConditionVariable(&g_cv_ready_to_read);
     InitializeConditionVariable(&g_cv_ready_to_write);
 
-    g_shutdown = FALSE;
-
+#if WORKERS_POOL
     //
-    // Create four writer threads
-    unsigned int thread_id;
-    for (int i = 0; i < 4; ++i)
-        g_threads[g_threads_count++] =
-        (HANDLE)_beginthreadex(NULL, 0, WriterThread_Func, (void *)(intptr_t)i, 0, &thread_id);
+    // Readers first: a writer's first element submits a task for one
+    for (int i = 0; i < READERS_COUNT; ++i) {
+        Timer_Init(&g_readers[i].timer, ReaderTimer_Func, &g_readers[i]);
+        g_readers[i].thread_number = i;
+    }
+    //
+    // Every writer's first step, now
+    for (int i = 0; i < WRITERS_COUNT; ++i) {
+        Timer_Init(&g_writers[i].timer, WriterTimer_Func, &g_writers[i]);
+        g_writers[i].thread_number = i;
+        g_writers[i].request_number = 1;
+        ThreadPool_Submit(&g_pool, WriterTask_Func, &g_writers[i]);
+    }
+#else
+    //
+    // Create the writer threads
+    for (int i = 0; i < WRITERS_COUNT; ++i)
+        ThreadGroup_Spawn(&g_group, WriterThread_Func, (void *)(intptr_t)i);
 
-//
-// Create two reader threads
-    for (int i = 0; i < 2; ++i)
-        g_threads[g_threads_count++] =
-        (HANDLE)_beginthreadex(NULL, 0, ReaderThread_Func, (void *)(intptr_t)i, 0, &thread_id);
+    //
+    // Create the reader threads
+    for (int i = 0; i < READERS_COUNT; ++i)
+        ThreadGroup_Spawn(&g_group, ReaderThread_Func, (void *)(intptr_t)i);
+#endif
 
     return TRUE;
 }
@@ -371,10 +714,41 @@ _tWinMain(
 ) {
     UNREFERENCED_PARAMETER(prev);
     UNREFERENCED_PARAMETER(showcmd);
-    Queue_Init(&g_q, 10);
+    QueueStats_Init(&g_stats, "app01");
+    if (!Queue_Init(&g_q, 10))
+        return(1);
+    if (!ThreadGroup_Init(&g_group)) {
+        Queue_Deinit(&g_q);
+        return(1);
+    }
+    // -- no wheel or no file, no dumps: the counting goes on regardless
+    FILE * stats_file = NULL;
+    BOOL wheel = TimerWheel_Init(&g_wheel, STATS_TICK_MS);
+#if WORKERS_POOL
+    // -- the tasks' pauses are timers: no wheel, no tasks
+    if (!wheel || !ThreadPool_Init(&g_pool, 0)) {
+        if (wheel)
+            TimerWheel_Deinit(&g_wheel);
+        ThreadGroup_Deinit(&g_group);
+        Queue_Deinit(&g_q);
+        return(1);
+    }
+#endif
+    if (wheel && (stats_file = fopen(STATS_FILE, "a")) != NULL)
+        QueueStatsDump_Start(&g_dump, &g_stats, &g_wheel, STATS_DUMP_MS, stats_file, TRUE);
     // NOTE(omid): The resource identifier of dialog box is created by MAKEINTRESOURCE macro
     DialogBox(instance, MAKEINTRESOURCE(IDD_DIALOG_MAIN), NULL, &DialogBox_Func);
     stop_processing();
+#if WORKERS_POOL
+    ThreadPool_Deinit(&g_pool);
+#endif
+    if (stats_file != NULL) {
+        QueueStatsDump_Stop(&g_dump);
+        fclose(stats_file);
+    }
+    if (wheel)
+        TimerWheel_Deinit(&g_wheel);
+    ThreadGroup_Deinit(&g_group);
     Queue_Deinit(&g_q);
     return(0);
 }
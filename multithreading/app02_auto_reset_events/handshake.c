@@ -3,21 +3,23 @@
    #Date: 10 July 2021 #
    #Revision: 1.0 #
    #Creator: Omid Miresmaeili #
-   #Description: Studying usage of auto-reset events #
+   #Description: Studying a thread pool and channels in place of auto-reset events #
    #The main idea is to reverse a string with two threads
    #Client thread (primary thread itself) submits requests
-   #Server thread reverses the submitted string
-   #Shutting down is done with a special string value
+   #Server work runs as a task on the shared thread pool
+   #Request and result travel through two SPSC channels
+   #Shutting down is draining and stopping the pool
    #Reference: "Windows via C/C++" 09-Handshake example
    #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
    =========================================================== */
 
 #include <windows.h>
-#include <process.h>    /* _beginthread, _endthread */
 #include <tchar.h>
 #include <windowsx.h>
 
 #include "resource.h"   /* ui controls IDs (from editor) */
+#include "../common/thread_pool.h"
+#include "../common/channel.h"
 
 // =========================================================================================
 
@@ -31,49 +33,42 @@
 // =========================================================================================
 
 //
-// Event to signal when client submits a request to server
-HANDLE g_event_request_submitted;
+// Pool the server work is submitted to
+ThreadPool g_pool;
 
 //
-// Event to signal when server returns the result to client
-HANDLE g_event_result_returned;
+// A request or a result, copied through the channels
+typedef struct Message {
+    TCHAR str[1024];
+} Message;
 
 //
-// Buffer shared between clinet and server
-TCHAR g_str_shared[1024];
-
-//
-// Special value sent from client to mark shutdown
-// NOTE(omid): a mechanism for server thread to terminate more cleanly
-TCHAR g_str_shutdown [] = TEXT("Server Shutdown");
-
-//
-// Server will check main dialog is no longer active when shutdown str is received
-HWND g_dialog_main;
+// Client to server, and server to client. One sender and one receiver each,
+// so both are SPSC rings; the result channel blocks the client while empty
+// NOTE(omid): server tasks may run on different workers, but never two at once:
+// the client submits the next one only after receiving the previous result
+Channel g_requests;
+Channel g_results;
 
 // =========================================================================================
 
-unsigned WINAPI
-ServerThread_Func (void * param_ptr) {
-   // -- assume server is to run forever
-    BOOL shutdown = FALSE;
-    while (!shutdown) {
-         // -- wait for client to submit request
-        WaitForSingleObject(g_event_request_submitted, INFINITE);
+/*
+ * One request is one task: no server thread sits blocked on a request event
+ * between submissions, the pool's workers run it when it arrives.
+ */
+void
+ServerTask_Func (void * param_ptr) {
+    UNREFERENCED_PARAMETER(param_ptr);
 
-        // -- check to see if client wants the server to shut down
-        shutdown =
-            (NULL == g_dialog_main) &&
-            (0 == _tcscmp(g_str_shared, g_str_shutdown));
+    // -- the request was sent before the task was submitted
+    Message m;
+    if (!Channel_TryRecv(&g_requests, &m))
+        return;
 
-        if (FALSE == shutdown) // process the request
-            _tcsrev(g_str_shared);  // reverse the string
+    _tcsrev(m.str);  // reverse the string
 
-        // -- let the client know the result is ready
-        SetEvent(g_event_result_returned);
-    }
-     // -- always return from exiting thread
-    return(0);
+    // -- hand the result back; the client is waiting on it
+    Channel_Send(&g_results, &m);
 }
 
 // =========================================================================================
@@ -93,9 +88,6 @@ DialogBox_OnInit (HWND hwnd, HWND hwnd_focus, LPARAM lparam) {
     // -- initialize edit control with some test data request
     Edit_SetText(GetDlgItem(hwnd, ID_TXT_REQUEST), TEXT("TEST DATA..."));
 
-    // -- store main dialog handle
-    g_dialog_main = hwnd;
-
     return TRUE;
 }
 void
@@ -104,25 +96,28 @@ DialogBox_OnCommand (HWND hwnd, int id, HWND hwnd_control, UINT code_notify) {
     case IDCANCEL:
         EndDialog(hwnd, id);
         break;
-    case ID_BTN_SUBMIT:     // submit a request to server thread
-        // -- copy request string to shared buffer
+    case ID_BTN_SUBMIT: {   // submit a request to server thread
+        // -- copy request string into a message
+        Message m;
         Edit_GetText(
             GetDlgItem(hwnd, ID_TXT_REQUEST),
-            g_str_shared,
-            _countof(g_str_shared)
+            m.str,
+            _countof(m.str)
         );
 
-        // -- let server know a request is ready,
-        // -- and wait for the server to process it
-        SignalObjectAndWait(
-            g_event_request_submitted,
-            g_event_result_returned,
-            INFINITE, FALSE
-        );
+        // -- send the request, hand its processing to the pool,
+        // -- and wait for the result to come back
+        if (!Channel_TrySend(&g_requests, &m))
+            break;
+        if (!ThreadPool_Submit(&g_pool, ServerTask_Func, NULL)) {
+            Channel_TryRecv(&g_requests, &m);   // take it back: no task will
+            break;
+        }
+        Channel_Recv(&g_results, &m);
 
         // -- after receiving the result, let the user know it
-        Edit_SetText(GetDlgItem(hwnd, ID_TXT_RESULT), g_str_shared);
-        break;
+        Edit_SetText(GetDlgItem(hwnd, ID_TXT_RESULT), m.str);
+    }break;
     }
 }
 INT_PTR WINAPI
@@ -146,34 +141,32 @@ _tWinMain(
     UNREFERENCED_PARAMETER(prev);
     UNREFERENCED_PARAMETER(showcmd);
 
-    // -- create two nonsignaled, auto-reset events
-    g_event_request_submitted = CreateEvent(NULL, FALSE, FALSE, NULL);
-    g_event_result_returned = CreateEvent(NULL, FALSE, FALSE, NULL);
+    // -- one message in flight each way; the client blocks on the result
+    if (!Channel_Init(&g_requests, sizeof(Message), 2, CHANNEL_SPSC, 1))
+        return(1);
+    if (!Channel_Init(&g_results, sizeof(Message), 2, CHANNEL_SPSC | CHANNEL_BLOCKING, 1)) {
+        Channel_Deinit(&g_requests);
+        return(1);
+    }
 
-    // -- spawn server thread
-    unsigned int thread_id;
-    HANDLE thread_server =  (HANDLE)_beginthreadex(
-        NULL, 0, ServerThread_Func, NULL, 0, &thread_id
-    );
+    // -- start the server pool, one worker per core
+    if (!ThreadPool_Init(&g_pool, 0)) {
+        Channel_Deinit(&g_results);
+        Channel_Deinit(&g_requests);
+        return(1);
+    }
 
     // -- execute client/main/primary thread UI
     DialogBox(instance, MAKEINTRESOURCE(ID_DIALOG_MAIN), NULL, &DialogBox_Func);
-    g_dialog_main = NULL;
 
     //
     // Dialog box is closed
-    // -- tell server thread to shutdown
-    _tcscpy_s(g_str_shared, _countof(g_str_shared), g_str_shutdown);
-    SetEvent(g_event_request_submitted);
-
-    // -- wait for server to acknowledge the shutdown and fully terminate
-    HANDLE h[] = {g_event_result_returned, thread_server};
-    WaitForMultipleObjects(_countof(h), h, TRUE, INFINITE);
+    // -- drain whatever is still queued and stop the workers
+    ThreadPool_Deinit(&g_pool);
 
     // -- cleanup
-    CloseHandle(thread_server);
-    CloseHandle(g_event_request_submitted);
-    CloseHandle(g_event_result_returned);
+    Channel_Deinit(&g_results);
+    Channel_Deinit(&g_requests);
 
     // Client thread terminates with whole process
     return(0);
@@ -6,19 +6,30 @@
    #Description: Thread synchronization with kernel objects
     Reworking the queue example using mutex and semaphore
     Semaphore keeps track of the # of elements in the Queue
-    Mutex guards the global shared resource (Queue)
+    Queue is a shard per NUMA node, each under its own lock
+    (QUEUE_SHARDED, the default), or one array guarded by a Mutex
+    Writers and readers are tasks on a thread pool (WORKERS_POOL,
+    the default) or a thread each
    #
    #Reference: "Windows via C/C++" 09-Handshake example #
    #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
    =========================================================== */
 
+#define _CRT_SECURE_NO_WARNINGS    /* fopen */
+
 #include <windows.h>
-#include <process.h>    /* _beginthread, _endthread */
 #include <tchar.h>
 #include <strsafe.h>
 #include <windowsx.h>
 
 #include "resource.h"   /* ui controls IDs (from editor) */
+#include "../../misc/alloc/mem_alloc.h"
+#include "../common/queue_stats.h"
+#include "../common/sharded_queue.h"
+#include "../common/thread_group.h"
+#include "../common/thread_pool.h"
+#include "../common/timer_wheel.h"
+#include "../common/topology.h"
 
 // =========================================================================================
 
@@ -31,15 +42,229 @@
 
 // =========================================================================================
 
+/*
+ * Queue timeouts are timers on one wheel rather than timed kernel waits:
+ * each thread waits without a timeout on its own auto-reset event as well,
+ * which the wheel sets when the timeout is up
+ */
+#define TIMEOUT_TICK_MS     10
+
+TimerWheel g_wheel;
+
+typedef struct Timeout {
+    Timer   timer;
+    HANDLE  event;      // auto-reset, set by the wheel
+} Timeout;
+
+static void
+Timeout_Fire (void * param_ptr) {
+    SetEvent(((Timeout *)param_ptr)->event);
+}
+static BOOL
+Timeout_Init (Timeout * t) {
+    Timer_Init(&t->timer, Timeout_Fire, t);
+    t->event = CreateEvent(NULL, FALSE, FALSE, NULL);
+    return t->event != NULL;
+}
+static void
+Timeout_Deinit (Timeout * t) {
+    TimerWheel_Cancel(&g_wheel, &t->timer);
+    CloseHandle(t->event);
+}
+static void
+Timeout_Start (Timeout * t, DWORD ms) {
+    if (ms != INFINITE)
+        TimerWheel_Arm(&g_wheel, &t->timer, ms);
+}
+static void
+Timeout_Stop (Timeout * t) {
+    // -- too late to cancel: it fired as the wait ended, do not let it end the next one
+    if (!TimerWheel_Cancel(&g_wheel, &t->timer))
+        ResetEvent(t->event);
+}
+
+// =========================================================================================
+
+/*
+ * Queue telemetry (common/queue_stats): appends, removes, full queues,
+ * readers that find it empty, timeouts and lock waits, the queue's depth at
+ * each append and each element's time in the queue. Appended to STATS_FILE
+ * as a JSON line every STATS_DUMP_MS, and once more on exit
+ */
+#define STATS_FILE          "app03_queue_stats.jsonl"
+#define STATS_DUMP_MS       5000
+
+QueueStats      g_stats;
+QueueStatsDump  g_dump;
+
+/*
+ * Waits for h[0], a semaphore, or the others: n handles, the last Timeout t's
+ * event. A reader that does not get an element at once counts as having
+ * found the queue empty; with timeout 0 it does not wait at all
+ */
+static DWORD
+Queue_WaitElement (HANDLE const * h, DWORD n, DWORD timeout, Timeout * t) {
+    DWORD dw = WaitForSingleObject(h[0], 0);
+    if (dw != WAIT_OBJECT_0 && 0 == timeout) {
+        QueueStats_Add(&g_stats, QSTAT_EMPTY, 1);
+    } else if (dw != WAIT_OBJECT_0) {
+        QueueStats_Add(&g_stats, QSTAT_EMPTY, 1);
+        Timeout_Start(t, timeout);
+        dw = WaitForMultipleObjects(n, h, FALSE, INFINITE);
+        Timeout_Stop(t);
+        if (WAIT_OBJECT_0 + n - 1 == dw)
+            QueueStats_Add(&g_stats, QSTAT_TIMEOUT, 1);
+    }
+    return dw;
+}
+
+// =========================================================================================
+
+/*
+ * QUEUE_SHARDED splits the queue per NUMA node (common/sharded_queue): a
+ * shard, its own lock and node-local memory per node, threads pinned to a
+ * node round-robin. Writers append to their node's shard, waiting on its
+ * free-slot semaphore when it is full; readers remove from theirs first and
+ * take from the others only once it has stayed empty for STEAL_AFTER polls.
+ * The semaphore still counts the elements of all shards. Without it, one array
+ * under one mutex, whose lines cross the sockets on every operation.
+ * numa_bench measures both.
+ */
+#ifndef QUEUE_SHARDED
+#define QUEUE_SHARDED       1
+#endif
+#define STEAL_AFTER         16      // empty local polls before a reader steals
+
+Topology g_topo;
+
+#if QUEUE_SHARDED
+struct Queue {
+    struct Element {
+        int thread_number;
+        int request_number;
+        LONGLONG enqueued_ns;   // QueueStats_Now() when appended
+        /* additional element data */
+
+    };
+    ShardedQueue        shards;             // a FIFO per node
+    int                 max_elements;       // max # of elements per shard
+
+    enum HANDLE_ID {
+        SEM_HID,         // semaphore for counting elements
+
+        _COUNT_HIDS
+    } HANDLE_IDS;
+
+    HANDLE  handles[_COUNT_HIDS];     // semaphore handle
+    HANDLE  space[TOPOLOGY_MAX_DOMAINS];    // semaphores for counting each shard's free slots
+};
+
+typedef struct Queue Queue;
+typedef struct Element Element;
+
+static void
+Queue_Deinit (Queue * q) {
+    if (q->handles[SEM_HID] != NULL)
+        CloseHandle(q->handles[SEM_HID]);
+    for (int i = 0; i < q->shards.n_shards; ++i)
+        if (q->space[i] != NULL)
+            CloseHandle(q->space[i]);
+    ShardedQueue_Deinit(&q->shards);
+}
+/* FALSE when the shards or a semaphore cannot be made */
+static BOOL
+Queue_Init (Queue * q, int max_e) {
+    if (!ShardedQueue_Init(&q->shards, &g_topo, sizeof(Element), max_e))
+        return FALSE;
+    q->shards.stats = &g_stats;
+    q->max_elements = max_e;
+    q->handles[SEM_HID] = CreateSemaphore(NULL, 0, max_e * q->shards.n_shards, NULL);
+    BOOL ok = (q->handles[SEM_HID] != NULL);
+    for (int i = 0; i < q->shards.n_shards; ++i) {
+        q->space[i] = CreateSemaphore(NULL, max_e, max_e, NULL);
+        ok = ok && (q->space[i] != NULL);
+    }
+    if (!ok)
+        Queue_Deinit(q);
+    return ok;
+}
+/*
+ * A full shard is waited on, through its free-slot semaphore, for up to
+ * timeout on the wheel (not at all with 0), where the FIFO waits for its
+ * mutex; a slot taken from the semaphore is the shard's, so the push that
+ * follows finds room
+ */
+static BOOL
+Queue_Append (Queue * q, Element * e, DWORD timeout, Timeout * t) {
+    int shard = Topology_CurrentDomain(&g_topo);
+    HANDLE h[] = {q->space[shard], t->event};
+
+    DWORD dw = WaitForSingleObject(h[0], 0);
+    if (dw != WAIT_OBJECT_0) {  // q's shard is full, wait for a reader to take one
+        QueueStats_Add(&g_stats, QSTAT_FULL, 1);
+        if (timeout != 0) {
+            Timeout_Start(t, timeout);
+            dw = WaitForMultipleObjects(_countof(h), h, FALSE, INFINITE);
+            Timeout_Stop(t);
+        }
+    }
+
+    if (WAIT_OBJECT_0 == dw) {  // a slot of q's shard is this thread's, append element
+        e->enqueued_ns = QueueStats_Now();
+        ShardedQueue_Push(&q->shards, shard, e);
+        ReleaseSemaphore(q->handles[SEM_HID], 1, NULL);
+        QueueStats_Enqueue(&g_stats, ShardedQueue_Count(&q->shards));
+        return TRUE;
+    }
+    // -- timeout!
+    QueueStats_Add(&g_stats, QSTAT_TIMEOUT, 1);
+    SetLastError(ERROR_TIMEOUT);
+    return FALSE;   // call GetLastError for more info
+}
+/*
+ * cancel is signaled to give up waiting (ERROR_CANCELLED). A semaphore count
+ * means an element is in some shard; another reader may be taking it from
+ * under this one, in which case the one left for this reader is elsewhere.
+ * A writer of this node may also append one meanwhile, which is taken first
+ */
+static BOOL
+Queue_Remove (Queue * q, Element * e_out, DWORD timeout, HANDLE cancel, Timeout * t) {
+    HANDLE h[] = {q->handles[SEM_HID], cancel, t->event};
+
+    DWORD dw = Queue_WaitElement(h, _countof(h), timeout, t);
+    BOOL ret = (WAIT_OBJECT_0 == dw);
+
+    if (ret) {
+        // Queue has an element reserved for this thread, local shard first
+        // -- local while there is local work; steal only after STEAL_AFTER empty polls
+        int domain = Topology_CurrentDomain(&g_topo);
+        int from = domain, idle = 0;
+        for (;;) {
+            if (ShardedQueue_PopLocal(&q->shards, domain, e_out))
+                break;
+            if (++idle >= STEAL_AFTER && ShardedQueue_Pop(&q->shards, domain, e_out, &from))
+                break;
+            SwitchToThread();
+        }
+        ReleaseSemaphore(q->space[from], 1, NULL);
+        QueueStats_Dequeue(&g_stats, e_out->enqueued_ns);
+    } else {    // timeout or shutdown!
+        SetLastError((WAIT_OBJECT_0 + 1 == dw) ? ERROR_CANCELLED : ERROR_TIMEOUT);
+    }
+    return ret;     // call GetLastError for more info
+}
+#else
 struct Queue {
     struct Element {
         int thread_number;
         int request_number;
+        LONGLONG enqueued_ns;   // QueueStats_Now() when appended
         /* additional element data */
 
     };
     struct Element *    elements;           // array of elements
     int                 max_elements;       // max # of elements
+    int                 count;              // # of stored elements, under the mutex
 
     enum HANDLE_ID {
         MTX_HID,         // mutex for guarding queue
@@ -54,56 +279,100 @@ struct Queue {
 typedef struct Queue Queue;
 typedef struct Element Element;
 
-static void
+/* FALSE when the array or a handle cannot be made */
+static BOOL
 Queue_Init (Queue * q, int max_e) {
-    q->elements = (Element *)HeapAlloc(
-        GetProcessHeap(), 0, sizeof(Element) * max_e
+    // -- zeroed and on its own cache lines, off the contended process heap
+    q->elements = (Element *)Mem_AllocAligned(
+        sizeof(Element) * max_e, MEM_CACHE_LINE, MEM_ZERO
     );
-    if (q->elements)
-        ZeroMemory(q->elements, sizeof(Element) * max_e);
+    if (NULL == q->elements)
+        return FALSE;
 
     q->max_elements = max_e;
+    q->count = 0;
 
     q->handles[MTX_HID] = CreateMutex(NULL, FALSE, NULL);
     q->handles[SEM_HID] = CreateSemaphore(NULL, 0, max_e, NULL);
+    if (NULL == q->handles[MTX_HID] || NULL == q->handles[SEM_HID]) {
+        if (q->handles[MTX_HID] != NULL)
+            CloseHandle(q->handles[MTX_HID]);
+        if (q->handles[SEM_HID] != NULL)
+            CloseHandle(q->handles[SEM_HID]);
+        Mem_FreeAligned(q->elements);
+        return FALSE;
+    }
+    return TRUE;
 }
 static void
 Queue_Deinit (Queue * q) {
     CloseHandle(q->handles[MTX_HID]);
     CloseHandle(q->handles[SEM_HID]);
-    HeapFree(GetProcessHeap(), 0, q->elements);
+    Mem_FreeAligned(q->elements);
+}
+/* Tries the mutex first; only a wait for it is timed */
+static DWORD
+Queue_Lock (Queue * q, HANDLE const * h, DWORD n) {
+    DWORD dw = WaitForSingleObject(q->handles[MTX_HID], 0);
+    if (WAIT_OBJECT_0 == dw) {
+        QueueStats_LockAcquired(&g_stats, 0);
+    } else {
+        LONGLONG start = QueueStats_Now();
+        dw = WaitForMultipleObjects(n, h, FALSE, INFINITE);
+        if (WAIT_OBJECT_0 == dw)
+            QueueStats_LockAcquired(&g_stats, max(QueueStats_Now() - start, 1));
+    }
+    return dw;
 }
+/* With timeout 0, the mutex is still waited for, up to one tick of the wheel */
 static BOOL
-Queue_Append (Queue * q, Element * e, DWORD timeout) {
+Queue_Append (Queue * q, Element * e, DWORD timeout, Timeout * t) {
     BOOL ret = FALSE;
-    DWORD dw = WaitForSingleObject(q->handles[MTX_HID], timeout);
+    HANDLE h[] = {q->handles[MTX_HID], t->event};
+
+    Timeout_Start(t, timeout);
+    DWORD dw = Queue_Lock(q, h, _countof(h));
+    Timeout_Stop(t);
 
     if (WAIT_OBJECT_0 == dw) {
         // Thread has exclusive access to queue
 
-        // -- increment # of elements
-        LONG prev_count;
-        ret = ReleaseSemaphore(q->handles[SEM_HID], 1, &prev_count);
-        if (ret)    // q is not full, append element
-            q->elements[prev_count] = *e;
-        else        // q is full, set error code
+        // -- a reader may hold a semaphore count it has not removed yet:
+        // -- the stored count, not the semaphore's, says where the element goes
+        ret = (q->count < q->max_elements);
+        if (ret) {  // q is not full, append element
+            e->enqueued_ns = QueueStats_Now();
+            q->elements[q->count++] = *e;
+            ReleaseSemaphore(q->handles[SEM_HID], 1, NULL);
+            QueueStats_Enqueue(&g_stats, q->count);
+        } else {    // q is full, set error code
+            QueueStats_Add(&g_stats, QSTAT_FULL, 1);
             SetLastError(ERROR_DATABASE_FULL);
+        }
 
         // -- allow other threads to access q
         ReleaseMutex(q->handles[MTX_HID]);
     } else {    // timeout!
+        QueueStats_Add(&g_stats, QSTAT_TIMEOUT, 1);
         SetLastError(ERROR_TIMEOUT);
     }
     return ret;     // call GetLastError for more info
 }
+/*
+ * cancel is signaled to give up waiting (ERROR_CANCELLED). Waiting for all of
+ * {mutex, semaphore, cancel} would need the cancel event set to return at all,
+ * so the semaphore (or cancel) is waited for first, then the mutex
+ */
 static BOOL
-Queue_Remove (Queue * q, Element * e_out, DWORD timeout) {
-    BOOL ret =
-        (WAIT_OBJECT_0 ==
-        WaitForMultipleObjects(_countof(q->handles), q->handles, TRUE, timeout));
+Queue_Remove (Queue * q, Element * e_out, DWORD timeout, HANDLE cancel, Timeout * t) {
+    HANDLE h[] = {q->handles[SEM_HID], cancel, t->event};
+
+    DWORD dw = Queue_WaitElement(h, _countof(h), timeout, t);
+    BOOL ret = (WAIT_OBJECT_0 == dw);
 
     if (ret) {
-        // Queue has an element, pull it from queue
+        // Queue has an element reserved for this thread, pull it from queue
+        Queue_Lock(q, &q->handles[MTX_HID], 1);
         *e_out = q->elements[0];
 
         // -- shift remaining elements down
@@ -111,24 +380,58 @@ Queue_Remove (Queue * q, Element * e_out, DWORD timeout) {
             &q->elements[0], &q->elements[1],
             sizeof(Element) * (q->max_elements - 1)
         );
+        q->count--;
 
         // -- allow other threads to access the queue
         ReleaseMutex(q->handles[MTX_HID]);
-    } else {    // timeout!
-        SetLastError(ERROR_TIMEOUT);
+        QueueStats_Dequeue(&g_stats, e_out->enqueued_ns);
+    } else {    // timeout or shutdown!
+        SetLastError((WAIT_OBJECT_0 + 1 == dw) ? ERROR_CANCELLED : ERROR_TIMEOUT);
     }
     return ret;     // call GetLastError for more info
 }
+#endif
 // =========================================================================================
 
 Queue               g_q;                    // shared resource b/w threads
-volatile LONG       g_shutdown;             // signal client/server threads to die
 HWND                g_hwnd;                 // to give status b/w client/server
 
-// -- cache handles to all threads [thread kernel objs]
-HANDLE g_threads[MAXIMUM_WAIT_OBJECTS];
-
-int g_threads_count = 0;     // number of reader/writer threads
+// -- reader/writer threads; its cancel token signals them (or their tasks) to die
+ThreadGroup g_group;
+
+#define WRITERS_COUNT   4
+#define READERS_COUNT   2
+
+/*
+ * WORKERS_POOL runs the writers and readers as short tasks on a
+ * work-stealing pool (common/thread_pool) instead of a thread each, so no
+ * pool worker sleeps or waits on the queue:
+ *  - a writer step appends one element without waiting for a full shard,
+ *    then arms its timer on the wheel, whose callback submits the next step;
+ *  - every element appended submits a reader task, which takes it, without
+ *    waiting, on behalf of an idle reader. The reader's processing time is
+ *    a timer too, after which its callback looks for the next element.
+ * Without it, the threads wait on the queue's kernel objects for up to
+ * their timeouts and sleep between requests.
+ */
+#ifndef WORKERS_POOL
+#define WORKERS_POOL        1
+#endif
+
+#define WRITER_PAUSE_MS     2500    // between a writer's requests
+
+/* A writer or reader run as pool tasks (WORKERS_POOL) */
+typedef struct Worker {
+    Timer           timer;          // the next step, on the wheel
+    Timeout         timeout;        // the queue's, which a task does not wait on
+    int             thread_number;
+    int             request_number; // a writer's last request
+    volatile LONG   busy;           // a reader is processing an element
+} Worker;
+
+ThreadPool  g_pool;
+Worker      g_writers[WRITERS_COUNT];
+Worker      g_readers[READERS_COUNT];
 
 // =========================================================================================
 //
@@ -143,20 +446,26 @@ int g_threads_count = 0;     // number of reader/writer threads
 
 // =========================================================================================
 
-unsigned WINAPI
+void
 WriterThread_Func (void * param_ptr) {
     int thread_number = (intptr_t)param_ptr;
     HWND hwnd_listbox = GetDlgItem(g_hwnd, ID_LBOX_CLIENTS);
+    Timeout timeout;
+    if (!Timeout_Init(&timeout))
+        return;
+#if QUEUE_SHARDED
+    Topology_PinToDomain(&g_topo, thread_number % g_topo.n_domains);
+#endif
 
     int request_number = 0;
-    while (1 != InterlockedCompareExchange(&g_shutdown, 0, 0)) {
+    while (!CancelToken_IsCancelled(&g_group.cancel)) {
         ++request_number;   // keep track of current preocessed element
 
         TCHAR str[1024];
         Element e = {thread_number, request_number};
 
         // -- try to append an element onto the q
-        if (Queue_Append(&g_q, &e, 200)) {
+        if (Queue_Append(&g_q, &e, 200, &timeout)) {
             // -- indicate which thread sent which request
             StringCchPrintf(
                 str, _countof(str),
@@ -172,23 +481,30 @@ WriterThread_Func (void * param_ptr) {
         }
         // -- update client list box
         ListBox_SetCurSel(hwnd_listbox, ListBox_AddString(hwnd_listbox, str));
-        Sleep(2500);    // wait before appending another element
+        // -- wait before appending another element, unless asked to stop
+        CancelToken_Sleep(&g_group.cancel, WRITER_PAUSE_MS);
     }
-    // -- always return from exiting thread
-    return(0);
+    Timeout_Deinit(&timeout);
 }
-unsigned WINAPI
+void
 ReaderThread_Func (void * param_ptr) {
     int thread_number = (intptr_t)param_ptr;
     HWND hwnd_listbox = GetDlgItem(g_hwnd, ID_LBOX_SERVERS);
+    HANDLE cancel = CancelToken_Event(&g_group.cancel);
+    Timeout timeout;
+    if (!Timeout_Init(&timeout))
+        return;
+#if QUEUE_SHARDED
+    Topology_PinToDomain(&g_topo, thread_number % g_topo.n_domains);
+#endif
 
-    while (1 != InterlockedCompareExchange(&g_shutdown, 0, 0)) {
+    while (!CancelToken_IsCancelled(&g_group.cancel)) {
 
         TCHAR str[1024];
         Element e;
 
         // -- try to get an element from the q
-        if (Queue_Remove(&g_q, &e, 5000)) {
+        if (Queue_Remove(&g_q, &e, 5000, cancel, &timeout)) {
             // -- indicate which thread processed which request
             StringCchPrintf(
                 str, _countof(str),
@@ -196,7 +512,9 @@ ReaderThread_Func (void * param_ptr) {
             );
 
             // -- server takes some time to process request
-            Sleep(2000 * e.thread_number);
+            CancelToken_Sleep(&g_group.cancel, 2000 * e.thread_number);
+        } else if (ERROR_CANCELLED == GetLastError()) {
+            break;
         } else {
             // -- couldn't get an element from q
             StringCchPrintf(
@@ -207,24 +525,144 @@ ReaderThread_Func (void * param_ptr) {
         // -- update server list box
         ListBox_SetCurSel(hwnd_listbox, ListBox_AddString(hwnd_listbox, str));
     }
-    // -- always return from exiting thread
-    return(0);
+    Timeout_Deinit(&timeout);
+}
+
+// =========================================================================================
+
+void ReaderTask_Func (void * param_ptr);
+
+/* One request, appended or not; either way the next one is a timer away */
+void
+WriterTask_Func (void * param_ptr) {
+    Worker * w = (Worker *)param_ptr;
+    HWND hwnd_listbox = GetDlgItem(g_hwnd, ID_LBOX_CLIENTS);
+    if (CancelToken_IsCancelled(&g_group.cancel))
+        return;
+
+    TCHAR str[1024];
+    Element e = {w->thread_number, ++w->request_number};
+
+    if (Queue_Append(&g_q, &e, 0, &w->timeout)) {
+        StringCchPrintf(
+            str, _countof(str),
+            TEXT("Sending %d:%d"), w->thread_number, w->request_number
+        );
+        // -- an idle reader takes it now, else the first to finish the one it is on
+        ThreadPool_Submit(&g_pool, ReaderTask_Func, NULL);
+    } else {
+        StringCchPrintf(
+            str, _countof(str),
+            TEXT("Sending %d:%d (%s)"), w->thread_number, w->request_number,
+            (GetLastError() == ERROR_TIMEOUT) ? TEXT("Timeout") : TEXT("Full")
+        );
+    }
+    ListBox_SetCurSel(hwnd_listbox, ListBox_AddString(hwnd_listbox, str));
+    TimerWheel_Arm(&g_wheel, &w->timer, WRITER_PAUSE_MS);
+}
+/* The first idle reader takes an element, if there is one; a busy one's timer looks again */
+void
+ReaderTask_Func (void * param_ptr) {
+    HWND hwnd_listbox = GetDlgItem(g_hwnd, ID_LBOX_SERVERS);
+    HANDLE cancel = CancelToken_Event(&g_group.cancel);
+    UNREFERENCED_PARAMETER(param_ptr);
+
+    for (int i = 0; i < READERS_COUNT; ++i) {
+        Worker * r = &g_readers[i];
+        if (CancelToken_IsCancelled(&g_group.cancel))
+            return;
+        if (InterlockedCompareExchange(&r->busy, TRUE, FALSE) != FALSE)
+            continue;
+
+        TCHAR str[1024];
+        Element e;
+        if (Queue_Remove(&g_q, &e, 0, cancel, &r->timeout)) {
+            StringCchPrintf(
+                str, _countof(str),
+                TEXT("%d: Processing %d:%d"), r->thread_number, e.thread_number, e.request_number
+            );
+            // -- the request takes some time to process: the reader is busy until its timer
+            TimerWheel_Arm(&g_wheel, &r->timer, 2000 * e.thread_number);
+        } else {
+            InterlockedExchange(&r->busy, FALSE);
+            StringCchPrintf(str, _countof(str), TEXT("%d: (empty)"), r->thread_number);
+        }
+        ListBox_SetCurSel(hwnd_listbox, ListBox_AddString(hwnd_listbox, str));
+        return;
+    }
+}
+/* On the wheel thread: the step itself goes to the pool, or tries again when it is full */
+static void
+WriterTimer_Func (void * param_ptr) {
+    Worker * w = (Worker *)param_ptr;
+    if (CancelToken_IsCancelled(&g_group.cancel))
+        return;
+    if (!ThreadPool_Submit(&g_pool, WriterTask_Func, w))
+        TimerWheel_Arm(&g_wheel, &w->timer, TIMEOUT_TICK_MS);
+}
+static void
+ReaderTimer_Func (void * param_ptr) {
+    Worker * r = (Worker *)param_ptr;
+    if (CancelToken_IsCancelled(&g_group.cancel))
+        return;
+    // -- done processing: free for the next element, appended meanwhile or not
+    InterlockedExchange(&r->busy, FALSE);
+    if (!ThreadPool_Submit(&g_pool, ReaderTask_Func, NULL))
+        TimerWheel_Arm(&g_wheel, &r->timer, TIMEOUT_TICK_MS);
+}
+static void
+Workers_Deinit (Worker * workers, int n) {
+    for (int i = 0; i < n; ++i)
+        if (workers[i].timeout.event != NULL) {
+            Timeout_Deinit(&workers[i].timeout);
+            workers[i].timeout.event = NULL;
+        }
+}
+/* FALSE when an event cannot be made */
+static BOOL
+Workers_Init (Worker * workers, int n, TimerFn step) {
+    for (int i = 0; i < n; ++i) {
+        Timer_Init(&workers[i].timer, step, &workers[i]);
+        workers[i].thread_number = i;
+        if (!Timeout_Init(&workers[i].timeout)) {
+            Workers_Deinit(workers, i + 1);
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+/*
+ * A task arms no timer once it sees the cancel: the tasks that may have
+ * started before it are waited for, then every timer is cancelled, then
+ * whatever the last callbacks submitted
+ */
+static void
+Workers_Stop (void) {
+    ThreadPool_Wait(&g_pool);
+    for (int i = 0; i < WRITERS_COUNT; ++i)
+        TimerWheel_Cancel(&g_wheel, &g_writers[i].timer);
+    for (int i = 0; i < READERS_COUNT; ++i)
+        TimerWheel_Cancel(&g_wheel, &g_readers[i].timer);
+    ThreadPool_Wait(&g_pool);
 }
 BOOL
 DialogBox_OnInit (HWND hwnd, HWND hwnd_focus, LPARAM lparam) {
     g_hwnd = hwnd;  // used by client/server threads to show status
-    unsigned int thread_id;
 
-    // Create four writer threads (client)
-    for (int i = 0; i < 4; ++i)
-        g_threads[g_threads_count++] =
-        (HANDLE)_beginthreadex(NULL, 0, WriterThread_Func, (void *)(intptr_t)i, 0, &thread_id);
-
-//
-// Create two reader threads (server)
-    for (int i = 0; i < 2; ++i)
-        g_threads[g_threads_count++] =
-        (HANDLE)_beginthreadex(NULL, 0, ReaderThread_Func, (void *)(intptr_t)i, 0, &thread_id);
+#if WORKERS_POOL
+    // Every writer's first step (client), now; a reader task comes with each element
+    for (int i = 0; i < WRITERS_COUNT; ++i)
+        ThreadPool_Submit(&g_pool, WriterTask_Func, &g_writers[i]);
+#else
+    // Create the writer threads (client)
+    for (int i = 0; i < WRITERS_COUNT; ++i)
+        ThreadGroup_Spawn(&g_group, WriterThread_Func, (void *)(intptr_t)i);
+
+    //
+    // Create the reader threads (server)
+    for (int i = 0; i < READERS_COUNT; ++i)
+        ThreadGroup_Spawn(&g_group, ReaderThread_Func, (void *)(intptr_t)i);
+#endif
 
     return TRUE;
 }
@@ -256,20 +694,66 @@ _tWinMain(
 ) {
     UNREFERENCED_PARAMETER(prev);
     UNREFERENCED_PARAMETER(showcmd);
-    Queue_Init(&g_q, 10);
+    if (!Topology_Detect(&g_topo, 0))
+        return(1);
+    QueueStats_Init(&g_stats, "app03");
+    if (!Queue_Init(&g_q, 10)) {
+        Topology_Deinit(&g_topo);
+        return(1);
+    }
+    if (!TimerWheel_Init(&g_wheel, TIMEOUT_TICK_MS)) {
+        Queue_Deinit(&g_q);
+        Topology_Deinit(&g_topo);
+        return(1);
+    }
+    if (!ThreadGroup_Init(&g_group)) {
+        TimerWheel_Deinit(&g_wheel);
+        Queue_Deinit(&g_q);
+        Topology_Deinit(&g_topo);
+        return(1);
+    }
+#if WORKERS_POOL
+    BOOL workers = Workers_Init(g_writers, WRITERS_COUNT, WriterTimer_Func)
+        && Workers_Init(g_readers, READERS_COUNT, ReaderTimer_Func);
+    if (!workers || !ThreadPool_Init(&g_pool, 0)) {
+        Workers_Deinit(g_writers, WRITERS_COUNT);
+        Workers_Deinit(g_readers, READERS_COUNT);
+        ThreadGroup_Deinit(&g_group);
+        TimerWheel_Deinit(&g_wheel);
+        Queue_Deinit(&g_q);
+        Topology_Deinit(&g_topo);
+        return(1);
+    }
+#endif
+    // -- no file, no dumps: the counting goes on regardless
+    FILE * stats_file = fopen(STATS_FILE, "a");
+    if (stats_file != NULL)
+        QueueStatsDump_Start(&g_dump, &g_stats, &g_wheel, STATS_DUMP_MS, stats_file, TRUE);
 
     DialogBox(instance, MAKEINTRESOURCE(ID_DIALOG_MAIN), NULL, &DialogBox_Func);
 
-    // -- mark the closing of dialog box
-    InterlockedExchange(&g_shutdown, TRUE);
+    // -- mark the closing of dialog box: sleeping and waiting threads wake up at once
+    ThreadGroup_Cancel(&g_group);
 
-    // -- wait for all threads to terminate
-    WaitForMultipleObjects(g_threads_count, g_threads, TRUE, INFINITE);
+#if WORKERS_POOL
+    Workers_Stop();
+    ThreadPool_Deinit(&g_pool);
+    Workers_Deinit(g_writers, WRITERS_COUNT);
+    Workers_Deinit(g_readers, READERS_COUNT);
+#else
+    // -- wait for all threads to terminate, one latch wait however many there are
+    ThreadGroup_Join(&g_group, MT_INFINITE);
+#endif
 
     // -- cleanup
-    while (g_threads_count--)
-        CloseHandle(g_threads[g_threads_count]);
+    if (stats_file != NULL) {
+        QueueStatsDump_Stop(&g_dump);
+        fclose(stats_file);
+    }
+    ThreadGroup_Deinit(&g_group);
+    TimerWheel_Deinit(&g_wheel);
     Queue_Deinit(&g_q);
+    Topology_Deinit(&g_topo);
 
     return(0);
 }
@@ -0,0 +1,228 @@
+/* ===========================================================
+   #File: channel_bench.c #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: One producer, one consumer: SPSC channel vs MPMC channel vs event handshake #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+/*
+One thread sends numbered 8-byte messages, another receives them and
+checks they arrive in order:
+
+    event       the handshake app's pattern: a shared slot and two auto-reset
+                events, one round trip per message
+    mpmc        common/channel without CHANNEL_SPSC
+    spsc        common/channel with CHANNEL_SPSC, publishing every send
+    spsc/32     the same, publishing every 32 sends
+
+The channels run blocking (spin, then sleep) and spinning (spin, then yield).
+*/
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L    /* clock_gettime */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../common/mt_platform.h"
+#include "../common/channel.h"
+#include "../../bench/bench_util.h"
+
+#define CHANNEL_MESSAGES    (1 << 22)
+#define EVENT_MESSAGES      (1 << 16)   // a round trip each: far slower
+#define CAPACITY            1024
+
+// =========================================================================================
+
+#pragma region events
+/* An auto-reset event: CreateEvent on Win32, a flag under a lock elsewhere */
+typedef struct BenchEvent {
+#ifdef _WIN32
+    HANDLE  h;
+#else
+    MtLock  lock;
+    MtCond  cond;
+    int     set;
+#endif
+} BenchEvent;
+
+static void
+event_init (BenchEvent * e) {
+#ifdef _WIN32
+    e->h = CreateEvent(NULL, FALSE, FALSE, NULL);
+#else
+    mt_lock_init(&e->lock);
+    mt_cond_init(&e->cond);
+    e->set = 0;
+#endif
+}
+static void
+event_deinit (BenchEvent * e) {
+#ifdef _WIN32
+    CloseHandle(e->h);
+#else
+    mt_lock_deinit(&e->lock);
+    mt_cond_deinit(&e->cond);
+#endif
+}
+static void
+event_set (BenchEvent * e) {
+#ifdef _WIN32
+    SetEvent(e->h);
+#else
+    mt_lock(&e->lock);
+    e->set = 1;
+    mt_cond_signal(&e->cond);
+    mt_unlock(&e->lock);
+#endif
+}
+static void
+event_wait (BenchEvent * e) {
+#ifdef _WIN32
+    WaitForSingleObject(e->h, INFINITE);
+#else
+    mt_lock(&e->lock);
+    while (!e->set)
+        mt_cond_wait(&e->cond, &e->lock);
+    e->set = 0;     // auto-reset
+    mt_unlock(&e->lock);
+#endif
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region workloads
+typedef struct Run {
+    Channel     ch;
+    BenchEvent  request_submitted;
+    BenchEvent  result_returned;
+    int64_t     shared;         // the event pattern's buffer
+    int64_t     n;
+    int         ok;             // set by the receiver
+} Run;
+
+static void
+channel_sender (void * arg) {
+    Run * r = (Run *)arg;
+    for (int64_t i = 1; i <= r->n; i++)
+        Channel_Send(&r->ch, &i);
+    Channel_Close(&r->ch);
+}
+static void
+channel_receiver (void * arg) {
+    Run * r = (Run *)arg;
+    int64_t expected = 1, msg;
+    while (Channel_Recv(&r->ch, &msg))
+        r->ok &= (msg == expected++);
+    r->ok &= (expected == r->n + 1);
+}
+static void
+event_server (void * arg) {
+    Run * r = (Run *)arg;
+    for (int64_t i = 1; i <= r->n; i++) {
+        event_wait(&r->request_submitted);
+        r->ok &= (r->shared == i);
+        r->shared = -r->shared;     // the "reverse"
+        event_set(&r->result_returned);
+    }
+}
+/* The client side runs on the calling thread, like the handshake's UI thread */
+static void
+event_client (Run * r) {
+    for (int64_t i = 1; i <= r->n; i++) {
+        r->shared = i;
+        event_set(&r->request_submitted);
+        event_wait(&r->result_returned);
+        r->ok &= (r->shared == -i);
+    }
+}
+#pragma endregion
+
+// =========================================================================================
+
+typedef struct Variant {
+    char const *    name;
+    int             flags;          // -1: the event handshake
+    int             batch;
+} Variant;
+
+static Variant const g_variants [] = {
+    {"event",               -1,                                 0},
+    {"mpmc blocking",       CHANNEL_BLOCKING,                   1},
+    {"mpmc spinning",       0,                                  1},
+    {"spsc blocking",       CHANNEL_SPSC | CHANNEL_BLOCKING,    1},
+    {"spsc spinning",       CHANNEL_SPSC,                       1},
+    {"spsc/32 blocking",    CHANNEL_SPSC | CHANNEL_BLOCKING,    32},
+    {"spsc/32 spinning",    CHANNEL_SPSC,                       32},
+};
+
+/* Seconds for one run, 0 if it failed */
+static double
+run_once (Variant const * v, int * ok) {
+    Run * r = (Run *)calloc(1, sizeof(Run));
+    MtThread receiver;
+    double t = 0;
+    r->ok = 1;
+    r->n = (v->flags < 0) ? EVENT_MESSAGES : CHANNEL_MESSAGES;
+    if (v->flags < 0) {
+        event_init(&r->request_submitted);
+        event_init(&r->result_returned);
+    } else if (!Channel_Init(&r->ch, sizeof(int64_t), CAPACITY, v->flags, v->batch)) {
+        free(r);
+        *ok = 0;
+        return 0;
+    }
+
+    int64_t t0 = mt_now_ns();
+    if (mt_thread_create(&receiver, (v->flags < 0) ? event_server : channel_receiver, r)) {
+        if (v->flags < 0)
+            event_client(r);
+        else
+            channel_sender(r);
+        mt_thread_join(receiver);
+        t = (double)(mt_now_ns() - t0) * 1e-9;
+    } else {
+        r->ok = 0;
+    }
+
+    if (v->flags < 0) {
+        event_deinit(&r->request_submitted);
+        event_deinit(&r->result_returned);
+    } else {
+        Channel_Deinit(&r->ch);
+    }
+    *ok &= r->ok;
+    free(r);
+    return t;
+}
+
+int main (int argc, char * argv []) {
+    (void)argc;
+    (void)argv;
+    printf("one sender, one receiver, 8-byte messages, capacity %d (best of %d)\n", CAPACITY, BENCH_REPS);
+    printf("%-18s %10s %12s %12s\n", "variant", "messages", "ns/message", "M msg/s");
+    for (size_t k = 0; k < sizeof(g_variants) / sizeof(g_variants[0]); ++k) {
+        Variant const * v = &g_variants[k];
+        double n = (v->flags < 0) ? EVENT_MESSAGES : CHANNEL_MESSAGES;
+        double best = 1e30;
+        int ok = 1;
+        for (int rep = 0; rep < BENCH_REPS; ++rep) {
+            double t = run_once(v, &ok);
+            if (t > 0 && t < best)
+                best = t;
+        }
+        printf(
+            "%-18s %10.0f %12.1f %12.2f%s\n", v->name, n, best / n * 1e9, n / best / 1e6,
+            ok ? "" : "  (MISMATCH)"
+        );
+        fflush(stdout);
+    }
+    return(0);
+}
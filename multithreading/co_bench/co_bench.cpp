@@ -0,0 +1,327 @@
+/* ===========================================================
+   #File: co_bench.cpp #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Thousands of logical consumers: coroutines on a pool vs a thread each #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+/*
+    consumers   PRODUCERS producers push 1..ITEMS through a queue of
+                CAPACITY to N consumers, which sum what they pop until the
+                queue is closed:
+                    coroutines  common/co_queue's CoQueue, the consumers
+                                coroutines on a ThreadPool
+                    threads     a lock + two condition variables queue, like
+                                app01's, and an OS thread per consumer
+    handshake   N clients each send REQUESTS strings to one server, which
+                reverses them, like app02, every client awaiting
+                server.request(msg) as a coroutine
+
+co_bench [consumers] [handshake]; no arguments runs both.
+*/
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L    /* clock_gettime */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../common/co_queue.h"
+#include "../common/thread_group.h"
+#include "../common/thread_pool.h"
+#include "../../bench/bench_util.h"
+
+#ifndef _countof
+#define _countof(a) (sizeof(a) / sizeof((a)[0]))
+#endif
+
+#define PRODUCERS       4
+#define ITEMS           (1 << 20)
+#define CAPACITY        1024
+#define REQUESTS        64          // per handshake client
+#define WORKERS         4           // pool size, whatever the core count
+
+static int const g_consumers [] = {100, 1000, 10000};
+
+// =========================================================================================
+
+#pragma region consumers
+struct Totals {
+    int64_t volatile    sum = 0;
+    int64_t volatile    popped = 0;
+};
+
+static CoTask<void>
+co_producer (CoQueue<int64_t> * q, int64_t first, int64_t last, Latch * done) {
+    for (int64_t v = first; v <= last; ++v)
+        co_await q->push(v);
+    Latch_CountDown(done);
+}
+static CoTask<void>
+co_consumer (CoQueue<int64_t> * q, Totals * totals, Latch * done) {
+    int64_t sum = 0, popped = 0;
+    while (std::optional<int64_t> v = co_await q->pop()) {
+        sum += *v;
+        popped++;
+    }
+    mt_fetch_add(&totals->sum, sum);
+    mt_fetch_add(&totals->popped, popped);
+    Latch_CountDown(done);
+}
+
+/* Seconds from starting the consumers to the last one returning */
+static double
+run_coroutines (int n, Totals * totals, int * ok) {
+    ThreadPool pool;
+    Latch produced, consumed;
+    if (!ThreadPool_Init(&pool, WORKERS)) {
+        *ok = 0;
+        return 0;
+    }
+    double t;
+    {
+        CoQueue<int64_t> q(&pool, CAPACITY);
+        Latch_Init(&produced, PRODUCERS);
+        Latch_Init(&consumed, n);
+
+        int64_t t0 = mt_now_ns();
+        for (int i = 0; i < n; ++i)
+            Co_Spawn(&pool, co_consumer(&q, totals, &consumed));
+        for (int p = 0; p < PRODUCERS; ++p)
+            Co_Spawn(&pool, co_producer(&q, (int64_t)ITEMS / PRODUCERS * p + 1, (int64_t)ITEMS / PRODUCERS * (p + 1), &produced));
+        Latch_Wait(&produced, MT_INFINITE);
+        q.close();
+        Latch_Wait(&consumed, MT_INFINITE);
+        t = (double)(mt_now_ns() - t0) * 1e-9;
+        ThreadPool_Wait(&pool);     // the last resumptions may still be returning
+    }
+    ThreadPool_Deinit(&pool);
+    Latch_Deinit(&produced);
+    Latch_Deinit(&consumed);
+    return t;
+}
+
+/* The thread-per-consumer baseline */
+struct BlockingQueue {
+    MtLock      lock;
+    MtCond      not_empty;
+    MtCond      not_full;
+    int64_t     ring[CAPACITY];
+    int         head;
+    int         count;
+    int         closed;
+};
+struct ThreadArg {
+    BlockingQueue *     q;
+    Totals *            totals;
+    int64_t             first;
+    int64_t             last;
+};
+
+static void
+thread_producer (void * arg) {
+    ThreadArg * a = (ThreadArg *)arg;
+    BlockingQueue * q = a->q;
+    for (int64_t v = a->first; v <= a->last; ++v) {
+        mt_lock(&q->lock);
+        while (CAPACITY == q->count)
+            mt_cond_wait(&q->not_full, &q->lock);
+        q->ring[(q->head + q->count++) % CAPACITY] = v;
+        mt_cond_signal(&q->not_empty);
+        mt_unlock(&q->lock);
+    }
+}
+static void
+thread_consumer (void * arg) {
+    ThreadArg * a = (ThreadArg *)arg;
+    BlockingQueue * q = a->q;
+    int64_t sum = 0, popped = 0;
+    for (;;) {
+        mt_lock(&q->lock);
+        while (0 == q->count && !q->closed)
+            mt_cond_wait(&q->not_empty, &q->lock);
+        if (0 == q->count) {
+            mt_unlock(&q->lock);
+            break;
+        }
+        sum += q->ring[q->head];
+        q->head = (q->head + 1) % CAPACITY;
+        q->count--;
+        mt_cond_signal(&q->not_full);
+        mt_unlock(&q->lock);
+        popped++;
+    }
+    mt_fetch_add(&a->totals->sum, sum);
+    mt_fetch_add(&a->totals->popped, popped);
+}
+static double
+run_threads (int n, Totals * totals, int * ok) {
+    BlockingQueue * q = (BlockingQueue *)calloc(1, sizeof(BlockingQueue));
+    ThreadGroup consumers, producers;
+    ThreadArg consumer_arg = {q, totals, 0, 0}, producer_args[PRODUCERS];
+    mt_lock_init(&q->lock);
+    mt_cond_init(&q->not_empty);
+    mt_cond_init(&q->not_full);
+    ThreadGroup_Init(&consumers);
+    ThreadGroup_Init(&producers);
+
+    int64_t t0 = mt_now_ns();
+    for (int i = 0; i < n; ++i)
+        *ok &= ThreadGroup_Spawn(&consumers, thread_consumer, &consumer_arg);
+    for (int p = 0; p < PRODUCERS; ++p) {
+        producer_args[p] = {q, totals, (int64_t)ITEMS / PRODUCERS * p + 1, (int64_t)ITEMS / PRODUCERS * (p + 1)};
+        *ok &= ThreadGroup_Spawn(&producers, thread_producer, &producer_args[p]);
+    }
+    ThreadGroup_Join(&producers, MT_INFINITE);
+    mt_lock(&q->lock);
+    q->closed = 1;
+    mt_cond_broadcast(&q->not_empty);
+    mt_unlock(&q->lock);
+    ThreadGroup_Join(&consumers, MT_INFINITE);
+    double t = (double)(mt_now_ns() - t0) * 1e-9;
+
+    ThreadGroup_Deinit(&consumers);
+    ThreadGroup_Deinit(&producers);
+    mt_lock_deinit(&q->lock);
+    mt_cond_deinit(&q->not_empty);
+    mt_cond_deinit(&q->not_full);
+    free(q);
+    return t;
+}
+
+static void
+bench_consumers (void) {
+    int64_t const expected = (int64_t)ITEMS * (ITEMS + 1) / 2;
+    printf("\nconsumers: %d producers, %d items, capacity %d, %d pool workers (best of %d)\n",
+        PRODUCERS, ITEMS, CAPACITY, WORKERS, BENCH_REPS);
+    printf("%10s %-11s %10s %12s\n", "consumers", "mode", "ms", "M items/s");
+    for (size_t k = 0; k < _countof(g_consumers); ++k) {
+        for (int threads = 0; threads < 2; ++threads) {
+            double best = 1e30;
+            int ok = 1;
+            for (int rep = 0; rep < BENCH_REPS; ++rep) {
+                Totals totals;
+                double t = threads ? run_threads(g_consumers[k], &totals, &ok) : run_coroutines(g_consumers[k], &totals, &ok);
+                ok &= (totals.sum == expected && totals.popped == ITEMS);
+                if (t > 0 && t < best)
+                    best = t;
+            }
+            printf("%10d %-11s %10.1f %12.2f%s\n", g_consumers[k], threads ? "threads" : "coroutines",
+                best * 1e3, ITEMS / best * 1e-6, ok ? "" : "  (MISMATCH)");
+            fflush(stdout);
+        }
+    }
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region handshake
+struct Message {
+    char    str[64];
+};
+
+/* app02's server as a coroutine: one loop reversing strings, any number of awaiting clients */
+class ReverseServer {
+    struct Request {
+        Message *   msg;
+        CoEvent *   done;
+    };
+
+public:
+    explicit ReverseServer (ThreadPool * pool) : pool_(pool), requests_(pool, CAPACITY) {}
+
+    CoTask<void> serve () {
+        while (std::optional<Request> r = co_await requests_.pop()) {
+            char * s = r->msg->str;
+            for (size_t i = 0, j = strlen(s); i + 1 < j; ++i, --j) {
+                char c = s[i];
+                s[i] = s[j - 1];
+                s[j - 1] = c;
+            }
+            r->done->set();
+        }
+    }
+    /* co_await: msg reversed, or empty once the server has stopped */
+    CoTask<Message> request (Message msg) {
+        CoEvent done(pool_);
+        if (co_await requests_.push(Request{&msg, &done}))
+            co_await done;
+        else
+            msg.str[0] = 0;
+        co_return msg;
+    }
+    void stop () {
+        requests_.close();
+    }
+
+private:
+    ThreadPool *        pool_;
+    CoQueue<Request>    requests_;
+};
+
+static CoTask<void>
+co_client (ReverseServer * server, int id, int64_t volatile * errors, Latch * done) {
+    for (int i = 0; i < REQUESTS; ++i) {
+        Message msg, expected;
+        snprintf(msg.str, sizeof(msg.str), "client %d request %d", id, i);
+        Message reply = co_await server->request(msg);
+
+        size_t n = strlen(msg.str);
+        for (size_t k = 0; k < n; ++k)
+            expected.str[k] = msg.str[n - 1 - k];
+        expected.str[n] = 0;
+        if (strcmp(reply.str, expected.str) != 0)
+            mt_fetch_add(errors, 1);
+    }
+    Latch_CountDown(done);
+}
+
+static void
+bench_handshake (void) {
+    printf("\nhandshake: %d requests per client, one server, %d pool workers\n", REQUESTS, WORKERS);
+    printf("%10s %10s %14s\n", "clients", "ms", "ns/request");
+    for (size_t k = 0; k < _countof(g_consumers); ++k) {
+        int n = g_consumers[k];
+        int64_t volatile errors = 0;
+        ThreadPool pool;
+        Latch done;
+        if (!ThreadPool_Init(&pool, WORKERS))
+            return;
+        double t;
+        {
+            ReverseServer server(&pool);
+            Latch_Init(&done, n);
+            int64_t t0 = mt_now_ns();
+            Co_Spawn(&pool, server.serve());
+            for (int i = 0; i < n; ++i)
+                Co_Spawn(&pool, co_client(&server, i, &errors, &done));
+            Latch_Wait(&done, MT_INFINITE);
+            t = (double)(mt_now_ns() - t0) * 1e-9;
+            server.stop();
+            ThreadPool_Wait(&pool);
+        }
+        ThreadPool_Deinit(&pool);
+        Latch_Deinit(&done);
+        printf("%10d %10.1f %14.1f%s\n", n, t * 1e3, t * 1e9 / ((double)n * REQUESTS),
+            (0 == errors) ? "" : "  (MISMATCH)");
+        fflush(stdout);
+    }
+}
+#pragma endregion
+
+// =========================================================================================
+
+int main (int argc, char * argv []) {
+    if (BenchUtil_Wanted(argc, argv, "consumers"))
+        bench_consumers();
+    if (BenchUtil_Wanted(argc, argv, "handshake"))
+        bench_handshake();
+    return(0);
+}
@@ -0,0 +1,307 @@
+/* ===========================================================
+   #File: channel.c #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Bounded message channels, wait-free when single-producer/single-consumer #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L    /* clock_gettime, pthread_condattr_setclock */
+#endif
+
+#include "channel.h"
+#include "mt_platform.h"
+#include "../../misc/alloc/mem_alloc.h"
+
+#include <string.h>
+
+#define CHANNEL_SPINS       128         // failed tries before a waiter yields or sleeps
+
+/*
+Every group of fields lives on its own cache line: the receiver's, the
+sender's and the waiting. The ring itself is a separate allocation.
+*/
+struct ChannelState {
+    int                 flags;
+    size_t              msg_size;
+    size_t              stride;         // bytes per slot
+    int64_t             mask;           // capacity - 1
+    int64_t             batch;
+    char *              slots;
+
+    /* -- the receiver's: SPSC next to read and its copy of tail; MPMC dequeue position */
+    MT_ALIGNED(MT_CACHE_LINE) volatile int64_t  head;
+    int64_t                                     cached_tail;
+
+    /* -- the sender's: SPSC published end, next slot written and its copy of head; MPMC enqueue position */
+    MT_ALIGNED(MT_CACHE_LINE) volatile int64_t  tail;
+    int64_t                                     next;
+    int64_t                                     cached_head;
+
+    /* -- waiting: the counters are read after every transfer of a blocking channel */
+    MT_ALIGNED(MT_CACHE_LINE) volatile int64_t  recv_waiters;
+    volatile int64_t                            send_waiters;
+    volatile int64_t                            closed;
+    MtLock                                      lock;
+    MtCond                                      not_empty;
+    MtCond                                      not_full;
+};
+
+// =========================================================================================
+
+#pragma region waiting
+/* After a transfer: wake the other side if it sleeps. The fence pairs with the waiter's increment */
+static void
+wake (ChannelState * s, int64_t volatile * waiters, MtCond * cond) {
+    if (0 == (s->flags & CHANNEL_BLOCKING))
+        return;
+    mt_fence();
+    if (mt_load_relaxed(waiters) > 0) {
+        mt_lock(&s->lock);
+        mt_cond_broadcast(cond);
+        mt_unlock(&s->lock);
+    }
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region spsc
+static char *
+spsc_slot (ChannelState * s, int64_t i) {
+    return s->slots + (size_t)(i & s->mask) * s->stride;
+}
+static void
+spsc_publish (ChannelState * s) {
+    if (s->next != mt_load_relaxed(&s->tail)) {
+        mt_store_release(&s->tail, s->next);
+        wake(s, &s->recv_waiters, &s->not_empty);
+    }
+}
+static int
+spsc_send (ChannelState * s, void const * msg) {
+    int64_t next = s->next;
+    if (next - s->cached_head > s->mask) {
+        s->cached_head = mt_load_acquire(&s->head);
+        if (next - s->cached_head > s->mask) {
+            spsc_publish(s);    // the receiver cannot free a slot it does not see
+            return 0;
+        }
+    }
+    memcpy(spsc_slot(s, next), msg, s->msg_size);
+    s->next = next + 1;
+    if (s->next - mt_load_relaxed(&s->tail) >= s->batch)
+        spsc_publish(s);
+    return 1;
+}
+static int
+spsc_recv (ChannelState * s, void * msg_out) {
+    int64_t head = mt_load_relaxed(&s->head);
+    if (head == s->cached_tail) {
+        s->cached_tail = mt_load_acquire(&s->tail);
+        if (head == s->cached_tail)
+            return 0;
+    }
+    memcpy(msg_out, spsc_slot(s, head), s->msg_size);
+    mt_store_release(&s->head, head + 1);
+    wake(s, &s->send_waiters, &s->not_full);
+    return 1;
+}
+static int
+spsc_full (ChannelState * s) {
+    return s->next - mt_load_acquire(&s->head) > s->mask;
+}
+static int
+spsc_empty (ChannelState * s) {
+    return mt_load_relaxed(&s->head) == mt_load_acquire(&s->tail);
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region mpmc
+/*
+Vyukov's bounded MPMC queue: a slot's sequence number is its position when
+free for the sender of that position, position + 1 once filled, and
+position + capacity once read, free for the next lap.
+*/
+static int64_t volatile *
+mpmc_seq (ChannelState * s, int64_t pos) {
+    return (int64_t volatile *)(s->slots + (size_t)(pos & s->mask) * s->stride);
+}
+static int
+mpmc_send (ChannelState * s, void const * msg) {
+    int64_t pos = mt_load_relaxed(&s->tail);
+    for (;;) {
+        int64_t diff = mt_load_acquire(mpmc_seq(s, pos)) - pos;
+        if (0 == diff) {
+            if (mt_cas(&s->tail, pos, pos + 1))
+                break;
+            pos = mt_load_relaxed(&s->tail);
+        } else if (diff < 0) {
+            return 0;   // a lap behind: full
+        } else {
+            pos = mt_load_relaxed(&s->tail);
+        }
+    }
+    int64_t volatile * seq = mpmc_seq(s, pos);
+    memcpy((char *)seq + sizeof(int64_t), msg, s->msg_size);
+    mt_store_release(seq, pos + 1);
+    wake(s, &s->recv_waiters, &s->not_empty);
+    return 1;
+}
+static int
+mpmc_recv (ChannelState * s, void * msg_out) {
+    int64_t pos = mt_load_relaxed(&s->head);
+    for (;;) {
+        int64_t diff = mt_load_acquire(mpmc_seq(s, pos)) - (pos + 1);
+        if (0 == diff) {
+            if (mt_cas(&s->head, pos, pos + 1))
+                break;
+            pos = mt_load_relaxed(&s->head);
+        } else if (diff < 0) {
+            return 0;   // not filled yet: empty
+        } else {
+            pos = mt_load_relaxed(&s->head);
+        }
+    }
+    int64_t volatile * seq = mpmc_seq(s, pos);
+    memcpy(msg_out, (char const *)seq + sizeof(int64_t), s->msg_size);
+    mt_store_release(seq, pos + s->mask + 1);
+    wake(s, &s->send_waiters, &s->not_full);
+    return 1;
+}
+static int
+mpmc_full (ChannelState * s) {
+    int64_t pos = mt_load_acquire(&s->tail);
+    return mt_load_acquire(mpmc_seq(s, pos)) - pos < 0;
+}
+static int
+mpmc_empty (ChannelState * s) {
+    int64_t pos = mt_load_acquire(&s->head);
+    return mt_load_acquire(mpmc_seq(s, pos)) - (pos + 1) < 0;
+}
+#pragma endregion
+
+// =========================================================================================
+
+int
+Channel_Init (Channel * ch, size_t msg_size, size_t capacity, int flags, int batch) {
+    ChannelState * s;
+    int64_t cap = 2;
+    while ((size_t)cap < capacity)
+        cap *= 2;
+
+    ch->state = NULL;
+    s = (ChannelState *)Mem_AllocAligned(sizeof(ChannelState), MT_CACHE_LINE, MEM_ZERO);
+    if (NULL == s)
+        return 0;
+    s->flags = flags;
+    s->msg_size = msg_size;
+    s->mask = cap - 1;
+    s->batch = (batch > 1 && batch <= cap) ? batch : 1;
+    if (flags & CHANNEL_SPSC)
+        s->stride = msg_size;
+    else    // -- a sequence number ahead of every message, kept 8-byte aligned
+        s->stride = sizeof(int64_t) + ((msg_size + sizeof(int64_t) - 1) & ~(sizeof(int64_t) - 1));
+    s->slots = (char *)Mem_AllocAligned((size_t)cap * s->stride, MT_CACHE_LINE, 0);
+    if (NULL == s->slots) {
+        Mem_FreeAligned(s);
+        return 0;
+    }
+    if (0 == (flags & CHANNEL_SPSC))
+        for (int64_t i = 0; i < cap; i++)
+            *mpmc_seq(s, i) = i;
+    mt_lock_init(&s->lock);
+    mt_cond_init(&s->not_empty);
+    mt_cond_init(&s->not_full);
+    ch->state = s;
+    return 1;
+}
+void
+Channel_Deinit (Channel * ch) {
+    ChannelState * s = ch->state;
+    if (NULL == s)
+        return;
+    mt_lock_deinit(&s->lock);
+    mt_cond_deinit(&s->not_empty);
+    mt_cond_deinit(&s->not_full);
+    Mem_FreeAligned(s->slots);
+    Mem_FreeAligned(s);
+    ch->state = NULL;
+}
+int
+Channel_TrySend (Channel * ch, void const * msg) {
+    ChannelState * s = ch->state;
+    if (mt_load_relaxed(&s->closed))
+        return 0;
+    return (s->flags & CHANNEL_SPSC) ? spsc_send(s, msg) : mpmc_send(s, msg);
+}
+int
+Channel_TryRecv (Channel * ch, void * msg_out) {
+    ChannelState * s = ch->state;
+    return (s->flags & CHANNEL_SPSC) ? spsc_recv(s, msg_out) : mpmc_recv(s, msg_out);
+}
+int
+Channel_Send (Channel * ch, void const * msg) {
+    ChannelState * s = ch->state;
+    for (;;) {
+        for (int i = 0; i < CHANNEL_SPINS; i++) {
+            if (Channel_TrySend(ch, msg))
+                return 1;
+            if (mt_load_acquire(&s->closed))
+                return 0;
+            mt_pause();
+        }
+        if (0 == (s->flags & CHANNEL_BLOCKING)) {
+            mt_yield();
+            continue;
+        }
+        mt_lock(&s->lock);
+        mt_fetch_add(&s->send_waiters, 1);  // a full barrier: either we see the room or the receiver sees us
+        while (!s->closed && ((s->flags & CHANNEL_SPSC) ? spsc_full(s) : mpmc_full(s)))
+            mt_cond_wait(&s->not_full, &s->lock);
+        mt_fetch_add(&s->send_waiters, -1);
+        mt_unlock(&s->lock);
+    }
+}
+int
+Channel_Recv (Channel * ch, void * msg_out) {
+    ChannelState * s = ch->state;
+    for (;;) {
+        for (int i = 0; i < CHANNEL_SPINS; i++) {
+            if (Channel_TryRecv(ch, msg_out))
+                return 1;
+            if (mt_load_acquire(&s->closed))    // -- closed after the last send: one more look
+                return Channel_TryRecv(ch, msg_out);
+            mt_pause();
+        }
+        if (0 == (s->flags & CHANNEL_BLOCKING)) {
+            mt_yield();
+            continue;
+        }
+        mt_lock(&s->lock);
+        mt_fetch_add(&s->recv_waiters, 1);
+        while (!s->closed && ((s->flags & CHANNEL_SPSC) ? spsc_empty(s) : mpmc_empty(s)))
+            mt_cond_wait(&s->not_empty, &s->lock);
+        mt_fetch_add(&s->recv_waiters, -1);
+        mt_unlock(&s->lock);
+    }
+}
+void
+Channel_Flush (Channel * ch) {
+    if (ch->state->flags & CHANNEL_SPSC)
+        spsc_publish(ch->state);
+}
+void
+Channel_Close (Channel * ch) {
+    ChannelState * s = ch->state;
+    Channel_Flush(ch);
+    mt_lock(&s->lock);
+    mt_store_release(&s->closed, 1);
+    mt_cond_broadcast(&s->not_empty);
+    mt_cond_broadcast(&s->not_full);
+    mt_unlock(&s->lock);
+}
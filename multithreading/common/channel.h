@@ -0,0 +1,79 @@
+#pragma once
+
+/* ===========================================================
+   #File: channel.h #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Bounded message channels, wait-free when single-producer/single-consumer #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+A fixed-capacity ring of fixed-size messages, copied in and out.
+
+ - CHANNEL_SPSC declares one sending and one receiving thread (at a time).
+   The channel is then a wait-free ring: each side owns its index on its
+   own cache line and keeps a cached copy of the other's, re-read only when
+   the cached one says full or empty. Sends are published in batches of
+   `batch` messages; Channel_Flush publishes a partial batch.
+ - Without it the channel is a bounded MPMC ring (Vyukov's, a sequence
+   number per slot), lock-free, any number of senders and receivers.
+ - CHANNEL_BLOCKING lets Channel_Send and Channel_Recv wait on full and
+   empty: a short spin, then a condition variable. Either side only takes
+   the lock when the other one is actually asleep.
+
+Channel_TrySend and Channel_TryRecv never wait, in either mode.
+*/
+
+enum ChannelFlags {
+    CHANNEL_SPSC        = 0x1,
+    CHANNEL_BLOCKING    = 0x2,
+};
+
+typedef struct ChannelState ChannelState;
+typedef struct Channel {
+    ChannelState *  state;
+} Channel;
+
+/* capacity is rounded up to a power of 2; batch 0 or 1 publishes every send. False on failure */
+int
+Channel_Init (Channel * ch, size_t msg_size, size_t capacity, int flags, int batch);
+
+void
+Channel_Deinit (Channel * ch);
+
+/* False when full (or closed) */
+int
+Channel_TrySend (Channel * ch, void const * msg);
+
+/* False when empty */
+int
+Channel_TryRecv (Channel * ch, void * msg_out);
+
+/* Waits while full, asleep on a blocking channel, yielding otherwise; false once closed */
+int
+Channel_Send (Channel * ch, void const * msg);
+
+/* Waits while empty, like Channel_Send; false once closed and drained */
+int
+Channel_Recv (Channel * ch, void * msg_out);
+
+/* SPSC: publishes the sends of a partial batch; the sender calls it before it waits on anything else */
+void
+Channel_Flush (Channel * ch);
+
+/* Flushes, refuses further sends and wakes every waiter; from a sending thread */
+void
+Channel_Close (Channel * ch);
+
+#ifdef __cplusplus
+}
+#endif
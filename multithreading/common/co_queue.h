@@ -0,0 +1,371 @@
+#pragma once
+
+/* ===========================================================
+   #File: co_queue.h #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: C++20 awaitable queue, event and tasks, resumed on the thread pool #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "mt_platform.h"
+#include "thread_pool.h"
+
+/*
+Waiting without holding a thread: a coroutine that has to wait for a
+queue or an event is suspended and parked on it, and whoever makes it
+runnable again submits it to a ThreadPool. Thousands of logical
+consumers then wait on a handful of workers.
+
+ - CoTask<T>: a lazy coroutine. Awaiting it runs it and resumes the
+   awaiter when it co_returns; Co_Spawn starts one detached on a pool.
+ - CoQueue<T>: bounded FIFO; co_await q.push(v) waits while full,
+   co_await q.pop() while empty. A push with poppers parked hands the value
+   straight to the first of them; a pop frees room for the first parked
+   pusher. close() wakes everyone: push gives false, pop an empty optional
+   once drained.
+ - CoEvent: manual-reset; co_await ev waits until set().
+
+Waiters are parked in FIFO order under a lock; the lock is never held
+while a coroutine runs. T must be default constructible and movable.
+Exceptions escaping a coroutine terminate, as they would a thread.
+*/
+
+// =========================================================================================
+
+#pragma region scheduling
+inline void
+co_resume (void * address) {
+    std::coroutine_handle<>::from_address(address).resume();
+}
+/* Resumes h on one of the pool's workers, or right here when the pool is out of room */
+inline void
+Co_Schedule (ThreadPool * pool, std::coroutine_handle<> h) {
+    if (!ThreadPool_Submit(pool, co_resume, h.address()))
+        h.resume();
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region tasks
+template <class T> class CoTask;
+
+struct CoPromiseBase {
+    std::coroutine_handle<>     continuation;   // the awaiter, if any
+
+    struct FinalAwaiter {
+        bool await_ready () noexcept { return false; }
+        template <class P>
+        std::coroutine_handle<> await_suspend (std::coroutine_handle<P> h) noexcept {
+            std::coroutine_handle<> next = h.promise().continuation;
+            return next ? next : std::noop_coroutine();
+        }
+        void await_resume () noexcept {}
+    };
+    std::suspend_always initial_suspend () noexcept { return {}; }
+    FinalAwaiter final_suspend () noexcept { return {}; }
+    void unhandled_exception () noexcept { std::terminate(); }
+};
+
+template <class T>
+struct CoPromise : CoPromiseBase {
+    T       value{};
+    CoTask<T> get_return_object ();
+    void return_value (T v) { value = std::move(v); }
+};
+template <>
+struct CoPromise<void> : CoPromiseBase {
+    CoTask<void> get_return_object ();
+    void return_void () {}
+};
+
+template <class T = void>
+class CoTask {
+public:
+    using promise_type = CoPromise<T>;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    explicit CoTask (Handle h) : h_(h) {}
+    CoTask (CoTask && o) noexcept : h_(std::exchange(o.h_, {})) {}
+    CoTask (CoTask const &) = delete;
+    CoTask & operator= (CoTask const &) = delete;
+    ~CoTask () {
+        if (h_)
+            h_.destroy();
+    }
+
+    // -- co_await task: runs it, symmetric transfer both ways so deep chains do not grow the stack
+    bool await_ready () const noexcept { return false; }
+    std::coroutine_handle<> await_suspend (std::coroutine_handle<> awaiter) noexcept {
+        h_.promise().continuation = awaiter;
+        return h_;
+    }
+    T await_resume () {
+        if constexpr (!std::is_void_v<T>)
+            return std::move(h_.promise().value);
+    }
+
+private:
+    Handle      h_;
+};
+
+template <class T>
+inline CoTask<T> CoPromise<T>::get_return_object () {
+    return CoTask<T>(std::coroutine_handle<CoPromise<T>>::from_promise(*this));
+}
+inline CoTask<void> CoPromise<void>::get_return_object () {
+    return CoTask<void>(std::coroutine_handle<CoPromise<void>>::from_promise(*this));
+}
+
+/* A coroutine that frees itself when done, awaiting the spawned task */
+struct CoDetached {
+    struct promise_type {
+        CoDetached get_return_object () { return {std::coroutine_handle<promise_type>::from_promise(*this)}; }
+        std::suspend_always initial_suspend () noexcept { return {}; }
+        std::suspend_never final_suspend () noexcept { return {}; }
+        void return_void () {}
+        void unhandled_exception () noexcept { std::terminate(); }
+    };
+    std::coroutine_handle<promise_type>     h;
+};
+
+inline CoDetached
+co_detach (CoTask<void> task) {
+    co_await task;
+}
+/* Runs task on the pool; nothing waits for it, it frees itself */
+inline void
+Co_Spawn (ThreadPool * pool, CoTask<void> task) {
+    Co_Schedule(pool, co_detach(std::move(task)).h);
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region queue
+template <class T>
+class CoQueue {
+    struct Waiter {
+        Waiter *                next = nullptr;
+        std::coroutine_handle<> h;
+        std::optional<T>        value;      // pushed, or popped into
+        bool                    ok = false;
+    };
+    struct WaitList {
+        Waiter *    head = nullptr;
+        Waiter *    tail = nullptr;
+
+        void push (Waiter * w) {
+            w->next = nullptr;
+            (tail ? tail->next : head) = w;
+            tail = w;
+        }
+        Waiter * pop () {
+            Waiter * w = head;
+            if (w != nullptr && nullptr == (head = w->next))
+                tail = nullptr;
+            return w;
+        }
+    };
+
+public:
+    struct PushAwaiter : Waiter {
+        CoQueue *   q;
+        bool await_ready () const noexcept { return false; }
+        bool await_suspend (std::coroutine_handle<> h) { return q->push_or_park(this, h); }
+        bool await_resume () const noexcept { return this->ok; }
+    };
+    struct PopAwaiter : Waiter {
+        CoQueue *   q;
+        bool await_ready () const noexcept { return false; }
+        bool await_suspend (std::coroutine_handle<> h) { return q->pop_or_park(this, h); }
+        std::optional<T> await_resume () { return this->ok ? std::move(this->value) : std::nullopt; }
+    };
+
+    /* Parked coroutines are resumed on pool; capacity 0 hands each value from pusher to popper */
+    CoQueue (ThreadPool * pool, size_t capacity) : pool_(pool), ring_(capacity ? capacity : 1), capacity_(capacity) {
+        mt_lock_init(&lock_);
+    }
+    ~CoQueue () {
+        mt_lock_deinit(&lock_);
+    }
+    CoQueue (CoQueue const &) = delete;
+    CoQueue & operator= (CoQueue const &) = delete;
+
+    /* co_await: true once queued, false if the queue is closed */
+    PushAwaiter push (T v) {
+        PushAwaiter a;
+        a.value.emplace(std::move(v));
+        a.q = this;
+        return a;
+    }
+    /* co_await: the oldest value; empty once closed and drained */
+    PopAwaiter pop () {
+        PopAwaiter a;
+        a.q = this;
+        return a;
+    }
+    /* Refuses further pushes; parked pushers get false, parked poppers an empty optional */
+    void close () {
+        ThreadPool * pool = pool_;      // a resumed coroutine may free the queue
+        mt_lock(&lock_);
+        closed_ = true;
+        Waiter * w = pushers_.head;
+        pushers_ = {};
+        while (Waiter * p = poppers_.pop()) {
+            p->next = w;
+            w = p;
+        }
+        mt_unlock(&lock_);
+        while (w != nullptr) {
+            Waiter * next = w->next;    // w's frame may be gone once it is resumed
+            w->ok = false;
+            Co_Schedule(pool, w->h);
+            w = next;
+        }
+    }
+
+private:
+    /* True when h must suspend; it is resumed with w filled in */
+    bool push_or_park (Waiter * w, std::coroutine_handle<> h) {
+        ThreadPool * pool = pool_;
+        Waiter * wake = nullptr;
+        mt_lock(&lock_);
+        if (closed_) {
+            w->ok = false;
+        } else if ((wake = poppers_.pop()) != nullptr) {
+            // -- someone is waiting: queue is empty, hand the value over
+            wake->value = std::move(w->value);
+            wake->ok = true;
+            w->ok = true;
+        } else if (count_ < capacity_) {
+            ring_[(head_ + count_++) % capacity_] = std::move(*w->value);
+            w->ok = true;
+        } else {
+            w->h = h;
+            pushers_.push(w);
+            mt_unlock(&lock_);
+            return true;
+        }
+        mt_unlock(&lock_);
+        if (wake != nullptr)
+            Co_Schedule(pool, wake->h);
+        return false;
+    }
+    bool pop_or_park (Waiter * w, std::coroutine_handle<> h) {
+        ThreadPool * pool = pool_;
+        Waiter * wake = nullptr;
+        mt_lock(&lock_);
+        if (count_ > 0) {
+            w->value.emplace(std::move(ring_[head_]));
+            head_ = (head_ + 1) % capacity_;
+            count_--;
+            w->ok = true;
+            // -- room for the first parked pusher
+            if ((wake = pushers_.pop()) != nullptr) {
+                ring_[(head_ + count_++) % capacity_] = std::move(*wake->value);
+                wake->ok = true;
+            }
+        } else if ((wake = pushers_.pop()) != nullptr) {
+            w->value = std::move(wake->value);     // capacity 0: straight from the pusher
+            w->ok = true;
+            wake->ok = true;
+        } else if (closed_) {
+            w->ok = false;
+        } else {
+            w->h = h;
+            poppers_.push(w);
+            mt_unlock(&lock_);
+            return true;
+        }
+        mt_unlock(&lock_);
+        if (wake != nullptr)
+            Co_Schedule(pool, wake->h);
+        return false;
+    }
+
+    ThreadPool *        pool_;
+    MtLock              lock_;
+    std::vector<T>      ring_;
+    size_t              capacity_;
+    size_t              head_ = 0;
+    size_t              count_ = 0;
+    bool                closed_ = false;
+    WaitList            pushers_;   // parked while full
+    WaitList            poppers_;   // parked while empty
+};
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region event
+class CoEvent {
+    struct Waiter {
+        Waiter *                next;
+        std::coroutine_handle<> h;
+    };
+
+public:
+    struct Awaiter : Waiter {
+        CoEvent *   ev;
+        // -- always through the lock: once set, the waiter may free the event, which
+        // -- must not happen before set() has let go of it
+        bool await_ready () const noexcept { return false; }
+        bool await_suspend (std::coroutine_handle<> h) {
+            mt_lock(&ev->lock_);
+            bool park = !ev->set_;
+            if (park) {
+                this->h = h;
+                this->next = ev->waiters_;
+                ev->waiters_ = this;
+            }
+            mt_unlock(&ev->lock_);
+            return park;
+        }
+        void await_resume () const noexcept {}
+    };
+
+    explicit CoEvent (ThreadPool * pool) : pool_(pool) {
+        mt_lock_init(&lock_);
+    }
+    ~CoEvent () {
+        mt_lock_deinit(&lock_);
+    }
+    CoEvent (CoEvent const &) = delete;
+    CoEvent & operator= (CoEvent const &) = delete;
+
+    Awaiter operator co_await () {
+        Awaiter a;
+        a.ev = this;
+        return a;
+    }
+    /* Resumes every parked waiter; later awaits do not suspend */
+    void set () {
+        ThreadPool * pool = pool_;
+        mt_lock(&lock_);
+        set_ = true;
+        Waiter * w = std::exchange(waiters_, nullptr);
+        mt_unlock(&lock_);
+        while (w != nullptr) {
+            Waiter * next = w->next;
+            Co_Schedule(pool, w->h);
+            w = next;
+        }
+    }
+
+private:
+    ThreadPool *        pool_;
+    MtLock              lock_;
+    bool                set_ = false;
+    Waiter *            waiters_ = nullptr;
+};
+#pragma endregion
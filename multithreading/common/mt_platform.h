@@ -0,0 +1,246 @@
+#pragma once
+
+/* ===========================================================
+   #File: mt_platform.h #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Atomics, locks, condition variables and threads for the shared modules #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+/*
+The few primitives the modules under multithreading/common need, on
+Win32 (Interlocked*, SRWLOCK, CONDITION_VARIABLE, _beginthreadex) and on
+POSIX (GCC __atomic builtins, pthreads). Everything is static inline.
+
+Atomics work on int64_t and void * and name their ordering; mt_fence is
+a full (sequentially consistent) barrier.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <process.h>    /* _beginthreadex */
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+#define MT_THREAD_LOCAL __declspec(thread)
+#define MT_INLINE       static __inline
+#define MT_ALIGNED(n)   __declspec(align(n))
+#else
+#define MT_THREAD_LOCAL _Thread_local
+#define MT_INLINE       static inline
+#define MT_ALIGNED(n)   __attribute__((aligned(n)))
+#endif
+
+#define MT_CACHE_LINE   64
+#define MT_INFINITE     (-1)    /* timeout in ms for waits that never expire */
+
+// =========================================================================================
+
+#pragma region atomics
+#ifdef _WIN32
+MT_INLINE int64_t mt_load_relaxed (int64_t const volatile * p)     { return ReadNoFence64((LONG64 const volatile *)p); }
+MT_INLINE int64_t mt_load_acquire (int64_t const volatile * p)     { return ReadAcquire64((LONG64 const volatile *)p); }
+MT_INLINE void    mt_store_relaxed (int64_t volatile * p, int64_t v) { WriteNoFence64((LONG64 volatile *)p, v); }
+MT_INLINE void    mt_store_release (int64_t volatile * p, int64_t v) { WriteRelease64((LONG64 volatile *)p, v); }
+MT_INLINE int64_t mt_fetch_add (int64_t volatile * p, int64_t v)   { return InterlockedExchangeAdd64((LONG64 volatile *)p, v); }
+MT_INLINE int     mt_cas (int64_t volatile * p, int64_t expected, int64_t desired) {
+    return InterlockedCompareExchange64((LONG64 volatile *)p, desired, expected) == expected;
+}
+MT_INLINE void *  mt_load_ptr_acquire (void * const volatile * p)  { return ReadPointerAcquire((PVOID const volatile *)p); }
+MT_INLINE void    mt_store_ptr_relaxed (void * volatile * p, void * v) { WritePointerNoFence((PVOID volatile *)p, v); }
+MT_INLINE void    mt_store_ptr_release (void * volatile * p, void * v) { WritePointerRelease((PVOID volatile *)p, v); }
+MT_INLINE void *  mt_load_ptr_relaxed (void * const volatile * p)  { return ReadPointerNoFence((PVOID const volatile *)p); }
+MT_INLINE void    mt_fence (void)                                  { MemoryBarrier(); }
+MT_INLINE void    mt_pause (void)                                  { YieldProcessor(); }
+#else
+MT_INLINE int64_t mt_load_relaxed (int64_t const volatile * p)     { return __atomic_load_n(p, __ATOMIC_RELAXED); }
+MT_INLINE int64_t mt_load_acquire (int64_t const volatile * p)     { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+MT_INLINE void    mt_store_relaxed (int64_t volatile * p, int64_t v) { __atomic_store_n(p, v, __ATOMIC_RELAXED); }
+MT_INLINE void    mt_store_release (int64_t volatile * p, int64_t v) { __atomic_store_n(p, v, __ATOMIC_RELEASE); }
+MT_INLINE int64_t mt_fetch_add (int64_t volatile * p, int64_t v)   { return __atomic_fetch_add(p, v, __ATOMIC_SEQ_CST); }
+MT_INLINE int     mt_cas (int64_t volatile * p, int64_t expected, int64_t desired) {
+    return __atomic_compare_exchange_n(p, &expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+}
+MT_INLINE void *  mt_load_ptr_acquire (void * const volatile * p)  { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+MT_INLINE void    mt_store_ptr_relaxed (void * volatile * p, void * v) { __atomic_store_n(p, v, __ATOMIC_RELAXED); }
+MT_INLINE void    mt_store_ptr_release (void * volatile * p, void * v) { __atomic_store_n(p, v, __ATOMIC_RELEASE); }
+MT_INLINE void *  mt_load_ptr_relaxed (void * const volatile * p)  { return __atomic_load_n(p, __ATOMIC_RELAXED); }
+MT_INLINE void    mt_fence (void)                                  { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+#if defined(__x86_64__) || defined(__i386__)
+MT_INLINE void    mt_pause (void)                                  { __builtin_ia32_pause(); }
+#else
+MT_INLINE void    mt_pause (void)                                  { }
+#endif
+#endif
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region locks
+#ifdef _WIN32
+typedef SRWLOCK             MtLock;
+typedef CONDITION_VARIABLE  MtCond;
+
+MT_INLINE void mt_lock_init (MtLock * l)        { InitializeSRWLock(l); }
+MT_INLINE void mt_lock_deinit (MtLock * l)      { (void)l; }
+MT_INLINE void mt_lock (MtLock * l)             { AcquireSRWLockExclusive(l); }
+MT_INLINE void mt_unlock (MtLock * l)           { ReleaseSRWLockExclusive(l); }
+MT_INLINE int  mt_trylock (MtLock * l)          { return TryAcquireSRWLockExclusive(l) != 0; }
+MT_INLINE void mt_cond_init (MtCond * c)        { InitializeConditionVariable(c); }
+MT_INLINE void mt_cond_deinit (MtCond * c)      { (void)c; }
+MT_INLINE void mt_cond_wait (MtCond * c, MtLock * l) { SleepConditionVariableSRW(c, l, INFINITE, 0); }
+/* False on timeout; spurious wakeups return true, callers recheck their predicate */
+MT_INLINE int  mt_cond_wait_ms (MtCond * c, MtLock * l, int64_t ms) {
+    return SleepConditionVariableSRW(c, l, (ms < 0) ? INFINITE : (DWORD)ms, 0);
+}
+MT_INLINE void mt_cond_signal (MtCond * c)      { WakeConditionVariable(c); }
+MT_INLINE void mt_cond_broadcast (MtCond * c)   { WakeAllConditionVariable(c); }
+#else
+typedef pthread_mutex_t     MtLock;
+typedef pthread_cond_t      MtCond;
+
+MT_INLINE void mt_lock_init (MtLock * l)        { pthread_mutex_init(l, NULL); }
+MT_INLINE void mt_lock_deinit (MtLock * l)      { pthread_mutex_destroy(l); }
+MT_INLINE void mt_lock (MtLock * l)             { pthread_mutex_lock(l); }
+MT_INLINE void mt_unlock (MtLock * l)           { pthread_mutex_unlock(l); }
+MT_INLINE int  mt_trylock (MtLock * l)          { return 0 == pthread_mutex_trylock(l); }
+MT_INLINE void mt_cond_init (MtCond * c) {
+    pthread_condattr_t attr;    // timed waits on the monotonic clock, like mt_now_ns
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(c, &attr);
+    pthread_condattr_destroy(&attr);
+}
+MT_INLINE void mt_cond_deinit (MtCond * c)      { pthread_cond_destroy(c); }
+MT_INLINE void mt_cond_wait (MtCond * c, MtLock * l) { pthread_cond_wait(c, l); }
+MT_INLINE int  mt_cond_wait_ms (MtCond * c, MtLock * l, int64_t ms) {
+    struct timespec ts;
+    if (ms < 0)
+        return 0 == pthread_cond_wait(c, l);
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_sec += (time_t)(ms / 1000);
+    ts.tv_nsec += (long)(ms % 1000) * 1000000;
+    if (ts.tv_nsec >= 1000000000) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
+    }
+    return 0 == pthread_cond_timedwait(c, l, &ts);
+}
+MT_INLINE void mt_cond_signal (MtCond * c)      { pthread_cond_signal(c); }
+MT_INLINE void mt_cond_broadcast (MtCond * c)   { pthread_cond_broadcast(c); }
+#endif
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region threads
+typedef void (*MtThreadFn) (void * arg);
+
+#ifdef _WIN32
+typedef HANDLE MtThread;
+typedef struct MtThreadStart {
+    MtThreadFn  fn;
+    void *      arg;
+} MtThreadStart;
+
+MT_INLINE unsigned WINAPI
+mt_thread_start (void * p) {
+    MtThreadStart s = *(MtThreadStart *)p;
+    HeapFree(GetProcessHeap(), 0, p);
+    s.fn(s.arg);
+    return(0);
+}
+MT_INLINE int
+mt_thread_create (MtThread * t, MtThreadFn fn, void * arg) {
+    MtThreadStart * s = (MtThreadStart *)HeapAlloc(GetProcessHeap(), 0, sizeof(MtThreadStart));
+    if (NULL == s)
+        return 0;
+    s->fn = fn;
+    s->arg = arg;
+    *t = (HANDLE)_beginthreadex(NULL, 0, mt_thread_start, s, 0, NULL);
+    if (NULL == *t)
+        HeapFree(GetProcessHeap(), 0, s);
+    return *t != NULL;
+}
+MT_INLINE void
+mt_thread_join (MtThread t) {
+    WaitForSingleObject(t, INFINITE);
+    CloseHandle(t);
+}
+MT_INLINE int
+mt_cpu_count (void) {
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return (int)si.dwNumberOfProcessors;
+}
+MT_INLINE void
+mt_yield (void) {
+    SwitchToThread();
+}
+/* Monotonic nanoseconds */
+MT_INLINE int64_t
+mt_now_ns (void) {
+    LARGE_INTEGER freq, t;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&t);
+    return (t.QuadPart / freq.QuadPart) * 1000000000 + (t.QuadPart % freq.QuadPart) * 1000000000 / freq.QuadPart;
+}
+#else
+typedef pthread_t MtThread;
+typedef struct MtThreadStart {
+    MtThreadFn  fn;
+    void *      arg;
+} MtThreadStart;
+
+MT_INLINE void *
+mt_thread_start (void * p) {
+    MtThreadStart s = *(MtThreadStart *)p;
+    free(p);
+    s.fn(s.arg);
+    return NULL;
+}
+MT_INLINE int
+mt_thread_create (MtThread * t, MtThreadFn fn, void * arg) {
+    MtThreadStart * s = (MtThreadStart *)malloc(sizeof(MtThreadStart));
+    if (NULL == s)
+        return 0;
+    s->fn = fn;
+    s->arg = arg;
+    if (pthread_create(t, NULL, mt_thread_start, s) != 0) {
+        free(s);
+        return 0;
+    }
+    return 1;
+}
+MT_INLINE void
+mt_thread_join (MtThread t) {
+    pthread_join(t, NULL);
+}
+MT_INLINE int
+mt_cpu_count (void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return (n > 0) ? (int)n : 1;
+}
+MT_INLINE void
+mt_yield (void) {
+    sched_yield();
+}
+MT_INLINE int64_t
+mt_now_ns (void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+#endif
+#pragma endregion
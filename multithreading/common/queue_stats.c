@@ -0,0 +1,248 @@
+/* ===========================================================
+   #File: queue_stats.c #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Queue telemetry: sharded counters, depth and latency histograms, dumps #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L    /* clock_gettime */
+#endif
+
+#include "queue_stats.h"
+
+#include <string.h>
+
+#define SUB_COUNT       (1 << QUEUE_STATS_SUB_BITS)
+
+static char const * const g_stat_names[QSTAT_COUNT] = {
+    "enqueue", "dequeue", "full", "empty", "timeout", "lock_acquire", "lock_contended", "lock_wait_ns"
+};
+
+/* Threads take shards round-robin, in the order they first count something */
+static int64_t volatile g_next_slot;
+static MT_THREAD_LOCAL int tls_slot = -1;
+
+// =========================================================================================
+
+#pragma region buckets
+static int
+msb (uint64_t v) {
+    int n = 0;
+    while (v >>= 1)
+        n++;
+    return n;
+}
+static int
+bucket_of (int64_t value) {
+    if (value < SUB_COUNT)
+        return (value < 0) ? 0 : (int)value;
+    // -- the top QUEUE_STATS_SUB_BITS + 1 bits pick the bucket: its power of 2, then 16 steps within it
+    int shift = msb((uint64_t)value) - QUEUE_STATS_SUB_BITS;
+    int idx = (shift + 1) * SUB_COUNT + (int)((value >> shift) - SUB_COUNT);
+    return (idx < QUEUE_STATS_BUCKETS) ? idx : QUEUE_STATS_BUCKETS - 1;
+}
+/* The smallest value in the bucket */
+static int64_t
+bucket_low (int idx) {
+    if (idx < SUB_COUNT)
+        return idx;
+    int shift = idx / SUB_COUNT - 1;
+    return (int64_t)(SUB_COUNT + idx % SUB_COUNT) << shift;
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region counting
+static QueueStatsShard *
+my_shard (QueueStats * s) {
+    if (tls_slot < 0)
+        tls_slot = (int)(mt_fetch_add(&g_next_slot, 1) % QUEUE_STATS_SHARDS);
+    return &s->shards[tls_slot];
+}
+
+void
+QueueStats_Init (QueueStats * s, char const * name) {
+    memset(s, 0, sizeof(*s));
+    s->name = name;
+    s->start_ns = mt_now_ns();
+}
+void
+QueueStats_Add (QueueStats * s, QueueStat stat, int64_t n) {
+    mt_fetch_add(&my_shard(s)->counters[stat], n);
+}
+void
+QueueStats_Enqueue (QueueStats * s, int64_t depth) {
+    QueueStatsShard * sh = my_shard(s);
+    mt_fetch_add(&sh->counters[QSTAT_ENQUEUE], 1);
+    mt_fetch_add(&sh->depth[bucket_of(depth)], 1);
+}
+void
+QueueStats_Dequeue (QueueStats * s, int64_t enqueued_ns) {
+    QueueStatsShard * sh = my_shard(s);
+    mt_fetch_add(&sh->counters[QSTAT_DEQUEUE], 1);
+    if (enqueued_ns != 0)
+        mt_fetch_add(&sh->latency[bucket_of(mt_now_ns() - enqueued_ns)], 1);
+}
+void
+QueueStats_LockAcquired (QueueStats * s, int64_t wait_ns) {
+    QueueStatsShard * sh = my_shard(s);
+    mt_fetch_add(&sh->counters[QSTAT_LOCK_ACQUIRE], 1);
+    if (wait_ns > 0) {
+        mt_fetch_add(&sh->counters[QSTAT_LOCK_CONTENDED], 1);
+        mt_fetch_add(&sh->counters[QSTAT_LOCK_WAIT_NS], wait_ns);
+    }
+}
+void
+QueueStats_Lock (QueueStats * s, MtLock * l) {
+    if (NULL == s) {
+        mt_lock(l);
+    } else if (mt_trylock(l)) {
+        QueueStats_LockAcquired(s, 0);
+    } else {
+        // -- the clock is read only on the slow path
+        int64_t t = mt_now_ns();
+        mt_lock(l);
+        int64_t wait = mt_now_ns() - t;
+        QueueStats_LockAcquired(s, (wait > 0) ? wait : 1);
+    }
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region snapshots
+void
+QueueStats_Snapshot (QueueStats * s, QueueStatsSnapshot * snap) {
+    memset(snap, 0, sizeof(*snap));
+    snap->name = s->name;
+    snap->elapsed_ns = mt_now_ns() - s->start_ns;
+    // -- no lock: every sum is exact for its own moment, and the moments are close
+    for (int k = 0; k < QUEUE_STATS_SHARDS; ++k) {
+        QueueStatsShard * sh = &s->shards[k];
+        for (int i = 0; i < QSTAT_COUNT; ++i)
+            snap->counters[i] += mt_load_relaxed(&sh->counters[i]);
+        for (int i = 0; i < QUEUE_STATS_BUCKETS; ++i) {
+            snap->depth[i] += mt_load_relaxed(&sh->depth[i]);
+            snap->latency[i] += mt_load_relaxed(&sh->latency[i]);
+        }
+    }
+}
+int64_t
+QueueStats_Percentile (int64_t const * hist, double p) {
+    int64_t total = 0, seen = 0;
+    for (int i = 0; i < QUEUE_STATS_BUCKETS; ++i)
+        total += hist[i];
+    if (0 == total)
+        return 0;
+    int64_t rank = (int64_t)(p * (double)total + 0.5);
+    if (rank < 1)
+        rank = 1;
+    for (int i = 0; i < QUEUE_STATS_BUCKETS; ++i) {
+        seen += hist[i];
+        if (seen >= rank)
+            return bucket_low(i);
+    }
+    return bucket_low(QUEUE_STATS_BUCKETS - 1);
+}
+static int64_t
+hist_max (int64_t const * hist) {
+    for (int i = QUEUE_STATS_BUCKETS - 1; i >= 0; --i)
+        if (hist[i] != 0)
+            return bucket_low(i);
+    return 0;
+}
+
+void
+QueueStats_Print (QueueStatsSnapshot const * snap, FILE * out) {
+    int64_t const * c = snap->counters;
+    double seconds = (double)snap->elapsed_ns * 1e-9;
+    fprintf(out, "%s after %.1f s:\n", snap->name ? snap->name : "queue", seconds);
+    fprintf(out, "  enqueue %lld, dequeue %lld (%.0f/s), full %lld, empty %lld, timeout %lld\n",
+        (long long)c[QSTAT_ENQUEUE], (long long)c[QSTAT_DEQUEUE], seconds > 0 ? (double)c[QSTAT_DEQUEUE] / seconds : 0.0,
+        (long long)c[QSTAT_FULL], (long long)c[QSTAT_EMPTY], (long long)c[QSTAT_TIMEOUT]);
+    fprintf(out, "  lock: %lld acquired, %lld contended (%.1f%%), %.3f ms waited, %.0f ns a wait\n",
+        (long long)c[QSTAT_LOCK_ACQUIRE], (long long)c[QSTAT_LOCK_CONTENDED],
+        c[QSTAT_LOCK_ACQUIRE] ? 100.0 * (double)c[QSTAT_LOCK_CONTENDED] / (double)c[QSTAT_LOCK_ACQUIRE] : 0.0,
+        (double)c[QSTAT_LOCK_WAIT_NS] * 1e-6,
+        c[QSTAT_LOCK_CONTENDED] ? (double)c[QSTAT_LOCK_WAIT_NS] / (double)c[QSTAT_LOCK_CONTENDED] : 0.0);
+    fprintf(out, "  depth:   p50 %lld, p90 %lld, p99 %lld, max %lld\n",
+        (long long)QueueStats_Percentile(snap->depth, 0.50), (long long)QueueStats_Percentile(snap->depth, 0.90),
+        (long long)QueueStats_Percentile(snap->depth, 0.99), (long long)hist_max(snap->depth));
+    fprintf(out, "  latency: p50 %.1f us, p90 %.1f us, p99 %.1f us, p99.9 %.1f us, max %.1f us\n",
+        (double)QueueStats_Percentile(snap->latency, 0.50) * 1e-3, (double)QueueStats_Percentile(snap->latency, 0.90) * 1e-3,
+        (double)QueueStats_Percentile(snap->latency, 0.99) * 1e-3, (double)QueueStats_Percentile(snap->latency, 0.999) * 1e-3,
+        (double)hist_max(snap->latency) * 1e-3);
+}
+
+/* {"p50": .., ..., "buckets": [[low, count], ...]}, non-empty buckets only */
+static void
+write_hist (int64_t const * hist, FILE * out) {
+    fprintf(out, "{\"p50\": %lld, \"p90\": %lld, \"p99\": %lld, \"p999\": %lld, \"max\": %lld, \"buckets\": [",
+        (long long)QueueStats_Percentile(hist, 0.50), (long long)QueueStats_Percentile(hist, 0.90),
+        (long long)QueueStats_Percentile(hist, 0.99), (long long)QueueStats_Percentile(hist, 0.999),
+        (long long)hist_max(hist));
+    char const * sep = "";
+    for (int i = 0; i < QUEUE_STATS_BUCKETS; ++i)
+        if (hist[i] != 0) {
+            fprintf(out, "%s[%lld, %lld]", sep, (long long)bucket_low(i), (long long)hist[i]);
+            sep = ", ";
+        }
+    fprintf(out, "]}");
+}
+void
+QueueStats_WriteJson (QueueStatsSnapshot const * snap, FILE * out) {
+    // -- names are the program's own literals: nothing to escape
+    fprintf(out, "{\"name\": \"%s\", \"elapsed_ms\": %.3f, \"counters\": {",
+        snap->name ? snap->name : "queue", (double)snap->elapsed_ns * 1e-6);
+    for (int i = 0; i < QSTAT_COUNT; ++i)
+        fprintf(out, "%s\"%s\": %lld", i ? ", " : "", g_stat_names[i], (long long)snap->counters[i]);
+    fprintf(out, "}, \"depth\": ");
+    write_hist(snap->depth, out);
+    fprintf(out, ", \"latency_ns\": ");
+    write_hist(snap->latency, out);
+    fprintf(out, "}\n");
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region dumps
+static void
+dump (QueueStatsDump * d) {
+    // -- ~10 KB: too much for some callers' stacks
+    static MT_THREAD_LOCAL QueueStatsSnapshot snap;
+    QueueStats_Snapshot(d->stats, &snap);
+    if (d->json)
+        QueueStats_WriteJson(&snap, d->out);
+    else
+        QueueStats_Print(&snap, d->out);
+    fflush(d->out);
+}
+static void
+on_dump (void * arg) {
+    QueueStatsDump * d = (QueueStatsDump *)arg;
+    dump(d);
+    TimerWheel_Arm(d->wheel, &d->timer, d->period_ms);
+}
+
+void
+QueueStatsDump_Start (QueueStatsDump * d, QueueStats * stats, TimerWheel * wheel, int64_t period_ms, FILE * out, int json) {
+    d->wheel = wheel;
+    d->stats = stats;
+    d->out = out;
+    d->json = json;
+    d->period_ms = period_ms;
+    Timer_Init(&d->timer, on_dump, d);
+    TimerWheel_Arm(wheel, &d->timer, period_ms);
+}
+void
+QueueStatsDump_Stop (QueueStatsDump * d) {
+    // -- waits out a dump in progress, then disarms what it re-armed
+    TimerWheel_Cancel(d->wheel, &d->timer);
+    dump(d);
+}
+#pragma endregion
@@ -0,0 +1,140 @@
+#pragma once
+
+/* ===========================================================
+   #File: queue_stats.h #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Queue telemetry: sharded counters, depth and latency histograms, dumps #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#include <stdio.h>
+
+#include "mt_platform.h"
+#include "timer_wheel.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+Counters and histograms a queue updates on its hot path, cheap enough to
+leave on in production:
+
+ - Every thread is given one of QUEUE_STATS_SHARDS shards, each on its own
+   cache lines, and only adds to its shard (an uncontended atomic add).
+   Readers sum the shards into a snapshot; nothing is reset.
+ - Histograms are log-linear, like HDR histograms: exact below 16, then
+   16 buckets per power of 2 (about 6% wide), up to 2^41. Queue depth is
+   sampled on every enqueue, latency (enqueue to dequeue, ns) on every
+   dequeue that carries an enqueue stamp.
+ - Lock waits: QueueStats_Lock tries the lock first and only reads the
+   clock when it has to wait; other locks report through
+   QueueStats_LockAcquired.
+
+A QueueStatsDump writes a snapshot every period from a TimerWheel, as
+text or as one JSON object per line.
+*/
+
+#define QUEUE_STATS_SHARDS      16
+#define QUEUE_STATS_SUB_BITS    4
+#define QUEUE_STATS_BUCKETS     608     // (41 - QUEUE_STATS_SUB_BITS) * 16 + 16
+
+typedef enum QueueStat {
+    QSTAT_ENQUEUE,
+    QSTAT_DEQUEUE,
+    QSTAT_FULL,             // an enqueue found the queue full
+    QSTAT_EMPTY,            // a dequeue found it empty (and waited, or gave up)
+    QSTAT_TIMEOUT,          // a wait ran out
+    QSTAT_LOCK_ACQUIRE,
+    QSTAT_LOCK_CONTENDED,   // acquisitions that had to wait
+    QSTAT_LOCK_WAIT_NS,     // total time they waited
+
+    QSTAT_COUNT
+} QueueStat;
+
+typedef struct QueueStatsShard {
+    MT_ALIGNED(MT_CACHE_LINE) int64_t   counters[QSTAT_COUNT];
+    int64_t     depth[QUEUE_STATS_BUCKETS];
+    int64_t     latency[QUEUE_STATS_BUCKETS];
+} QueueStatsShard;
+
+typedef struct QueueStats {
+    char const *        name;
+    int64_t             start_ns;
+    QueueStatsShard     shards[QUEUE_STATS_SHARDS];
+} QueueStats;
+
+typedef struct QueueStatsSnapshot {
+    char const *    name;
+    int64_t         elapsed_ns;     // since Init
+    int64_t         counters[QSTAT_COUNT];
+    int64_t         depth[QUEUE_STATS_BUCKETS];
+    int64_t         latency[QUEUE_STATS_BUCKETS];
+} QueueStatsSnapshot;
+
+/* name is kept, not copied */
+void
+QueueStats_Init (QueueStats * s, char const * name);
+
+void
+QueueStats_Add (QueueStats * s, QueueStat stat, int64_t n);
+
+/* Counts an enqueue; depth is the queue's length after it */
+void
+QueueStats_Enqueue (QueueStats * s, int64_t depth);
+
+/* Counts a dequeue; enqueued_ns is the element's QueueStats_Now() stamp, 0 if it has none */
+void
+QueueStats_Dequeue (QueueStats * s, int64_t enqueued_ns);
+
+/* wait_ns 0: got the lock without waiting */
+void
+QueueStats_LockAcquired (QueueStats * s, int64_t wait_ns);
+
+/* mt_lock, counted; s may be NULL */
+void
+QueueStats_Lock (QueueStats * s, MtLock * l);
+
+MT_INLINE int64_t
+QueueStats_Now (void) {
+    return mt_now_ns();
+}
+
+void
+QueueStats_Snapshot (QueueStats * s, QueueStatsSnapshot * snap);
+
+/* The value below which a fraction p (0..1) of the histogram's samples are; 0 if it is empty */
+int64_t
+QueueStats_Percentile (int64_t const * hist, double p);
+
+void
+QueueStats_Print (QueueStatsSnapshot const * snap, FILE * out);
+
+/* One line: {"name": ..., "counters": {...}, "depth": {...}, "latency_ns": {...}} */
+void
+QueueStats_WriteJson (QueueStatsSnapshot const * snap, FILE * out);
+
+// =========================================================================================
+
+typedef struct QueueStatsDump {
+    Timer           timer;
+    TimerWheel *    wheel;
+    QueueStats *    stats;
+    FILE *          out;
+    int             json;
+    int64_t         period_ms;
+} QueueStatsDump;
+
+/* Writes a snapshot of stats to out every period_ms, from the wheel's thread */
+void
+QueueStatsDump_Start (QueueStatsDump * d, QueueStats * stats, TimerWheel * wheel, int64_t period_ms, FILE * out, int json);
+
+/* Stops the dumps and writes a last one */
+void
+QueueStatsDump_Stop (QueueStatsDump * d);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,130 @@
+/* ===========================================================
+   #File: sharded_queue.c #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Bounded queue sharded per NUMA node or core group #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L    /* clock_gettime, pthread_condattr_setclock */
+#endif
+
+#include "sharded_queue.h"
+#include "queue_stats.h"
+
+#include <string.h>
+
+/* Header on its own lines, the ring right after it, all in one node-local block */
+struct Shard {
+    MT_ALIGNED(MT_CACHE_LINE) MtLock    lock;
+    int64_t             head;
+    int64_t volatile    count;          // written under lock, peeked without
+    int64_t             pushed;
+    int64_t             popped_local;
+    int64_t             stolen;
+    MT_ALIGNED(MT_CACHE_LINE) char      msgs[1];
+};
+
+// =========================================================================================
+
+int
+ShardedQueue_Init (ShardedQueue * q, Topology const * topo, size_t msg_size, int capacity_per_shard) {
+    memset(q, 0, sizeof(*q));
+    q->topo = topo;
+    q->msg_size = msg_size;
+    q->capacity = capacity_per_shard;
+    q->n_shards = topo->n_domains;
+    q->shard_bytes = offsetof(Shard, msgs) + msg_size * (size_t)capacity_per_shard;
+
+    for (int i = 0; i < q->n_shards; ++i) {
+        q->shards[i] = (Shard *)Topology_AllocOnDomain(topo, i, q->shard_bytes);
+        if (NULL == q->shards[i]) {
+            ShardedQueue_Deinit(q);
+            return 0;
+        }
+        // -- zeroed pages: touching the header here places at least it on the node
+        mt_lock_init(&q->shards[i]->lock);
+    }
+    return 1;
+}
+void
+ShardedQueue_Deinit (ShardedQueue * q) {
+    for (int i = 0; i < q->n_shards; ++i)
+        if (q->shards[i] != NULL) {
+            mt_lock_deinit(&q->shards[i]->lock);
+            Topology_Free(q->shards[i], q->shard_bytes);
+        }
+    memset(q, 0, sizeof(*q));
+}
+int
+ShardedQueue_Push (ShardedQueue * q, int domain, void const * msg) {
+    Shard * s = q->shards[domain];
+    int ret = 0;
+    QueueStats_Lock(q->stats, &s->lock);
+    if (s->count < q->capacity) {
+        int64_t tail = (s->head + s->count) % q->capacity;
+        memcpy(s->msgs + (size_t)tail * q->msg_size, msg, q->msg_size);
+        mt_store_relaxed(&s->count, s->count + 1);
+        s->pushed++;
+        ret = 1;
+    }
+    mt_unlock(&s->lock);
+    return ret;
+}
+/* False when the shard turned out empty */
+static int
+take (ShardedQueue * q, Shard * s, void * msg_out, int local) {
+    int ret = 0;
+    QueueStats_Lock(q->stats, &s->lock);
+    if (s->count > 0) {
+        memcpy(msg_out, s->msgs + (size_t)s->head * q->msg_size, q->msg_size);
+        s->head = (s->head + 1) % q->capacity;
+        mt_store_relaxed(&s->count, s->count - 1);
+        if (local)
+            s->popped_local++;
+        else
+            s->stolen++;
+        ret = 1;
+    }
+    mt_unlock(&s->lock);
+    return ret;
+}
+int
+ShardedQueue_Pop (ShardedQueue * q, int domain, void * msg_out, int * from_out) {
+    for (int k = 0; k < q->n_shards; ++k) {
+        int i = (domain + k) % q->n_shards;
+        Shard * s = q->shards[i];
+        // -- shards are only locked when they look non-empty
+        if (0 == mt_load_relaxed(&s->count))
+            continue;
+        if (take(q, s, msg_out, 0 == k)) {
+            if (from_out != NULL)
+                *from_out = i;
+            return 1;
+        }
+    }
+    return 0;
+}
+int
+ShardedQueue_PopLocal (ShardedQueue * q, int domain, void * msg_out) {
+    Shard * s = q->shards[domain];
+    return mt_load_relaxed(&s->count) > 0 && take(q, s, msg_out, 1);
+}
+int64_t
+ShardedQueue_Count (ShardedQueue const * q) {
+    int64_t n = 0;
+    for (int i = 0; i < q->n_shards; ++i)
+        n += mt_load_relaxed(&q->shards[i]->count);
+    return n;
+}
+void
+ShardedQueue_GetStats (ShardedQueue const * q, int shard, ShardStats * stats) {
+    Shard * s = q->shards[shard];
+    mt_lock(&s->lock);
+    stats->pushed = s->pushed;
+    stats->popped_local = s->popped_local;
+    stats->stolen = s->stolen;
+    mt_unlock(&s->lock);
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+/* ===========================================================
+   #File: sharded_queue.h #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Bounded queue sharded per NUMA node or core group #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#include "mt_platform.h"
+#include "topology.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+One FIFO ring of fixed-size messages per topology domain, instead of one
+queue whose lock and indices every socket pulls across the interconnect.
+
+ - A shard (its lock, indices and messages) is allocated on its domain's
+   node and first touched there; its header has cache lines of its own.
+ - Producers push to their own domain's shard.
+ - Consumers pop their own shard first and steal from the others only when
+   it is empty, nearest-numbered first; PopLocal leaves stealing to the
+   caller, e.g. after some idle polls. A shard's count is read without
+   its lock before stealing, so idle consumers do not drag the lines of
+   empty remote shards around.
+
+Order is FIFO within a shard only. The caller supplies its domain; a
+thread pinned with Topology_PinToDomain knows it.
+*/
+
+typedef struct Shard Shard;
+struct QueueStats;
+
+typedef struct ShardedQueue {
+    Topology const *    topo;
+    size_t              msg_size;
+    int                 capacity;       // per shard
+    int                 n_shards;
+    Shard *             shards[TOPOLOGY_MAX_DOMAINS];
+    size_t              shard_bytes;
+    struct QueueStats * stats;          // shard lock waits are counted into it when set
+} ShardedQueue;
+
+typedef struct ShardStats {
+    int64_t     pushed;
+    int64_t     popped_local;   // by consumers of its own domain
+    int64_t     stolen;         // by consumers of other domains
+} ShardStats;
+
+/* A shard per domain of topo, which must outlive the queue; false on failure */
+int
+ShardedQueue_Init (ShardedQueue * q, Topology const * topo, size_t msg_size, int capacity_per_shard);
+
+void
+ShardedQueue_Deinit (ShardedQueue * q);
+
+/* Onto the domain's own shard; false when that shard is full */
+int
+ShardedQueue_Push (ShardedQueue * q, int domain, void const * msg);
+
+/* Own shard first, then the others; false when all are empty. from_out (may be NULL) gets the shard */
+int
+ShardedQueue_Pop (ShardedQueue * q, int domain, void * msg_out, int * from_out);
+
+/* Own shard only: consumers that steal only once they have been idle a while call this first */
+int
+ShardedQueue_PopLocal (ShardedQueue * q, int domain, void * msg_out);
+
+/* Messages in all shards, a snapshot */
+int64_t
+ShardedQueue_Count (ShardedQueue const * q);
+
+void
+ShardedQueue_GetStats (ShardedQueue const * q, int shard, ShardStats * stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,202 @@
+/* ===========================================================
+   #File: thread_group.c #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Thread groups with a latch join and cancellation tokens #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L    /* clock_gettime, pthread_condattr_setclock */
+#endif
+
+#include "thread_group.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define GROUP_INITIAL   16      // handle slots before the first growth
+
+// =========================================================================================
+
+#pragma region latch
+void
+Latch_Init (Latch * l, int64_t count) {
+    mt_lock_init(&l->lock);
+    mt_cond_init(&l->zero);
+    l->count = count;
+}
+void
+Latch_Deinit (Latch * l) {
+    mt_lock_deinit(&l->lock);
+    mt_cond_deinit(&l->zero);
+}
+void
+Latch_Add (Latch * l, int64_t n) {
+    mt_lock(&l->lock);
+    l->count += n;
+    mt_unlock(&l->lock);
+}
+void
+Latch_CountDown (Latch * l) {
+    mt_lock(&l->lock);
+    if (0 == --l->count)
+        mt_cond_broadcast(&l->zero);
+    mt_unlock(&l->lock);
+}
+int
+Latch_Wait (Latch * l, int64_t timeout_ms) {
+    int64_t deadline = mt_now_ns() + timeout_ms * 1000000;
+    mt_lock(&l->lock);
+    while (l->count > 0) {
+        int64_t left_ms = (deadline - mt_now_ns() + 999999) / 1000000;
+        if (timeout_ms != MT_INFINITE && left_ms <= 0)
+            break;
+        mt_cond_wait_ms(&l->zero, &l->lock, (timeout_ms == MT_INFINITE) ? MT_INFINITE : left_ms);
+    }
+    int ret = (l->count <= 0);
+    mt_unlock(&l->lock);
+    return ret;
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region cancellation
+int
+CancelToken_Init (CancelToken * t) {
+    t->requested = 0;
+#ifdef _WIN32
+    t->event = CreateEvent(NULL, TRUE, FALSE, NULL);
+    return t->event != NULL;
+#else
+    mt_lock_init(&t->lock);
+    mt_cond_init(&t->cancelled);
+    return 1;
+#endif
+}
+void
+CancelToken_Deinit (CancelToken * t) {
+#ifdef _WIN32
+    CloseHandle(t->event);
+#else
+    mt_lock_deinit(&t->lock);
+    mt_cond_deinit(&t->cancelled);
+#endif
+}
+void
+CancelToken_Cancel (CancelToken * t) {
+#ifdef _WIN32
+    mt_store_release(&t->requested, 1);
+    SetEvent(t->event);
+#else
+    // -- set under the lock: a sleeper between its check and its wait cannot miss it
+    mt_lock(&t->lock);
+    mt_store_release(&t->requested, 1);
+    mt_cond_broadcast(&t->cancelled);
+    mt_unlock(&t->lock);
+#endif
+}
+int
+CancelToken_Sleep (CancelToken * t, int64_t ms) {
+#ifdef _WIN32
+    return WAIT_TIMEOUT == WaitForSingleObject(t->event, (ms < 0) ? INFINITE : (DWORD)ms);
+#else
+    int64_t deadline = mt_now_ns() + ms * 1000000;
+    mt_lock(&t->lock);
+    while (!t->requested) {
+        int64_t left_ms = (deadline - mt_now_ns() + 999999) / 1000000;
+        if (ms != MT_INFINITE && left_ms <= 0)
+            break;
+        mt_cond_wait_ms(&t->cancelled, &t->lock, (ms == MT_INFINITE) ? MT_INFINITE : left_ms);
+    }
+    int ret = !t->requested;
+    mt_unlock(&t->lock);
+    return ret;
+#endif
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region group
+typedef struct GroupStart {
+    ThreadGroup *   group;
+    GroupThreadFn   fn;
+    void *          arg;
+} GroupStart;
+
+static void
+member_main (void * p) {
+    GroupStart s = *(GroupStart *)p;
+    free(p);
+    s.fn(s.arg);
+    Latch_CountDown(&s.group->running);
+}
+
+int
+ThreadGroup_Init (ThreadGroup * g) {
+    memset(g, 0, sizeof(*g));
+    if (!CancelToken_Init(&g->cancel))
+        return 0;
+    Latch_Init(&g->running, 0);
+    mt_lock_init(&g->lock);
+    return 1;
+}
+void
+ThreadGroup_Deinit (ThreadGroup * g) {
+    ThreadGroup_Cancel(g);
+    ThreadGroup_Join(g, MT_INFINITE);
+    free(g->threads);
+    mt_lock_deinit(&g->lock);
+    Latch_Deinit(&g->running);
+    CancelToken_Deinit(&g->cancel);
+}
+int
+ThreadGroup_Spawn (ThreadGroup * g, GroupThreadFn fn, void * arg) {
+    int ret = 0;
+    GroupStart * s = NULL;
+    mt_lock(&g->lock);
+    if (g->count == g->capacity) {
+        int capacity = g->capacity ? 2 * g->capacity : GROUP_INITIAL;
+        MtThread * threads = (MtThread *)realloc(g->threads, (size_t)capacity * sizeof(MtThread));
+        if (NULL == threads)
+            goto done;
+        g->threads = threads;
+        g->capacity = capacity;
+    }
+    s = (GroupStart *)malloc(sizeof(GroupStart));
+    if (NULL == s)
+        goto done;
+    s->group = g;
+    s->fn = fn;
+    s->arg = arg;
+
+    // -- counted before it starts, so a join right after Spawn waits for it
+    Latch_Add(&g->running, 1);
+    if (mt_thread_create(&g->threads[g->count], member_main, s)) {
+        g->count++;
+        ret = 1;
+    } else {
+        Latch_CountDown(&g->running);
+        free(s);
+    }
+done:
+    mt_unlock(&g->lock);
+    return ret;
+}
+int
+ThreadGroup_Join (ThreadGroup * g, int64_t timeout_ms) {
+    if (!Latch_Wait(&g->running, timeout_ms))
+        return 0;
+
+    // -- every member has returned from its function: these joins are only the thread exits
+    mt_lock(&g->lock);
+    for (int i = 0; i < g->count; ++i)
+        mt_thread_join(g->threads[i]);
+    g->count = 0;
+    mt_unlock(&g->lock);
+    return 1;
+}
+#pragma endregion
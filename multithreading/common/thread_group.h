@@ -0,0 +1,130 @@
+#pragma once
+
+/* ===========================================================
+   #File: thread_group.h #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Thread groups with a latch join and cancellation tokens #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#include "mt_platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ - Latch: a countdown; waiters wake when it reaches zero. One wait covers
+   any number of counted parties, unlike WaitForMultipleObjects and its
+   MAXIMUM_WAIT_OBJECTS (64) handles.
+ - CancelToken: a one-way flag. CancelToken_Sleep returns early when the
+   token is cancelled, so workers that pace themselves with sleeps notice a
+   shutdown at once instead of after their sleep. On Win32 the token also
+   has a manual-reset event to add to WaitForMultipleObjects calls.
+ - ThreadGroup: any number of threads counted by a latch and sharing a
+   token. Join is one latch wait, then every handle is released.
+
+Timeouts are in milliseconds, MT_INFINITE waits forever.
+*/
+
+typedef struct Latch {
+    MtLock      lock;
+    MtCond      zero;
+    int64_t     count;      // under lock
+} Latch;
+
+void
+Latch_Init (Latch * l, int64_t count);
+
+void
+Latch_Deinit (Latch * l);
+
+/* Raises the count, for parties that join after Init */
+void
+Latch_Add (Latch * l, int64_t n);
+
+void
+Latch_CountDown (Latch * l);
+
+/* True once the count is zero, false on timeout */
+int
+Latch_Wait (Latch * l, int64_t timeout_ms);
+
+// =========================================================================================
+
+typedef struct CancelToken {
+    int64_t volatile    requested;
+#ifdef _WIN32
+    HANDLE              event;      // manual-reset, set on cancel
+#else
+    MtLock              lock;
+    MtCond              cancelled;
+#endif
+} CancelToken;
+
+/* False when the event cannot be created */
+int
+CancelToken_Init (CancelToken * t);
+
+void
+CancelToken_Deinit (CancelToken * t);
+
+/* Wakes every CancelToken_Sleep and every wait on the event; idempotent */
+void
+CancelToken_Cancel (CancelToken * t);
+
+MT_INLINE int
+CancelToken_IsCancelled (CancelToken * t) {
+    return 0 != mt_load_acquire(&t->requested);
+}
+
+/* True after sleeping the whole time, false as soon as the token is cancelled */
+int
+CancelToken_Sleep (CancelToken * t, int64_t ms);
+
+#ifdef _WIN32
+/* Signaled once cancelled; owned by the token */
+MT_INLINE HANDLE
+CancelToken_Event (CancelToken * t) {
+    return t->event;
+}
+#endif
+
+// =========================================================================================
+
+typedef void (*GroupThreadFn) (void * arg);
+
+typedef struct ThreadGroup {
+    CancelToken     cancel;     // shared by the members
+    Latch           running;    // members that have not returned yet
+    MtLock          lock;       // guards the handles
+    MtThread *      threads;
+    int             count;
+    int             capacity;
+} ThreadGroup;
+
+int
+ThreadGroup_Init (ThreadGroup * g);
+
+/* Cancels, joins whatever is left and frees the group */
+void
+ThreadGroup_Deinit (ThreadGroup * g);
+
+/* Starts a member running fn(arg); false when the thread cannot be created */
+int
+ThreadGroup_Spawn (ThreadGroup * g, GroupThreadFn fn, void * arg);
+
+MT_INLINE void
+ThreadGroup_Cancel (ThreadGroup * g) {
+    CancelToken_Cancel(&g->cancel);
+}
+
+/* Waits for every member to return, then releases their handles; false on timeout */
+int
+ThreadGroup_Join (ThreadGroup * g, int64_t timeout_ms);
+
+#ifdef __cplusplus
+}
+#endif
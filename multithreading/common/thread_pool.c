@@ -0,0 +1,469 @@
+/* ===========================================================
+   #File: thread_pool.c #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Work-stealing thread pool #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L    /* clock_gettime, pthread_condattr_setclock */
+#endif
+
+#include "thread_pool.h"
+#include "mt_platform.h"
+#include "../../misc/alloc/mem_alloc.h"
+
+#include <string.h>
+
+#define MAX_PENDING         (1 << 22)   // task records the pool reserves room for
+#define DEQUE_INITIAL       256         // slots, a power of 2
+#define INJECT_INITIAL      256
+#define IDLE_SPINS          64          // empty scans before a worker parks
+
+typedef struct Task {
+    PoolTaskFn  fn;
+    void *      arg;
+} Task;
+
+// =========================================================================================
+
+#pragma region deque
+/*
+Chase-Lev deque, in the C11 formulation of Le, Pop, Cohen and Zappa Nardelli
+(PPoPP 2013). The owner pushes and takes at the bottom, thieves steal at the
+top; only the last element is contended, settled by a CAS on top. A full
+array is replaced by one twice the size; the old ones stay alive until the
+pool goes, since a thief may still be reading them.
+*/
+typedef struct DequeArray {
+    int64_t                 size;           // a power of 2
+    struct DequeArray *     retired;        // the array this one replaced
+    void * volatile         slots[1];
+} DequeArray;
+
+typedef struct Deque {
+    volatile int64_t        top;
+    char                    pad0[MT_CACHE_LINE - sizeof(int64_t)];
+    volatile int64_t        bottom;
+    DequeArray * volatile   array;
+    char                    pad1[MT_CACHE_LINE - sizeof(int64_t) - sizeof(void *)];
+} Deque;
+
+#define STEAL_EMPTY     ((Task *)0)
+#define STEAL_ABORT     ((Task *)1)         // lost a race: worth another try
+
+static DequeArray *
+deque_array_new (int64_t size) {
+    DequeArray * a = (DequeArray *)Mem_AllocAligned(sizeof(DequeArray) + (size_t)(size - 1) * sizeof(void *), MT_CACHE_LINE, 0);
+    if (a != NULL) {
+        a->size = size;
+        a->retired = NULL;
+    }
+    return a;
+}
+static int
+deque_init (Deque * d) {
+    memset(d, 0, sizeof(*d));
+    d->array = deque_array_new(DEQUE_INITIAL);
+    return d->array != NULL;
+}
+static void
+deque_deinit (Deque * d) {
+    DequeArray * a = d->array;
+    while (a != NULL) {
+        DequeArray * next = a->retired;
+        Mem_FreeAligned(a);
+        a = next;
+    }
+}
+static int
+deque_push (Deque * d, Task * t) {
+    int64_t b = mt_load_relaxed(&d->bottom);
+    int64_t top = mt_load_acquire(&d->top);
+    DequeArray * a = (DequeArray *)mt_load_ptr_relaxed((void * const volatile *)&d->array);
+    if (b - top > a->size - 1) {
+        DequeArray * bigger = deque_array_new(a->size * 2);
+        if (NULL == bigger)
+            return 0;
+        for (int64_t i = top; i < b; i++)
+            bigger->slots[i & (bigger->size - 1)] = a->slots[i & (a->size - 1)];
+        bigger->retired = a;
+        mt_store_ptr_release((void * volatile *)&d->array, bigger);
+        a = bigger;
+    }
+    mt_store_ptr_relaxed(&a->slots[b & (a->size - 1)], t);
+    mt_store_release(&d->bottom, b + 1);
+    return 1;
+}
+static Task *
+deque_take (Deque * d) {
+    int64_t b = mt_load_relaxed(&d->bottom) - 1;
+    DequeArray * a = (DequeArray *)mt_load_ptr_relaxed((void * const volatile *)&d->array);
+    mt_store_relaxed(&d->bottom, b);
+    mt_fence();
+    int64_t t = mt_load_relaxed(&d->top);
+    Task * task = NULL;
+
+    if (t <= b) {
+        task = (Task *)mt_load_ptr_relaxed(&a->slots[b & (a->size - 1)]);
+        if (t == b) {
+            /* -- the last one: race the thieves for it */
+            if (!mt_cas(&d->top, t, t + 1))
+                task = NULL;
+            mt_store_relaxed(&d->bottom, b + 1);
+        }
+    } else {
+        mt_store_relaxed(&d->bottom, b + 1);
+    }
+    return task;
+}
+static Task *
+deque_steal (Deque * d) {
+    int64_t t = mt_load_acquire(&d->top);
+    mt_fence();
+    int64_t b = mt_load_acquire(&d->bottom);
+    if (t >= b)
+        return STEAL_EMPTY;
+    DequeArray * a = (DequeArray *)mt_load_ptr_acquire((void * const volatile *)&d->array);
+    Task * task = (Task *)mt_load_ptr_relaxed(&a->slots[t & (a->size - 1)]);
+    if (!mt_cas(&d->top, t, t + 1))
+        return STEAL_ABORT;
+    return task;
+}
+static int
+deque_looks_empty (Deque * d) {
+    return mt_load_acquire(&d->bottom) - mt_load_acquire(&d->top) <= 0;
+}
+#pragma endregion
+
+// =========================================================================================
+
+typedef struct Worker {
+    Deque               deque;
+    PoolState *         pool;
+    int                 index;
+    uint32_t            rng;            // victim selection
+    MtThread            thread;
+    volatile int64_t    executed;
+    volatile int64_t    stolen;
+    volatile int64_t    parks;
+    char                pad[MT_CACHE_LINE];
+} Worker;
+
+struct PoolState {
+    Worker *            workers;
+    int                 n_workers;
+    MemPool             tasks;
+
+    /* -- submissions from outside the pool: a ring under a lock */
+    MtLock              inject_lock;
+    Task **             inject;
+    size_t              inject_cap;     // a power of 2
+    size_t              inject_head;
+    volatile int64_t    inject_count;   // also read without the lock, as a hint
+    int64_t             injected;       // under inject_lock
+
+    /* -- parking: sleepers is read by every submit, epoch only under park_lock */
+    char                pad0[MT_CACHE_LINE];
+    volatile int64_t    sleepers;
+    char                pad1[MT_CACHE_LINE];
+    MtLock              park_lock;
+    MtCond              park_cond;
+    int64_t             epoch;
+    volatile int64_t    shutdown;
+
+    /* -- completion, for Wait and Deinit */
+    char                pad2[MT_CACHE_LINE];
+    volatile int64_t    pending;
+    MtLock              done_lock;
+    MtCond              done_cond;
+};
+
+static MT_THREAD_LOCAL Worker * t_worker;
+
+// =========================================================================================
+
+#pragma region inject
+static int
+inject_push (PoolState * p, Task * t) {
+    mt_lock(&p->inject_lock);
+    size_t count = (size_t)p->inject_count;
+    if (count == p->inject_cap) {
+        size_t cap = p->inject_cap * 2;
+        Task ** ring = (Task **)Mem_AllocAligned(cap * sizeof(Task *), MT_CACHE_LINE, 0);
+        if (NULL == ring) {
+            mt_unlock(&p->inject_lock);
+            return 0;
+        }
+        for (size_t i = 0; i < count; i++)
+            ring[i] = p->inject[(p->inject_head + i) & (p->inject_cap - 1)];
+        Mem_FreeAligned(p->inject);
+        p->inject = ring;
+        p->inject_cap = cap;
+        p->inject_head = 0;
+    }
+    p->inject[(p->inject_head + count) & (p->inject_cap - 1)] = t;
+    mt_store_release(&p->inject_count, (int64_t)count + 1);
+    p->injected++;
+    mt_unlock(&p->inject_lock);
+    return 1;
+}
+static Task *
+inject_pop (PoolState * p) {
+    Task * t = NULL;
+    if (mt_load_relaxed(&p->inject_count) == 0)
+        return NULL;
+    mt_lock(&p->inject_lock);
+    if (p->inject_count > 0) {
+        t = p->inject[p->inject_head];
+        p->inject_head = (p->inject_head + 1) & (p->inject_cap - 1);
+        mt_store_release(&p->inject_count, p->inject_count - 1);
+    }
+    mt_unlock(&p->inject_lock);
+    return t;
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region workers
+static int
+has_work (PoolState * p) {
+    if (mt_load_acquire(&p->inject_count) > 0)
+        return 1;
+    for (int i = 0; i < p->n_workers; i++)
+        if (!deque_looks_empty(&p->workers[i].deque))
+            return 1;
+    return 0;
+}
+/* After publishing work: wake one parked worker, if there is one */
+static void
+wake_one (PoolState * p) {
+    /* -- pairs with the fence in park: either we see the sleeper, or it sees the work */
+    mt_fence();
+    if (mt_load_relaxed(&p->sleepers) > 0) {
+        mt_lock(&p->park_lock);
+        p->epoch++;
+        mt_cond_signal(&p->park_cond);
+        mt_unlock(&p->park_lock);
+    }
+}
+static void
+park (Worker * w) {
+    PoolState * p = w->pool;
+    int64_t epoch;
+
+    mt_lock(&p->park_lock);
+    epoch = p->epoch;
+    mt_unlock(&p->park_lock);
+    mt_fetch_add(&p->sleepers, 1);  // a full barrier, as mt_fence
+    if (!has_work(p) && !mt_load_acquire(&p->shutdown)) {
+        mt_lock(&p->park_lock);
+        while (p->epoch == epoch && !mt_load_acquire(&p->shutdown))
+            mt_cond_wait(&p->park_cond, &p->park_lock);
+        mt_unlock(&p->park_lock);
+        w->parks++;
+    }
+    mt_fetch_add(&p->sleepers, -1);
+}
+static Task *
+steal_any (Worker * w, int * contended) {
+    PoolState * p = w->pool;
+    int n = p->n_workers;
+    /* -- xorshift32: a different first victim each time, so thieves spread out */
+    w->rng ^= w->rng << 13;
+    w->rng ^= w->rng >> 17;
+    w->rng ^= w->rng << 5;
+    int start = (int)(w->rng % (uint32_t)n);
+    for (int k = 0; k < n; k++) {
+        int v = (start + k) % n;
+        if (v == w->index)
+            continue;
+        Task * t = deque_steal(&p->workers[v].deque);
+        if (STEAL_ABORT == t)
+            *contended = 1;
+        else if (t != STEAL_EMPTY)
+            return t;
+    }
+    return NULL;
+}
+static void
+run_task (Worker * w, Task * t) {
+    PoolState * p = w->pool;
+    Task task = *t;
+    MemPool_Free(&p->tasks, t);
+    task.fn(task.arg);
+    w->executed++;
+    if (mt_fetch_add(&p->pending, -1) == 1) {
+        mt_lock(&p->done_lock);
+        mt_cond_broadcast(&p->done_cond);
+        mt_unlock(&p->done_lock);
+    }
+}
+static void
+worker_main (void * arg) {
+    Worker * w = (Worker *)arg;
+    PoolState * p = w->pool;
+    int idle = 0;
+    t_worker = w;
+
+    for (;;) {
+        int contended = 0;
+        Task * t = deque_take(&w->deque);
+        if (NULL == t)
+            t = inject_pop(p);
+        if (NULL == t && (t = steal_any(w, &contended)) != NULL)
+            w->stolen++;
+        if (t != NULL) {
+            run_task(w, t);
+            idle = 0;
+            continue;
+        }
+        if (contended || ++idle < IDLE_SPINS) {
+            mt_pause();
+            continue;
+        }
+        if (mt_load_acquire(&p->shutdown) && !has_work(p))
+            break;
+        park(w);
+        idle = 0;
+    }
+    MemPool_FlushThread(&p->tasks);
+    t_worker = NULL;
+}
+#pragma endregion
+
+// =========================================================================================
+
+/* Wakes every worker to find the shutdown flag, and joins the first n */
+static void
+stop_workers (PoolState * p, int n) {
+    mt_store_release(&p->shutdown, 1);
+    mt_lock(&p->park_lock);
+    p->epoch++;
+    mt_cond_broadcast(&p->park_cond);
+    mt_unlock(&p->park_lock);
+    for (int i = 0; i < n; i++)
+        mt_thread_join(p->workers[i].thread);
+}
+/* Frees the state; the first n_deques workers have a deque */
+static void
+free_state (PoolState * p, int n_deques) {
+    for (int i = 0; i < n_deques; i++)
+        deque_deinit(&p->workers[i].deque);
+    MemPool_Deinit(&p->tasks);
+    mt_lock_deinit(&p->inject_lock);
+    mt_lock_deinit(&p->park_lock);
+    mt_cond_deinit(&p->park_cond);
+    mt_lock_deinit(&p->done_lock);
+    mt_cond_deinit(&p->done_cond);
+    Mem_FreeAligned(p->inject);
+    Mem_FreeAligned(p->workers);
+    Mem_FreeAligned(p);
+}
+
+int
+ThreadPool_Init (ThreadPool * pool, int n_workers) {
+    PoolState * p;
+    memset(pool, 0, sizeof(*pool));
+    if (n_workers <= 0)
+        n_workers = mt_cpu_count();
+
+    p = (PoolState *)Mem_AllocAligned(sizeof(PoolState), MT_CACHE_LINE, MEM_ZERO);
+    if (NULL == p)
+        return 0;
+    p->n_workers = n_workers;
+    p->workers = (Worker *)Mem_AllocAligned(sizeof(Worker) * (size_t)n_workers, MT_CACHE_LINE, MEM_ZERO);
+    p->inject_cap = INJECT_INITIAL;
+    p->inject = (Task **)Mem_AllocAligned(p->inject_cap * sizeof(Task *), MT_CACHE_LINE, 0);
+    if (NULL == p->workers || NULL == p->inject || !MemPool_Init(&p->tasks, sizeof(Task), 0, MAX_PENDING)) {
+        Mem_FreeAligned(p->inject);
+        Mem_FreeAligned(p->workers);
+        Mem_FreeAligned(p);
+        return 0;
+    }
+    mt_lock_init(&p->inject_lock);
+    mt_lock_init(&p->park_lock);
+    mt_cond_init(&p->park_cond);
+    mt_lock_init(&p->done_lock);
+    mt_cond_init(&p->done_cond);
+
+    for (int i = 0; i < n_workers; i++) {
+        Worker * w = &p->workers[i];
+        w->pool = p;
+        w->index = i;
+        w->rng = 0x9E3779B9u * (uint32_t)(i + 1);
+        if (!deque_init(&w->deque)) {
+            free_state(p, i);
+            return 0;
+        }
+    }
+    /* -- start the threads only once every deque exists: they steal from all */
+    for (int i = 0; i < n_workers; i++) {
+        if (!mt_thread_create(&p->workers[i].thread, worker_main, &p->workers[i])) {
+            stop_workers(p, i);
+            free_state(p, n_workers);
+            return 0;
+        }
+    }
+    pool->state = p;
+    pool->n_workers = n_workers;
+    return 1;
+}
+void
+ThreadPool_Deinit (ThreadPool * pool) {
+    PoolState * p = pool->state;
+    if (NULL == p)
+        return;
+    ThreadPool_Wait(pool);
+    stop_workers(p, p->n_workers);
+    free_state(p, p->n_workers);
+    pool->state = NULL;
+}
+int
+ThreadPool_Submit (ThreadPool * pool, PoolTaskFn fn, void * arg) {
+    PoolState * p = pool->state;
+    Task * t = (Task *)MemPool_Alloc(&p->tasks);
+    if (NULL == t)
+        return 0;
+    t->fn = fn;
+    t->arg = arg;
+    mt_fetch_add(&p->pending, 1);
+
+    Worker * w = t_worker;
+    int ok = (w != NULL && w->pool == p) ? deque_push(&w->deque, t) : 0;
+    if (!ok)
+        ok = inject_push(p, t);
+    if (!ok) {
+        MemPool_Free(&p->tasks, t);
+        mt_fetch_add(&p->pending, -1);
+        return 0;
+    }
+    wake_one(p);
+    return 1;
+}
+void
+ThreadPool_Wait (ThreadPool * pool) {
+    PoolState * p = pool->state;
+    mt_lock(&p->done_lock);
+    while (mt_load_acquire(&p->pending) != 0)
+        mt_cond_wait(&p->done_cond, &p->done_lock);
+    mt_unlock(&p->done_lock);
+}
+int
+ThreadPool_WorkerIndex (void) {
+    return (t_worker != NULL) ? t_worker->index : -1;
+}
+void
+ThreadPool_GetStats (ThreadPool const * pool, PoolStats * stats) {
+    PoolState const * p = pool->state;
+    memset(stats, 0, sizeof(*stats));
+    for (int i = 0; i < p->n_workers; i++) {
+        stats->executed += p->workers[i].executed;
+        stats->stolen += p->workers[i].stolen;
+        stats->parks += p->workers[i].parks;
+    }
+    stats->injected = p->injected;
+}
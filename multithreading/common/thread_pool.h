@@ -0,0 +1,76 @@
+#pragma once
+
+/* ===========================================================
+   #File: thread_pool.h #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Work-stealing thread pool #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+A fixed set of workers, one per core by default, runs submitted tasks.
+
+ - Every worker owns a Chase-Lev deque. A task submitted from inside a task
+   goes to the bottom of the running worker's deque, which the worker pops
+   LIFO (hot in cache); idle workers steal FIFO from the top of others'.
+ - Tasks submitted from other threads (the UI thread, a server loop) go
+   through a shared injection queue under a lock.
+ - A worker that finds nothing anywhere spins briefly, then parks on a
+   condition variable; submitters only touch the parking lock when some
+   worker is actually parked.
+ - Task records come from a MemPool, so submitting does not hit the heap.
+
+Tasks should not block for long: a parked task holds its worker. Long
+waits belong on dedicated threads or in timers that submit the follow-up.
+*/
+
+typedef void (*PoolTaskFn) (void * arg);
+
+typedef struct PoolState PoolState;
+typedef struct ThreadPool {
+    PoolState *     state;
+    int             n_workers;
+} ThreadPool;
+
+typedef struct PoolStats {
+    int64_t     executed;       // tasks run
+    int64_t     stolen;         // of which taken from another worker's deque
+    int64_t     injected;       // submitted from outside the pool
+    int64_t     parks;          // times a worker went to sleep
+} PoolStats;
+
+/* n_workers 0 means one per logical processor; false when a thread cannot be started */
+int
+ThreadPool_Init (ThreadPool * pool, int n_workers);
+
+/* Waits for every submitted task (and the ones they submit), then stops the workers */
+void
+ThreadPool_Deinit (ThreadPool * pool);
+
+/* False when the pool has no room for another pending task */
+int
+ThreadPool_Submit (ThreadPool * pool, PoolTaskFn fn, void * arg);
+
+/* Returns once no task is queued or running; not from inside a task of this pool */
+void
+ThreadPool_Wait (ThreadPool * pool);
+
+/* The calling worker's index in its pool, -1 on other threads */
+int
+ThreadPool_WorkerIndex (void);
+
+void
+ThreadPool_GetStats (ThreadPool const * pool, PoolStats * stats);
+
+#ifdef __cplusplus
+}
+#endif
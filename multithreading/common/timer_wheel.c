@@ -0,0 +1,282 @@
+/* ===========================================================
+   #File: timer_wheel.c #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Hierarchical timer wheel for timeouts and delayed work #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L    /* clock_gettime, pthread_condattr_setclock */
+#endif
+
+#include "timer_wheel.h"
+
+#include <string.h>
+
+#define TIMER_MASK      (TIMER_SLOTS - 1)
+#define TIMER_NEVER     INT64_MAX
+
+/* The wheel whose thread this is, so a callback can cancel its own timer */
+static MT_THREAD_LOCAL TimerWheel * tls_wheel;
+
+// =========================================================================================
+
+#pragma region lists
+static void
+list_init (Timer * head) {
+    head->next = head;
+    head->prev = head;
+}
+static int
+list_empty (Timer const * head) {
+    return head->next == head;
+}
+static void
+list_push (Timer * head, Timer * t) {
+    t->prev = head->prev;
+    t->next = head;
+    head->prev->next = t;
+    head->prev = t;
+}
+static void
+list_unlink (Timer * t) {
+    t->prev->next = t->next;
+    t->next->prev = t->prev;
+    t->next = t->prev = NULL;
+}
+/* Moves every timer of from onto the empty list to */
+static void
+list_splice (Timer * from, Timer * to) {
+    if (list_empty(from))
+        return;
+    to->next = from->next;
+    to->prev = from->prev;
+    to->next->prev = to;
+    to->prev->next = to;
+    list_init(from);
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region wheel
+/* Whole ticks elapsed since Init */
+static int64_t
+clock_tick (TimerWheel const * w) {
+    return (mt_now_ns() - w->start_ns) / w->tick_ns;
+}
+/* Links an armed timer into the slot for its expiry, relative to w->now */
+static void
+place (TimerWheel * w, Timer * t) {
+    int64_t delta = t->expires - w->now;
+    int64_t expires = t->expires;
+    int level = 0;
+
+    if (delta < 0) {
+        expires = w->now;       // overdue: the next tick processed
+    } else if (delta >= ((int64_t)1 << (TIMER_BITS * TIMER_LEVELS))) {
+        expires = w->now + ((int64_t)1 << (TIMER_BITS * TIMER_LEVELS)) - 1;
+        delta = expires - w->now;   // beyond the top level: parked there, re-placed on cascade
+    }
+    while (level < TIMER_LEVELS - 1 && delta >= ((int64_t)1 << (TIMER_BITS * (level + 1))))
+        level++;
+    list_push(&w->slots[level][(expires >> (TIMER_BITS * level)) & TIMER_MASK], t);
+}
+/* Re-places the timers of one slot, each lands at least a level lower */
+static void
+cascade (TimerWheel * w, int level, int slot) {
+    Timer moving;
+    list_init(&moving);
+    list_splice(&w->slots[level][slot], &moving);
+    while (!list_empty(&moving)) {
+        Timer * t = moving.next;
+        list_unlink(t);
+        place(w, t);
+    }
+}
+/* Runs tick w->now; called and returns with the lock held, drops it around callbacks */
+static void
+process_tick (TimerWheel * w) {
+    Timer due;
+    int slot = (int)(w->now & TIMER_MASK);
+
+    // -- level 0 wrapped: bring the next span of each level down, as far up as it wraps too
+    if (0 == slot) {
+        for (int level = 1; level < TIMER_LEVELS; ++level) {
+            int s = (int)((w->now >> (TIMER_BITS * level)) & TIMER_MASK);
+            cascade(w, level, s);
+            if (s != 0)
+                break;
+        }
+    }
+    list_init(&due);
+    list_splice(&w->slots[0][slot], &due);
+    w->now++;
+
+    // -- timers in due stay armed until they run: Arm and Cancel may still take them out
+    while (!list_empty(&due)) {
+        Timer * t = due.next;
+        list_unlink(t);
+        t->armed = 0;
+        w->pending--;
+        w->running = t;
+        mt_unlock(&w->lock);
+        t->fn(t->arg);          // may re-arm or free t
+        mt_lock(&w->lock);
+        w->running = NULL;
+        if (w->cancelling > 0)
+            mt_cond_broadcast(&w->fired);
+    }
+}
+/* The next tick with anything to do: a non-empty level-0 slot, else the next cascade */
+static int64_t
+next_tick (TimerWheel const * w) {
+    if (0 == (w->now & TIMER_MASK))
+        return w->now;
+    for (int64_t tick = w->now; (tick & TIMER_MASK) != 0; ++tick)
+        if (!list_empty(&w->slots[0][tick & TIMER_MASK]))
+            return tick;
+    return (w->now | TIMER_MASK) + 1;
+}
+static void
+wheel_thread (void * arg) {
+    TimerWheel * w = (TimerWheel *)arg;
+    tls_wheel = w;
+
+    mt_lock(&w->lock);
+    while (!w->stop) {
+        int64_t tick = clock_tick(w);
+        if (0 == w->pending && w->now <= tick)
+            w->now = tick + 1;  // nothing armed: skip the idle ticks
+        while (w->now <= tick && !w->stop)
+            process_tick(w);
+        if (w->stop)
+            break;
+
+        if (0 == w->pending) {
+            w->sleep_until = TIMER_NEVER;
+            mt_cond_wait(&w->wake, &w->lock);
+        } else {
+            w->sleep_until = next_tick(w);
+            int64_t left_ms = (w->start_ns + w->sleep_until * w->tick_ns - mt_now_ns() + 999999) / 1000000;
+            if (left_ms > 0)
+                mt_cond_wait_ms(&w->wake, &w->lock, left_ms);
+        }
+    }
+    mt_unlock(&w->lock);
+}
+#pragma endregion
+
+// =========================================================================================
+
+int
+TimerWheel_Init (TimerWheel * w, int tick_ms) {
+    memset(w, 0, sizeof(*w));
+    mt_lock_init(&w->lock);
+    mt_cond_init(&w->wake);
+    mt_cond_init(&w->fired);
+    for (int level = 0; level < TIMER_LEVELS; ++level)
+        for (int slot = 0; slot < TIMER_SLOTS; ++slot)
+            list_init(&w->slots[level][slot]);
+    w->tick_ns = (int64_t)((tick_ms < 1) ? 1 : tick_ms) * 1000000;
+    w->start_ns = mt_now_ns();
+    w->sleep_until = TIMER_NEVER;
+    if (!mt_thread_create(&w->thread, wheel_thread, w)) {
+        mt_lock_deinit(&w->lock);
+        mt_cond_deinit(&w->wake);
+        mt_cond_deinit(&w->fired);
+        return 0;
+    }
+    return 1;
+}
+void
+TimerWheel_Deinit (TimerWheel * w) {
+    mt_lock(&w->lock);
+    w->stop = 1;
+    mt_cond_signal(&w->wake);
+    mt_unlock(&w->lock);
+    mt_thread_join(w->thread);
+    mt_lock_deinit(&w->lock);
+    mt_cond_deinit(&w->wake);
+    mt_cond_deinit(&w->fired);
+}
+void
+Timer_Init (Timer * t, TimerFn fn, void * arg) {
+    t->next = t->prev = NULL;
+    t->expires = 0;
+    t->fn = fn;
+    t->arg = arg;
+    t->armed = 0;
+}
+void
+TimerWheel_Arm (TimerWheel * w, Timer * t, int64_t ms) {
+    // -- round the deadline up to a tick: late by less than a tick, never early
+    int64_t deadline = mt_now_ns() - w->start_ns + ((ms < 0) ? 0 : ms) * 1000000;
+    int64_t expires = (deadline + w->tick_ns - 1) / w->tick_ns;
+
+    mt_lock(&w->lock);
+    // -- an idle wheel's now is stale: catch up here, not tick by tick on the wheel thread
+    if (0 == w->pending) {
+        int64_t tick = clock_tick(w);
+        if (w->now < tick)
+            w->now = tick;
+    }
+    if (t->armed)
+        list_unlink(t);
+    else
+        w->pending++;
+    t->armed = 1;
+    t->expires = expires;
+    place(w, t);
+    if (expires < w->sleep_until)
+        mt_cond_signal(&w->wake);
+    mt_unlock(&w->lock);
+}
+int
+TimerWheel_Cancel (TimerWheel * w, Timer * t) {
+    mt_lock(&w->lock);
+    // -- a running callback may still use what t points to: wait it out, unless it is the caller
+    if (w->running == t && tls_wheel != w) {
+        w->cancelling++;
+        while (w->running == t)
+            mt_cond_wait(&w->fired, &w->lock);
+        w->cancelling--;
+    }
+    int ret = t->armed;
+    if (ret) {
+        list_unlink(t);
+        t->armed = 0;
+        w->pending--;
+    }
+    mt_unlock(&w->lock);
+    return ret;
+}
+
+// =========================================================================================
+
+#pragma region timed waits
+static void
+timed_wait_expire (void * arg) {
+    TimedWait * tw = (TimedWait *)arg;
+    mt_lock(tw->lock);
+    tw->expired = 1;
+    mt_cond_broadcast(tw->cond);
+    mt_unlock(tw->lock);
+}
+void
+TimedWait_Begin (TimerWheel * w, TimedWait * tw, MtLock * lock, MtCond * cond, int64_t ms) {
+    tw->lock = lock;
+    tw->cond = cond;
+    tw->expired = 0;
+    Timer_Init(&tw->timer, timed_wait_expire, tw);
+    if (ms != MT_INFINITE)
+        TimerWheel_Arm(w, &tw->timer, ms);
+}
+int
+TimedWait_End (TimerWheel * w, TimedWait * tw) {
+    TimerWheel_Cancel(w, &tw->timer);
+    return tw->expired;     // Cancel waited for the callback, if it ran
+}
+#pragma endregion
@@ -0,0 +1,125 @@
+#pragma once
+
+/* ===========================================================
+   #File: timer_wheel.h #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Hierarchical timer wheel for timeouts and delayed work #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#include "mt_platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+One thread serves any number of pending timers, instead of one kernel
+timer (a timed wait) per waiter.
+
+ - The wheel has TIMER_LEVELS levels of TIMER_SLOTS slots, each slot a
+   doubly linked list of timers. Level 0 holds timers due within
+   TIMER_SLOTS ticks, one slot per tick; each level up covers TIMER_SLOTS
+   times the span of the one below. Arm and Cancel are O(1): link into or
+   unlink from a slot.
+ - When level 0 wraps, the next slot of level 1 is cascaded, its timers
+   re-linked a level down (and so on up the levels): each timer moves at
+   most TIMER_LEVELS - 1 times.
+ - The thread sleeps until the next non-empty level-0 slot or the next
+   cascade, and not at all while no timer is armed.
+ - A timer fires at the first tick at or after its deadline, never early.
+   Callbacks run on the wheel thread, one at a time, with no lock held:
+   they should only wake someone or submit work (e.g. ThreadPool_Submit).
+
+Timers are owned by the caller; Cancel waits for a callback that is
+already running, so a timer can be freed once Cancel returns. A callback
+may re-arm or free its own timer.
+*/
+
+#define TIMER_LEVELS    4
+#define TIMER_BITS      6
+#define TIMER_SLOTS     (1 << TIMER_BITS)
+
+typedef void (*TimerFn) (void * arg);
+
+typedef struct Timer {
+    struct Timer *  next;
+    struct Timer *  prev;
+    int64_t         expires;    // tick
+    TimerFn         fn;
+    void *          arg;
+    int             armed;      // under the wheel's lock
+} Timer;
+
+typedef struct TimerWheel {
+    MtLock      lock;
+    MtCond      wake;           // the wheel thread sleeps on it
+    MtCond      fired;          // Cancel waits on it for a running callback
+    Timer       slots[TIMER_LEVELS][TIMER_SLOTS];   // list heads
+    int64_t     now;            // next tick to process
+    int64_t     sleep_until;    // tick the wheel thread sleeps until
+    int64_t     start_ns;
+    int64_t     tick_ns;
+    int64_t     pending;        // armed timers
+    Timer *     running;        // whose callback is running
+    int         cancelling;     // Cancel calls waiting for it
+    int         stop;
+    MtThread    thread;
+} TimerWheel;
+
+/* tick_ms is the resolution, 1 or more; false when the thread cannot be started */
+int
+TimerWheel_Init (TimerWheel * w, int tick_ms);
+
+/* Stops the thread; timers still armed never fire */
+void
+TimerWheel_Deinit (TimerWheel * w);
+
+void
+Timer_Init (Timer * t, TimerFn fn, void * arg);
+
+/* fn(arg) runs ms from now; an armed timer is moved */
+void
+TimerWheel_Arm (TimerWheel * w, Timer * t, int64_t ms);
+
+/* True when the timer was armed and now will not fire; false if it had fired or was not armed */
+int
+TimerWheel_Cancel (TimerWheel * w, Timer * t);
+
+// =========================================================================================
+
+/*
+A timed wait on the caller's condition variable, its timeout a wheel
+timer. The condition is waited on without a timeout:
+
+    mt_lock(lock);
+    TimedWait_Begin(w, &tw, lock, cond, ms);
+    while (!predicate && !tw.expired)
+        mt_cond_wait(cond, lock);
+    mt_unlock(lock);
+    TimedWait_End(w, &tw);
+
+The timer broadcasts cond under lock when it fires; End, called without
+the lock, cancels it.
+*/
+
+typedef struct TimedWait {
+    Timer       timer;
+    MtLock *    lock;
+    MtCond *    cond;
+    int         expired;        // under lock
+} TimedWait;
+
+/* With lock held */
+void
+TimedWait_Begin (TimerWheel * w, TimedWait * tw, MtLock * lock, MtCond * cond, int64_t ms);
+
+/* Without lock held; true when the wait timed out */
+int
+TimedWait_End (TimerWheel * w, TimedWait * tw);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,258 @@
+/* ===========================================================
+   #File: topology.c #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: NUMA nodes and core groups: detection, thread pinning, node-local memory #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE                 /* sched_getcpu, pthread_setaffinity_np, MAP_ANONYMOUS */
+#endif
+
+#include "topology.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+#define TOPOLOGY_MAX_NODE_ID    1024
+#define TOPOLOGY_MAX_CPUS       4096
+#define TOPOLOGY_MPOL_PREFERRED 1       // <linux/mempolicy.h>
+
+// =========================================================================================
+
+#pragma region detection
+/* Splits the node's processors into domains of group_size (all of them for 0) */
+static void
+add_node (Topology * t, int node, int const * cpus, int n_cpus, int group_size) {
+    int step = (group_size > 0) ? group_size : n_cpus;
+    for (int first = 0; first < n_cpus && t->n_domains < TOPOLOGY_MAX_DOMAINS; first += step) {
+        TopologyDomain * d = &t->domains[t->n_domains];
+        d->node = node;
+        d->n_cpus = (n_cpus - first < step) ? n_cpus - first : step;
+        d->cpus = (int *)malloc(sizeof(int) * (size_t)d->n_cpus);
+        if (NULL == d->cpus)
+            return;
+        memcpy(d->cpus, cpus + first, sizeof(int) * (size_t)d->n_cpus);
+        t->n_domains++;
+    }
+}
+
+/* The processor -> domain map Topology_CurrentDomain looks up; out of memory undoes the detection */
+static int
+map_cpus (Topology * t) {
+    int max_cpu = -1;
+    for (int i = 0; i < t->n_domains; ++i)
+        for (int k = 0; k < t->domains[i].n_cpus; ++k)
+            if (t->domains[i].cpus[k] > max_cpu)
+                max_cpu = t->domains[i].cpus[k];
+    t->n_cpu_ids = max_cpu + 1;
+    t->cpu_domain = (unsigned char *)calloc((size_t)t->n_cpu_ids + 1, 1);
+    if (NULL == t->cpu_domain) {
+        Topology_Deinit(t);
+        return 0;
+    }
+    for (int i = 0; i < t->n_domains; ++i)
+        for (int k = 0; k < t->domains[i].n_cpus; ++k)
+            t->cpu_domain[t->domains[i].cpus[k]] = (unsigned char)i;
+    return 1;
+}
+
+#ifdef _WIN32
+int
+Topology_Detect (Topology * t, int group_size) {
+    ULONG highest = 0;
+    WORD n_groups = GetActiveProcessorGroupCount();
+    int * cpus = (int *)malloc(sizeof(int) * TOPOLOGY_MAX_CPUS);
+    memset(t, 0, sizeof(*t));
+    if (NULL == cpus || !GetNumaHighestNodeNumber(&highest)) {
+        free(cpus);
+        return 0;
+    }
+
+    // -- node by node, asking every group: a node's GroupMask names only its first group,
+    //    and a node of more than 64 processors (or a split one) spans several
+    for (ULONG node = 0; node <= highest && node < TOPOLOGY_MAX_NODE_ID; ++node) {
+        int n = 0;
+        for (WORD group = 0; group < n_groups; ++group) {
+            for (BYTE bit = 0; bit < 64 && n < TOPOLOGY_MAX_CPUS; ++bit) {
+                PROCESSOR_NUMBER pn = {group, bit, 0};
+                USHORT at;
+                // -- fails for a processor the group does not have
+                if (GetNumaProcessorNodeEx(&pn, &at) && at == node)
+                    cpus[n++] = group * 64 + bit;
+            }
+        }
+        if (n > 0) {
+            add_node(t, (int)node, cpus, n, group_size);
+            t->n_nodes++;
+        }
+    }
+    free(cpus);
+    return t->n_domains > 0 && map_cpus(t);
+}
+#else
+/* "0-3,8-11" into cpus, keeping those the process may run on; the count */
+static int
+parse_cpu_list (char const * s, cpu_set_t const * allowed, int * cpus, int max) {
+    int n = 0;
+    while (*s) {
+        char * end;
+        long lo = strtol(s, &end, 10), hi = lo;
+        if (end == s)
+            break;
+        if ('-' == *end)
+            hi = strtol(end + 1, &end, 10);
+        for (long c = lo; c <= hi && n < max; ++c)
+            if (c < CPU_SETSIZE && CPU_ISSET((int)c, allowed))
+                cpus[n++] = (int)c;
+        s = (',' == *end) ? end + 1 : end;
+        if ('\n' == *s)
+            break;
+    }
+    return n;
+}
+static int
+read_line (char const * path, char * buf, int size) {
+    FILE * f = fopen(path, "r");
+    if (NULL == f)
+        return 0;
+    int ok = (NULL != fgets(buf, size, f));
+    fclose(f);
+    return ok;
+}
+int
+Topology_Detect (Topology * t, int group_size) {
+    char line[4096], path[128];
+    cpu_set_t allowed;
+    int * cpus = (int *)malloc(sizeof(int) * TOPOLOGY_MAX_CPUS);
+    int nodes[TOPOLOGY_MAX_DOMAINS];
+    memset(t, 0, sizeof(*t));
+    if (NULL == cpus || sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        free(cpus);
+        return 0;
+    }
+
+    // -- the online nodes, themselves a list like the processors'
+    cpu_set_t every;
+    CPU_ZERO(&every);
+    for (int i = 0; i < TOPOLOGY_MAX_NODE_ID && i < CPU_SETSIZE; ++i)
+        CPU_SET(i, &every);
+    int n_nodes = 0;
+    if (read_line("/sys/devices/system/node/online", line, sizeof(line)))
+        n_nodes = parse_cpu_list(line, &every, nodes, TOPOLOGY_MAX_DOMAINS);
+
+    for (int i = 0; i < n_nodes; ++i) {
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", nodes[i]);
+        if (!read_line(path, line, sizeof(line)))
+            continue;
+        int n = parse_cpu_list(line, &allowed, cpus, TOPOLOGY_MAX_CPUS);
+        if (n > 0) {
+            add_node(t, nodes[i], cpus, n, group_size);
+            t->n_nodes++;
+        }
+    }
+    // -- no NUMA information (or none we may use): one node of every allowed processor
+    if (0 == t->n_domains) {
+        int n = 0;
+        for (int c = 0; c < CPU_SETSIZE && n < TOPOLOGY_MAX_CPUS; ++c)
+            if (CPU_ISSET(c, &allowed))
+                cpus[n++] = c;
+        add_node(t, 0, cpus, n, group_size);
+        t->n_nodes = 1;
+    }
+    free(cpus);
+    return t->n_domains > 0 && map_cpus(t);
+}
+#endif
+
+void
+Topology_Deinit (Topology * t) {
+    for (int i = 0; i < t->n_domains; ++i)
+        free(t->domains[i].cpus);
+    free(t->cpu_domain);
+    memset(t, 0, sizeof(*t));
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region threads
+int
+Topology_PinToDomain (Topology const * t, int domain) {
+    TopologyDomain const * d = &t->domains[domain];
+#ifdef _WIN32
+    // -- a thread runs in one processor group: the domain's processors in the first one's
+    GROUP_AFFINITY ga;
+    memset(&ga, 0, sizeof(ga));
+    ga.Group = (WORD)(d->cpus[0] / 64);
+    for (int i = 0; i < d->n_cpus; ++i)
+        if (d->cpus[i] / 64 == ga.Group)
+            ga.Mask |= (KAFFINITY)1 << (d->cpus[i] % 64);
+    return SetThreadGroupAffinity(GetCurrentThread(), &ga, NULL);
+#else
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int i = 0; i < d->n_cpus; ++i)
+        CPU_SET(d->cpus[i], &set);
+    return 0 == pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+}
+int
+Topology_CurrentDomain (Topology const * t) {
+#ifdef _WIN32
+    PROCESSOR_NUMBER pn;
+    GetCurrentProcessorNumberEx(&pn);
+    int cpu = pn.Group * 64 + pn.Number;
+#else
+    int cpu = sched_getcpu();
+#endif
+    if (cpu < 0 || cpu >= t->n_cpu_ids)
+        return 0;
+    // -- a copy narrowed to fewer domains (numa_bench's global layout) shares the map
+    int d = t->cpu_domain[cpu];
+    return (d < t->n_domains) ? d : 0;
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region memory
+void *
+Topology_AllocOnDomain (Topology const * t, int domain, size_t size) {
+    int node = t->domains[domain].node;
+#ifdef _WIN32
+    return VirtualAllocExNuma(GetCurrentProcess(), NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, (DWORD)node);
+#else
+    void * p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (MAP_FAILED == p)
+        return NULL;
+    // -- before anything touches the pages; refused without NUMA support, which is harmless
+    if (t->n_nodes > 1 && node < TOPOLOGY_MAX_NODE_ID) {
+        unsigned long mask[TOPOLOGY_MAX_NODE_ID / (8 * sizeof(unsigned long))];
+        memset(mask, 0, sizeof(mask));
+        mask[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+        syscall(SYS_mbind, p, size, TOPOLOGY_MPOL_PREFERRED, mask, (unsigned long)(8 * sizeof(mask)), 0u);
+    }
+    return p;
+#endif
+}
+void
+Topology_Free (void * p, size_t size) {
+    if (NULL == p)
+        return;
+#ifdef _WIN32
+    (void)size;
+    VirtualFree(p, 0, MEM_RELEASE);
+#else
+    munmap(p, size);
+#endif
+}
+#pragma endregion
@@ -0,0 +1,81 @@
+#pragma once
+
+/* ===========================================================
+   #File: topology.h #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: NUMA nodes and core groups: detection, thread pinning, node-local memory #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#include "mt_platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+The machine as a few domains of logical processors that share memory
+cheaply:
+
+ - Without grouping, one domain per NUMA node, from the node of every
+   processor of every processor group (GetNumaProcessorNodeEx; a node may
+   span groups) on Windows and from /sys/devices/system/node on Linux. A machine or container that reports
+   none is a single domain of every processor.
+ - group_size > 0 splits each node further into core groups of that many
+   logical processors (e.g. a shared L2/L3 slice), or partitions a
+   single-node machine for testing.
+
+Processors are numbered as the OS does: the Linux CPU number, or
+group * 64 + number within the group on Windows.
+
+Memory for a domain is preferred on its node: VirtualAllocExNuma on
+Windows, mmap plus mbind(MPOL_PREFERRED) on Linux (the system call
+itself, no libnuma needed). Pages are placed on first touch either way.
+*/
+
+#define TOPOLOGY_MAX_DOMAINS    64
+
+typedef struct TopologyDomain {
+    int         node;           // the OS's NUMA node number
+    int         n_cpus;
+    int *       cpus;
+} TopologyDomain;
+
+typedef struct Topology {
+    int             n_domains;
+    int             n_nodes;        // NUMA nodes reported; 1 when none are
+    TopologyDomain  domains[TOPOLOGY_MAX_DOMAINS];
+    int             n_cpu_ids;      // highest processor number + 1
+    unsigned char * cpu_domain;     // [n_cpu_ids], the domain of every processor
+} Topology;
+
+/* group_size 0 for a domain per node; false when the processors cannot be listed */
+int
+Topology_Detect (Topology * t, int group_size);
+
+void
+Topology_Deinit (Topology * t);
+
+/* The calling thread may run on any processor of the domain; false if the OS refuses */
+int
+Topology_PinToDomain (Topology const * t, int domain);
+
+/*
+The domain of the processor the caller is running on (a hint unless pinned),
+a lookup in cpu_domain; 0 for a processor outside the domains
+*/
+int
+Topology_CurrentDomain (Topology const * t);
+
+/* Zeroed, page-aligned, preferring the domain's node; NULL on failure */
+void *
+Topology_AllocOnDomain (Topology const * t, int domain, size_t size);
+
+void
+Topology_Free (void * p, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,127 @@
+/* ===========================================================
+   #File: urgency_queue.c #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Bounded priority/deadline queue with aging, a heap per consumer class #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L    /* clock_gettime, pthread_condattr_setclock */
+#endif
+
+#include "urgency_queue.h"
+#include "../../misc/alloc/mem_alloc.h"
+
+#include <string.h>
+
+// =========================================================================================
+
+#pragma region heap
+/* Slot a before slot b: smaller key, then earlier push */
+static int
+before (UrgencyQueue const * q, int a, int b) {
+    if (q->keys[a] != q->keys[b])
+        return q->keys[a] < q->keys[b];
+    return q->seqs[a] < q->seqs[b];
+}
+static void
+sift_up (UrgencyQueue * q, int * heap, int i) {
+    int slot = heap[i];
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!before(q, slot, heap[parent]))
+            break;
+        heap[i] = heap[parent];
+        i = parent;
+    }
+    heap[i] = slot;
+}
+static void
+sift_down (UrgencyQueue * q, int * heap, int count, int i) {
+    int slot = heap[i];
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= count)
+            break;
+        if (child + 1 < count && before(q, heap[child + 1], heap[child]))
+            child++;
+        if (!before(q, heap[child], slot))
+            break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = slot;
+}
+#pragma endregion
+
+// =========================================================================================
+
+int
+UrgencyQueue_Init (UrgencyQueue * q, size_t msg_size, int capacity, int n_classes, int64_t aging) {
+    memset(q, 0, sizeof(*q));
+    q->msg_size = msg_size;
+    q->capacity = capacity;
+    q->n_classes = n_classes;
+    q->aging = aging;
+    // -- every array on its own cache lines, so a slot padded to a line is one line
+    q->msgs = (char *)Mem_AllocAligned(msg_size * (size_t)capacity, MT_CACHE_LINE, 0);
+    q->keys = (int64_t *)Mem_AllocAligned(sizeof(int64_t) * (size_t)capacity, MT_CACHE_LINE, 0);
+    q->seqs = (int64_t *)Mem_AllocAligned(sizeof(int64_t) * (size_t)capacity, MT_CACHE_LINE, 0);
+    q->free_slots = (int *)Mem_AllocAligned(sizeof(int) * (size_t)capacity, MT_CACHE_LINE, 0);
+    q->heaps = (int *)Mem_AllocAligned(sizeof(int) * (size_t)capacity * (size_t)n_classes, MT_CACHE_LINE, 0);
+    q->counts = (int *)Mem_AllocAligned(sizeof(int) * (size_t)n_classes, MT_CACHE_LINE, MEM_ZERO);
+    if (!q->msgs || !q->keys || !q->seqs || !q->free_slots || !q->heaps || !q->counts) {
+        UrgencyQueue_Deinit(q);
+        return 0;
+    }
+    // -- slot 0 on top of the stack, so the first pushes fill the array in order
+    for (int i = 0; i < capacity; ++i)
+        q->free_slots[i] = capacity - 1 - i;
+    q->n_free = capacity;
+    return 1;
+}
+void
+UrgencyQueue_Deinit (UrgencyQueue * q) {
+    Mem_FreeAligned(q->msgs);
+    Mem_FreeAligned(q->keys);
+    Mem_FreeAligned(q->seqs);
+    Mem_FreeAligned(q->free_slots);
+    Mem_FreeAligned(q->heaps);
+    Mem_FreeAligned(q->counts);
+    memset(q, 0, sizeof(*q));
+}
+int
+UrgencyQueue_Push (UrgencyQueue * q, int cls, int priority, int64_t deadline, int64_t now, void const * msg) {
+    if (0 == q->n_free)
+        return 0;
+    int slot = q->free_slots[--q->n_free];
+    int64_t aged = now + (int64_t)priority * q->aging;
+
+    memcpy(q->msgs + (size_t)slot * q->msg_size, msg, q->msg_size);
+    q->keys[slot] = (deadline < aged) ? deadline : aged;
+    q->seqs[slot] = q->next_seq++;
+
+    int * heap = q->heaps + (size_t)cls * (size_t)q->capacity;
+    heap[q->counts[cls]] = slot;
+    sift_up(q, heap, q->counts[cls]++);
+    return 1;
+}
+int
+UrgencyQueue_Pop (UrgencyQueue * q, int cls, void * msg_out, int64_t * key_out) {
+    if (0 == q->counts[cls])
+        return 0;
+    int * heap = q->heaps + (size_t)cls * (size_t)q->capacity;
+    int slot = heap[0];
+
+    memcpy(msg_out, q->msgs + (size_t)slot * q->msg_size, q->msg_size);
+    if (key_out != NULL)
+        *key_out = q->keys[slot];
+
+    heap[0] = heap[--q->counts[cls]];
+    if (q->counts[cls] > 0)
+        sift_down(q, heap, q->counts[cls], 0);
+    q->free_slots[q->n_free++] = slot;
+    return 1;
+}
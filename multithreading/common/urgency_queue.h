@@ -0,0 +1,77 @@
+#pragma once
+
+/* ===========================================================
+   #File: urgency_queue.h #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Bounded priority/deadline queue with aging, a heap per consumer class #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+#include "mt_platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+Fixed-size messages, each pushed for one consumer class with a priority
+and a deadline; Pop hands a class its most urgent message. Push and Pop
+are O(log n): a binary min-heap of slot indices per class over one
+shared slot array, whose free slots are a stack.
+
+Urgency is a single key fixed at push time:
+
+    key = min(deadline, now + priority * aging)
+
+priority 0 is the most urgent. A message's key never exceeds its arrival
+plus priority * aging, so anything pushed more than that much later
+sorts after it whatever its priority: waiting is bounded, no message
+starves. Equal keys leave in push order.
+
+Not synchronized: the caller's lock guards it, as with the apps' queues.
+*/
+
+typedef struct UrgencyQueue {
+    size_t      msg_size;
+    int         capacity;
+    int         n_classes;
+    int64_t     aging;          // key offset per priority level, in the caller's time unit
+    int64_t     next_seq;
+    char *      msgs;           // capacity messages
+    int64_t *   keys;           // per slot
+    int64_t *   seqs;           // per slot, the tie-break
+    int *       free_slots;     // stack of free slot indices
+    int         n_free;
+    int *       heaps;          // n_classes heaps of capacity slot indices
+    int *       counts;         // per class
+} UrgencyQueue;
+
+/* False on allocation failure */
+int
+UrgencyQueue_Init (UrgencyQueue * q, size_t msg_size, int capacity, int n_classes, int64_t aging);
+
+void
+UrgencyQueue_Deinit (UrgencyQueue * q);
+
+/* False when full. now, deadline and aging share a time unit */
+int
+UrgencyQueue_Push (UrgencyQueue * q, int cls, int priority, int64_t deadline, int64_t now, void const * msg);
+
+/* Most urgent message of the class; false when it has none. key_out may be NULL */
+int
+UrgencyQueue_Pop (UrgencyQueue * q, int cls, void * msg_out, int64_t * key_out);
+
+MT_INLINE int
+UrgencyQueue_IsFull (UrgencyQueue const * q) {
+    return 0 == q->n_free;
+}
+MT_INLINE int
+UrgencyQueue_Count (UrgencyQueue const * q, int cls) {
+    return q->counts[cls];
+}
+
+#ifdef __cplusplus
+}
+#endif
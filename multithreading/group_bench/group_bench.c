@@ -0,0 +1,132 @@
+/* ===========================================================
+   #File: group_bench.c #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Start and shutdown times of thread groups, cancellation vs polling #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+/*
+Every member paces itself with a sleep between requests, like the writers
+and readers of app01 and app03. Shutdown is measured from the request to
+the return of the join:
+
+    token       members sleep in CancelToken_Sleep, cancel wakes them
+    polling     members sleep POLL_MS at a time and check a flag in between,
+                the way app01/app03 checked g_shutdown
+
+Group sizes go well past MAXIMUM_WAIT_OBJECTS (64).
+*/
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L    /* clock_gettime */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../common/thread_group.h"
+#include "../../bench/bench_util.h"
+
+#ifndef _countof
+#define _countof(a) (sizeof(a) / sizeof((a)[0]))
+#endif
+
+#define PACE_MS         2500        // a member's sleep between requests
+#define POLL_MS         100         // slice of the polling members' sleep
+
+static int const g_sizes [] = {16, 64, 256, 1024};
+
+// =========================================================================================
+
+typedef struct Shared {
+    ThreadGroup *       group;
+    int64_t volatile    started;
+    int64_t volatile    exited;
+    int64_t volatile    stop;       // the polling members' flag
+} Shared;
+
+static void
+token_member (void * arg) {
+    Shared * sh = (Shared *)arg;
+    mt_fetch_add(&sh->started, 1);
+    while (CancelToken_Sleep(&sh->group->cancel, PACE_MS))
+        ;   // a request would be handled here
+    mt_fetch_add(&sh->exited, 1);
+}
+static void
+polling_member (void * arg) {
+    Shared * sh = (Shared *)arg;
+    mt_fetch_add(&sh->started, 1);
+    while (!mt_load_acquire(&sh->stop)) {
+        for (int slept = 0; slept < PACE_MS && !mt_load_acquire(&sh->stop); slept += POLL_MS) {
+#ifdef _WIN32
+            Sleep(POLL_MS);
+#else
+            struct timespec ts = {0, POLL_MS * 1000000L};
+            nanosleep(&ts, NULL);
+#endif
+        }
+    }
+    mt_fetch_add(&sh->exited, 1);
+}
+
+/* Spawn n members, let them all start, then stop and join; times in ms. False if a member went missing */
+static int
+measure (GroupThreadFn fn, int n, double * spawn_ms, double * stop_ms) {
+    ThreadGroup g;
+    Shared sh;
+    memset(&sh, 0, sizeof(sh));
+    if (!ThreadGroup_Init(&g))
+        return 0;
+    sh.group = &g;
+
+    int64_t t0 = mt_now_ns();
+    int spawned = 0;
+    for (int i = 0; i < n; ++i)
+        spawned += ThreadGroup_Spawn(&g, fn, &sh);
+    while (mt_load_acquire(&sh.started) < spawned)
+        mt_yield();
+    int64_t t1 = mt_now_ns();
+
+    mt_store_release(&sh.stop, 1);
+    ThreadGroup_Cancel(&g);
+    ThreadGroup_Join(&g, MT_INFINITE);
+    int64_t t2 = mt_now_ns();
+
+    ThreadGroup_Deinit(&g);
+    *spawn_ms = (double)(t1 - t0) * 1e-6;
+    *stop_ms = (double)(t2 - t1) * 1e-6;
+    return spawned == n && sh.exited == n;
+}
+
+int main (int argc, char * argv []) {
+    (void)argc;
+    (void)argv;
+    printf("group start and shutdown in ms, members sleep %d ms between requests (best of %d)\n", PACE_MS, BENCH_REPS);
+    printf("%-10s %8s %12s %12s\n", "wake", "threads", "start", "shutdown");
+    for (size_t k = 0; k < _countof(g_sizes); ++k) {
+        for (int polling = 0; polling < 2; ++polling) {
+            double best_spawn = 1e30, best_stop = 1e30;
+            int ok = 1;
+            for (int rep = 0; rep < BENCH_REPS; ++rep) {
+                double spawn_ms, stop_ms;
+                ok &= measure(polling ? polling_member : token_member, g_sizes[k], &spawn_ms, &stop_ms);
+                if (spawn_ms < best_spawn)
+                    best_spawn = spawn_ms;
+                if (stop_ms < best_stop)
+                    best_stop = stop_ms;
+            }
+            printf(
+                "%-10s %8d %12.2f %12.2f%s\n", polling ? "polling" : "token", g_sizes[k],
+                best_spawn, best_stop, ok ? "" : "  (MISSING MEMBERS)"
+            );
+            fflush(stdout);
+        }
+    }
+    return(0);
+}
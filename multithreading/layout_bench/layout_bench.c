@@ -0,0 +1,338 @@
+/* ===========================================================
+   #File: layout_bench.c #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: False sharing in app01's shared queue state, packed vs padded #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+/*
+The two things app01's QUEUE_PAD_HOT and QUEUE_PAD_SLOTS change, without the
+lock around them so the cache traffic is not hidden behind it:
+
+    slots       every thread fills and clears its own 12-byte slot, like a
+                writer and a reader do; packed, five slots share a line
+    hot         even threads bump the writers' counter, odd ones the readers',
+                all of them read the shutdown flag and the queue size
+
+On Linux the cache misses of each run come from perf_event_open; a raw
+event code can be added for the HITM count, whose encoding is CPU specific
+(e.g. raw=0x20d1 for MEM_LOAD_L3_HIT_RETIRED.XSNP_FWD on recent Intel cores).
+
+layout_bench [slots] [hot] [raw=<hex event>]; no workload names run both.
+*/
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE                 /* syscall, for perf_event_open */
+#elif !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L    /* clock_gettime */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../common/mt_platform.h"
+#include "../../bench/bench_util.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#ifndef _countof
+#define _countof(a) (sizeof(a) / sizeof((a)[0]))
+#endif
+
+#define MAX_THREADS     64
+#define ITERS           (1 << 20)   // per thread
+
+static int const g_threads [] = {2, 4, 8, 16, 32, 64};
+
+// =========================================================================================
+
+#pragma region counters
+/* Misses of the whole process, threads included; -1 where the counters are not available */
+enum { CNT_CACHE_MISSES, CNT_L1D_MISSES, CNT_RAW, _COUNT_CNTS };
+
+static char const * const g_counter_names [_COUNT_CNTS] = {"LLC miss", "L1D miss", "raw"};
+static uint64_t g_raw_config;
+
+typedef struct Counters {
+    int         fd[_COUNT_CNTS];
+    int64_t     value[_COUNT_CNTS];
+} Counters;
+
+#ifdef __linux__
+static int
+counter_open (uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.inherit = 1;           // threads started after this count into it
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+static void
+counters_start (Counters * c) {
+    for (int i = 0; i < _COUNT_CNTS; ++i) {
+        c->fd[i] = -1;
+        c->value[i] = -1;
+    }
+#ifdef __linux__
+    c->fd[CNT_CACHE_MISSES] = counter_open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    c->fd[CNT_L1D_MISSES] = counter_open(
+        PERF_TYPE_HW_CACHE,
+        PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)
+    );
+    if (g_raw_config)
+        c->fd[CNT_RAW] = counter_open(PERF_TYPE_RAW, g_raw_config);
+    for (int i = 0; i < _COUNT_CNTS; ++i)
+        if (c->fd[i] >= 0) {
+            ioctl(c->fd[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(c->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+}
+/* After the threads are joined: an exited thread's counts are folded into the parent's */
+static void
+counters_stop (Counters * c) {
+#ifdef __linux__
+    for (int i = 0; i < _COUNT_CNTS; ++i)
+        if (c->fd[i] >= 0) {
+            uint64_t v;
+            ioctl(c->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+            if (sizeof(v) == read(c->fd[i], &v, sizeof(v)))
+                c->value[i] = (int64_t)v;
+            close(c->fd[i]);
+        }
+#else
+    (void)c;
+#endif
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region layouts
+/* app01's slot: a stamp and the element, 12 bytes */
+typedef struct Slot {
+    int volatile    stamp;
+    int volatile    thread_number;
+    int volatile    request_number;
+} Slot;
+
+typedef struct PaddedSlot {
+    Slot    s;
+    char    pad[MT_CACHE_LINE - sizeof(Slot)];
+} PaddedSlot;
+
+/* The writers' and readers' indices, the shutdown flag and the read-only size */
+typedef struct HotPacked {
+    int64_t volatile    produced;
+    int64_t volatile    consumed;
+    int64_t volatile    shutdown;
+    int64_t volatile    max_elements;
+} HotPacked;
+
+typedef struct PaddedI64 {
+    int64_t volatile    v;
+    char                pad[MT_CACHE_LINE - sizeof(int64_t)];
+} PaddedI64;
+
+typedef struct HotPadded {
+    PaddedI64   produced;
+    PaddedI64   consumed;
+    PaddedI64   shutdown;
+    PaddedI64   max_elements;
+} HotPadded;
+
+static MT_ALIGNED(MT_CACHE_LINE) Slot          g_slots_packed[MAX_THREADS];
+static MT_ALIGNED(MT_CACHE_LINE) PaddedSlot    g_slots_padded[MAX_THREADS];
+static MT_ALIGNED(MT_CACHE_LINE) HotPacked     g_hot_packed;
+static MT_ALIGNED(MT_CACHE_LINE) HotPadded     g_hot_padded;
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region workloads
+typedef struct Job {
+    int                 thread;
+    int                 padded;
+    int64_t volatile *  go;
+    int64_t             sum;        // read back by the thread, checked against what it wrote
+} Job;
+
+static void
+wait_for_go (Job * j) {
+    while (!mt_load_acquire(j->go))
+        mt_yield();
+}
+static void
+slots_job (void * arg) {
+    Job * j = (Job *)arg;
+    Slot * s = j->padded ? &g_slots_padded[j->thread].s : &g_slots_packed[j->thread];
+    int64_t sum = 0;    // local: the Job array would be one more shared line
+    wait_for_go(j);
+    for (int k = 1; k <= ITERS; ++k) {
+        // -- writer side
+        s->thread_number = j->thread;
+        s->request_number = k;
+        s->stamp = k;
+        // -- reader side
+        if (s->stamp != 0) {
+            sum += s->request_number;
+            s->stamp = 0;
+        }
+    }
+    j->sum = sum;
+}
+static void
+hot_job (void * arg) {
+    Job * j = (Job *)arg;
+    int64_t volatile * produced = j->padded ? &g_hot_padded.produced.v : &g_hot_packed.produced;
+    int64_t volatile * consumed = j->padded ? &g_hot_padded.consumed.v : &g_hot_packed.consumed;
+    int64_t volatile * shutdown = j->padded ? &g_hot_padded.shutdown.v : &g_hot_packed.shutdown;
+    int64_t volatile * max_elements = j->padded ? &g_hot_padded.max_elements.v : &g_hot_packed.max_elements;
+    int64_t volatile * mine = (j->thread % 2) ? consumed : produced;
+    int64_t sum = 0;
+    wait_for_go(j);
+    for (int k = 0; k < ITERS && !mt_load_relaxed(shutdown); ++k) {
+        sum += mt_load_relaxed(max_elements) > 0;
+        mt_fetch_add(mine, 1);
+    }
+    j->sum = sum;
+}
+
+static int
+check_slots (Job const * jobs, int n) {
+    for (int i = 0; i < n; ++i)
+        if (jobs[i].sum != (int64_t)ITERS * (ITERS + 1) / 2 || g_slots_packed[i].stamp || g_slots_padded[i].s.stamp)
+            return 0;
+    return 1;
+}
+static int
+check_hot (Job const * jobs, int n) {
+    int64_t producers = (n + 1) / 2, consumers = n / 2;
+    HotPacked const * p = &g_hot_packed;
+    HotPadded const * q = &g_hot_padded;
+    for (int i = 0; i < n; ++i)
+        if (jobs[i].sum != ITERS)
+            return 0;
+    if (jobs[0].padded)
+        return q->produced.v == producers * ITERS && q->consumed.v == consumers * ITERS;
+    return p->produced == producers * ITERS && p->consumed == consumers * ITERS;
+}
+static void
+reset_layouts (void) {
+    memset(g_slots_packed, 0, sizeof(g_slots_packed));
+    memset(g_slots_padded, 0, sizeof(g_slots_padded));
+    memset(&g_hot_packed, 0, sizeof(g_hot_packed));
+    memset(&g_hot_padded, 0, sizeof(g_hot_padded));
+    g_hot_packed.max_elements = 10;
+    g_hot_padded.max_elements.v = 10;
+}
+#pragma endregion
+
+// =========================================================================================
+
+typedef struct Result {
+    double      mops;                   // best of BENCH_REPS
+    double      per_op[_COUNT_CNTS];    // counter / operation on the best run, <0 when unavailable
+    int         ok;
+} Result;
+
+static Result
+measure (MtThreadFn fn, int (*check) (Job const *, int), int n, int padded) {
+    Result r;
+    memset(&r, 0, sizeof(r));
+    r.ok = 1;
+    double best = 1e30;
+    for (int rep = 0; rep < BENCH_REPS; ++rep) {
+        Job jobs[MAX_THREADS];
+        MtThread threads[MAX_THREADS];
+        Counters c;
+        int64_t volatile go = 0;
+        int started = 0;
+
+        reset_layouts();
+        counters_start(&c);
+        for (int i = 0; i < n; ++i) {
+            jobs[i].thread = i;
+            jobs[i].padded = padded;
+            jobs[i].go = &go;
+            jobs[i].sum = 0;
+            started += mt_thread_create(&threads[i], fn, &jobs[i]);
+        }
+        int64_t t = mt_now_ns();
+        mt_store_release(&go, 1);
+        for (int i = 0; i < started; ++i)
+            mt_thread_join(threads[i]);
+        t = mt_now_ns() - t;
+        counters_stop(&c);
+
+        r.ok &= (started == n) && check(jobs, n);
+        if ((double)t < best) {
+            best = (double)t;
+            for (int k = 0; k < _COUNT_CNTS; ++k)
+                r.per_op[k] = (c.value[k] < 0) ? -1.0 : (double)c.value[k] / ((double)n * ITERS);
+        }
+    }
+    r.mops = (double)n * ITERS / best * 1e3;
+    return r;
+}
+
+static void
+bench_layout (char const * title, MtThreadFn fn, int (*check) (Job const *, int)) {
+    printf("\n%s: M ops per second and counter events per op (best of %d)\n", title, BENCH_REPS);
+    printf("%8s %10s %10s", "threads", "packed", "padded");
+    for (int k = 0; k < _COUNT_CNTS; ++k)
+        if (k != CNT_RAW || g_raw_config)
+            printf("  %8s %8s", g_counter_names[k], "(padded)");
+    printf("\n");
+
+    for (size_t t = 0; t < _countof(g_threads); ++t) {
+        Result packed = measure(fn, check, g_threads[t], 0);
+        Result padded = measure(fn, check, g_threads[t], 1);
+        printf("%8d %10.1f %10.1f", g_threads[t], packed.mops, padded.mops);
+        for (int k = 0; k < _COUNT_CNTS; ++k) {
+            if (k == CNT_RAW && !g_raw_config)
+                continue;
+            if (packed.per_op[k] < 0 || padded.per_op[k] < 0)
+                printf("  %8s %8s", "-", "-");
+            else
+                printf("  %8.4f %8.4f", packed.per_op[k], padded.per_op[k]);
+        }
+        printf("%s\n", (packed.ok && padded.ok) ? "" : "  (MISMATCH)");
+        fflush(stdout);
+    }
+}
+
+int main (int argc, char * argv []) {
+    for (int i = 1; i < argc; ++i)
+        if (0 == strncmp(argv[i], "raw=", 4))
+            g_raw_config = strtoull(argv[i] + 4, NULL, 16);
+
+    Counters probe;
+    counters_start(&probe);
+    counters_stop(&probe);
+    printf(
+        "%d logical processors, perf counters %s\n", mt_cpu_count(),
+        (probe.value[CNT_CACHE_MISSES] >= 0) ? "available" : "not available"
+    );
+
+    if (BenchUtil_Wanted(argc, argv, "slots"))
+        bench_layout("slots (12-byte slots, each thread on its own)", slots_job, check_slots);
+    if (BenchUtil_Wanted(argc, argv, "hot"))
+        bench_layout("hot (writer/reader counters, shutdown flag, size)", hot_job, check_hot);
+    return(0);
+}
@@ -0,0 +1,258 @@
+/* ===========================================================
+   #File: numa_bench.c #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: One global queue vs a shard per NUMA node / core group, threads pinned #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+/*
+Every domain of the topology runs PAIRS producer/consumer pairs (by
+default one per two of its processors), each thread pinned to its domain.
+Messages are a cache line; consumers check the sum of what they pop.
+
+    balanced    every domain produces
+    skewed      only domain 0 produces: the other domains live off stealing
+
+in two layouts:
+
+    global      common/sharded_queue with a single shard on domain 0's
+                node: app01/app03's one g_q
+    sharded     a shard per domain: push local, pop local, steal after
+                STEAL_AFTER empty polls of the local shard
+
+Reported: messages per second and the share popped by a consumer of the
+shard's own domain.
+
+numa_bench [balanced] [skewed] [groups=<cpus>] [pairs=<n>]; no workload
+names run both. groups splits nodes into core groups of that many
+logical processors (on a one-node machine, the only way to get shards).
+*/
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L    /* clock_gettime */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../common/mt_platform.h"
+#include "../common/sharded_queue.h"
+#include "../common/thread_group.h"
+#include "../common/topology.h"
+#include "../../bench/bench_util.h"
+
+#define MESSAGES        (1 << 21)   // in all, split between the producers
+#define CAPACITY        4096        // per shard
+#define STEAL_AFTER     16          // empty local polls before a consumer steals
+
+typedef struct Message {
+    int64_t     value;
+    char        payload[MT_CACHE_LINE - sizeof(int64_t)];
+} Message;
+
+static int g_group_size = 0;
+static int g_pairs = 0;             // 0: per domain, half its processors
+
+// =========================================================================================
+
+#pragma region workers
+typedef struct Run {
+    Topology const *    topo;       // the machine's, for pinning
+    ShardedQueue        q;
+    int                 sharded;
+    Latch               start;
+    int64_t volatile    producers_left;
+    int64_t volatile    sum;
+    int64_t volatile    popped;
+    int64_t volatile    unpinned;
+} Run;
+
+typedef struct Worker {
+    Run *       run;
+    int         domain;
+    int         producer;
+    int64_t     first;          // producers: the values first..last
+    int64_t     last;
+} Worker;
+
+static void
+worker (void * arg) {
+    Worker * w = (Worker *)arg;
+    Run * r = w->run;
+    int shard = r->sharded ? w->domain : 0;
+    Message m;
+    memset(&m, 0, sizeof(m));
+    if (!Topology_PinToDomain(r->topo, w->domain))
+        mt_fetch_add(&r->unpinned, 1);
+    Latch_CountDown(&r->start);
+    Latch_Wait(&r->start, MT_INFINITE);
+
+    if (w->producer) {
+        for (int64_t v = w->first; v <= w->last; ++v) {
+            m.value = v;
+            while (!ShardedQueue_Push(&r->q, shard, &m))
+                mt_yield();     // full: let the consumers catch up
+        }
+        mt_fetch_add(&r->producers_left, -1);
+    } else {
+        int64_t sum = 0, popped = 0;
+        int idle = 0;
+        for (;;) {
+            // -- local while there is local work; steal only after STEAL_AFTER empty polls
+            int got = ShardedQueue_PopLocal(&r->q, shard, &m);
+            if (!got && ++idle >= STEAL_AFTER)
+                got = ShardedQueue_Pop(&r->q, shard, &m, NULL);
+            if (got) {
+                sum += m.value;
+                popped++;
+                idle = 0;
+            } else if (idle < STEAL_AFTER) {
+                mt_yield();
+            } else if (0 == mt_load_acquire(&r->producers_left) && 0 == ShardedQueue_Count(&r->q)) {
+                break;
+            } else {
+                mt_yield();
+            }
+        }
+        mt_fetch_add(&r->sum, sum);
+        mt_fetch_add(&r->popped, popped);
+    }
+}
+#pragma endregion
+
+// =========================================================================================
+
+typedef struct Result {
+    double      seconds;
+    double      local;          // share of pops by the shard's own domain
+    int         ok;
+    int64_t     unpinned;
+} Result;
+
+static void
+run_once (Topology const * topo, int sharded, int skewed, Result * res) {
+    Run * r = (Run *)calloc(1, sizeof(Run));
+    Topology one = *topo;           // the global layout: domain 0's node only, not to be freed
+    one.n_domains = 1;
+    int n_domains = topo->n_domains;
+
+    int n_workers = 0, n_producers = 0;
+    for (int d = 0; d < n_domains; ++d) {
+        int pairs = g_pairs ? g_pairs : (topo->domains[d].n_cpus + 1) / 2;
+        n_workers += 2 * pairs;
+        n_producers += (!skewed || 0 == d) ? pairs : 0;
+    }
+    Worker * ws = (Worker *)calloc((size_t)n_workers, sizeof(Worker));
+    ThreadGroup g;
+
+    r->topo = topo;
+    r->sharded = sharded;
+    r->producers_left = n_producers;
+    if (!ShardedQueue_Init(&r->q, sharded ? topo : &one, sizeof(Message), CAPACITY)) {
+        res->ok = 0;
+        free(ws);
+        free(r);
+        return;
+    }
+    Latch_Init(&r->start, n_workers + 1);
+    ThreadGroup_Init(&g);
+
+    // -- producers split 1..MESSAGES; in skewed runs domain 0's pairs produce, the rest only consume
+    int64_t per = MESSAGES / n_producers, next = 1;
+    int k = 0, p = 0;
+    for (int d = 0; d < n_domains; ++d) {
+        int pairs = g_pairs ? g_pairs : (topo->domains[d].n_cpus + 1) / 2;
+        for (int i = 0; i < 2 * pairs; ++i, ++k) {
+            ws[k].run = r;
+            ws[k].domain = d;
+            ws[k].producer = (i % 2 == 0) && (!skewed || 0 == d);
+            if (ws[k].producer) {
+                ws[k].first = next;
+                ws[k].last = (++p == n_producers) ? MESSAGES : next + per - 1;
+                next = ws[k].last + 1;
+            }
+            res->ok &= ThreadGroup_Spawn(&g, worker, &ws[k]);
+        }
+    }
+    Latch_CountDown(&r->start);
+    Latch_Wait(&r->start, MT_INFINITE);
+    int64_t t = mt_now_ns();
+    ThreadGroup_Join(&g, MT_INFINITE);
+    res->seconds = (double)(mt_now_ns() - t) * 1e-9;
+
+    int64_t local = 0, stolen = 0;
+    for (int s = 0; s < r->q.n_shards; ++s) {
+        ShardStats st;
+        ShardedQueue_GetStats(&r->q, s, &st);
+        local += st.popped_local;
+        stolen += st.stolen;
+    }
+    // -- the global layout has one shard: its pops count as local, but only domain 0's are
+    res->local = sharded ? (double)local / (double)(local + stolen) : 1.0 / n_domains;
+    res->ok &= (r->popped == MESSAGES && r->sum == (int64_t)MESSAGES * (MESSAGES + 1) / 2);
+    res->unpinned = r->unpinned;
+
+    ThreadGroup_Deinit(&g);
+    Latch_Deinit(&r->start);
+    ShardedQueue_Deinit(&r->q);
+    free(ws);
+    free(r);
+}
+
+static void
+bench (Topology const * topo, char const * name, int skewed) {
+    printf("\n%s: %d messages of %d bytes, %d per shard\n", name, MESSAGES, (int)sizeof(Message), CAPACITY);
+    printf("%-8s %10s %12s %8s\n", "layout", "ms", "M msg/s", "local%");
+    for (int sharded = 0; sharded < 2; ++sharded) {
+        Result best = {1e30, 0, 1, 0};
+        for (int rep = 0; rep < BENCH_REPS; ++rep) {
+            Result res = {0, 0, 1, 0};
+            run_once(topo, sharded, skewed, &res);
+            best.ok &= res.ok;
+            best.unpinned += res.unpinned;
+            if (res.seconds > 0 && res.seconds < best.seconds) {
+                best.seconds = res.seconds;
+                best.local = res.local;
+            }
+        }
+        printf("%-8s %10.1f %12.2f %8.1f%s%s\n", sharded ? "sharded" : "global",
+            best.seconds * 1e3, MESSAGES / best.seconds * 1e-6, best.local * 100,
+            best.unpinned ? "  (unpinned)" : "", best.ok ? "" : "  (MISMATCH)");
+        fflush(stdout);
+    }
+}
+
+// =========================================================================================
+
+int main (int argc, char * argv []) {
+    Topology topo;
+    for (int i = 1; i < argc; ++i) {
+        if (0 == strncmp(argv[i], "groups=", 7))
+            g_group_size = atoi(argv[i] + 7);
+        else if (0 == strncmp(argv[i], "pairs=", 6))
+            g_pairs = atoi(argv[i] + 6);
+    }
+    if (!Topology_Detect(&topo, g_group_size)) {
+        printf("cannot list the processors\n");
+        return(1);
+    }
+    printf("%d NUMA node(s), %d domain(s):\n", topo.n_nodes, topo.n_domains);
+    for (int d = 0; d < topo.n_domains; ++d) {
+        printf("  domain %d: node %d, cpus", d, topo.domains[d].node);
+        for (int i = 0; i < topo.domains[d].n_cpus; ++i)
+            printf(" %d", topo.domains[d].cpus[i]);
+        printf("\n");
+    }
+
+    if (BenchUtil_Wanted(argc, argv, "balanced"))
+        bench(&topo, "balanced", 0);
+    if (BenchUtil_Wanted(argc, argv, "skewed"))
+        bench(&topo, "skewed", 1);
+    Topology_Deinit(&topo);
+    return(0);
+}
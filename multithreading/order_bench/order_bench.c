@@ -0,0 +1,286 @@
+/* ===========================================================
+   #File: order_bench.c #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Queue orders under bursts: deadline misses, starvation and cost per operation #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+/*
+    misses      a simulated server pair draining a queue fed at 60% of its
+                capacity plus periodic bursts, about 84% in all; requests carry a priority
+                (0..3) and a deadline (tighter for higher priority). Every
+                order is common/urgency_queue with other parameters:
+                    fifo            key = arrival
+                    strict          key = arrival + priority * huge
+                    edf             key = deadline
+                    urgency         key = min(deadline, arrival + priority * aging)
+    cost        ns per push + pop at a given size: urgency_queue's heaps vs
+                app01's stamp scan (a linear search for a free slot and
+                another for the oldest stamp of the class)
+
+order_bench [misses] [cost]; no arguments runs both.
+*/
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L    /* clock_gettime */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../common/mt_platform.h"
+#include "../common/urgency_queue.h"
+#include "../../bench/bench_util.h"
+
+#ifndef _countof
+#define _countof(a) (sizeof(a) / sizeof((a)[0]))
+#endif
+
+#define LEVELS          4           // priorities 0..3
+#define REQUESTS        (1 << 18)
+#define SERVERS         2
+#define SERVICE         100         // time units per request
+#define BASE_LOAD       60          // % of the servers' capacity, between bursts
+#define BURST_EVERY     20000       // a burst arrives this often...
+#define BURST_SIZE      96          // ...this big
+#define AGING           3000        // urgency order: per priority level
+#define HUGE_AGING      ((int64_t)1 << 40)
+
+static int64_t const g_sla [LEVELS] = {400, 1200, 3000, 8000};     // deadline after arrival
+
+// =========================================================================================
+
+#pragma region misses
+typedef struct Request {
+    int64_t     arrival;
+    int64_t     deadline;
+    int         priority;
+} Request;
+
+typedef struct Order {
+    char const *    name;
+    int64_t         aging;
+    int             use_deadline;
+    int             priority;       // -1: the request's own
+} Order;
+
+static Order const g_orders [] = {
+    {"fifo",        0,          0, 0},
+    {"strict",      HUGE_AGING, 0, -1},
+    {"edf",         HUGE_AGING, 1, 1},
+    {"urgency",     AGING,      1, -1},
+};
+
+static uint64_t
+xorshift (uint64_t * s) {
+    *s ^= *s << 13;
+    *s ^= *s >> 7;
+    *s ^= *s << 17;
+    return *s;
+}
+/* Arrivals at BASE_LOAD of the servers' capacity, uniform gaps, plus a burst every BURST_EVERY */
+static Request *
+make_requests (void) {
+    Request * r = (Request *)malloc(sizeof(Request) * REQUESTS);
+    uint64_t rng = 0x2545F4914F6CDD1DULL;
+    int64_t t = 0, next_burst = BURST_EVERY;
+    int64_t mean_gap = SERVICE * 100 / (SERVERS * BASE_LOAD);
+    for (int i = 0; i < REQUESTS; ) {
+        int n = 1;
+        if (t >= next_burst) {
+            n = BURST_SIZE;
+            next_burst += BURST_EVERY;
+        } else {
+            t += (int64_t)(xorshift(&rng) % (uint64_t)(2 * mean_gap + 1));
+        }
+        for (int k = 0; k < n && i < REQUESTS; ++k, ++i) {
+            uint64_t x = xorshift(&rng) % 10;   // 10% p0, 20% p1, 30% p2, 40% p3
+            r[i].priority = (x < 1) ? 0 : (x < 3) ? 1 : (x < 6) ? 2 : 3;
+            r[i].arrival = t;
+            r[i].deadline = t + g_sla[r[i].priority];
+        }
+    }
+    return r;
+}
+
+typedef struct Outcome {
+    int64_t     missed[LEVELS];
+    int64_t     count[LEVELS];
+    int64_t     max_wait[LEVELS];
+    int64_t     served;
+    int64_t     order_errors;       // served a request while a more urgent one was queued
+} Outcome;
+
+static void
+simulate (Request const * reqs, Order const * o, Outcome * out) {
+    UrgencyQueue q;
+    int64_t server_free[SERVERS] = {0};
+    int next = 0;
+    memset(out, 0, sizeof(*out));
+    if (!UrgencyQueue_Init(&q, sizeof(int), REQUESTS, 1, o->aging))
+        return;
+
+    while (out->served < REQUESTS) {
+        // -- the server that frees up first takes the next request
+        int s = 0;
+        for (int k = 1; k < SERVERS; ++k)
+            if (server_free[k] < server_free[s])
+                s = k;
+        int64_t now = server_free[s];
+        if (0 == UrgencyQueue_Count(&q, 0) && reqs[next].arrival > now)
+            now = reqs[next].arrival;   // idle until the next arrival
+        for (; next < REQUESTS && reqs[next].arrival <= now; ++next) {
+            Request const * r = &reqs[next];
+            int64_t deadline = o->use_deadline ? r->deadline : r->arrival + HUGE_AGING * LEVELS;
+            int priority = (o->priority < 0) ? r->priority : o->priority;
+            UrgencyQueue_Push(&q, 0, priority, deadline, r->arrival, &next);
+        }
+
+        int i;
+        int64_t key;
+        UrgencyQueue_Pop(&q, 0, &i, &key);
+        Request const * r = &reqs[i];
+        int64_t wait = now - r->arrival;
+        out->count[r->priority]++;
+        out->missed[r->priority] += (now + SERVICE > r->deadline);
+        if (wait > out->max_wait[r->priority])
+            out->max_wait[r->priority] = wait;
+        server_free[s] = now + SERVICE;
+        out->served++;
+
+        // -- what is left on top must never be more urgent than what was just served
+        if (UrgencyQueue_Count(&q, 0) > 0)
+            out->order_errors += (q.keys[q.heaps[0]] < key);
+    }
+    UrgencyQueue_Deinit(&q);
+}
+
+static void
+bench_misses (void) {
+    Request * reqs = make_requests();
+    printf("\nmisses: %d requests, %d servers, %d units each, bursts of %d every %d units\n",
+        REQUESTS, SERVERS, SERVICE, BURST_SIZE, BURST_EVERY);
+    printf("%-10s %8s", "order", "missed%");
+    for (int p = 0; p < LEVELS; ++p)
+        printf("  p%d miss%%", p);
+    for (int p = 0; p < LEVELS; ++p)
+        printf("  p%d max wait", p);
+    printf("\n");
+
+    for (size_t k = 0; k < _countof(g_orders); ++k) {
+        Outcome o;
+        int64_t missed = 0;
+        simulate(reqs, &g_orders[k], &o);
+        for (int p = 0; p < LEVELS; ++p)
+            missed += o.missed[p];
+        printf("%-10s %8.2f", g_orders[k].name, 100.0 * (double)missed / (double)REQUESTS);
+        for (int p = 0; p < LEVELS; ++p)
+            printf("  %8.2f", o.count[p] ? 100.0 * (double)o.missed[p] / (double)o.count[p] : 0.0);
+        for (int p = 0; p < LEVELS; ++p)
+            printf("  %11lld", (long long)o.max_wait[p]);
+        printf("%s\n", (o.served == REQUESTS && 0 == o.order_errors) ? "" : "  (MISORDERED)");
+    }
+    free(reqs);
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region cost
+/* app01's stamped queue, as it was: linear scans, two classes by parity */
+typedef struct StampSlot {
+    int     stamp;      // 0 means free
+    int     request_number;
+    int     priority;
+} StampSlot;
+
+static int
+stamp_push (StampSlot * slots, int n, int * curr_stamp, int request_number) {
+    for (int i = 0; i < n; ++i)
+        if (0 == slots[i].stamp) {
+            slots[i].request_number = request_number;
+            slots[i].stamp = ++*curr_stamp;
+            return 1;
+        }
+    return 0;
+}
+static int
+stamp_pop (StampSlot * slots, int n, int curr_stamp, int cls) {
+    int ret = -1, first = curr_stamp + 1;
+    for (int i = 0; i < n; ++i)
+        if (slots[i].stamp != 0 && (slots[i].request_number % 2) == cls && slots[i].stamp < first) {
+            first = slots[i].stamp;
+            ret = i;
+        }
+    if (ret >= 0)
+        slots[ret].stamp = 0;
+    return ret >= 0;
+}
+
+static int const g_sizes [] = {16, 64, 256, 1024, 4096};
+
+/* Fill to half, then OPS push/pop pairs, alternating classes; ns per pair */
+static double
+cost_heap (int size, int64_t ops) {
+    UrgencyQueue q;
+    uint64_t rng = 88172645463325252ULL;
+    int msg = 0, half = size / 2;
+    UrgencyQueue_Init(&q, sizeof(int), size, 2, AGING);
+    for (int i = 0; i < half; ++i)
+        UrgencyQueue_Push(&q, i % 2, (int)(xorshift(&rng) % LEVELS), i + 5000, i, &i);
+    int64_t t = mt_now_ns();
+    for (int64_t i = 0; i < ops; ++i) {
+        UrgencyQueue_Push(&q, (int)(i % 2), (int)(xorshift(&rng) % LEVELS), i + 5000, i, &msg);
+        UrgencyQueue_Pop(&q, (int)(i % 2), &msg, NULL);
+    }
+    t = mt_now_ns() - t;
+    UrgencyQueue_Deinit(&q);
+    return (double)t / (double)ops;
+}
+static double
+cost_stamp (int size, int64_t ops) {
+    StampSlot * slots = (StampSlot *)calloc((size_t)size, sizeof(StampSlot));
+    int curr_stamp = 0, half = size / 2;
+    for (int i = 0; i < half; ++i)
+        stamp_push(slots, size, &curr_stamp, i);
+    int64_t t = mt_now_ns();
+    for (int64_t i = 0; i < ops; ++i) {
+        stamp_push(slots, size, &curr_stamp, (int)i);
+        stamp_pop(slots, size, curr_stamp, (int)(i % 2));
+    }
+    t = mt_now_ns() - t;
+    free(slots);
+    return (double)t / (double)ops;
+}
+
+static void
+bench_cost (void) {
+    printf("\ncost: ns per push + pop, queue half full (best of %d)\n", BENCH_REPS);
+    printf("%8s %12s %12s\n", "size", "heaps", "stamp scan");
+    for (size_t k = 0; k < _countof(g_sizes); ++k) {
+        int64_t ops = (int64_t)(1 << 24) / g_sizes[k];
+        double heap = 1e30, scan = 1e30;
+        for (int rep = 0; rep < BENCH_REPS; ++rep) {
+            double h = cost_heap(g_sizes[k], ops * 4), s = cost_stamp(g_sizes[k], ops);
+            heap = (h < heap) ? h : heap;
+            scan = (s < scan) ? s : scan;
+        }
+        printf("%8d %12.1f %12.1f\n", g_sizes[k], heap, scan);
+    }
+}
+#pragma endregion
+
+// =========================================================================================
+
+int main (int argc, char * argv []) {
+    if (BenchUtil_Wanted(argc, argv, "misses"))
+        bench_misses();
+    if (BenchUtil_Wanted(argc, argv, "cost"))
+        bench_cost();
+    return(0);
+}
@@ -0,0 +1,353 @@
+/* ===========================================================
+   #File: pool_bench.c #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Work-stealing pool vs dedicated threads on a shared queue #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+/*
+The dedicated model is what app01 does: a fixed set of threads around one
+queue guarded by a lock and a condition variable. The pool is
+common/thread_pool. Both run the same three workloads:
+
+    flat        one thread submits many small tasks, then waits
+    tree        every task submits two children, 2^20 leaves
+    latency     bursts of tasks; the delay from submit to start, by percentile
+
+pool_bench [flat] [tree] [latency]; no arguments runs all three.
+*/
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L    /* clock_gettime */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../common/mt_platform.h"
+#include "../common/thread_pool.h"
+#include "../../bench/bench_util.h"
+
+#define FLAT_TASKS      (1 << 20)
+#define TREE_DEPTH      20
+#define TASK_SPINS      200         // work per task, a few hundred ns
+#define LAT_BURSTS      2000
+
+// =========================================================================================
+
+#pragma region dedicated
+/* Dedicated threads: one shared ring under a lock, a condition variable to sleep on */
+typedef struct DedicatedTask {
+    PoolTaskFn  fn;
+    void *      arg;
+} DedicatedTask;
+
+typedef struct Dedicated {
+    MtLock              lock;
+    MtCond              not_empty;
+    MtCond              done;
+    DedicatedTask *     ring;
+    size_t              cap, head, count;
+    int64_t             pending;        // under lock
+    int                 shutdown;
+    int                 n_threads;
+    MtThread            threads[64];
+} Dedicated;
+
+static void
+dedicated_main (void * arg) {
+    Dedicated * d = (Dedicated *)arg;
+    mt_lock(&d->lock);
+    for (;;) {
+        while (0 == d->count && !d->shutdown)
+            mt_cond_wait(&d->not_empty, &d->lock);
+        if (0 == d->count)
+            break;
+        DedicatedTask t = d->ring[d->head];
+        d->head = (d->head + 1) % d->cap;
+        d->count--;
+        mt_unlock(&d->lock);
+
+        t.fn(t.arg);
+
+        mt_lock(&d->lock);
+        if (0 == --d->pending)
+            mt_cond_broadcast(&d->done);
+    }
+    mt_unlock(&d->lock);
+}
+static void
+dedicated_init (Dedicated * d, int n_threads) {
+    memset(d, 0, sizeof(*d));
+    mt_lock_init(&d->lock);
+    mt_cond_init(&d->not_empty);
+    mt_cond_init(&d->done);
+    d->cap = 1024;
+    d->ring = (DedicatedTask *)malloc(d->cap * sizeof(DedicatedTask));
+    d->n_threads = n_threads;
+    for (int i = 0; i < n_threads; i++)
+        mt_thread_create(&d->threads[i], dedicated_main, d);
+}
+static void
+dedicated_submit (Dedicated * d, PoolTaskFn fn, void * arg) {
+    mt_lock(&d->lock);
+    if (d->count == d->cap) {
+        DedicatedTask * ring = (DedicatedTask *)malloc(2 * d->cap * sizeof(DedicatedTask));
+        for (size_t i = 0; i < d->count; i++)
+            ring[i] = d->ring[(d->head + i) % d->cap];
+        free(d->ring);
+        d->ring = ring;
+        d->head = 0;
+        d->cap *= 2;
+    }
+    d->ring[(d->head + d->count) % d->cap].fn = fn;
+    d->ring[(d->head + d->count) % d->cap].arg = arg;
+    d->count++;
+    d->pending++;
+    mt_cond_signal(&d->not_empty);
+    mt_unlock(&d->lock);
+}
+static void
+dedicated_wait (Dedicated * d) {
+    mt_lock(&d->lock);
+    while (d->pending != 0)
+        mt_cond_wait(&d->done, &d->lock);
+    mt_unlock(&d->lock);
+}
+static void
+dedicated_deinit (Dedicated * d) {
+    mt_lock(&d->lock);
+    d->shutdown = 1;
+    mt_cond_broadcast(&d->not_empty);
+    mt_unlock(&d->lock);
+    for (int i = 0; i < d->n_threads; i++)
+        mt_thread_join(d->threads[i]);
+    free(d->ring);
+    mt_lock_deinit(&d->lock);
+    mt_cond_deinit(&d->not_empty);
+    mt_cond_deinit(&d->done);
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region executors
+/* One of the two models, so the workloads are written once */
+typedef struct Executor {
+    char const *    name;
+    int             is_pool;
+    ThreadPool      pool;
+    Dedicated       dedicated;
+} Executor;
+
+static Executor * g_exec;
+
+static void
+exec_submit (PoolTaskFn fn, void * arg) {
+    if (g_exec->is_pool) {
+        while (!ThreadPool_Submit(&g_exec->pool, fn, arg))
+            mt_yield();     // out of task records: let the workers drain some
+    } else {
+        dedicated_submit(&g_exec->dedicated, fn, arg);
+    }
+}
+static void
+exec_wait (void) {
+    if (g_exec->is_pool)
+        ThreadPool_Wait(&g_exec->pool);
+    else
+        dedicated_wait(&g_exec->dedicated);
+}
+static int
+exec_start (Executor * e, int is_pool, int n_threads) {
+    memset(e, 0, sizeof(*e));
+    e->is_pool = is_pool;
+    e->name = is_pool ? "pool" : "dedicated";
+    g_exec = e;
+    if (is_pool)
+        return ThreadPool_Init(&e->pool, n_threads);
+    dedicated_init(&e->dedicated, n_threads);
+    return 1;
+}
+static void
+exec_stop (Executor * e) {
+    if (e->is_pool)
+        ThreadPool_Deinit(&e->pool);
+    else
+        dedicated_deinit(&e->dedicated);
+    g_exec = NULL;
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region workloads
+static volatile int64_t g_sum;
+
+static void
+spin_work (uintptr_t seed) {
+    volatile uint32_t x = (uint32_t)seed;
+    for (int i = 0; i < TASK_SPINS; i++)
+        x = x * 1664525u + 1013904223u;
+}
+static void
+flat_task (void * arg) {
+    spin_work((uintptr_t)arg);
+    mt_fetch_add(&g_sum, (int64_t)(uintptr_t)arg);
+}
+static double
+run_flat (void) {
+    int64_t t = mt_now_ns();
+    for (uintptr_t i = 0; i < FLAT_TASKS; i++)
+        exec_submit(flat_task, (void *)i);
+    exec_wait();
+    return (double)(mt_now_ns() - t) * 1e-9;
+}
+static int
+check_flat (void) {
+    return g_sum == (int64_t)FLAT_TASKS * (FLAT_TASKS - 1) / 2;
+}
+
+/* The depth rides in the argument; leaves count themselves */
+static void
+tree_task (void * arg) {
+    uintptr_t depth = (uintptr_t)arg;
+    spin_work(depth);
+    if (0 == depth) {
+        mt_fetch_add(&g_sum, 1);
+        return;
+    }
+    exec_submit(tree_task, (void *)(depth - 1));
+    exec_submit(tree_task, (void *)(depth - 1));
+}
+static double
+run_tree (void) {
+    int64_t t = mt_now_ns();
+    exec_submit(tree_task, (void *)(uintptr_t)TREE_DEPTH);
+    exec_wait();
+    return (double)(mt_now_ns() - t) * 1e-9;
+}
+static int
+check_tree (void) {
+    return g_sum == ((int64_t)1 << TREE_DEPTH);
+}
+
+/* Each task writes its own start delay into the slot its argument points at */
+typedef struct LatencySlot {
+    int64_t submitted;
+    int64_t delay;
+} LatencySlot;
+
+static void
+latency_task (void * arg) {
+    LatencySlot * s = (LatencySlot *)arg;
+    s->delay = mt_now_ns() - s->submitted;
+    spin_work((uintptr_t)s);
+}
+static int
+compare_i64 (void const * a, void const * b) {
+    int64_t x = *(int64_t const *)a, y = *(int64_t const *)b;
+    return (x > y) - (x < y);
+}
+#pragma endregion
+
+// =========================================================================================
+
+static void
+thread_counts (int * counts, int * n) {
+    int cores = mt_cpu_count();
+    int k = 0;
+    for (int c = 1; c < cores && c <= 16 && k < 4; c *= 2)
+        counts[k++] = c;
+    counts[k++] = (cores < 64) ? cores : 64;
+    *n = k;
+}
+
+static void
+bench_throughput (char const * title, double (*run) (void), int (*check) (void), double n_tasks) {
+    int counts[8], n_counts;
+    thread_counts(counts, &n_counts);
+    printf("\n%s: M tasks per second (best of %d)\n%-10s", title, BENCH_REPS, "threads");
+    for (int c = 0; c < n_counts; c++)
+        printf(" %10d", counts[c]);
+    printf("\n");
+
+    for (int is_pool = 0; is_pool < 2; is_pool++) {
+        int ok = 1;
+        printf("%-10s", is_pool ? "pool" : "dedicated");
+        for (int c = 0; c < n_counts; c++) {
+            Executor e;
+            double best = 1e30;
+            if (!exec_start(&e, is_pool, counts[c])) {
+                printf(" %10s", "-");
+                continue;
+            }
+            for (int rep = 0; rep < BENCH_REPS; rep++) {
+                g_sum = 0;
+                double t = run();
+                ok &= check();
+                if (t < best)
+                    best = t;
+            }
+            exec_stop(&e);
+            printf(" %10.2f", n_tasks / best / 1e6);
+            fflush(stdout);
+        }
+        printf("%s\n", ok ? "" : "  (MISMATCH)");
+    }
+}
+
+static void
+bench_latency (void) {
+    int counts[8], n_counts;
+    thread_counts(counts, &n_counts);
+    printf("\nlatency: submit to start in us, bursts of 4 tasks per thread, %d bursts\n", LAT_BURSTS);
+    printf("%-10s %8s %10s %10s %10s %10s\n", "model", "threads", "p50", "p99", "p99.9", "max");
+
+    for (int c = 0; c < n_counts; c++) {
+        for (int is_pool = 0; is_pool < 2; is_pool++) {
+            Executor e;
+            int burst = 4 * counts[c];
+            size_t n = (size_t)burst * LAT_BURSTS;
+            if (!exec_start(&e, is_pool, counts[c]))
+                continue;
+            LatencySlot * slots = (LatencySlot *)malloc(n * sizeof(LatencySlot));
+            int64_t * delays = (int64_t *)malloc(n * sizeof(int64_t));
+            for (int b = 0; b < LAT_BURSTS; b++) {
+                for (int i = 0; i < burst; i++) {
+                    LatencySlot * s = &slots[(size_t)b * burst + i];
+                    s->submitted = mt_now_ns();
+                    exec_submit(latency_task, s);
+                }
+                exec_wait();
+            }
+            exec_stop(&e);
+
+            for (size_t i = 0; i < n; i++)
+                delays[i] = slots[i].delay;
+            qsort(delays, n, sizeof(int64_t), compare_i64);
+            printf(
+                "%-10s %8d %10.1f %10.1f %10.1f %10.1f\n", is_pool ? "pool" : "dedicated", counts[c],
+                delays[n / 2] * 1e-3, delays[n * 99 / 100] * 1e-3, delays[n * 999 / 1000] * 1e-3, delays[n - 1] * 1e-3
+            );
+            free(delays);
+            free(slots);
+        }
+    }
+}
+
+int main (int argc, char * argv []) {
+    printf("%d logical processors\n", mt_cpu_count());
+    if (BenchUtil_Wanted(argc, argv, "flat"))
+        bench_throughput("flat (one submitter)", run_flat, check_flat, (double)FLAT_TASKS);
+    if (BenchUtil_Wanted(argc, argv, "tree"))
+        bench_throughput("tree (tasks submit tasks)", run_tree, check_tree, (double)((2 << TREE_DEPTH) - 1));
+    if (BenchUtil_Wanted(argc, argv, "latency"))
+        bench_latency();
+    return(0);
+}
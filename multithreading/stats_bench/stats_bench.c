@@ -0,0 +1,257 @@
+/* ===========================================================
+   #File: stats_bench.c #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Cost of common/queue_stats on a queue's hot path, and what its dumps look like #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+/*
+    overhead    T threads each count OPS enqueues, dequeues (with latency)
+                and lock acquisitions, as a queue would:
+                    none        no telemetry, the loop alone
+                    shared      the same atomic adds into one set of
+                                counters and histograms for every thread
+                    sharded     common/queue_stats
+                ns per operation (enqueue + dequeue + lock), and a check
+                that the snapshot adds up
+    dump        producers and consumers on a small locked ring counted
+                with QueueStats; the final snapshot as text and as JSON
+
+stats_bench [overhead] [dump]; no arguments runs both.
+*/
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L    /* clock_gettime */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../common/mt_platform.h"
+#include "../common/queue_stats.h"
+#include "../common/thread_group.h"
+#include "../../bench/bench_util.h"
+
+#ifndef _countof
+#define _countof(a) (sizeof(a) / sizeof((a)[0]))
+#endif
+
+#define OPS             (1 << 19)   // per thread
+#define RING            64
+#define ITEMS           200000      // dump: per producer
+#define DUMP_PAIRS      2
+
+static int const g_threads [] = {1, 2, 4, 8};
+
+// =========================================================================================
+
+#pragma region overhead
+typedef enum Mode { MODE_NONE, MODE_SHARED, MODE_SHARDED } Mode;
+static char const * const g_modes [] = {"none", "shared", "sharded"};
+
+typedef struct Overhead {
+    Mode                mode;
+    QueueStats *        stats;
+    QueueStatsShard *   shared;     // MODE_SHARED: everybody's
+    Latch               start;
+    int64_t volatile    sink;
+} Overhead;
+
+static void
+overhead_worker (void * arg) {
+    Overhead * o = (Overhead *)arg;
+    int64_t sink = 0;
+    Latch_CountDown(&o->start);
+    Latch_Wait(&o->start, MT_INFINITE);
+    for (int64_t i = 0; i < OPS; ++i) {
+        // -- a stamp from the recent past, as a dequeued element would carry
+        int64_t stamp = mt_now_ns() - 1000;
+        int64_t depth = i & 63;
+        switch (o->mode) {
+        case MODE_NONE:
+            sink += stamp + depth;
+            break;
+        case MODE_SHARED: {
+            QueueStatsShard * sh = o->shared;
+            int64_t lat = mt_now_ns() - stamp;
+            mt_fetch_add(&sh->counters[QSTAT_ENQUEUE], 1);
+            mt_fetch_add(&sh->depth[depth], 1);
+            mt_fetch_add(&sh->counters[QSTAT_DEQUEUE], 1);
+            mt_fetch_add(&sh->latency[(lat >> 6) & (QUEUE_STATS_BUCKETS - 1)], 1);
+            mt_fetch_add(&sh->counters[QSTAT_LOCK_ACQUIRE], 1);
+            break;
+        }
+        case MODE_SHARDED:
+            QueueStats_Enqueue(o->stats, depth);
+            QueueStats_Dequeue(o->stats, stamp);
+            QueueStats_LockAcquired(o->stats, 0);
+            break;
+        }
+    }
+    mt_fetch_add(&o->sink, sink);
+}
+
+static void
+bench_overhead (void) {
+    printf("\noverhead: %d enqueue + dequeue + lock per thread, ns each\n", OPS);
+    printf("%8s %10s %10s %10s\n", "threads", g_modes[0], g_modes[1], g_modes[2]);
+    for (size_t k = 0; k < _countof(g_threads); ++k) {
+        int n = g_threads[k];
+        int ok = 1;
+        printf("%8d", n);
+        for (int mode = MODE_NONE; mode <= MODE_SHARDED; ++mode) {
+            double best = 1e30;
+            for (int rep = 0; rep < BENCH_REPS; ++rep) {
+                Overhead * o = (Overhead *)calloc(1, sizeof(Overhead));
+                o->mode = (Mode)mode;
+                o->stats = (QueueStats *)malloc(sizeof(QueueStats));
+                o->shared = (QueueStatsShard *)calloc(1, sizeof(QueueStatsShard));
+                QueueStats_Init(o->stats, "overhead");
+                Latch_Init(&o->start, n + 1);
+                ThreadGroup g;
+                ThreadGroup_Init(&g);
+                for (int i = 0; i < n; ++i)
+                    ok &= ThreadGroup_Spawn(&g, overhead_worker, o);
+                Latch_CountDown(&o->start);
+                Latch_Wait(&o->start, MT_INFINITE);
+                int64_t t = mt_now_ns();
+                ThreadGroup_Join(&g, MT_INFINITE);
+                t = mt_now_ns() - t;
+                if ((double)t < best)
+                    best = (double)t;
+
+                if (MODE_SHARDED == mode) {
+                    QueueStatsSnapshot * snap = (QueueStatsSnapshot *)malloc(sizeof(QueueStatsSnapshot));
+                    QueueStats_Snapshot(o->stats, snap);
+                    int64_t total = (int64_t)n * OPS, depths = 0, latencies = 0;
+                    for (int i = 0; i < QUEUE_STATS_BUCKETS; ++i) {
+                        depths += snap->depth[i];
+                        latencies += snap->latency[i];
+                    }
+                    ok &= (snap->counters[QSTAT_ENQUEUE] == total && snap->counters[QSTAT_DEQUEUE] == total
+                        && snap->counters[QSTAT_LOCK_ACQUIRE] == total && 0 == snap->counters[QSTAT_LOCK_CONTENDED]
+                        && depths == total && latencies == total && 0 == QueueStats_Percentile(snap->depth, 0.0));
+                    free(snap);
+                } else if (MODE_SHARED == mode) {
+                    ok &= (o->shared->counters[QSTAT_DEQUEUE] == (int64_t)n * OPS);
+                }
+                ThreadGroup_Deinit(&g);
+                Latch_Deinit(&o->start);
+                free(o->shared);
+                free(o->stats);
+                free(o);
+            }
+            printf(" %10.1f", best / ((double)n * OPS));
+        }
+        printf("%s\n", ok ? "" : "  (MISMATCH)");
+        fflush(stdout);
+    }
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region dump
+/* app01/app03's shape: a bounded ring under one lock, producers and consumers polling it */
+typedef struct Ring {
+    MtLock              lock;
+    int64_t             stamps[RING];
+    int64_t             values[RING];
+    int                 head;
+    int                 count;
+    QueueStats          stats;
+    int64_t volatile    producers_left;
+    int64_t volatile    sum;
+} Ring;
+
+static void
+producer (void * arg) {
+    Ring * r = (Ring *)arg;
+    for (int64_t v = 1; v <= ITEMS; ) {
+        QueueStats_Lock(&r->stats, &r->lock);
+        if (r->count == RING) {
+            mt_unlock(&r->lock);
+            QueueStats_Add(&r->stats, QSTAT_FULL, 1);
+            mt_yield();
+            continue;
+        }
+        int tail = (r->head + r->count) % RING;
+        r->values[tail] = v++;
+        r->stamps[tail] = QueueStats_Now();
+        int depth = ++r->count;
+        mt_unlock(&r->lock);
+        QueueStats_Enqueue(&r->stats, depth);
+    }
+    mt_fetch_add(&r->producers_left, -1);
+}
+static void
+consumer (void * arg) {
+    Ring * r = (Ring *)arg;
+    int64_t sum = 0;
+    for (;;) {
+        int left = (int)mt_load_acquire(&r->producers_left);
+        QueueStats_Lock(&r->stats, &r->lock);
+        if (0 == r->count) {
+            mt_unlock(&r->lock);
+            if (0 == left)
+                break;
+            QueueStats_Add(&r->stats, QSTAT_EMPTY, 1);
+            mt_yield();
+            continue;
+        }
+        int64_t v = r->values[r->head], stamp = r->stamps[r->head];
+        r->head = (r->head + 1) % RING;
+        r->count--;
+        mt_unlock(&r->lock);
+        QueueStats_Dequeue(&r->stats, stamp);
+        sum += v;
+    }
+    mt_fetch_add(&r->sum, sum);
+}
+
+static void
+bench_dump (void) {
+    Ring * r = (Ring *)calloc(1, sizeof(Ring));
+    ThreadGroup g;
+    int ok = 1;
+    printf("\ndump: %d producers x %d items, %d consumers, ring of %d\n", DUMP_PAIRS, ITEMS, DUMP_PAIRS, RING);
+    mt_lock_init(&r->lock);
+    QueueStats_Init(&r->stats, "ring");
+    r->producers_left = DUMP_PAIRS;
+    ThreadGroup_Init(&g);
+    for (int i = 0; i < DUMP_PAIRS; ++i) {
+        ok &= ThreadGroup_Spawn(&g, producer, r);
+        ok &= ThreadGroup_Spawn(&g, consumer, r);
+    }
+    ThreadGroup_Join(&g, MT_INFINITE);
+
+    QueueStatsSnapshot * snap = (QueueStatsSnapshot *)malloc(sizeof(QueueStatsSnapshot));
+    QueueStats_Snapshot(&r->stats, snap);
+    int64_t total = (int64_t)DUMP_PAIRS * ITEMS;
+    ok &= (r->sum == DUMP_PAIRS * ((int64_t)ITEMS * (ITEMS + 1) / 2));
+    ok &= (snap->counters[QSTAT_ENQUEUE] == total && snap->counters[QSTAT_DEQUEUE] == total);
+    QueueStats_Print(snap, stdout);
+    QueueStats_WriteJson(snap, stdout);
+    printf("%s\n", ok ? "ok" : "(MISMATCH)");
+
+    free(snap);
+    ThreadGroup_Deinit(&g);
+    mt_lock_deinit(&r->lock);
+    free(r);
+}
+#pragma endregion
+
+// =========================================================================================
+
+int main (int argc, char * argv []) {
+    if (BenchUtil_Wanted(argc, argv, "overhead"))
+        bench_overhead();
+    if (BenchUtil_Wanted(argc, argv, "dump"))
+        bench_dump();
+    return(0);
+}
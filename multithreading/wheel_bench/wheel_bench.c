@@ -0,0 +1,373 @@
+/* ===========================================================
+   #File: wheel_bench.c #
+   #Date: 19 October 2026 #
+   #Revision: 1.0 #
+   #Creator: Omid Miresmaeili #
+   #Description: Timer wheel vs a timer heap and vs one timed kernel wait per waiter #
+   #Notice: (C) Copyright 2021 by Omid. All Rights Reserved. #
+   =========================================================== */
+
+/*
+    ops         ns per arm + cancel with N timers pending (none due): the
+                wheel's O(1) slot lists vs a binary heap of timers, each
+                under a lock
+    fire        N timers armed 1..FIRE_SPAN_MS ahead; how late they fire,
+                by percentile. Every timer must fire once, never early
+    waits       T threads each time out WAITS times on a condition nobody
+                signals (the apps' queue timeouts): mt_cond_wait_ms per
+                waiter vs an untimed wait and a TimedWait on the wheel.
+                Lateness and wall time
+
+wheel_bench [ops] [fire] [waits]; no arguments runs all three.
+*/
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L    /* clock_gettime */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../common/mt_platform.h"
+#include "../common/thread_group.h"
+#include "../common/timer_wheel.h"
+#include "../../bench/bench_util.h"
+
+#ifndef _countof
+#define _countof(a) (sizeof(a) / sizeof((a)[0]))
+#endif
+
+#define TICK_MS         1
+#define OPS             (1 << 20)
+#define FIRE_TIMERS     100000
+#define FIRE_SPAN_MS    2000
+#define WAITS           5
+#define WAIT_MS         20          // plus up to as much again
+
+static int const g_pending [] = {1024, 16384, 262144};
+static int const g_threads [] = {64, 256, 1024};
+
+static uint64_t
+xorshift (uint64_t * s) {
+    *s ^= *s << 13;
+    *s ^= *s >> 7;
+    *s ^= *s << 17;
+    return *s;
+}
+static int
+compare_i64 (void const * a, void const * b) {
+    int64_t x = *(int64_t const *)a, y = *(int64_t const *)b;
+    return (x > y) - (x < y);
+}
+static void
+noop (void * arg) {
+    (void)arg;
+}
+
+// =========================================================================================
+
+#pragma region ops
+/* The usual alternative: a min-heap of expiries, each timer knowing its index for cancel */
+typedef struct HeapTimer {
+    int64_t     expires;
+    int         index;      // -1 when not armed
+} HeapTimer;
+
+typedef struct TimerHeap {
+    MtLock          lock;
+    HeapTimer **    items;
+    int             count;
+} TimerHeap;
+
+static void
+heap_swap (TimerHeap * h, int a, int b) {
+    HeapTimer * t = h->items[a];
+    h->items[a] = h->items[b];
+    h->items[b] = t;
+    h->items[a]->index = a;
+    h->items[b]->index = b;
+}
+static void
+heap_fix (TimerHeap * h, int i) {
+    while (i > 0 && h->items[i]->expires < h->items[(i - 1) / 2]->expires) {
+        heap_swap(h, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+    for (;;) {
+        int c = 2 * i + 1;
+        if (c >= h->count)
+            break;
+        if (c + 1 < h->count && h->items[c + 1]->expires < h->items[c]->expires)
+            c++;
+        if (h->items[i]->expires <= h->items[c]->expires)
+            break;
+        heap_swap(h, i, c);
+        i = c;
+    }
+}
+static void
+heap_arm (TimerHeap * h, HeapTimer * t, int64_t ms) {
+    int64_t expires = mt_now_ns() + ms * 1000000;
+    mt_lock(&h->lock);
+    t->expires = expires;
+    t->index = h->count;
+    h->items[h->count++] = t;
+    heap_fix(h, t->index);
+    mt_unlock(&h->lock);
+}
+static int
+heap_cancel (TimerHeap * h, HeapTimer * t) {
+    mt_lock(&h->lock);
+    int i = t->index, ret = (i >= 0);
+    if (ret) {
+        h->items[i] = h->items[--h->count];
+        h->items[i]->index = i;
+        if (i < h->count)
+            heap_fix(h, i);
+        t->index = -1;
+    }
+    mt_unlock(&h->lock);
+    return ret;
+}
+
+/* Far-off timeouts, like queue waits that are almost always satisfied first */
+static int64_t
+far_ms (uint64_t * rng) {
+    return 10000 + (int64_t)(xorshift(rng) % 50000);
+}
+static double
+ops_wheel (int pending, int * ok) {
+    TimerWheel w;
+    Timer * timers = (Timer *)malloc(sizeof(Timer) * (size_t)(pending + 1));
+    uint64_t rng = 88172645463325252ULL;
+    int cancelled = 0;
+    if (!TimerWheel_Init(&w, TICK_MS)) {
+        *ok = 0;
+        free(timers);
+        return 0;
+    }
+    for (int i = 0; i <= pending; ++i)
+        Timer_Init(&timers[i], noop, NULL);
+    for (int i = 0; i < pending; ++i)
+        TimerWheel_Arm(&w, &timers[i], far_ms(&rng));
+
+    int64_t t = mt_now_ns();
+    for (int i = 0; i < OPS; ++i) {
+        TimerWheel_Arm(&w, &timers[pending], far_ms(&rng));
+        cancelled += TimerWheel_Cancel(&w, &timers[pending]);
+    }
+    t = mt_now_ns() - t;
+
+    *ok &= (cancelled == OPS && w.pending == pending);
+    for (int i = 0; i < pending; ++i)
+        TimerWheel_Cancel(&w, &timers[i]);
+    *ok &= (0 == w.pending);
+    TimerWheel_Deinit(&w);
+    free(timers);
+    return (double)t / OPS;
+}
+static double
+ops_heap (int pending, int * ok) {
+    TimerHeap h;
+    HeapTimer * timers = (HeapTimer *)malloc(sizeof(HeapTimer) * (size_t)(pending + 1));
+    uint64_t rng = 88172645463325252ULL;
+    int cancelled = 0;
+    mt_lock_init(&h.lock);
+    h.items = (HeapTimer **)malloc(sizeof(HeapTimer *) * (size_t)(pending + 1));
+    h.count = 0;
+    for (int i = 0; i < pending; ++i)
+        heap_arm(&h, &timers[i], far_ms(&rng));
+
+    int64_t t = mt_now_ns();
+    for (int i = 0; i < OPS; ++i) {
+        heap_arm(&h, &timers[pending], far_ms(&rng));
+        cancelled += heap_cancel(&h, &timers[pending]);
+    }
+    t = mt_now_ns() - t;
+
+    *ok &= (cancelled == OPS && h.count == pending);
+    mt_lock_deinit(&h.lock);
+    free(h.items);
+    free(timers);
+    return (double)t / OPS;
+}
+static void
+bench_ops (void) {
+    printf("\nops: ns per arm + cancel (best of %d)\n", BENCH_REPS);
+    printf("%10s %10s %10s\n", "pending", "wheel", "heap");
+    for (size_t k = 0; k < _countof(g_pending); ++k) {
+        double wheel = 1e30, heap = 1e30;
+        int ok = 1;
+        for (int rep = 0; rep < BENCH_REPS; ++rep) {
+            double a = ops_wheel(g_pending[k], &ok), b = ops_heap(g_pending[k], &ok);
+            wheel = (a < wheel) ? a : wheel;
+            heap = (b < heap) ? b : heap;
+        }
+        printf("%10d %10.1f %10.1f%s\n", g_pending[k], wheel, heap, ok ? "" : "  (MISMATCH)");
+    }
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region fire
+typedef struct FireTimer {
+    Timer       timer;
+    int64_t     deadline_ns;
+    int64_t     late_ns;
+    int64_t     fires;
+    Latch *     done;
+} FireTimer;
+
+static void
+fire (void * arg) {
+    FireTimer * f = (FireTimer *)arg;
+    f->late_ns = mt_now_ns() - f->deadline_ns;
+    f->fires++;
+    Latch_CountDown(f->done);
+}
+static void
+bench_fire (void) {
+    TimerWheel w;
+    Latch done;
+    FireTimer * timers = (FireTimer *)calloc(FIRE_TIMERS, sizeof(FireTimer));
+    int64_t * late = (int64_t *)malloc(sizeof(int64_t) * FIRE_TIMERS);
+    uint64_t rng = 0x2545F4914F6CDD1DULL;
+    int ok = 1;
+    if (!TimerWheel_Init(&w, TICK_MS))
+        return;
+    Latch_Init(&done, FIRE_TIMERS);
+
+    int64_t t = mt_now_ns();
+    for (int i = 0; i < FIRE_TIMERS; ++i) {
+        int64_t ms = 1 + (int64_t)(xorshift(&rng) % FIRE_SPAN_MS);
+        Timer_Init(&timers[i].timer, fire, &timers[i]);
+        timers[i].done = &done;
+        timers[i].deadline_ns = mt_now_ns() + ms * 1000000;
+        TimerWheel_Arm(&w, &timers[i].timer, ms);
+    }
+    int64_t arm_ns = mt_now_ns() - t;
+    ok &= Latch_Wait(&done, FIRE_SPAN_MS + 5000);
+    TimerWheel_Deinit(&w);
+    Latch_Deinit(&done);
+
+    int64_t early = 0;
+    for (int i = 0; i < FIRE_TIMERS; ++i) {
+        ok &= (1 == timers[i].fires);
+        early += (timers[i].late_ns < 0);
+        late[i] = timers[i].late_ns;
+    }
+    qsort(late, FIRE_TIMERS, sizeof(int64_t), compare_i64);
+    printf("\nfire: %d timers over %d ms, %d ms ticks, armed in %.1f ms\n",
+        FIRE_TIMERS, FIRE_SPAN_MS, TICK_MS, (double)arm_ns * 1e-6);
+    printf("late (us): p50 %.0f  p99 %.0f  p99.9 %.0f  max %.0f  early %lld%s\n",
+        late[FIRE_TIMERS / 2] * 1e-3, late[FIRE_TIMERS / 100 * 99] * 1e-3,
+        late[FIRE_TIMERS / 1000 * 999] * 1e-3, late[FIRE_TIMERS - 1] * 1e-3,
+        (long long)early, (ok && 0 == early) ? "" : "  (MISMATCH)");
+    free(late);
+    free(timers);
+}
+#pragma endregion
+
+// =========================================================================================
+
+#pragma region waits
+typedef struct Waiter {
+    TimerWheel *        wheel;      // NULL: timed kernel waits
+    MtLock              lock;
+    MtCond              cond;
+    int                 signaled;   // never set: every wait times out
+    int64_t             late_ns;
+    int64_t             timeouts;
+    uint64_t            rng;
+} Waiter;
+
+static void
+waiter (void * arg) {
+    Waiter * wt = (Waiter *)arg;
+    for (int i = 0; i < WAITS; ++i) {
+        int64_t ms = WAIT_MS + (int64_t)(xorshift(&wt->rng) % WAIT_MS);
+        int64_t deadline = mt_now_ns() + ms * 1000000;
+        int expired = 0;
+        mt_lock(&wt->lock);
+        if (wt->wheel != NULL) {
+            TimedWait tw;
+            TimedWait_Begin(wt->wheel, &tw, &wt->lock, &wt->cond, ms);
+            while (!wt->signaled && !tw.expired)
+                mt_cond_wait(&wt->cond, &wt->lock);
+            mt_unlock(&wt->lock);
+            expired = TimedWait_End(wt->wheel, &tw);
+        } else {
+            // -- the queues' way: a timed wait, re-armed with what is left after a spurious wakeup
+            while (!wt->signaled) {
+                int64_t left_ms = (deadline - mt_now_ns() + 999999) / 1000000;
+                if (left_ms <= 0 || !mt_cond_wait_ms(&wt->cond, &wt->lock, left_ms)) {
+                    expired = 1;
+                    break;
+                }
+            }
+            mt_unlock(&wt->lock);
+        }
+        int64_t late = mt_now_ns() - deadline;
+        wt->late_ns += (late > 0) ? late : 0;
+        wt->timeouts += expired;
+    }
+}
+static void
+bench_waits (void) {
+    printf("\nwaits: %d timeouts of %d..%d ms per thread\n", WAITS, WAIT_MS, 2 * WAIT_MS - 1);
+    printf("%8s %-8s %12s %14s\n", "threads", "timeout", "wall ms", "mean late us");
+    for (size_t k = 0; k < _countof(g_threads); ++k) {
+        for (int use_wheel = 0; use_wheel < 2; ++use_wheel) {
+            int n = g_threads[k], ok = 1;
+            TimerWheel w;
+            ThreadGroup g;
+            Waiter * wts = (Waiter *)calloc((size_t)n, sizeof(Waiter));
+            if (use_wheel && !TimerWheel_Init(&w, TICK_MS))
+                return;
+            ThreadGroup_Init(&g);
+
+            int64_t t = mt_now_ns();
+            for (int i = 0; i < n; ++i) {
+                wts[i].wheel = use_wheel ? &w : NULL;
+                wts[i].rng = 0x9E3779B97F4A7C15ULL * (uint64_t)(i + 1);
+                mt_lock_init(&wts[i].lock);
+                mt_cond_init(&wts[i].cond);
+                ok &= ThreadGroup_Spawn(&g, waiter, &wts[i]);
+            }
+            ThreadGroup_Join(&g, MT_INFINITE);
+            t = mt_now_ns() - t;
+
+            int64_t late = 0;
+            for (int i = 0; i < n; ++i) {
+                ok &= (WAITS == wts[i].timeouts);
+                late += wts[i].late_ns;
+                mt_lock_deinit(&wts[i].lock);
+                mt_cond_deinit(&wts[i].cond);
+            }
+            ThreadGroup_Deinit(&g);
+            if (use_wheel)
+                TimerWheel_Deinit(&w);
+            printf("%8d %-8s %12.1f %14.1f%s\n", n, use_wheel ? "wheel" : "kernel",
+                (double)t * 1e-6, (double)late * 1e-3 / ((double)n * WAITS), ok ? "" : "  (MISMATCH)");
+            fflush(stdout);
+            free(wts);
+        }
+    }
+}
+#pragma endregion
+
+// =========================================================================================
+
+int main (int argc, char * argv []) {
+    if (BenchUtil_Wanted(argc, argv, "ops"))
+        bench_ops();
+    if (BenchUtil_Wanted(argc, argv, "fire"))
+        bench_fire();
+    if (BenchUtil_Wanted(argc, argv, "waits"))
+        bench_waits();
+    return(0);
+}